@@ -8,6 +8,9 @@
 #include <Windows.h>
 #include <stdio.h>
 #include <stdint.h>
+#include "../src/coop_hook.h"
+#include "../src/coop_profiler.h"
+#include "../src/coop_log.h"
 
 // =====================================================
 // CONFIGURAÇÃO - PREENCHER APÓS ANÁLISE NO GHIDRA
@@ -58,12 +61,11 @@ HMODULE g_moduleBase = nullptr;
 // UTILIDADES
 // =====================================================
 
-void Log(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    vprintf(format, args);
-    va_end(args);
-    printf("\n");
+// Só copia formato e argumentos; a thread do Logger formata e escreve
+// (seguro dentro dos hooks). O formato precisa ser literal.
+template<typename... Args>
+void Log(const char* format, const Args&... args) {
+    CoopLog(format, args...);
 }
 
 uintptr_t GetAddress(uintptr_t offset) {
@@ -85,6 +87,8 @@ RenderPlayer_t Original_RenderPlayer = nullptr;
 
 // Hook: Player Update
 void Hooked_PlayerUpdate(Player* player, float deltaTime) {
+    COOP_PROFILE_ZONE("Hooked_PlayerUpdate");
+    
     // Atualiza Player 1 normalmente
     Original_PlayerUpdate(player, deltaTime);
     
@@ -105,6 +109,8 @@ void Hooked_ReadInput(InputState* input) {
 
 // Hook: Render Player
 void Hooked_RenderPlayer(Player* player) {
+    COOP_PROFILE_ZONE("Hooked_RenderPlayer");
+    
     // Renderiza Player 1
     Original_RenderPlayer(player);
     
@@ -118,31 +124,26 @@ void Hooked_RenderPlayer(Player* player) {
 // INSTALAÇÃO DE HOOKS
 // =====================================================
 
-bool WriteJump(uintptr_t address, void* destination) {
-    DWORD oldProtect;
-    if (!VirtualProtect((void*)address, 5, PAGE_EXECUTE_READWRITE, &oldProtect)) {
-        return false;
-    }
-    
-    // Escreve JMP (E9 + offset relativo)
-    *(uint8_t*)address = 0xE9;
-    *(uint32_t*)(address + 1) = (uint32_t)((uintptr_t)destination - address - 5);
-    
-    VirtualProtect((void*)address, 5, oldProtect, &oldProtect);
-    return true;
-}
-
 void InstallHooks() {
     Log("[HOOK] Instalando hooks...");
     
+    HookEngine& hooks = HookEngine::Instance();
+    
     // TODO: Instalar hooks quando tiver os endereços
     
-    // Exemplo:
+    // Exemplo (Original_* aponta para o trampolim):
     // uintptr_t addr = GetAddress(OFFSET_PLAYER_UPDATE);
-    // Original_PlayerUpdate = (PlayerUpdate_t)addr;
-    // WriteJump(addr, Hooked_PlayerUpdate);
+    // HookStatus status = hooks.Create((void*)addr, (void*)Hooked_PlayerUpdate, (void**)&Original_PlayerUpdate);
+    // if (status != HookStatus::OK) Log("[HOOK] PlayerUpdate falhou (%d)", (int)status);
+    
+    // Todos de uma vez: uma troca de proteção por página
+    hooks.SetAllEnabled(true);
+    if (hooks.Apply() != HookStatus::OK) {
+        Log("[HOOK] Falha ao escrever os hooks!");
+        return;
+    }
     
-    Log("[HOOK] Hooks instalados!");
+    Log("[HOOK] %u hooks instalados!", hooks.HookCount());
 }
 
 // =====================================================
@@ -171,6 +172,7 @@ DWORD WINAPI ModThread(LPVOID param) {
     // Cria console para debug
     AllocConsole();
     freopen("CONOUT$", "w", stdout);
+    Logger::Instance().Start(LOG_FILE, true);
     
     Log("========================================");
     Log("  RESIDENT EVIL CO-OP MOD");
@@ -210,6 +212,21 @@ DWORD WINAPI ModThread(LPVOID param) {
             Log("[INFO] Mod enabled: %s", g_modEnabled ? "sim" : "não");
         }
         
+#ifdef COOP_PROFILING
+        // F4 = Liga/desliga gravação do trace
+        if (GetAsyncKeyState(VK_F4) & 1) {
+            Profiler& profiler = Profiler::Instance();
+            if (profiler.IsEnabled()) {
+                profiler.Stop();
+                Log("[PROF] Trace salvo: %s (%llu eventos, %u descartados)", PROFILER_TRACE_FILE,
+                    (unsigned long long)profiler.EventsWritten(), profiler.Dropped());
+            }
+            else if (profiler.Start()) {
+                Log("[PROF] Gravando trace...");
+            }
+        }
+#endif
+        
         Sleep(100);
     }
     
@@ -0,0 +1,8 @@
+/**
+ * RE4 CO-OP MOD - WS2tcpip sobre POSIX (só para o harness)
+ *
+ * getaddrinfo/inet_pton/inet_ntop já vêm de <netdb.h> e <arpa/inet.h>.
+ */
+
+#pragma once
+#include "WinSock2.h"
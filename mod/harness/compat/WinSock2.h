@@ -0,0 +1,90 @@
+/**
+ * RE4 CO-OP MOD - Winsock sobre sockets BSD (só para o harness)
+ *
+ * Só as diferenças que o código de rede do mod enxerga:
+ * - select() ignora o primeiro argumento no Windows
+ * - SO_RCVTIMEO recebe um DWORD em milissegundos
+ * - closesocket() acorda quem está bloqueado em recv() na mesma socket
+ */
+
+#pragma once
+#include "Windows.h"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+typedef int SOCKET;
+
+#define INVALID_SOCKET (-1)
+#define SOCKET_ERROR (-1)
+#define MAKEWORD(a, b) ((WORD)(((BYTE)(a)) | ((WORD)((BYTE)(b))) << 8))
+
+typedef struct {
+    WORD wVersion;
+    WORD wHighVersion;
+} WSADATA;
+
+inline int WSAStartup(WORD version, WSADATA* data) {
+    data->wVersion = version;
+    data->wHighVersion = version;
+    return 0;
+}
+
+inline int WSACleanup() { return 0; }
+inline int WSAGetLastError() { return errno; }
+
+inline int closesocket(SOCKET s) {
+    shutdown(s, SHUT_RDWR);
+    return close(s);
+}
+
+inline int ioctlsocket(SOCKET s, long command, unsigned long* argument) {
+    int value = (int)*argument;
+    return ioctl(s, (unsigned long)command, &value);
+}
+
+inline int CompatSelect(int, fd_set* readSet, fd_set* writeSet, fd_set* errorSet, timeval* timeout) {
+    return select(FD_SETSIZE, readSet, writeSet, errorSet, timeout);
+}
+
+inline int CompatSetsockopt(SOCKET s, int level, int name, const char* value, int size) {
+    if (level == SOL_SOCKET && (name == SO_RCVTIMEO || name == SO_SNDTIMEO) && size == (int)sizeof(DWORD)) {
+        DWORD ms;
+        memcpy(&ms, value, sizeof(ms));
+        timeval timeout;
+        timeout.tv_sec = ms / 1000;
+        timeout.tv_usec = (ms % 1000) * 1000;
+        return setsockopt(s, level, name, &timeout, sizeof(timeout));
+    }
+    return setsockopt(s, level, name, value, (socklen_t)size);
+}
+
+inline SOCKET CompatAccept(SOCKET s, sockaddr* address, int* length) {
+    socklen_t size = length ? (socklen_t)*length : 0;
+    SOCKET client = accept(s, address, length ? &size : nullptr);
+    if (length) *length = (int)size;
+    return client;
+}
+
+inline int CompatRecvfrom(SOCKET s, char* buffer, int size, int flags, sockaddr* from, int* length) {
+    socklen_t fromSize = length ? (socklen_t)*length : 0;
+    int received = (int)recvfrom(s, buffer, size, flags, from, length ? &fromSize : nullptr);
+    if (length) *length = (int)fromSize;
+    return received;
+}
+
+// send() num socket fechado pelo outro lado vira erro, não SIGPIPE
+inline int CompatSend(SOCKET s, const char* buffer, int size, int flags) {
+    return (int)send(s, buffer, (size_t)size, flags | MSG_NOSIGNAL);
+}
+
+#define select(n, r, w, e, t) CompatSelect(n, r, w, e, t)
+#define setsockopt(s, l, n, v, z) CompatSetsockopt(s, l, n, v, z)
+#define accept(s, a, l) CompatAccept(s, a, l)
+#define recvfrom(s, b, n, f, a, l) CompatRecvfrom(s, b, n, f, a, l)
+#define send(s, b, n, f) CompatSend(s, b, n, f)
@@ -0,0 +1,473 @@
+/**
+ * RE4 CO-OP MOD - Win32 mínimo sobre POSIX (só para o harness)
+ *
+ * O código de mod/src inclui <Windows.h> direto. No harness este
+ * diretório vem antes no include path e implementa só o que o mod usa,
+ * em cima de mmap, mprotect, sigaction e /proc/self/maps.
+ *
+ * GetModuleHandleA(nullptr) devolve a imagem registrada pelo harness com
+ * CompatSetMainModule() (o "executável do jogo" falso).
+ */
+
+#pragma once
+#include <cerrno>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+//=============================================================================
+// TIPOS
+//=============================================================================
+
+typedef uint32_t DWORD;
+typedef int BOOL;
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef int32_t LONG;
+typedef int64_t LONGLONG;
+typedef size_t SIZE_T;
+typedef void* HANDLE;
+typedef void* HMODULE;
+typedef void* LPVOID;
+typedef const char* LPCSTR;
+typedef char* LPSTR;
+typedef uintptr_t ULONG_PTR;
+
+typedef union {
+    struct {
+        DWORD LowPart;
+        LONG HighPart;
+    };
+    LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+#define TRUE 1
+#define FALSE 0
+#define WINAPI
+#define APIENTRY
+#define __declspec(x)
+#define MAX_PATH 260
+
+#define PAGE_NOACCESS 0x01
+#define PAGE_READONLY 0x02
+#define PAGE_READWRITE 0x04
+#define PAGE_WRITECOPY 0x08
+#define PAGE_EXECUTE 0x10
+#define PAGE_EXECUTE_READ 0x20
+#define PAGE_EXECUTE_READWRITE 0x40
+#define PAGE_EXECUTE_WRITECOPY 0x80
+#define PAGE_GUARD 0x100
+
+#define MEM_COMMIT 0x1000
+#define MEM_RESERVE 0x2000
+#define MEM_RELEASE 0x8000
+#define MEM_FREE 0x10000
+#define MEM_PRIVATE 0x20000
+
+#define ZeroMemory(p, n) memset((p), 0, (n))
+
+typedef struct {
+    void* BaseAddress;
+    void* AllocationBase;
+    DWORD AllocationProtect;
+    SIZE_T RegionSize;
+    DWORD State;
+    DWORD Protect;
+    DWORD Type;
+} MEMORY_BASIC_INFORMATION;
+
+typedef struct {
+    WORD wProcessorArchitecture;
+    WORD wReserved;
+    DWORD dwPageSize;
+    void* lpMinimumApplicationAddress;
+    void* lpMaximumApplicationAddress;
+    uintptr_t dwActiveProcessorMask;
+    DWORD dwNumberOfProcessors;
+    DWORD dwProcessorType;
+    DWORD dwAllocationGranularity;
+    WORD wProcessorLevel;
+    WORD wProcessorRevision;
+} SYSTEM_INFO;
+
+//=============================================================================
+// PE (layout de 32 bits, o do executável do jogo)
+//=============================================================================
+
+#pragma pack(push, 1)
+
+typedef struct {
+    WORD e_magic;
+    WORD e_reserved[29];
+    LONG e_lfanew;
+} IMAGE_DOS_HEADER;
+
+typedef struct {
+    WORD Machine;
+    WORD NumberOfSections;
+    DWORD TimeDateStamp;
+    DWORD PointerToSymbolTable;
+    DWORD NumberOfSymbols;
+    WORD SizeOfOptionalHeader;
+    WORD Characteristics;
+} IMAGE_FILE_HEADER;
+
+typedef struct {
+    WORD Magic;
+    BYTE MajorLinkerVersion;
+    BYTE MinorLinkerVersion;
+    DWORD SizeOfCode;
+    DWORD SizeOfInitializedData;
+    DWORD SizeOfUninitializedData;
+    DWORD AddressOfEntryPoint;
+    DWORD BaseOfCode;
+    DWORD BaseOfData;
+    DWORD ImageBase;
+    DWORD SectionAlignment;
+    DWORD FileAlignment;
+    WORD Versions[6];
+    DWORD Win32VersionValue;
+    DWORD SizeOfImage;
+    DWORD SizeOfHeaders;
+    DWORD CheckSum;
+} IMAGE_OPTIONAL_HEADER;
+
+typedef struct {
+    DWORD Signature;
+    IMAGE_FILE_HEADER FileHeader;
+    IMAGE_OPTIONAL_HEADER OptionalHeader;
+} IMAGE_NT_HEADERS;
+
+typedef struct {
+    BYTE Name[8];
+    union {
+        DWORD PhysicalAddress;
+        DWORD VirtualSize;
+    } Misc;
+    DWORD VirtualAddress;
+    DWORD SizeOfRawData;
+    DWORD PointerToRawData;
+    DWORD PointerToRelocations;
+    DWORD PointerToLinenumbers;
+    WORD NumberOfRelocations;
+    WORD NumberOfLinenumbers;
+    DWORD Characteristics;
+} IMAGE_SECTION_HEADER;
+
+#pragma pack(pop)
+
+#define IMAGE_FIRST_SECTION(h) \
+    ((IMAGE_SECTION_HEADER*)((uint8_t*)&(h)->OptionalHeader + (h)->FileHeader.SizeOfOptionalHeader))
+#define IMAGE_SCN_MEM_EXECUTE 0x20000000
+#define IMAGE_SCN_MEM_READ 0x40000000
+#define IMAGE_SCN_MEM_WRITE 0x80000000
+
+//=============================================================================
+// TEMPO E THREADS
+//=============================================================================
+
+inline uint64_t CompatMonotonicNanos() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+inline DWORD GetTickCount() { return (DWORD)(CompatMonotonicNanos() / 1000000ull); }
+inline void Sleep(DWORD ms) { usleep((useconds_t)ms * 1000); }
+inline DWORD GetCurrentThreadId() { return (DWORD)syscall(SYS_gettid); }
+
+inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency) {
+    frequency->QuadPart = 1000000000;
+    return TRUE;
+}
+
+inline BOOL QueryPerformanceCounter(LARGE_INTEGER* counter) {
+    counter->QuadPart = (LONGLONG)CompatMonotonicNanos();
+    return TRUE;
+}
+
+//=============================================================================
+// MÓDULO
+//=============================================================================
+
+inline HMODULE& CompatMainModuleStorage() {
+    static HMODULE module = nullptr;
+    return module;
+}
+
+// Imagem PE falsa que faz o papel do executável do jogo
+inline void CompatSetMainModule(void* image) { CompatMainModuleStorage() = image; }
+
+inline HMODULE GetModuleHandleA(const char* name) {
+    return name ? nullptr : CompatMainModuleStorage();
+}
+
+inline HMODULE GetModuleHandle(const char* name) { return GetModuleHandleA(name); }
+
+// DllMain compila, mas o harness nunca chama
+#define DLL_PROCESS_DETACH 0
+#define DLL_PROCESS_ATTACH 1
+
+inline BOOL DisableThreadLibraryCalls(HMODULE) { return TRUE; }
+
+inline DWORD GetModuleFileNameA(HMODULE, char* path, DWORD size) {
+    ssize_t length = readlink("/proc/self/exe", path, size ? size - 1 : 0);
+    if (length <= 0) return 0;
+    path[length] = '\0';
+    return (DWORD)length;
+}
+
+//=============================================================================
+// MEMÓRIA VIRTUAL
+//=============================================================================
+
+inline int CompatProtectFlags(DWORD protect) {
+    switch (protect & 0xFF) {
+        case PAGE_READONLY: return PROT_READ;
+        case PAGE_READWRITE:
+        case PAGE_WRITECOPY: return PROT_READ | PROT_WRITE;
+        case PAGE_EXECUTE: return PROT_EXEC;
+        case PAGE_EXECUTE_READ: return PROT_READ | PROT_EXEC;
+        case PAGE_EXECUTE_READWRITE:
+        case PAGE_EXECUTE_WRITECOPY: return PROT_READ | PROT_WRITE | PROT_EXEC;
+        default: return PROT_NONE;
+    }
+}
+
+inline DWORD CompatPageProtect(bool read, bool write, bool exec) {
+    if (exec) return write ? PAGE_EXECUTE_READWRITE : (read ? PAGE_EXECUTE_READ : PAGE_EXECUTE);
+    if (write) return PAGE_READWRITE;
+    return read ? PAGE_READONLY : PAGE_NOACCESS;
+}
+
+inline void GetSystemInfo(SYSTEM_INFO* info) {
+    memset(info, 0, sizeof(*info));
+    info->dwPageSize = (DWORD)sysconf(_SC_PAGESIZE);
+    info->dwAllocationGranularity = 0x10000;
+    info->lpMinimumApplicationAddress = (void*)0x10000;
+    info->lpMaximumApplicationAddress = (void*)0x7FFFFFFEFFFFull;
+    info->dwNumberOfProcessors = (DWORD)sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+// Procura a região em /proc/self/maps. Fora de qualquer mapeamento é
+// MEM_FREE até o próximo.
+inline SIZE_T VirtualQuery(const void* address, MEMORY_BASIC_INFORMATION* info, SIZE_T size) {
+    if (size < sizeof(*info)) return 0;
+
+    uintptr_t at = (uintptr_t)address;
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t gapEnd = ~(uintptr_t)0;
+
+    memset(info, 0, sizeof(*info));
+    FILE* maps = fopen("/proc/self/maps", "r");
+    if (!maps) return 0;
+
+    char line[512];
+    bool found = false;
+    while (fgets(line, sizeof(line), maps)) {
+        unsigned long start, end;
+        char perms[5] = {};
+        if (sscanf(line, "%lx-%lx %4s", &start, &end, perms) != 3) continue;
+
+        if (at >= start && at < end) {
+            info->BaseAddress = (void*)start;
+            info->AllocationBase = (void*)start;
+            info->RegionSize = end - start;
+            info->State = MEM_COMMIT;
+            info->Type = MEM_PRIVATE;
+            info->Protect = CompatPageProtect(perms[0] == 'r', perms[1] == 'w', perms[2] == 'x');
+            info->AllocationProtect = info->Protect;
+            found = true;
+            break;
+        }
+        if (start > at) {
+            gapEnd = start;
+            break;
+        }
+    }
+    fclose(maps);
+
+    if (!found) {
+        info->BaseAddress = (void*)(at & ~(page - 1));
+        info->RegionSize = gapEnd - (uintptr_t)info->BaseAddress;
+        info->AllocationBase = nullptr;
+        info->State = MEM_FREE;
+        info->Protect = PAGE_NOACCESS;
+    }
+    return sizeof(*info);
+}
+
+inline BOOL VirtualProtect(void* address, SIZE_T size, DWORD protect, DWORD* oldProtect) {
+    MEMORY_BASIC_INFORMATION info;
+    if (oldProtect) {
+        *oldProtect = VirtualQuery(address, &info, sizeof(info)) ? info.Protect : PAGE_NOACCESS;
+    }
+
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)address & ~(page - 1);
+    uintptr_t end = ((uintptr_t)address + size + page - 1) & ~(page - 1);
+    return mprotect((void*)start, end - start, CompatProtectFlags(protect)) == 0;
+}
+
+// Tamanho de cada alocação (VirtualFree com MEM_RELEASE recebe size 0)
+struct CompatAllocation {
+    void* base;
+    SIZE_T size;
+};
+
+inline CompatAllocation* CompatAllocations() {
+    static CompatAllocation allocations[64];
+    return allocations;
+}
+
+inline void* VirtualAlloc(void* address, SIZE_T size, DWORD, DWORD protect) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_FIXED_NOREPLACE
+    if (address) flags |= MAP_FIXED_NOREPLACE;
+#endif
+    void* p = mmap(address, size, CompatProtectFlags(protect), flags, -1, 0);
+    if (p == MAP_FAILED) return nullptr;
+    if (address && p != address) {
+        munmap(p, size);
+        return nullptr;
+    }
+
+    CompatAllocation* allocations = CompatAllocations();
+    for (int i = 0; i < 64; i++) {
+        if (!allocations[i].base) {
+            allocations[i].base = p;
+            allocations[i].size = size;
+            break;
+        }
+    }
+    return p;
+}
+
+inline BOOL VirtualFree(void* address, SIZE_T, DWORD) {
+    CompatAllocation* allocations = CompatAllocations();
+    for (int i = 0; i < 64; i++) {
+        if (allocations[i].base == address) {
+            munmap(address, allocations[i].size);
+            allocations[i].base = nullptr;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+inline HANDLE GetCurrentProcess() { return (HANDLE)(intptr_t)-1; }
+
+inline BOOL FlushInstructionCache(HANDLE, const void* address, SIZE_T size) {
+    __builtin___clear_cache((char*)address, (char*)address + size);
+    return TRUE;
+}
+
+//=============================================================================
+// EXCEÇÕES (handler vetorizado sobre SIGSEGV)
+//=============================================================================
+
+#define EXCEPTION_ACCESS_VIOLATION 0xC0000005
+#define EXCEPTION_CONTINUE_EXECUTION (-1)
+#define EXCEPTION_CONTINUE_SEARCH 0
+#define EXCEPTION_MAXIMUM_PARAMETERS 15
+
+typedef struct _EXCEPTION_RECORD {
+    DWORD ExceptionCode;
+    DWORD ExceptionFlags;
+    struct _EXCEPTION_RECORD* ExceptionRecord;
+    void* ExceptionAddress;
+    DWORD NumberParameters;
+    ULONG_PTR ExceptionInformation[EXCEPTION_MAXIMUM_PARAMETERS];
+} EXCEPTION_RECORD;
+
+typedef struct {
+    EXCEPTION_RECORD* ExceptionRecord;
+    void* ContextRecord;        // ucontext_t* aqui
+} EXCEPTION_POINTERS, *PEXCEPTION_POINTERS;
+
+typedef LONG (WINAPI* PVECTORED_EXCEPTION_HANDLER)(EXCEPTION_POINTERS*);
+
+struct CompatVectoredHandlers {
+    PVECTORED_EXCEPTION_HANDLER handlers[8];
+    volatile uint32_t count;
+    struct sigaction previous;
+    bool installed;
+};
+
+inline CompatVectoredHandlers& CompatVectored() {
+    static CompatVectoredHandlers state;
+    return state;
+}
+
+// Access violation do Windows a partir do SIGSEGV. Escrita vem do código
+// de erro da falta de página (bit 1), que o kernel põe no contexto.
+inline void CompatSegvHandler(int, siginfo_t* signal, void* context) {
+    EXCEPTION_RECORD record;
+    memset(&record, 0, sizeof(record));
+    record.ExceptionCode = EXCEPTION_ACCESS_VIOLATION;
+    record.NumberParameters = 2;
+#if defined(__x86_64__) || defined(__i386__)
+    record.ExceptionInformation[0] = (((ucontext_t*)context)->uc_mcontext.gregs[REG_ERR] & 2) ? 1 : 0;
+#else
+    record.ExceptionInformation[0] = 1;
+#endif
+    record.ExceptionInformation[1] = (ULONG_PTR)signal->si_addr;
+
+    EXCEPTION_POINTERS pointers = { &record, context };
+    CompatVectoredHandlers& state = CompatVectored();
+    for (uint32_t i = 0; i < state.count; i++) {
+        if (state.handlers[i](&pointers) == EXCEPTION_CONTINUE_EXECUTION) return;
+    }
+
+    // Ninguém tratou: volta o handler anterior e a instrução falha de novo
+    sigaction(SIGSEGV, &state.previous, nullptr);
+}
+
+inline void* AddVectoredExceptionHandler(DWORD first, PVECTORED_EXCEPTION_HANDLER handler) {
+    CompatVectoredHandlers& state = CompatVectored();
+    if (state.count >= 8) return nullptr;
+
+    if (!state.installed) {
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = CompatSegvHandler;
+        action.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGSEGV, &action, &state.previous) != 0) return nullptr;
+        state.installed = true;
+    }
+
+    if (first) {
+        for (uint32_t i = state.count; i > 0; i--) state.handlers[i] = state.handlers[i - 1];
+        state.handlers[0] = handler;
+    }
+    else {
+        state.handlers[state.count] = handler;
+    }
+    state.count++;
+    return (void*)handler;
+}
+
+inline DWORD RemoveVectoredExceptionHandler(void* handle) {
+    CompatVectoredHandlers& state = CompatVectored();
+    for (uint32_t i = 0; i < state.count; i++) {
+        if ((void*)state.handlers[i] != handle) continue;
+        for (uint32_t k = i + 1; k < state.count; k++) state.handlers[k - 1] = state.handlers[k];
+        state.count--;
+        if (!state.count && state.installed) {
+            sigaction(SIGSEGV, &state.previous, nullptr);
+            state.installed = false;
+        }
+        return 1;
+    }
+    return 0;
+}
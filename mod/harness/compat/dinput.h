@@ -0,0 +1,25 @@
+/**
+ * RE4 CO-OP MOD - DirectInput (só para o harness)
+ *
+ * O mod só passa DIJOYSTATE2 por ponteiro.
+ */
+
+#pragma once
+#include "Windows.h"
+
+typedef struct DIJOYSTATE2 {
+    LONG lX, lY, lZ;
+    LONG lRx, lRy, lRz;
+    LONG rglSlider[2];
+    DWORD rgdwPOV[4];
+    BYTE rgbButtons[128];
+    LONG lVX, lVY, lVZ;
+    LONG lVRx, lVRy, lVRz;
+    LONG rglVSlider[2];
+    LONG lAX, lAY, lAZ;
+    LONG lARx, lARy, lARz;
+    LONG rglASlider[2];
+    LONG lFX, lFY, lFZ;
+    LONG lFRx, lFRy, lFRz;
+    LONG rglFSlider[2];
+} DIJOYSTATE2;
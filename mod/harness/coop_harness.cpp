@@ -0,0 +1,390 @@
+/**
+ * RE4 CO-OP MOD - Harness Headless (Linux)
+ *
+ * Roda o núcleo do co-op fora do jogo, contra memória falsa montada com
+ * os offsets de OffsetTable<V1_1_0>:
+ *
+ * - Uma imagem PE falsa faz o papel do executável (vtables, scanner)
+ * - Os players (Leon, Ashley e até COOP_MAX_PLAYERS), GLOBAL_WK e o
+ *   EmMgr com N inimigos ficam num bloco
+ *   abaixo de 2 GB (os ponteiros do jogo são de 32 bits)
+ * - A cada frame o "jogo" mexe Leon e os inimigos, o harness chama
+ *   CoopMod::Advance com um frame fixo de 60 FPS e mede cada parte
+ * - Com --net, servidor e cliente conversam por loopback no mesmo
+ *   processo (handshake, cifra e filas de verdade); falha com offset de
+ *   relógio fora de 0, check de desync diferente ou alocação em regime
+ * - Com --players N, os slots extras (2+) são ligados a players falsos
+ *   que andam em volta do Leon (custo por frame de 2 a 4 slots)
+ * - Com --record ARQ, grava a posição dos slots a cada frame (a entrada do
+ *   --camera, em test_camera.cpp)
+ *
+ * Cada subsistema tem o seu teste em test_<área>.cpp, com a flag e o que
+ * ele confere no topo do arquivo; a base comum (jogo falso, medição) fica
+ * em coop_harness.h.
+ *
+ * Compilar (da raiz do repositório):
+ *   g++ -std=c++17 -O2 -msse4.1 -maes -mpclmul -pthread \
+ *       -Imod/harness/compat -Imod/src \
+ *       mod/harness/coop_harness.cpp mod/harness/test_*.cpp mod/src/coop_main.cpp -o coop_harness
+ *
+ * Uso:
+ *   ./coop_harness [frames] [--enemies N] [--room-every N] [--net] [--port N] [--players N] [--record ARQ]
+ *                 [--camera ARQ] [--pool] [--tick] [--bulk] [--crypto] [--schema] [--memory] [--snapshot] [--scanner] [--hooks] [--entities] [--profiler] [--spawn] [--input S] [--seqlock S]
+ *                 [--anim] [--checkpoint] [--desync] [--merkle] [--log] [--discovery]
+ *                 [--hitscan]
+ *
+ * O scanner grava re4coop_patterns.cache e o índice de pontos seguros
+ * grava re4coop_spawn_XXXX.cache no diretório atual (como fariam ao lado
+ * do executável do jogo).
+ */
+
+#include "coop_harness.h"
+
+static LatencyStats s_FrameStats("CoopMod::Advance");
+static LatencyStats s_InputStats("ApplyInputToAshley");
+static LatencyStats s_ServerStats("CoopServer::Update");
+static LatencyStats s_ClientStats("CoopClient::Update");
+static LatencyStats s_GameStats("jogo falso (Step)");
+
+// Alocações do processo inteiro. O harness substitui malloc/calloc/realloc
+// da glibc (o operator new do libstdc++ passa por eles) e só conta.
+static std::atomic<uint64_t> s_Allocations{0};
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* p, size_t size);
+
+void* malloc(size_t size) {
+    s_Allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    s_Allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* p, size_t size) {
+    s_Allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(p, size);
+}
+}
+
+uint64_t HarnessAllocations() {
+    return s_Allocations.load(std::memory_order_relaxed);
+}
+
+//=============================================================================
+// REDE
+//=============================================================================
+
+constexpr uint32_t HARNESS_CLOCK_IDLE_RTT = 250;        // us: PONG de loopback sem a CPU ocupada
+constexpr int32_t HARNESS_CLOCK_MAX_OFFSET = 100;       // us
+
+static void NetworkTick() {
+    uint64_t t0 = HarnessNanos();
+    CoopServer::Instance().Update();
+    uint64_t t1 = HarnessNanos();
+    CoopClient::Instance().Update();
+    uint64_t t2 = HarnessNanos();
+
+    s_ServerStats.Record(t1 - t0);
+    s_ClientStats.Record(t2 - t1);
+}
+
+static bool StartLoopback(uint16_t port) {
+    CoopServer& server = CoopServer::Instance();
+    if (!server.Start(port)) {
+        printf("[NET] Servidor não abriu a porta %u\n", port);
+        return false;
+    }
+
+    // Como o menu: endereço pelos beacons da LAN (a sala com a nossa porta)
+    char ip[INET_ADDRSTRLEN] = "127.0.0.1";
+    DiscoveryListener discovery;
+    if (discovery.Start()) {
+        const DiscoverySession* session = nullptr;
+        for (int i = 0; i < 200 && !session; i++) {
+            Sleep(5);
+            discovery.Poll(GetTickCount());
+            const DiscoverySession* sessions[DISCOVERY_MAX_SESSIONS];
+            uint32_t count = discovery.Sessions(sessions, DISCOVERY_MAX_SESSIONS, GetTickCount());
+            for (uint32_t k = 0; k < count && !session; k++) {
+                if (sessions[k]->port == port) session = sessions[k];
+            }
+        }
+        if (session) memcpy(ip, session->ip, sizeof(ip));
+        else printf("[NET] Sala não apareceu na LAN, conectando em %s\n", ip);
+    }
+
+    if (!CoopClient::Instance().Connect(ip, port, server.GetRoomCode())) {
+        printf("[NET] Cliente não conectou\n");
+        return false;
+    }
+
+    for (int i = 0; i < 500 && !server.IsClientConnected(); i++) Sleep(10);
+    if (!server.IsClientConnected()) {
+        printf("[NET] Handshake não completou\n");
+        return false;
+    }
+    printf("[NET] Loopback na porta %u (sala %s, %s)\n", port, server.GetRoomCode(), ip);
+    return true;
+}
+
+static void StopLoopback() {
+    CoopClient::Instance().Disconnect();
+    CoopServer::Instance().Stop();
+}
+
+//=============================================================================
+// MAIN
+//=============================================================================
+
+struct HarnessOptions {
+    uint64_t frames = 1000000;
+    uint32_t enemies = 64;
+    uint32_t roomEvery = 36000;     // 10 minutos de jogo
+    bool net = false;
+    bool pool = false;
+    bool tick = false;
+    bool bulk = false;
+    bool crypto = false;
+    bool schema = false;
+    bool memory = false;
+    bool snapshot = false;
+    bool scanner = false;
+    bool hooks = false;
+    bool entities = false;
+    bool profiler = false;
+    bool hitscan = false;
+    uint16_t players = 2;
+    const char* record = nullptr;
+    const char* camera = nullptr;
+    bool spawn = false;
+    uint32_t input = 0;
+    uint32_t seqlock = 0;
+    bool anim = false;
+    bool checkpoint = false;
+    bool desync = false;
+    bool merkle = false;
+    bool log = false;
+    bool discovery = false;
+    uint16_t port = 27115;
+};
+
+static bool ParseOptions(int argc, char** argv, HarnessOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (!strcmp(arg, "--net")) options.net = true;
+        else if (!strcmp(arg, "--hitscan")) options.hitscan = true;
+        else if (!strcmp(arg, "--pool")) options.pool = true;
+        else if (!strcmp(arg, "--tick")) options.tick = true;
+        else if (!strcmp(arg, "--bulk")) options.bulk = true;
+        else if (!strcmp(arg, "--crypto")) options.crypto = true;
+        else if (!strcmp(arg, "--schema")) options.schema = true;
+        else if (!strcmp(arg, "--memory")) options.memory = true;
+        else if (!strcmp(arg, "--snapshot")) options.snapshot = true;
+        else if (!strcmp(arg, "--scanner")) options.scanner = true;
+        else if (!strcmp(arg, "--hooks")) options.hooks = true;
+        else if (!strcmp(arg, "--entities")) options.entities = true;
+        else if (!strcmp(arg, "--profiler")) options.profiler = true;
+        else if (!strcmp(arg, "--spawn")) options.spawn = true;
+        else if (!strcmp(arg, "--input") && value) options.input = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(arg, "--seqlock") && value) options.seqlock = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(arg, "--anim")) options.anim = true;
+        else if (!strcmp(arg, "--checkpoint")) options.checkpoint = true;
+        else if (!strcmp(arg, "--desync")) options.desync = true;
+        else if (!strcmp(arg, "--merkle")) options.merkle = true;
+        else if (!strcmp(arg, "--log")) options.log = true;
+        else if (!strcmp(arg, "--discovery")) options.discovery = true;
+        else if (!strcmp(arg, "--players") && value) options.players = (uint16_t)atoi(argv[++i]);
+        else if (!strcmp(arg, "--record") && value) options.record = argv[++i];
+        else if (!strcmp(arg, "--camera") && value) options.camera = argv[++i];
+        else if (!strcmp(arg, "--enemies") && value) options.enemies = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(arg, "--room-every") && value) options.roomEvery = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(arg, "--port") && value) options.port = (uint16_t)atoi(argv[++i]);
+        else if (arg[0] != '-') options.frames = strtoull(arg, nullptr, 10);
+        else {
+            printf("Uso: %s [frames] [--enemies N] [--room-every N] [--net] [--port N] [--players N] [--record ARQ] [--camera ARQ] [--pool] [--tick] [--bulk] [--crypto] [--schema] [--memory] [--snapshot] [--scanner] [--hooks] [--entities] [--profiler] [--spawn] [--input S] [--seqlock S] [--anim] [--checkpoint] [--desync] [--merkle] [--log] [--discovery] [--hitscan]\n", argv[0]);
+            return false;
+        }
+    }
+    if (options.players < 2 || options.players > COOP_MAX_PLAYERS) {
+        printf("--players: 2 a %u\n", COOP_MAX_PLAYERS);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    HarnessOptions options;
+    if (!ParseOptions(argc, argv, options)) return 2;
+
+    signal(SIGPIPE, SIG_IGN);
+
+    if (options.hitscan) return RunHitscanBench();
+    if (options.pool) return RunPoolBench();
+    if (options.tick) return RunTickBench();
+    if (options.bulk) return RunBulkBench();
+    if (options.crypto) return RunCryptoBench();
+    if (options.schema) return RunSchemaBench();
+    if (options.memory) return RunMemoryBench();
+    if (options.snapshot) return RunSnapshotBench();
+    if (options.scanner) return RunScannerBench();
+    if (options.hooks) return RunHookBench();
+    if (options.entities) return RunEntityBench();
+    if (options.profiler) return RunProfilerBench();
+    if (options.camera) return RunCameraReplay(options.camera);
+    if (options.spawn) return RunSpawnBench();
+    if (options.input) return RunInputBench(options.input, options.enemies);
+    if (options.seqlock) return RunSeqlockBench(options.seqlock);
+    if (options.anim) return RunAnimSim();
+    if (options.checkpoint) return RunCheckpointBench();
+    if (options.desync) return RunDesyncBench();
+    if (options.merkle) return RunMerkleBench();
+    if (options.log) return RunLogBench();
+    if (options.discovery) return RunDiscoveryBench();
+
+    MockGame game;
+    if (!game.Create(options.enemies)) {
+        printf("[HARNESS] Falha ao alocar a memória do jogo falso\n");
+        return 1;
+    }
+
+    if (!CoopMod::Initialize()) {
+        printf("[HARNESS] CoopMod::Initialize falhou\n");
+        return 1;
+    }
+    g_CoopConfig.enabled = true;
+    g_P2_Input.connected = true;
+    CoopMod::SetNetworkTickHandler(NetworkTick);
+
+    // Slots extras (Initialize só liga Leon e Ashley)
+    for (uint16_t slot = 2; slot < options.players; slot++) {
+        CoopMod::BindPlayerSlot(slot, game.SlotSource(slot),
+                                (PlayerCharacter)((uint8_t)PlayerCharacter::Ada + slot - 2));
+    }
+
+    if (options.net && !StartLoopback(options.port)) return 1;
+
+    FILE* record = options.record ? fopen(options.record, "w") : nullptr;
+    if (options.record && !record) {
+        printf("[HARNESS] Não abriu %s para gravar\n", options.record);
+        return 1;
+    }
+    if (record) fprintf(record, "# máscara e x y z de %u slots por frame\n", COOP_MAX_PLAYERS);
+
+#ifdef COOP_PROFILING
+    Profiler::Instance().Start();
+#endif
+
+    printf("[HARNESS] %llu frames, %u players, %u inimigos%s\n", (unsigned long long)options.frames,
+           options.players, options.enemies, options.net ? ", rede por loopback" : "");
+
+    // Regime: depois do handshake, da primeira sala e do primeiro PING, e
+    // fora do segundo que segue cada troca de sala (índice de spawn vai e
+    // volta do disco, o cache revalida os players)
+    uint64_t steadyFrame = options.frames / 4;
+    uint64_t steadyAllocations = 0;
+    uint64_t steadyFrames = 0;
+
+    uint64_t begin = HarnessNanos();
+    for (uint64_t frame = 0; frame < options.frames; frame++) {
+        uint64_t allocations = HarnessAllocations();
+        uint64_t t0 = HarnessNanos();
+        game.Step(frame, options.roomEvery);
+        uint64_t t1 = HarnessNanos();
+
+        // Player 2 gira o analógico
+        float t = (float)frame * (1.0f / 60.0f);
+        g_P2_Input.moveX = cosf(t);
+        g_P2_Input.moveY = sinf(t);
+        g_P2_Input.aim = (frame % 120) < 30;
+        g_P2_Input.shoot = (frame % 120) < 10;
+
+        CoopMod::Advance(HARNESS_FRAME_MICROS);
+        uint64_t t2 = HarnessNanos();
+
+        CoopMod::ApplyInputToAshley(EntityCache::Instance().Ashley(), g_P2_Input, 1.0f / 60.0f);
+        uint64_t t3 = HarnessNanos();
+
+        s_GameStats.Record(t1 - t0);
+        s_FrameStats.Record(t2 - t1);
+        s_InputStats.Record(t3 - t2);
+
+        if (record) RecordPlayers(record);
+
+        if (frame >= steadyFrame && (!options.roomEvery || frame % options.roomEvery >= 60)) {
+            steadyAllocations += HarnessAllocations() - allocations;
+            steadyFrames++;
+        }
+    }
+    double seconds = (double)(HarnessNanos() - begin) / 1e9;
+
+#ifdef COOP_PROFILING
+    Profiler::Instance().Stop();
+#endif
+    if (record) fclose(record);
+
+    printf("[HARNESS] %.2f s (%.0f frames/s)\n\n", seconds, (double)options.frames / seconds);
+    printf("  %-22s %10s  %8s %8s %8s %8s %8s %10s\n", "ns por chamada", "amostras",
+           "média", "p50", "p90", "p99", "p99.9", "máx");
+    s_FrameStats.Print();
+    s_InputStats.Print();
+    s_ServerStats.Print();
+    s_ClientStats.Print();
+    s_GameStats.Print();
+
+    bool clockOk = true;
+    bool desyncOk = true;
+    if (options.net) {
+        TelemetrySnapshot telemetry;
+        CoopServer::Instance().GetTelemetry().Snapshot(telemetry);
+        printf("\n[NET] Host: %llu pacotes enviados, %llu bytes\n",
+               (unsigned long long)telemetry.total.packetsSent, (unsigned long long)telemetry.total.bytesSent);
+
+        // O host só fica sabendo do RTT no PING seguinte ao primeiro PONG
+        for (int wait = 0; wait < 300 && !CoopServer::Instance().GetTelemetry().LastRttUs(); wait++) Sleep(10);
+        TelemetrySnapshot clientTelemetry;
+        CoopClient::Instance().GetTelemetry().Snapshot(clientTelemetry);
+        printf("[NET] RTT: cliente p50 %u us (n=%llu), host recebeu %u us\n", clientTelemetry.rtt.Percentile(0.5),
+               (unsigned long long)clientTelemetry.rtt.count, CoopServer::Instance().GetTelemetry().LastRttUs());
+        uint32_t roomRecords = 0;
+        CoopClient::Instance().GetRoomState(roomRecords);
+        const BulkTransferReceiver& room = CoopClient::Instance().GetRoomTransfer();
+        printf("[NET] Sala %#x no cliente: %u registros, %s (%.2f ms do primeiro chunk ao último)\n",
+               room.RoomId(), roomRecords, room.IsReady() ? "pronta" : "incompleta",
+               room.RoomReadyMicros() / 1000.0);
+        // Mesmo relógio dos dois lados: o offset certo é 0. Com os frames
+        // rodando a CPU toda, as amostras têm RTT alto; espera um PONG com
+        // o harness parado (o erro de uma amostra é no máximo RTT/2).
+        const ClockSync& clock = CoopClient::Instance().GetClock();
+        for (int wait = 0; wait < 300 && !(clock.Synced() && clock.BestRtt() < HARNESS_CLOCK_IDLE_RTT); wait++) {
+            Sleep(10);
+        }
+        clockOk = clock.Synced() && abs(clock.Offset()) <= HARNESS_CLOCK_MAX_OFFSET;
+        printf("[NET] Relógio do host no cliente: offset %d us (mesmo relógio aqui), RTT mínimo %u us%s\n",
+               clock.Offset(), clock.BestRtt(), clockOk ? "" : "  ERRADO");
+        // Nenhum check pode errar: host e cliente rodam o mesmo jogo. Sem
+        // DESYNC_CHECKS nenhum lado compara (o cliente hashearia a própria
+        // memória, não o estado do host).
+        const DesyncMonitor& desync = CoopClient::Instance().GetDesync();
+        desyncOk = desync.Mismatches() == 0 && CoopServer::Instance().GetDesync().Mismatches() == 0;
+        printf("[NET] Desync: %u checks comparados no cliente, %u diferentes, %u episódios%s%s\n",
+               desync.Checks(), desync.Mismatches(), desync.Episodes(),
+               DESYNC_CHECKS ? "" : " (checks desligados)", desyncOk ? "" : "  ERRADO");
+        StopLoopback();
+    }
+
+    // Pacotes saem do pool: nada do frame nem das threads de rede aloca
+    printf("[HARNESS] Alocações em regime (%llu frames): %llu\n", (unsigned long long)steadyFrames,
+           (unsigned long long)steadyAllocations);
+    int failures = (options.net && steadyAllocations) || !clockOk || !desyncOk ? 1 : 0;
+
+    CoopMod::Shutdown();
+    game.Destroy();
+    return failures;
+}
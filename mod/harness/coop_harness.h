@@ -0,0 +1,358 @@
+/**
+ * RE4 CO-OP MOD - Harness Headless: base comum
+ *
+ * O que os testes de cada subsistema (test_<área>.cpp) dividem: medição,
+ * contagem de alocações, o jogo falso montado com os offsets de
+ * OffsetTable<V1_1_0> e as entradas que o main (coop_harness.cpp) chama
+ * por flag.
+ */
+
+#pragma once
+#include "coop_core.h"
+#include "coop_game_memory.h"
+#include "coop_entity_cache.h"
+#include "coop_network.h"
+#include "coop_profiler.h"
+#include "coop_hitscan.h"
+#include "coop_camera.h"
+#include "coop_spawn.h"
+#include "coop_input.h"
+#include "coop_seqlock.h"
+#include "coop_anim.h"
+#include "coop_checkpoint.h"
+#include "coop_desync.h"
+#include "coop_merkle.h"
+#include "coop_log.h"
+#include "coop_scanner.h"
+#include "coop_hook.h"
+#include <chrono>
+#include <csignal>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <algorithm>
+#include <deque>
+#include <cstdlib>
+#include <vector>
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+constexpr uint64_t HARNESS_FRAME_MICROS = 16667;       // 60 FPS
+constexpr uint32_t HARNESS_IMAGE_SIZE = 0x10000;
+constexpr uint32_t HARNESS_GLOBALS_SIZE = 0x8000;
+constexpr uint32_t HARNESS_PLAYER_SIZE = 0x1000;
+constexpr uint32_t HARNESS_ENEMY_STRIDE = 0x800;
+
+// Dentro da imagem falsa
+constexpr uint32_t HARNESS_VTABLE_OFFSET = 0x1000;
+constexpr uint32_t HARNESS_CODE_OFFSET = 0x2000;
+
+using Table = OffsetTable<GameVersion::V1_1_0>;
+
+//=============================================================================
+// MEDIÇÃO
+//=============================================================================
+
+inline uint64_t HarnessNanos() {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Histograma logarítmico da telemetria, aqui em nanossegundos
+struct LatencyStats {
+    const char* name;
+    TelemetryHistogram histogram;
+
+    explicit LatencyStats(const char* statName) : name(statName) {
+        memset(&histogram, 0, sizeof(histogram));
+    }
+
+    void Record(uint64_t nanos) {
+        uint32_t value = nanos > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)nanos;
+        histogram.buckets[TelemetryBucketIndex(value)]++;
+        histogram.count++;
+        histogram.sum += value;
+        if (value > histogram.max) histogram.max = value;
+    }
+
+    void Print() const {
+        if (!histogram.count) {
+            printf("  %-22s (sem amostras)\n", name);
+            return;
+        }
+        printf("  %-22s %10llu  %8u %8u %8u %8u %8u %10u\n", name,
+               (unsigned long long)histogram.count, histogram.Mean(),
+               histogram.Percentile(0.50), histogram.Percentile(0.90),
+               histogram.Percentile(0.99), histogram.Percentile(0.999), histogram.max);
+    }
+};
+
+// xorshift32: mesma sequência em toda execução
+inline float HarnessRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (float)(state >> 8) * (1.0f / 16777216.0f);
+}
+
+// Percentil p (0.0 a 1.0) de amostras soltas; ordena o vetor
+inline double HarnessPercentile(std::vector<double>& values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[(size_t)(p * (double)(values.size() - 1))];
+}
+
+// Alocações do processo inteiro até agora (ver coop_harness.cpp)
+uint64_t HarnessAllocations();
+
+//=============================================================================
+// JOGO FALSO
+//=============================================================================
+
+class MockGame {
+public:
+    bool Create(uint32_t enemyCount) {
+        m_enemyCount = enemyCount;
+        m_size = HARNESS_IMAGE_SIZE + HARNESS_GLOBALS_SIZE + COOP_MAX_PLAYERS * HARNESS_PLAYER_SIZE +
+                 HARNESS_PLAYER_SIZE + enemyCount * HARNESS_ENEMY_STRIDE;
+
+        // Abaixo de 2 GB: GameAddress (32 bits) precisa alcançar tudo
+        void* arena = mmap(nullptr, m_size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+        if (arena == MAP_FAILED) return false;
+        m_arena = (uint8_t*)arena;
+
+        uint8_t* at = m_arena;
+        m_image = at;           at += HARNESS_IMAGE_SIZE;
+        m_globals = at;         at += HARNESS_GLOBALS_SIZE;
+        for (uint16_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+            m_players[i] = at;  at += HARNESS_PLAYER_SIZE;
+        }
+        m_manager = at;         at += HARNESS_PLAYER_SIZE;
+        m_enemies = at;
+
+        BuildImage();
+        for (uint16_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+            BuildPlayer(m_players[i], { 100.0f * i, 0.0f, 0.0f });
+            m_playerSlots[i] = (cPlayer*)m_players[i];
+        }
+        BuildEnemies();
+        Field<Table::RoomId>(m_globals) = 0x100;
+
+        // O que o Initialize acharia pelo scanner
+        pPL_ptr = &m_playerSlots[ENTITY_SLOT_PLAYER];
+        pAS_ptr = &m_playerSlots[ENTITY_SLOT_ASHLEY];
+        pGlobals = m_globals;
+        pEmMgr = (cEmMgr*)m_manager;
+        CompatSetMainModule(m_image);
+        return true;
+    }
+
+    void Destroy() {
+        pPL_ptr = pAS_ptr = nullptr;
+        memset(g_PlayerSlots, 0, sizeof(g_PlayerSlots));
+        pGlobals = nullptr;
+        pEmMgr = nullptr;
+        CompatSetMainModule(nullptr);
+        if (m_arena) munmap(m_arena, m_size);
+        m_arena = nullptr;
+    }
+
+    // Um frame do jogo: Leon anda em círculo, inimigos andam e levam dano
+    void Step(uint64_t frame, uint32_t roomEvery) {
+        float t = (float)frame * (1.0f / 60.0f);
+
+        Vec& leonPos = Field<Table::Pos>(m_players[ENTITY_SLOT_PLAYER]);
+        Field<Table::PosOld>(m_players[ENTITY_SLOT_PLAYER]) = leonPos;
+        leonPos.x = 300.0f * cosf(t * 0.5f);
+        leonPos.z = 300.0f * sinf(t * 0.5f);
+
+        // Players extras orbitam o Leon (de vez em quando longe o bastante para teleportar)
+        for (uint16_t i = 2; i < COOP_MAX_PLAYERS; i++) {
+            Vec& pos = Field<Table::Pos>(m_players[i]);
+            Field<Table::PosOld>(m_players[i]) = pos;
+            float radius = 200.0f + 1000.0f * (1.0f + sinf(t * 0.05f * i));
+            pos.x = leonPos.x + radius * cosf(t * 0.3f * i);
+            pos.z = leonPos.z + radius * sinf(t * 0.3f * i);
+        }
+
+        // 1 em cada 4 inimigos se mexe por frame
+        for (uint32_t i = (uint32_t)(frame & 3); i < m_enemyCount; i += 4) {
+            uint8_t* em = m_enemies + i * HARNESS_ENEMY_STRIDE;
+            Field<Table::Pos>(em).x += ((i & 1) ? 1.0f : -1.0f);
+            if ((frame + i) % 97 == 0 && Field<Table::HP>(em) > 0) Field<Table::HP>(em)--;
+        }
+
+        // Troca de sala: inimigos renascem, o cache e a transferência recomeçam
+        if (roomEvery && frame && frame % roomEvery == 0) {
+            Field<Table::RoomId>(m_globals)++;
+            BuildEnemies();
+        }
+    }
+
+    // Só os primeiros count slots do EmMgr ficam visíveis (count <= o do Create)
+    void SetEnemyCount(uint32_t count) { Field<Table::ManagerCount>(m_manager) = std::min(count, m_enemyCount); }
+
+    cPlayer* Ashley() const { return (cPlayer*)m_players[ENTITY_SLOT_ASHLEY]; }
+
+    // Global falso do slot (o que BindPlayerSlot recebe)
+    cPlayer** SlotSource(uint16_t slot) { return &m_playerSlots[slot]; }
+
+private:
+    template<typename F>
+    static typename F::Type& Field(uint8_t* base) { return *(typename F::Type*)(base + F::OFFSET); }
+
+    static GameAddress Address(const void* p) { return (GameAddress)(uintptr_t)p; }
+
+    void BuildImage() {
+        IMAGE_DOS_HEADER* dos = (IMAGE_DOS_HEADER*)m_image;
+        dos->e_magic = 0x5A4D;
+        dos->e_lfanew = 0x80;
+
+        IMAGE_NT_HEADERS* nt = (IMAGE_NT_HEADERS*)(m_image + dos->e_lfanew);
+        nt->Signature = 0x4550;
+        nt->FileHeader.Machine = 0x14C;
+        nt->FileHeader.SizeOfOptionalHeader = sizeof(IMAGE_OPTIONAL_HEADER);
+        nt->OptionalHeader.Magic = 0x10B;
+        nt->OptionalHeader.SizeOfImage = HARNESS_IMAGE_SIZE;
+        nt->OptionalHeader.SizeOfHeaders = 0x400;
+
+        // Uma vtable cujas entradas apontam para um RET
+        m_image[HARNESS_CODE_OFFSET] = 0xC3;
+        GameAddress* vtable = (GameAddress*)(m_image + HARNESS_VTABLE_OFFSET);
+        for (int i = 0; i < 16; i++) vtable[i] = Address(m_image + HARNESS_CODE_OFFSET);
+    }
+
+    void BuildPlayer(uint8_t* player, const Vec& pos) {
+        memset(player, 0, HARNESS_PLAYER_SIZE);
+        *(GameAddress*)player = Address(m_image + HARNESS_VTABLE_OFFSET);
+        Field<Table::Pos>(player) = pos;
+        Field<Table::PosOld>(player) = pos;
+        Field<Table::HP>(player) = 1200;
+        Field<Table::HPMax>(player) = 1200;
+        Field<Table::AtariFlag>(player) = SAT_SCA_ENABLE | SAT_OBA_ENABLE;
+    }
+
+    void BuildEnemies() {
+        Field<Table::ManagerArray>(m_manager) = Address(m_enemies);
+        Field<Table::ManagerCount>(m_manager) = m_enemyCount;
+        Field<Table::ManagerStride>(m_manager) = HARNESS_ENEMY_STRIDE;
+
+        for (uint32_t i = 0; i < m_enemyCount; i++) {
+            uint8_t* em = m_enemies + i * HARNESS_ENEMY_STRIDE;
+            memset(em, 0, HARNESS_ENEMY_STRIDE);
+            *(GameAddress*)em = Address(m_image + HARNESS_VTABLE_OFFSET);
+            Field<Table::UnitFlag>(em) = (i % 8 == 7) ? 0 : Table::UNIT_ALIVE;  // Alguns slots livres
+            Field<Table::Pos>(em) = { (float)(i % 16) * 150.0f, 0.0f, (float)(i / 16) * 150.0f };
+            Field<Table::HP>(em) = 200;
+            Field<Table::HPMax>(em) = 200;
+        }
+    }
+
+    uint8_t* m_arena = nullptr;
+    size_t m_size = 0;
+    uint8_t* m_image = nullptr;
+    uint8_t* m_globals = nullptr;
+    uint8_t* m_players[COOP_MAX_PLAYERS] = {};
+    uint8_t* m_manager = nullptr;
+    uint8_t* m_enemies = nullptr;
+    uint32_t m_enemyCount = 0;
+
+    // Fazem o papel dos globais do jogo (pPL_ptr, pAS_ptr e os slots extras)
+    cPlayer* m_playerSlots[COOP_MAX_PLAYERS] = {};
+};
+
+//=============================================================================
+// CANAL CIFRADO
+//=============================================================================
+
+// Handshake inteiro nos dois lados, em memória (sem socket)
+inline bool HarnessHandshake(SecureSession& host, SecureSession& client,
+                             const char* hostCode, const char* clientCode, CipherSuite suite) {
+    uint8_t offered = SecureSession::LocalSuites();
+    client.Begin(SecureRole::CLIENT, clientCode);
+    host.Begin(SecureRole::HOST, hostCode);
+    if (!host.Establish(client.PublicKey(), offered, suite)) return false;
+    if (!client.Establish(host.PublicKey(), offered, suite)) return false;
+    if (!client.VerifyConfirm(host.LocalConfirm())) return false;
+    return host.VerifyConfirm(client.LocalConfirm());
+}
+
+//=============================================================================
+// SNAPSHOTS DE SALA (desync e merkle)
+//=============================================================================
+
+inline void FillDesyncSnapshot(EntitySnapshot& s, uint32_t count, uint32_t& rng) {
+    memset(&s, 0, sizeof(s));
+    s.roomId = 0x0105;
+    s.count = count;
+    for (uint32_t i = 0; i < count; i++) {
+        s.id[i] = i < 2 ? SnapshotId(RoomRecordKind::PLAYER, (uint16_t)i)
+                        : SnapshotId(RoomRecordKind::ENEMY, (uint16_t)(i - 2));
+        s.posX[i] = (HarnessRandom(rng) - 0.5f) * 20000.0f;
+        s.posY[i] = HarnessRandom(rng) * 500.0f;
+        s.posZ[i] = (HarnessRandom(rng) - 0.5f) * 20000.0f;
+        s.hp[i] = (int16_t)(HarnessRandom(rng) * 2000.0f - 100.0f);
+        s.hpMax[i] = 2000;
+        s.flags[i] = (uint32_t)(HarnessRandom(rng) * 65536.0f);
+        s.state[i] = i < 2 ? (uint32_t)(HarnessRandom(rng) * 16.0f) : 0;
+    }
+}
+
+// Posição depois de ir e voltar pelo fio (o que o cliente aplica)
+inline void WireSnapshot(const EntitySnapshot& host, EntitySnapshot& client) {
+    memcpy(&client, &host, sizeof(client));
+    for (uint32_t i = 0; i < host.count; i++) {
+        client.posX[i] = WorldPos::Axis::Dequantize(WorldPos::Axis::Quantize(host.posX[i]));
+        client.posY[i] = WorldPos::Axis::Dequantize(WorldPos::Axis::Quantize(host.posY[i]));
+        client.posZ[i] = WorldPos::Axis::Dequantize(WorldPos::Axis::Quantize(host.posZ[i]));
+    }
+}
+
+// Tira a entidade i do snapshot (inimigo morreu), mantendo a ordem
+inline void RemoveSnapshotEntity(EntitySnapshot& s, uint32_t i) {
+    uint32_t tail = s.count - i - 1;
+    memmove(&s.id[i], &s.id[i + 1], tail * sizeof(s.id[0]));
+    memmove(&s.posX[i], &s.posX[i + 1], tail * sizeof(s.posX[0]));
+    memmove(&s.posY[i], &s.posY[i + 1], tail * sizeof(s.posY[0]));
+    memmove(&s.posZ[i], &s.posZ[i + 1], tail * sizeof(s.posZ[0]));
+    memmove(&s.hp[i], &s.hp[i + 1], tail * sizeof(s.hp[0]));
+    memmove(&s.hpMax[i], &s.hpMax[i + 1], tail * sizeof(s.hpMax[0]));
+    memmove(&s.flags[i], &s.flags[i + 1], tail * sizeof(s.flags[0]));
+    memmove(&s.state[i], &s.state[i + 1], tail * sizeof(s.state[0]));
+    s.count--;
+    s.id[s.count] = 0;
+    s.posX[s.count] = s.posY[s.count] = s.posZ[s.count] = 0.0f;
+    s.hp[s.count] = s.hpMax[s.count] = 0;
+    s.flags[s.count] = s.state[s.count] = 0;
+}
+
+//=============================================================================
+// TESTES (um test_<área>.cpp cada; o main chama pela flag)
+//=============================================================================
+
+int RunPoolBench();                     // test_pool.cpp
+int RunTickBench();                     // test_tick.cpp
+int RunBulkBench();                     // test_bulk.cpp
+int RunCryptoBench();                   // test_crypto.cpp
+int RunSchemaBench();                   // test_schema.cpp
+int RunMemoryBench();                   // test_memory.cpp
+int RunSnapshotBench();                 // test_snapshot.cpp
+int RunScannerBench();                  // test_scanner.cpp
+int RunHookBench();                     // test_hooks.cpp
+int RunEntityBench();                   // test_entities.cpp
+int RunProfilerBench();                 // test_profiler.cpp
+int RunHitscanBench();                  // test_hitscan.cpp
+int RunCameraReplay(const char* path);  // test_camera.cpp
+void RecordPlayers(FILE* file);         // test_camera.cpp
+int RunSpawnBench();                    // test_spawn.cpp
+int RunInputBench(uint32_t seconds, uint32_t enemies);// test_input.cpp
+int RunSeqlockBench(uint32_t seconds);  // test_seqlock.cpp
+int RunAnimSim();                       // test_anim.cpp
+int RunCheckpointBench();               // test_checkpoint.cpp
+int RunDesyncBench();                   // test_desync.cpp
+int RunMerkleBench();                   // test_merkle.cpp
+int RunLogBench();                      // test_log.cpp
+int RunDiscoveryBench();                // test_discovery.cpp
@@ -0,0 +1,268 @@
+/**
+ * RE4 CO-OP MOD - Harness: Animação (--anim)
+ *
+ * Simula 2 minutos de animação do host (andar com velocidade variando,
+ * recarga, faca, QTE, crossfades) passando por uma rede com latência e
+ * jitter e um relógio de cliente com offset e drift: banda das chaves
+ * contra fase a cada tick e erro de fase no cliente.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// ANIMAÇÃO
+//=============================================================================
+
+constexpr double HARNESS_ANIM_SECONDS = 120.0;
+constexpr double HARNESS_ANIM_TICK = 1e6 / 60.0;            // Host manda todo tick
+constexpr double HARNESS_ANIM_FRAME_SHIFT = 5000.0;         // Frame do cliente fora de fase com o tick
+constexpr double HARNESS_ANIM_LATENCY = 40000.0;            // Um sentido, sem jitter
+constexpr double HARNESS_CLOCK_OFFSET = -1234567.0;         // Relógio do cliente - host
+constexpr double HARNESS_CLOCK_DRIFT = 100e-6;              // 100 ppm
+
+// Trecho com velocidade constante; a fase é contínua dentro do clipe
+struct AnimSegment {
+    double start;               // us no relógio do host
+    double clipStart;           // Início do clipe (trechos do mesmo clipe continuam a fase)
+    uint16_t id;
+    bool loop;
+    float rate;
+    float phase;                // Fase no início do trecho
+    float blend;
+    float blendSpeed;
+};
+
+// Roteiro: andar (velocidade muda a cada 0.5 s), parado, recarga, faca, QTE
+static void BuildAnimTimeline(std::vector<AnimSegment>& timeline) {
+    uint32_t rng = 0xA11CE5u;
+    double t = 0.0;
+    AnimSegment current = { 0.0, 0.0, 1, true, 1.0f, 0.0f, 1.0f, 0.0f };
+
+    auto startClip = [&](uint16_t id, bool loop, float rate) {
+        current.start = t;
+        current.clipStart = t;
+        current.id = id;
+        current.loop = loop;
+        current.rate = rate;
+        current.phase = 0.0f;
+        current.blend = 0.0f;
+        current.blendSpeed = 1.0f / 0.15f;          // Crossfade de 150 ms
+        timeline.push_back(current);
+    };
+    auto advance = [&](double micros) {
+        // Fim do crossfade vira trecho próprio (blend para em 1)
+        double fadeEnd = current.start + (1.0f - current.blend) / current.blendSpeed * 1e6;
+        if (current.blendSpeed > 0.0f && fadeEnd < t + micros) {
+            float phase = current.phase + current.rate * (float)((fadeEnd - current.start) * 1e-6);
+            current.start = fadeEnd;
+            current.phase = current.loop ? phase - floorf(phase) : std::min(phase, 1.0f);
+            current.blend = 1.0f;
+            current.blendSpeed = 0.0f;
+            timeline.push_back(current);
+        }
+        t += micros;
+    };
+
+    while (t < HARNESS_ANIM_SECONDS * 1e6) {
+        float pick = HarnessRandom(rng);
+        if (pick < 0.55f) {
+            // Andando: 2 a 5 s com a velocidade mudando
+            startClip(1, true, 1.1f);
+            uint32_t steps = 4 + (uint32_t)(HarnessRandom(rng) * 6.0f);
+            for (uint32_t i = 0; i < steps; i++) {
+                advance(500000.0);
+                float phase = current.phase + current.rate * (float)((t - current.start) * 1e-6);
+                float blend = std::min(1.0f, current.blend + current.blendSpeed * (float)((t - current.start) * 1e-6));
+                current.start = t;
+                current.phase = phase - floorf(phase);
+                current.blend = blend;
+                current.blendSpeed = blend < 1.0f ? current.blendSpeed : 0.0f;
+                current.rate = 0.8f + HarnessRandom(rng) * 0.7f;
+                timeline.push_back(current);
+            }
+        }
+        else if (pick < 0.7f) {
+            startClip(2, true, 0.25f);              // Parado
+            advance(1000000.0 + HarnessRandom(rng) * 2000000.0);
+        }
+        else if (pick < 0.82f) {
+            startClip(3, false, 0.5f);              // Recarga de 2 s
+            advance(2000000.0);
+        }
+        else if (pick < 0.94f) {
+            startClip(4, false, 1.0f / 0.6f);       // Faca de 0.6 s
+            advance(600000.0);
+        }
+        else {
+            startClip(5, false, 1.0f / 1.2f);       // QTE de 1.2 s
+            advance(1200000.0);
+        }
+    }
+}
+
+static const AnimSegment& FindSegment(const std::vector<AnimSegment>& timeline, double t) {
+    auto it = std::upper_bound(timeline.begin(), timeline.end(), t,
+                               [](double value, const AnimSegment& seg) { return value < seg.start; });
+    return *(it == timeline.begin() ? it : it - 1);
+}
+
+static AnimSample SampleTimeline(const std::vector<AnimSegment>& timeline, double t) {
+    const AnimSegment& seg = FindSegment(timeline, t);
+    float age = (float)((t - seg.start) * 1e-6);
+
+    AnimSample sample;
+    sample.id = seg.id;
+    sample.loop = seg.loop;
+    sample.rate = seg.rate;
+    sample.phase = seg.phase + seg.rate * age;
+    sample.phase = seg.loop ? sample.phase - floorf(sample.phase) : std::min(sample.phase, 1.0f);
+    sample.blend = std::min(1.0f, seg.blend + seg.blendSpeed * age);
+    sample.blendSpeed = sample.blend < 1.0f ? seg.blendSpeed : 0.0f;
+    return sample;
+}
+
+struct AnimRun {
+    uint64_t bitsKeys;          // Campo anim no delta (chaves só nas descontinuidades)
+    uint64_t bitsEveryTick;     // Campo anim no delta (chave nova todo tick)
+    uint32_t keys;
+    LatencyStats errorKeys{"chaves + previsão"};
+    LatencyStats errorLatest{"fase todo tick"};
+    uint32_t transition;        // Frames em que o clipe novo ainda não chegou
+    uint32_t frames;
+    int32_t clockError;         // Offset estimado - real no fim (us)
+};
+
+// Relógio local do cliente no instante host t
+static uint32_t ClientClock(double t) {
+    return (uint32_t)(int64_t)(t + HARNESS_CLOCK_OFFSET + t * HARNESS_CLOCK_DRIFT);
+}
+
+static void SimulateAnim(const std::vector<AnimSegment>& timeline, double jitter, AnimRun& run) {
+    uint32_t rng = 0x5EED1234u;
+    auto delay = [&]() { return HARNESS_ANIM_LATENCY + HarnessRandom(rng) * jitter; };
+
+    struct InFlight {
+        double sent;
+        double arrival;
+        AnimKey key;            // Previsto
+        AnimKey latest;         // Fase deste tick
+    };
+    std::vector<InFlight> wire;
+    double lastArrival = 0.0;   // TCP: entrega em ordem
+
+    AnimKeyEncoder encoder;
+    ClockSync clock;
+    clock.Reset();
+    GameStatePacket baseKeys = {}, baseTick = {};
+    uint8_t scratch[256];
+
+    AnimKey rxKey = {}, rxLatest = {};
+    double rxSent = -1.0;
+    size_t delivered = 0;
+    double nextPing = 0.0;
+
+    uint64_t ticks = (uint64_t)(HARNESS_ANIM_SECONDS * 1e6 / HARNESS_ANIM_TICK);
+    for (uint64_t tick = 0; tick < ticks; tick++) {
+        double t = (double)tick * HARNESS_ANIM_TICK;
+        uint32_t hostMicros = (uint32_t)(uint64_t)t;
+        AnimSample sample = SampleTimeline(timeline, t);
+
+        // Host: as duas variantes passam pelo schema de verdade
+        GameStatePacket packet = {};
+        packet.playerMask = 1;
+        run.keys += encoder.Update(sample, hostMicros, packet.players[0].anim) ? 1 : 0;
+        BitWriter keysWriter(scratch, sizeof(scratch));
+        GameStateSchema::EncodeDelta(keysWriter, baseKeys, packet);
+        run.bitsKeys += keysWriter.Flush() * 8;
+        baseKeys = packet;
+        AnimKey predicted = packet.players[0].anim;
+
+        AnimKeyEncoder fresh;
+        fresh.Update(sample, hostMicros, packet.players[0].anim);
+        BitWriter tickWriter(scratch, sizeof(scratch));
+        GameStateSchema::EncodeDelta(tickWriter, baseTick, packet);
+        run.bitsEveryTick += tickWriter.Flush() * 8;
+        baseTick = packet;
+
+        double arrival = std::max(t + delay(), lastArrival);
+        lastArrival = arrival;
+        wire.push_back({ t, arrival, predicted, packet.players[0].anim });
+
+        // PING/PONG a cada segundo
+        if (t >= nextPing) {
+            double hostAt = t + delay();
+            double back = hostAt + delay();
+            clock.AddSample(ClientClock(t), (uint32_t)(uint64_t)hostAt, (uint32_t)(uint64_t)hostAt, ClientClock(back));
+            nextPing = t + 1e6;
+        }
+
+        // Cliente: um frame por tick, deslocado
+        double frameAt = t + HARNESS_ANIM_FRAME_SHIFT;
+        while (delivered < wire.size() && wire[delivered].arrival <= frameAt) {
+            rxKey = wire[delivered].key;
+            rxLatest = wire[delivered].latest;
+            rxSent = wire[delivered].sent;
+            delivered++;
+        }
+        if (rxSent < 0.0 || !clock.Synced()) continue;
+
+        // Clipe começou depois do último pacote entregue: nenhum método sabe
+        // dele ainda (latência pura, igual para os dois)
+        run.frames++;
+        if (FindSegment(timeline, frameAt).clipStart > rxSent) {
+            run.transition++;
+            continue;
+        }
+
+        AnimSample truth = SampleTimeline(timeline, frameAt);
+        AnimPose keys = PredictAnim(rxKey, clock.RemoteMicros(ClientClock(frameAt)));
+        AnimPose latest = PredictAnim(rxLatest, (uint32_t)rxLatest.stamp << ANIM_STAMP_SHIFT);
+
+        // Erro em us de animação (fase / velocidade)
+        auto error = [&](const AnimPose& pose) {
+            float cycles = AnimPhaseDistance(pose.phase, truth.phase, truth.loop);
+            return (uint64_t)(cycles / std::max(truth.rate, 0.01f) * 1e6f);
+        };
+        run.errorKeys.Record(error(keys));
+        run.errorLatest.Record(error(latest));
+    }
+
+    // Offset verdadeiro (host - cliente) no fim, contra o estimado
+    double end = HARNESS_ANIM_SECONDS * 1e6;
+    int32_t trueOffset = (int32_t)((uint32_t)(uint64_t)end - ClientClock(end));
+    run.clockError = clock.Offset() - trueOffset;
+}
+
+int RunAnimSim() {
+    std::vector<AnimSegment> timeline;
+    BuildAnimTimeline(timeline);
+
+    printf("[ANIM] %.0f s de animação a 60 ticks/s, %zu trechos; latência %.0f ms, relógio do cliente %+.0f ms e %.0f ppm\n\n",
+           HARNESS_ANIM_SECONDS, timeline.size(), HARNESS_ANIM_LATENCY / 1000.0,
+           HARNESS_CLOCK_OFFSET / 1000.0, HARNESS_CLOCK_DRIFT * 1e6);
+
+    const double jitters[] = { 0.0, 30000.0, 80000.0 };
+    bool ok = true;
+    for (double jitter : jitters) {
+        AnimRun run = {};
+        SimulateAnim(timeline, jitter, run);
+
+        printf("  Jitter até %.0f ms: %u chaves (%.1f/s), offset do relógio errado em %d us\n", jitter / 1000.0,
+               run.keys, run.keys / HARNESS_ANIM_SECONDS, run.clockError);
+        printf("    Banda do GAME_STATE: %.0f B/s com chaves, %.0f B/s com fase todo tick\n",
+               run.bitsKeys / 8.0 / HARNESS_ANIM_SECONDS, run.bitsEveryTick / 8.0 / HARNESS_ANIM_SECONDS);
+        printf("    Clipe novo ainda em trânsito: %.2f%% dos frames (fora da conta abaixo)\n",
+               100.0 * run.transition / run.frames);
+        printf("    %-22s %10s  %8s %8s %8s %8s %8s %10s\n", "erro de fase (us)", "frames",
+               "média", "p50", "p90", "p99", "p99.9", "máx");
+        printf("  ");
+        run.errorKeys.Print();
+        printf("  ");
+        run.errorLatest.Print();
+        printf("\n");
+
+        // Cauda das chaves abaixo da mediana de quem manda a fase todo tick
+        ok &= run.errorKeys.histogram.Percentile(0.99) < run.errorLatest.histogram.Percentile(0.50);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,231 @@
+/**
+ * RE4 CO-OP MOD - Harness: Estado da Sala (--bulk)
+ *
+ * Manda o estado de salas de 100 a 1000 entidades por um enlace simulado
+ * (banda e latência) com as regras de prioridade do CoopServer, contra
+ * pôr a sala na fila de tempo real: tempo até a sala ficar pronta e
+ * latência do GAME_STATE durante a transferência.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// ESTADO DA SALA (CANAL EM MASSA)
+//=============================================================================
+
+// Enlace simulado: ~1 Mbit/s de subida do host, 25 ms de ida
+constexpr double HARNESS_BULK_BYTES_PER_MS = 128.0;
+constexpr double HARNESS_BULK_DELAY_MS = 25.0;
+constexpr uint32_t HARNESS_BULK_WIRE_OVERHEAD = 40 + SECURE_RECORD_OVERHEAD;   // IP + TCP + registro
+constexpr uint32_t HARNESS_BULK_STATE_BYTES = 64;      // GAME_STATE típico (delta)
+constexpr double HARNESS_BULK_STEP_MS = 0.25;
+constexpr double HARNESS_BULK_TIMEOUT_MS = 30000.0;
+constexpr uint32_t HARNESS_BULK_QUEUE_CAP = 16;        // Como PumpRoomTransfer
+
+struct BulkSimPacket {
+    bool realtime;
+    double queuedMs;
+    uint32_t bytes;
+    RoomChunkPacket chunk;
+};
+
+struct BulkRun {
+    uint32_t chunks;
+    uint32_t nacks;
+    double readyMs;                 // < 0: não completou
+    std::vector<double> stateLatency;
+    bool intact;
+};
+
+static RoomEntityRecord s_BulkApplied[BULK_MAX_RECORDS];
+static uint32_t s_BulkAppliedCount = 0;
+
+// Reenvios chegam fora de ordem: cada registro vai para o seu índice
+static void ApplyBulkRecords(uint16_t, const RoomEntityRecord* records, uint32_t count, void*) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (records[i].index >= BULK_MAX_RECORDS) continue;
+        s_BulkApplied[records[i].index] = records[i];
+        s_BulkAppliedCount++;
+    }
+}
+
+// Host e cliente pelo enlace simulado, com as regras do CoopServer: GAME_STATE
+// a cada tick de rede na fila de tempo real; até bulkChunksPerTick chunks por
+// tick, só com a fila de tempo real vazia, e a thread de envio drena a fila
+// de tempo real antes. priority = false põe a sala inteira na fila única
+// de uma vez (o que seria mandar pelo caminho de tempo real).
+static void SimulateBulk(const RoomEntityRecord* records, uint32_t count, bool priority, float corrupt,
+                         bool idle, BulkRun& run) {
+    static BulkTransferSender sender;
+    BulkTransferReceiver receiver;
+    std::deque<BulkSimPacket> realtime, room;
+    std::deque<std::pair<double, BulkSimPacket>> wire;
+    std::deque<std::pair<double, uint16_t>> nacks;     // Cliente -> host (subida sem fila)
+
+    run.chunks = run.nacks = 0;
+    run.readyMs = -1.0;
+    run.stateLatency.clear();
+    s_BulkAppliedCount = 0;
+
+    if (!idle) sender.Begin(0x200, records, count);
+    uint16_t transferId = sender.TransferId();
+
+    double tickMs = 1000.0 * g_CoopConfig.netSendInterval / g_CoopConfig.tickRate;
+    double nextTick = 0.0;
+    double linkFree = 0.0;
+    uint32_t rng = 0xB01C;
+    double endMs = idle ? 5000.0 : HARNESS_BULK_TIMEOUT_MS;
+
+    auto ChunkBytes = [](const RoomChunkPacket& packet) {
+        return (uint32_t)(offsetof(RoomChunkPacket, records) + packet.chunk.recordCount * sizeof(RoomEntityRecord));
+    };
+
+    if (!idle && !priority) {
+        BulkSimPacket packet = {};
+        while (sender.NextChunk(packet.chunk.chunk, packet.chunk.records)) {
+            packet.realtime = false;
+            packet.bytes = ChunkBytes(packet.chunk);
+            realtime.push_back(packet);
+        }
+    }
+
+    for (double t = 0.0; t < endMs; t += HARNESS_BULK_STEP_MS) {
+        // Tick de rede do host e do cliente
+        if (t >= nextTick) {
+            nextTick += tickMs;
+
+            BulkSimPacket state = {};
+            state.realtime = true;
+            state.queuedMs = t;
+            state.bytes = HARNESS_BULK_STATE_BYTES;
+            realtime.push_back(state);
+
+            while (!nacks.empty() && nacks.front().first <= t) {
+                sender.Resend(transferId, nacks.front().second);
+                nacks.pop_front();
+            }
+            if (priority && sender.HasPending() && realtime.size() <= 1) {
+                for (uint32_t i = 0; i < g_CoopConfig.bulkChunksPerTick && sender.HasPending(); i++) {
+                    if (room.size() >= HARNESS_BULK_QUEUE_CAP) break;
+                    BulkSimPacket packet = {};
+                    sender.NextChunk(packet.chunk.chunk, packet.chunk.records);
+                    packet.bytes = ChunkBytes(packet.chunk);
+                    room.push_back(packet);
+                }
+            }
+            else if (!priority && sender.HasPending()) {
+                BulkSimPacket packet = {};
+                sender.NextChunk(packet.chunk.chunk, packet.chunk.records);    // Reenvio
+                packet.bytes = ChunkBytes(packet.chunk);
+                realtime.push_back(packet);
+            }
+
+            uint16_t missing[8];
+            uint32_t n = receiver.CollectMissing(15, missing, 8);
+            for (uint32_t i = 0; i < n; i++) {
+                nacks.push_back({ t + HARNESS_BULK_DELAY_MS, missing[i] });
+                run.nacks++;
+            }
+        }
+
+        // Thread de envio: tempo real primeiro, sala com o que sobra
+        while (linkFree <= t && (!realtime.empty() || !room.empty())) {
+            std::deque<BulkSimPacket>& queue = !realtime.empty() ? realtime : room;
+            BulkSimPacket packet = queue.front();
+            queue.pop_front();
+            linkFree = std::max(linkFree, t) + (packet.bytes + HARNESS_BULK_WIRE_OVERHEAD) / HARNESS_BULK_BYTES_PER_MS;
+            wire.push_back({ linkFree + HARNESS_BULK_DELAY_MS, packet });
+        }
+
+        // Cliente
+        while (!wire.empty() && wire.front().first <= t) {
+            BulkSimPacket& packet = wire.front().second;
+            if (packet.realtime) {
+                // Estados que saíram enquanto a sala não estava pronta
+                if (idle || run.readyMs < 0 || packet.queuedMs <= run.readyMs) {
+                    run.stateLatency.push_back(wire.front().first - packet.queuedMs);
+                }
+            }
+            else {
+                run.chunks++;
+                if (HarnessRandom(rng) < corrupt) packet.chunk.records[0].hp ^= 1;
+                if (receiver.OnChunk(packet.chunk.chunk, packet.chunk.records, ApplyBulkRecords, nullptr) ==
+                    BulkChunkResult::CORRUPT) {
+                    nacks.push_back({ t + HARNESS_BULK_DELAY_MS, packet.chunk.chunk.chunkIndex });
+                    run.nacks++;
+                }
+                if (receiver.IsReady() && run.readyMs < 0) run.readyMs = t;
+            }
+            wire.pop_front();
+        }
+        if (!idle && run.readyMs >= 0 && t > run.readyMs + 1000.0) break;
+    }
+
+    run.intact = idle || (s_BulkAppliedCount == count &&
+                          !memcmp(s_BulkApplied, records, count * sizeof(RoomEntityRecord)));
+}
+
+int RunBulkBench() {
+    uint32_t failures = 0;
+    static RoomEntityRecord records[BULK_MAX_RECORDS];
+    uint32_t rng = 0x50A1;
+    for (uint32_t i = 0; i < BULK_MAX_RECORDS; i++) {
+        RoomEntityRecord& r = records[i];
+        r = {};
+        r.kind = i % 10 == 0 ? RoomRecordKind::DOOR : (i % 3 ? RoomRecordKind::ENEMY : RoomRecordKind::ITEM);
+        r.index = (uint16_t)i;
+        r.pos = { HarnessRandom(rng) * 8000.0f, 0.0f, HarnessRandom(rng) * 8000.0f };
+        r.hp = r.hpMax = 200;
+        r.flags = i;
+    }
+
+    BulkRun idle;
+    SimulateBulk(records, 0, true, 0.0f, true, idle);
+    double idleP50 = HarnessPercentile(idle.stateLatency, 0.50);
+    double idleP99 = HarnessPercentile(idle.stateLatency, 0.99);
+
+    printf("[BULK] Enlace de %.0f kbit/s, %.0f ms de ida; GAME_STATE de %u bytes a cada %.1f ms, "
+           "%u chunks de até %u registros por tick\n", HARNESS_BULK_BYTES_PER_MS * 8.0, HARNESS_BULK_DELAY_MS,
+           HARNESS_BULK_STATE_BYTES, 1000.0 * g_CoopConfig.netSendInterval / g_CoopConfig.tickRate,
+           g_CoopConfig.bulkChunksPerTick, BULK_RECORDS_PER_CHUNK);
+    printf("  Sem transferência: GAME_STATE p50 %.1f ms, p99 %.1f ms\n\n", idleP50, idleP99);
+    printf("  %-9s %-22s %8s %8s %12s %10s %10s %10s\n", "registros", "caminho", "chunks", "NACKs",
+           "sala pronta", "GS p50", "GS p99", "GS máx");
+
+    struct Scenario {
+        uint32_t records;
+        bool priority;
+        float corrupt;
+        const char* name;
+    };
+    const Scenario scenarios[] = {
+        { 100,  true,  0.0f,  "canal em massa" },
+        { 100,  false, 0.0f,  "fila única" },
+        { 300,  true,  0.0f,  "canal em massa" },
+        { 300,  false, 0.0f,  "fila única" },
+        { 1000, true,  0.0f,  "canal em massa" },
+        { 1000, false, 0.0f,  "fila única" },
+        { 1000, true,  0.05f, "canal em massa, 5% CRC" },
+    };
+
+    for (const Scenario& scenario : scenarios) {
+        BulkRun run;
+        SimulateBulk(records, scenario.records, scenario.priority, scenario.corrupt, false, run);
+        double p50 = HarnessPercentile(run.stateLatency, 0.50);
+        double p99 = HarnessPercentile(run.stateLatency, 0.99);
+        double max = run.stateLatency.empty() ? 0.0 : run.stateLatency.back();
+        printf("  %-9u %-22s %8u %8u %9.0f ms %7.1f ms %7.1f ms %7.1f ms%s\n", scenario.records, scenario.name,
+               run.chunks, run.nacks, run.readyMs, p50, p99, max, run.intact ? "" : "  (sala diferente!)");
+
+        // No canal em massa o GAME_STATE espera no máximo um chunk na frente
+        bool ok = run.readyMs >= 0 && run.intact;
+        if (scenario.priority) {
+            double chunkMs = (sizeof(RoomChunkPacket) + HARNESS_BULK_WIRE_OVERHEAD) / HARNESS_BULK_BYTES_PER_MS;
+            ok = ok && p99 <= idleP99 + chunkMs + HARNESS_BULK_STEP_MS;
+        }
+        if (!ok) failures++;
+    }
+
+    printf("\n  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,179 @@
+/**
+ * RE4 CO-OP MOD - Harness: Câmera (--camera ARQ)
+ *
+ * Passa uma gravação do --record pelo solver de câmera (com pilares
+ * falsos tapando a visada) e mede estabilidade do quadro e custo por
+ * frame. Falha se, depois de assentar, alguém sai do quadro, se o FOV ou
+ * o alvo dão tranco acima do limite ou se o cache de visada quase não
+ * acerta.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// CÂMERA
+//=============================================================================
+
+constexpr uint32_t HARNESS_CAMERA_SETTLE_FRAMES = 60;          // ~3x CAMERA_SMOOTH_TIME a 60 FPS
+constexpr double HARNESS_CAMERA_FOV_RATE_MAX = 150.0;          // °/s (2.5° num frame)
+constexpr double HARNESS_CAMERA_JERK_MAX = 8.0;                // u/frame²
+constexpr double HARNESS_CAMERA_PROBE_HIT_MIN = 0.5;           // Fração dos testes de visada
+
+// Uma linha por frame: máscara e x y z de cada slot
+void RecordPlayers(FILE* file) {
+    PlayerPositions players = {};
+    WithGameVersion([&](auto table) {
+        GatherPlayerPositions(table, EntityCache::Instance(), players);
+    });
+    fprintf(file, "%u", players.mask);
+    for (uint16_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+        fprintf(file, " %.2f %.2f %.2f", players.x[i], players.y[i], players.z[i]);
+    }
+    fprintf(file, "\n");
+}
+
+static bool LoadRecording(const char* path, std::vector<PlayerPositions>& frames) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#') continue;
+        PlayerPositions players;
+        char* at = line;
+        players.mask = (uint32_t)strtoul(at, &at, 10);
+        players.count = 0;
+        for (uint16_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+            players.x[i] = strtof(at, &at);
+            players.y[i] = strtof(at, &at);
+            players.z[i] = strtof(at, &at);
+            if (players.Has(i)) players.count++;
+        }
+        frames.push_back(players);
+    }
+    fclose(file);
+    return true;
+}
+
+// Pilares de 40 cm de raio a cada 6 m: tapam a visada de vez em quando
+static bool PillarLineOfSight(const Vec& from, const Vec& to, void*) {
+    const float SPACING = 600.0f, RADIUS = 40.0f;
+    float dx = to.x - from.x, dz = to.z - from.z;
+    float length = sqrtf(dx * dx + dz * dz);
+    uint32_t steps = (uint32_t)(length / (RADIUS * 0.5f)) + 1;
+    for (uint32_t k = 0; k <= steps; k++) {
+        float t = (float)k / (float)steps;
+        float x = from.x + dx * t, z = from.z + dz * t;
+        float px = roundf(x / SPACING) * SPACING, pz = roundf(z / SPACING) * SPACING;
+        if ((x - px) * (x - px) + (z - pz) * (z - pz) < RADIUS * RADIUS) return false;
+    }
+    return true;
+}
+
+// Players dentro do cone do FOV vertical (estimativa conservadora do quadro)
+static bool AllInFrame(const PlayerPositions& players, const CoopCameraFrame& frame) {
+    Vec view = { frame.target.x - frame.eye.x, frame.target.y - frame.eye.y, frame.target.z - frame.eye.z };
+    float viewLength = sqrtf(view.x * view.x + view.y * view.y + view.z * view.z);
+    for (uint16_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+        if (!players.Has(i)) continue;
+        Vec to = { players.x[i] - frame.eye.x, players.y[i] + CAMERA_TARGET_HEIGHT - frame.eye.y,
+                   players.z[i] - frame.eye.z };
+        float length = sqrtf(to.x * to.x + to.y * to.y + to.z * to.z);
+        float cosine = (to.x * view.x + to.y * view.y + to.z * view.z) / (length * viewLength);
+        if (cosine < cosf(frame.fovy * 0.5f)) return false;
+    }
+    return true;
+}
+
+int RunCameraReplay(const char* path) {
+    std::vector<PlayerPositions> frames;
+    if (!LoadRecording(path, frames) || frames.size() < 3) {
+        printf("[CAMERA] Gravação vazia ou ilegível: %s\n", path);
+        return 1;
+    }
+
+    static CoopCameraSolver camera;
+    camera.SetLineOfSight(PillarLineOfSight, nullptr);
+    LatencyStats solveStats("CoopCameraSolver::Solve");
+
+    const float dt = 1.0f / 60.0f;
+    Vec previous[2] = {}, previousRaw[2] = {};
+    double jerk = 0.0, jerkRaw = 0.0, jerkMax = 0.0, fovRate = 0.0, fovRateMax = 0.0;
+    uint32_t inFrame = 0, settledFrames = 0, settledOut = 0, occluded = 0, samples = 0;
+    float lastFov = 0.0f;
+
+    for (size_t n = 0; n < frames.size(); n++) {
+        const PlayerPositions& players = frames[n];
+        if (players.count < 2) continue;
+
+        uint64_t t0 = HarnessNanos();
+        const CoopCameraFrame& frame = camera.Solve(players, 0x100, 0.0f, dt);
+        solveStats.Record(HarnessNanos() - t0);
+
+        // Jerk = segunda diferença do alvo (suavizado vs centro cru)
+        Vec raw = PlayerCentroid(players);
+        if (samples >= 2) {
+            #define JERK(a, b, c) sqrtf(((a).x - 2 * (b).x + (c).x) * ((a).x - 2 * (b).x + (c).x) + \
+                                        ((a).z - 2 * (b).z + (c).z) * ((a).z - 2 * (b).z + (c).z))
+            double j = JERK(frame.target, previous[0], previous[1]);
+            jerk += j;
+            jerkMax = j > jerkMax ? j : jerkMax;
+            jerkRaw += JERK(raw, previousRaw[0], previousRaw[1]);
+            #undef JERK
+            double rate = fabsf(frame.fovy - lastFov) / dt / CAMERA_DEG;
+            fovRate += rate;
+            fovRateMax = rate > fovRateMax ? rate : fovRateMax;
+        }
+        previous[1] = previous[0];
+        previous[0] = frame.target;
+        previousRaw[1] = previousRaw[0];
+        previousRaw[0] = raw;
+        lastFov = frame.fovy;
+
+        bool all = AllInFrame(players, frame);
+        inFrame += all;
+        if (samples >= HARNESS_CAMERA_SETTLE_FRAMES) {
+            settledFrames++;
+            settledOut += !all;
+        }
+        occluded += frame.occludedMask != 0;
+        samples++;
+    }
+
+    uint32_t measured = samples > 2 ? samples - 2 : 1;
+    const CameraProbeCache& probes = camera.Probes();
+    uint64_t probeTotal = probes.Hits() + probes.Misses();
+
+    printf("[CAMERA] %u frames de %s\n\n", samples, path);
+    printf("  %-22s %10s  %8s %8s %8s %8s %8s %10s\n", "ns por chamada", "amostras",
+           "média", "p50", "p90", "p99", "p99.9", "máx");
+    solveStats.Print();
+    printf("\n  Todos no quadro:        %.2f%% dos frames\n", 100.0 * inFrame / samples);
+    printf("  Visada tapada:          %.2f%% dos frames\n", 100.0 * occluded / samples);
+    printf("  Jerk do alvo (u/frame²): média %.4f (cru %.4f), máx %.3f\n",
+           jerk / measured, jerkRaw / measured, jerkMax);
+    printf("  Variação do FOV (°/s):  média %.3f, máx %.2f\n", fovRate / measured, fovRateMax);
+    printf("  Solves:                 %llu (%.1f%% dos frames)\n", (unsigned long long)camera.SolveCount(),
+           100.0 * camera.SolveCount() / samples);
+    printf("  Cache de visada:        %llu testes, %.1f%% do cache\n", (unsigned long long)probeTotal,
+           probeTotal ? 100.0 * probes.Hits() / probeTotal : 0.0);
+
+    // Depois de assentar, ninguém sai do quadro; a suavização não pode dar
+    // mais tranco que o grupo cru
+    uint32_t failures = 0;
+    double hitRate = probeTotal ? (double)probes.Hits() / probeTotal : 1.0;
+    bool frameOk = settledOut == 0;
+    bool fovOk = fovRateMax <= HARNESS_CAMERA_FOV_RATE_MAX;
+    bool jerkOk = jerkMax <= HARNESS_CAMERA_JERK_MAX && jerk <= jerkRaw;
+    bool cacheOk = hitRate >= HARNESS_CAMERA_PROBE_HIT_MIN;
+    failures += !frameOk + !fovOk + !jerkOk + !cacheOk;
+    printf("\n  Fora do quadro depois de %u frames: %u de %u -> %s\n", HARNESS_CAMERA_SETTLE_FRAMES, settledOut,
+           settledFrames, frameOk ? "ok" : "ERRADO");
+    printf("  FOV máx %.2f °/s (limite %.0f) -> %s\n", fovRateMax, HARNESS_CAMERA_FOV_RATE_MAX, fovOk ? "ok" : "ERRADO");
+    printf("  Jerk máx %.3f (limite %.1f), média não acima da crua -> %s\n", jerkMax, HARNESS_CAMERA_JERK_MAX,
+           jerkOk ? "ok" : "ERRADO");
+    printf("  Cache de visada %.1f%% (mínimo %.0f%%) -> %s\n", 100.0 * hitRate, 100.0 * HARNESS_CAMERA_PROBE_HIT_MIN,
+           cacheOk ? "ok" : "ERRADO");
+    printf("\n  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
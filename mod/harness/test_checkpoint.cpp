@@ -0,0 +1,207 @@
+/**
+ * RE4 CO-OP MOD - Harness: Checkpoints de Memória (--checkpoint)
+ *
+ * Rastreia 8 MB de EmMgr, players e inventário com MemoryCheckpoints por
+ * 3000 ticks de rede: custo de checkpoint contra copiar tudo, faltas de
+ * escrita por tick (sala reiniciando à parte) e Restore de até um ring
+ * para trás conferido por hash.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// CHECKPOINTS DE MEMÓRIA
+//=============================================================================
+
+constexpr uint32_t HARNESS_CKPT_TICKS = 3000;               // Ticks de rede (100 s a 30 Hz)
+constexpr uint32_t HARNESS_CKPT_EM_SLOTS = 4096;            // EmMgr de 8 MB
+constexpr uint32_t HARNESS_CKPT_EM_ACTIVE = 64;             // Inimigos que se mexem
+constexpr uint32_t HARNESS_CKPT_INVENTORY = 0x40000;        // 256 KB
+constexpr uint32_t HARNESS_CKPT_RESTORE_EVERY = 37;
+constexpr uint32_t HARNESS_CKPT_BURST_EVERY = 700;          // "Sala reinicia": EmMgr inteiro muda
+
+// Memória rastreada: players, EmMgr e inventário em blocos separados
+struct CheckpointMemory {
+    uint8_t* players;
+    uint8_t* enemies;
+    uint8_t* inventory;
+    uint32_t active[HARNESS_CKPT_EM_ACTIVE];
+
+    size_t PlayersSize() const { return (size_t)COOP_MAX_PLAYERS * HARNESS_PLAYER_SIZE; }
+    size_t EnemiesSize() const { return (size_t)HARNESS_CKPT_EM_SLOTS * HARNESS_ENEMY_STRIDE; }
+
+    uint64_t Hash() const {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        hash = HashBlock(hash, players, PlayersSize());
+        hash = HashBlock(hash, enemies, EnemiesSize());
+        return HashBlock(hash, inventory, HARNESS_CKPT_INVENTORY);
+    }
+
+    static uint64_t HashBlock(uint64_t hash, const uint8_t* data, size_t size) {
+        const uint64_t* words = (const uint64_t*)data;
+        for (size_t i = 0; i < size / 8; i++) hash = (hash ^ words[i]) * 0x100000001B3ull;
+        return hash;
+    }
+
+    // Um tick de jogo: players e inimigos ativos andam, inventário às vezes
+    void Step(uint32_t tick, uint32_t& rng) {
+        for (uint16_t slot = 0; slot < COOP_MAX_PLAYERS; slot++) {
+            Vec* pos = (Vec*)(players + slot * HARNESS_PLAYER_SIZE + Table::Pos::OFFSET);
+            pos->x += 1.0f + slot;
+            pos->z = (float)tick;
+        }
+        for (uint32_t i = 0; i < HARNESS_CKPT_EM_ACTIVE; i++) {
+            uint8_t* em = enemies + (size_t)active[i] * HARNESS_ENEMY_STRIDE;
+            Vec* pos = (Vec*)(em + Table::Pos::OFFSET);
+            pos->x += HarnessRandom(rng) - 0.5f;
+            pos->z += HarnessRandom(rng) - 0.5f;
+            if (HarnessRandom(rng) < 0.05f) (*(int16_t*)(em + Table::HP::OFFSET))--;
+        }
+        if (tick % 30 == 0) inventory[(tick * 97) % HARNESS_CKPT_INVENTORY] ^= 0x5A;
+        if (tick % HARNESS_CKPT_BURST_EVERY == HARNESS_CKPT_BURST_EVERY - 1) {
+            for (size_t at = 0; at < EnemiesSize(); at += 64) enemies[at] = (uint8_t)tick;
+        }
+    }
+};
+
+int RunCheckpointBench() {
+    CheckpointMemory memory;
+    memory.players = (uint8_t*)VirtualAlloc(nullptr, memory.PlayersSize(), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    memory.enemies = (uint8_t*)VirtualAlloc(nullptr, memory.EnemiesSize(), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    memory.inventory = (uint8_t*)VirtualAlloc(nullptr, HARNESS_CKPT_INVENTORY, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (!memory.players || !memory.enemies || !memory.inventory) {
+        printf("[CHECKPOINT] Falha ao alocar as regiões\n");
+        return 1;
+    }
+
+    uint32_t rng = 0xC0FFEE;
+    for (size_t i = 0; i < memory.EnemiesSize(); i++) memory.enemies[i] = (uint8_t)(HarnessRandom(rng) * 256.0f);
+    memset(memory.players, 0, memory.PlayersSize());
+    memset(memory.inventory, 0, HARNESS_CKPT_INVENTORY);
+    for (uint32_t i = 0; i < HARNESS_CKPT_EM_SLOTS; i++) {
+        // Bytes aleatórios em volta, mas posição de verdade (float sem lixo)
+        Vec* pos = (Vec*)(memory.enemies + (size_t)i * HARNESS_ENEMY_STRIDE + Table::Pos::OFFSET);
+        *pos = { HarnessRandom(rng) * 4000.0f, 0.0f, HarnessRandom(rng) * 4000.0f };
+    }
+    for (uint32_t i = 0; i < HARNESS_CKPT_EM_ACTIVE; i++) {
+        memory.active[i] = (uint32_t)(HarnessRandom(rng) * HARNESS_CKPT_EM_SLOTS);
+    }
+
+    // Linha de base: o mesmo jogo sem rastreio, copiando tudo todo tick
+    static std::vector<uint8_t> full(memory.PlayersSize() + memory.EnemiesSize() + HARNESS_CKPT_INVENTORY);
+    LatencyStats stepPlain("Tick sem rastreio");
+    LatencyStats fullCopy("Cópia inteira");
+    uint32_t plainRng = rng;
+    for (uint32_t tick = 0; tick < HARNESS_CKPT_TICKS; tick++) {
+        uint64_t t0 = HarnessNanos();
+        memory.Step(tick, plainRng);
+        uint64_t t1 = HarnessNanos();
+        memcpy(full.data(), memory.players, memory.PlayersSize());
+        memcpy(full.data() + memory.PlayersSize(), memory.enemies, memory.EnemiesSize());
+        memcpy(full.data() + memory.PlayersSize() + memory.EnemiesSize(), memory.inventory, HARNESS_CKPT_INVENTORY);
+        uint64_t t2 = HarnessNanos();
+        stepPlain.Record(t1 - t0);
+        fullCopy.Record(t2 - t1);
+    }
+
+    MemoryCheckpoints& checkpoints = MemoryCheckpoints::Instance();
+    checkpoints.ClearRegions();
+    bool added = checkpoints.AddRegion(memory.players, memory.PlayersSize()) &&
+                 checkpoints.AddRegion(memory.enemies, memory.EnemiesSize()) &&
+                 checkpoints.AddRegion(memory.inventory, HARNESS_CKPT_INVENTORY);
+    uint64_t t0 = HarnessNanos();
+    if (!added || !checkpoints.Arm()) {
+        printf("[CHECKPOINT] Registro das regiões falhou\n");
+        return 1;
+    }
+    uint64_t armNanos = HarnessNanos() - t0;
+
+    // Hash da memória em cada checkpoint, para conferir o Restore
+    std::vector<uint64_t> hashes(HARNESS_CKPT_TICKS + 2, 0);
+    hashes[checkpoints.Latest()] = memory.Hash();
+
+    LatencyStats stepTracked("Tick com rastreio");
+    LatencyStats stepBurst("Tick sala reinicia");
+    LatencyStats checkpointStats("Checkpoint");
+    LatencyStats restoreStats("Restore");
+    uint64_t pagesCopied = 0;
+    uint64_t pagesRestored = 0;
+    uint32_t restores = 0;
+    uint32_t mismatches = 0;
+    uint32_t maxDepth = 0;
+    uint64_t burstFaults = 0;
+
+    for (uint32_t tick = 0; tick < HARNESS_CKPT_TICKS; tick++) {
+        // Sala reiniciando fica à parte: uma falta por página do EmMgr,
+        // é ela que domina a cauda do tick com rastreio
+        bool burst = tick % HARNESS_CKPT_BURST_EVERY == HARNESS_CKPT_BURST_EVERY - 1;
+        uint64_t faultsBefore = checkpoints.Faults();
+        uint64_t s0 = HarnessNanos();
+        memory.Step(tick, rng);
+        uint64_t s1 = HarnessNanos();
+        uint32_t id = checkpoints.Checkpoint();
+        uint64_t s2 = HarnessNanos();
+        (burst ? stepBurst : stepTracked).Record(s1 - s0);
+        if (burst) burstFaults += checkpoints.Faults() - faultsBefore;
+        checkpointStats.Record(s2 - s1);
+        pagesCopied += checkpoints.LastPages();
+        hashes[id] = memory.Hash();
+
+        if (tick % HARNESS_CKPT_RESTORE_EVERY == HARNESS_CKPT_RESTORE_EVERY - 1) {
+            // Jogo andou um pouco depois do checkpoint; volta até o mais velho
+            memory.Step(tick, rng);
+            uint32_t depth = (uint32_t)(HarnessRandom(rng) * (float)(checkpoints.Latest() - checkpoints.Oldest() + 1));
+            uint32_t target = checkpoints.Latest() - depth;
+
+            uint64_t r0 = HarnessNanos();
+            bool ok = checkpoints.Restore(target);
+            uint64_t r1 = HarnessNanos();
+            restoreStats.Record(r1 - r0);
+            pagesRestored += checkpoints.LastPages();
+            restores++;
+            if (depth > maxDepth) maxDepth = depth;
+            if (!ok || memory.Hash() != hashes[target]) {
+                printf("[CHECKPOINT] Restore(%u) no tick %u não voltou igual\n", target, tick);
+                mismatches++;
+            }
+        }
+    }
+
+    // Mais velho que o ring não volta; desarmado a memória fica como está
+    bool tooOld = checkpoints.Oldest() > 1 && checkpoints.Restore(checkpoints.Oldest() - 1);
+    uint64_t faults = checkpoints.Faults();
+    uint64_t before = memory.Hash();
+    checkpoints.Disarm();
+    memory.enemies[0] ^= 1;
+    memory.enemies[0] ^= 1;
+    if (tooOld || memory.Hash() != before) mismatches++;
+
+    uint32_t trackedPages = checkpoints.PageCount();
+    printf("[CHECKPOINT] %u regiões, %u páginas de %u B (%.1f MB), ring de %u checkpoints, %u ticks\n",
+           checkpoints.RegionCount(), trackedPages, checkpoints.PageSize(),
+           (double)trackedPages * checkpoints.PageSize() / (1024.0 * 1024.0), CHECKPOINT_RING, HARNESS_CKPT_TICKS);
+    printf("  Arm (cópia para a sombra): %.2f ms\n", (double)armNanos / 1e6);
+    printf("  Páginas por checkpoint:    %.1f (faltas de escrita: %llu, %.1f por tick)\n",
+           (double)pagesCopied / HARNESS_CKPT_TICKS, (unsigned long long)faults,
+           (double)faults / HARNESS_CKPT_TICKS);
+    printf("  Sala reiniciando:          %u ticks, %.0f faltas cada, %.2f us por falta\n",
+           (uint32_t)stepBurst.histogram.count,
+           stepBurst.histogram.count ? (double)burstFaults / stepBurst.histogram.count : 0.0,
+           burstFaults ? (double)stepBurst.histogram.sum / burstFaults / 1e3 : 0.0);
+    printf("  Restores:                  %u (até %u checkpoints para trás, %.1f cópias de página cada)\n\n",
+           restores, maxDepth, restores ? (double)pagesRestored / restores : 0.0);
+    printf("  %-22s %10s  %8s %8s %8s %8s %8s %10s\n", "ns por chamada", "amostras",
+           "média", "p50", "p90", "p99", "p99.9", "máx");
+    stepPlain.Print();
+    stepTracked.Print();
+    stepBurst.Print();
+    checkpointStats.Print();
+    fullCopy.Print();
+    restoreStats.Print();
+    printf("\n  Divergências: %u\n", mismatches);
+
+    VirtualFree(memory.players, 0, MEM_RELEASE);
+    VirtualFree(memory.enemies, 0, MEM_RELEASE);
+    VirtualFree(memory.inventory, 0, MEM_RELEASE);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,282 @@
+/**
+ * RE4 CO-OP MOD - Harness: Canal Cifrado (--crypto)
+ *
+ * Confere SHA-512/HMAC e os vetores conhecidos de ChaCha20-Poly1305
+ * (RFC 8439), AES-256-GCM (casos 13, 14 e 16 do GCM da NIST) e X25519
+ * (RFC 7748), fecha o handshake CPace em memória (código certo
+ * confirma, errado não), recusa registro adulterado e repetido, e mede
+ * Seal+Open por pacote de cada suíte contra o caminho em claro.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// CANAL CIFRADO
+//=============================================================================
+
+static bool HarnessHexEqual(const uint8_t* bytes, const char* hex) {
+    for (size_t i = 0; hex[2 * i]; i++) {
+        unsigned value = 0;
+        sscanf(hex + 2 * i, "%2x", &value);
+        if (bytes[i] != (uint8_t)value) return false;
+    }
+    return true;
+}
+
+static void HarnessHexBytes(const char* hex, uint8_t* out) {
+    for (size_t i = 0; hex[2 * i]; i++) {
+        unsigned value = 0;
+        sscanf(hex + 2 * i, "%2x", &value);
+        out[i] = (uint8_t)value;
+    }
+}
+
+// AEAD: cifra bate com o vetor, a tag bate, abre de volta no texto original
+// e não abre com um bit trocado na tag
+template<typename SealFn, typename OpenFn>
+static bool AeadKnownAnswer(SealFn&& seal, OpenFn&& open, const char* aadHex, const char* plainHex,
+                            const char* cipherHex, const char* tagHex) {
+    uint8_t aad[32] = {}, plain[128] = {}, data[128] = {}, tag[16];
+    size_t aadSize = strlen(aadHex) / 2, size = strlen(plainHex) / 2;
+    HarnessHexBytes(aadHex, aad);
+    HarnessHexBytes(plainHex, plain);
+    memcpy(data, plain, size);
+
+    seal(aad, aadSize, data, size, tag);
+    bool ok = HarnessHexEqual(data, cipherHex) && HarnessHexEqual(tag, tagHex);
+    ok = open(aad, aadSize, data, size, tag) && memcmp(data, plain, size) == 0 && ok;
+
+    seal(aad, aadSize, data, size, tag);
+    tag[0] ^= 0x01;
+    return !open(aad, aadSize, data, size, tag) && ok;
+}
+
+static uint32_t CryptoKnownAnswers() {
+    uint32_t failures = 0;
+    uint8_t key[32], nonce[12];
+
+    // RFC 8439 §2.8.2
+    HarnessHexBytes("808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f", key);
+    HarnessHexBytes("070000004041424344454647", nonce);
+    bool chachaOk = AeadKnownAnswer(
+        [&](const uint8_t* aad, size_t aadSize, uint8_t* data, size_t size, uint8_t* tag) {
+            ChaChaPolySeal(key, nonce, aad, aadSize, data, size, tag);
+        },
+        [&](const uint8_t* aad, size_t aadSize, uint8_t* data, size_t size, const uint8_t* tag) {
+            return ChaChaPolyOpen(key, nonce, aad, aadSize, data, size, tag);
+        },
+        "50515253c0c1c2c3c4c5c6c7",
+        "4c616469657320616e642047656e746c656d656e206f662074686520636c6173"
+        "73206f66202739393a204966204920636f756c64206f6666657220796f75206f"
+        "6e6c79206f6e652074697020666f7220746865206675747572652c2073756e73"
+        "637265656e20776f756c642062652069742e",
+        "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d6"
+        "3dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b36"
+        "92ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+        "3ff4def08e4b7a9de576d26586cec64b6116",
+        "1ae10b594f09e26a7e902ecbd0600691");
+    printf("[CRYPTO] ChaCha20-Poly1305 (RFC 8439 2.8.2) %s\n", chachaOk ? "ok" : "ERRADO");
+    failures += !chachaOk;
+
+    // GCM da NIST, casos 13, 14 e 16 (AES-256, nonce de 96 bits)
+#ifdef COOP_CRYPTO_X86
+    if (CpuHasAesGcm()) {
+        struct GcmCase {
+            const char* key;
+            const char* nonce;
+            const char* aad;
+            const char* plain;
+            const char* cipher;
+            const char* tag;
+        };
+        static const GcmCase cases[] = {
+            { "0000000000000000000000000000000000000000000000000000000000000000", "000000000000000000000000",
+              "", "", "", "530f8afbc74536b9a963b4f1c4cb738b" },
+            { "0000000000000000000000000000000000000000000000000000000000000000", "000000000000000000000000",
+              "", "00000000000000000000000000000000", "cea7403d4d606b6e074ec5d3baf39d18",
+              "d0d1c8a799996bf0265b98b5d48ab919" },
+            { "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888",
+              "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+              "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+              "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+              "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa"
+              "8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662",
+              "76fc6ece0f4e1768cddf8853bb2d551b" },
+        };
+        uint32_t passed = 0;
+        for (const GcmCase& test : cases) {
+            Aes256Gcm gcm;
+            HarnessHexBytes(test.key, key);
+            HarnessHexBytes(test.nonce, nonce);
+            gcm.SetKey(key);
+            passed += AeadKnownAnswer(
+                [&](const uint8_t* aad, size_t aadSize, uint8_t* data, size_t size, uint8_t* tag) {
+                    gcm.Seal(nonce, aad, aadSize, data, size, tag);
+                },
+                [&](const uint8_t* aad, size_t aadSize, uint8_t* data, size_t size, const uint8_t* tag) {
+                    return gcm.Open(nonce, aad, aadSize, data, size, tag);
+                },
+                test.aad, test.plain, test.cipher, test.tag);
+        }
+        bool gcmOk = passed == sizeof(cases) / sizeof(cases[0]);
+        printf("[CRYPTO] AES-256-GCM (NIST, casos 13, 14, 16) %u de %u %s\n", passed,
+               (uint32_t)(sizeof(cases) / sizeof(cases[0])), gcmOk ? "ok" : "ERRADO");
+        failures += !gcmOk;
+    }
+    else
+#endif
+    {
+        printf("[CRYPTO] AES-256-GCM (NIST): CPU sem AES-NI/PCLMUL, pulado\n");
+    }
+
+    // RFC 7748 §5.2 (dois vetores de uma iteração) e §6.1 (Diffie-Hellman)
+    uint8_t scalar[32], point[32], out[32], alice[32], bob[32];
+    HarnessHexBytes("a546e36bf0527c9d3b16154b82465edd62144c0ac1fc5a18506a2244ba449ac4", scalar);
+    HarnessHexBytes("e6db6867583030db3594c1a424b15f7c726624ec26b3353b10a903a6d0ab1c4c", point);
+    x25519::ScalarMult(out, scalar, point);
+    bool x25519Ok = HarnessHexEqual(out, "c3da55379de9c6908e94ea4df28d084f32eccf03491c71f754b4075577a28552");
+    HarnessHexBytes("4b66e9d4d1b4673c5ad22691957d6af5c11b6421e0ea01d42ca4169e7918ba0d", scalar);
+    HarnessHexBytes("e5210f12786811d3f4b7959d0538ae2c31dbe7106fc03c3efc4cd549c715a493", point);
+    x25519::ScalarMult(out, scalar, point);
+    x25519Ok = HarnessHexEqual(out, "95cbde9476e8907d7aade45cb4b873f88b595a68799fa152e6f8f7647aac7957") && x25519Ok;
+
+    HarnessHexBytes("77076d0a7318a57d3c16c17251b26645df4c2f87ebc0992ab177fba51db92c2a", alice);
+    HarnessHexBytes("5dab087e624a8a4b79e17f8b83800ee66f3bb1292618b6fd1c2f8b27ff88e0eb", bob);
+    x25519::PublicKey(out, alice);
+    x25519Ok = HarnessHexEqual(out, "8520f0098930a754748b7ddcb43ef75a0dbf3a0d26381af4eba4a98eaa9b4e6a") && x25519Ok;
+    x25519::PublicKey(point, bob);
+    x25519Ok = HarnessHexEqual(point, "de9edb7d7b7dc1b4d35b61c2ece435373f8343c85b78674dadfc7e146f882b4f") && x25519Ok;
+    x25519::ScalarMult(out, alice, point);
+    x25519Ok = HarnessHexEqual(out, "4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742") && x25519Ok;
+    printf("[CRYPTO] X25519 (RFC 7748 5.2 e 6.1) %s\n", x25519Ok ? "ok" : "ERRADO");
+    failures += !x25519Ok;
+
+    return failures;
+}
+
+// Seal + Open de um pacote por iteração. suite NONE é o caminho em claro
+// (prefixo de tamanho e as duas cópias que o transporte faria de qualquer jeito).
+static double CryptoNanosPerPacket(SecureSession& host, SecureSession& client, CipherSuite suite,
+                                   uint32_t size, uint32_t iterations) {
+    uint8_t plain[512];
+    uint8_t record[512 + SECURE_RECORD_OVERHEAD];
+    uint8_t body[512 + AEAD_TAG_SIZE];
+    uint32_t seed = 0x5EA1u + size;
+    for (uint32_t i = 0; i < size; i++) plain[i] = (uint8_t)(HarnessRandom(seed) * 256.0f);
+
+    uint64_t start = HarnessNanos();
+    volatile uint8_t sink = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        plain[0] = (uint8_t)i;
+        if (suite == CipherSuite::NONE) {
+            record[0] = (uint8_t)size;
+            record[1] = (uint8_t)(size >> 8);
+            memcpy(record + SECURE_LENGTH_SIZE, plain, size);
+            memcpy(body, record + SECURE_LENGTH_SIZE, size);
+        }
+        else {
+            uint32_t length = host.Seal(plain, size, record);
+            uint32_t plainSize = 0;
+            memcpy(body, record + SECURE_LENGTH_SIZE, length - SECURE_LENGTH_SIZE);
+            if (!client.Open(record, body, length - SECURE_LENGTH_SIZE, plainSize)) return -1.0;
+        }
+        sink = sink + body[0];
+    }
+    (void)sink;
+    return (double)(HarnessNanos() - start) / iterations;
+}
+
+int RunCryptoBench() {
+    uint32_t failures = 0;
+
+    // Vetores conhecidos (FIPS 180-4 e RFC 4231, caso 2)
+    uint8_t digest[Sha512::DIGEST_SIZE];
+    Sha512 hash;
+    hash.Update("abc", 3);
+    hash.Finish(digest);
+    bool shaOk = HarnessHexEqual(digest,
+        "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+        "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f");
+    HmacSha512(digest, (const uint8_t*)"Jefe", 4, "what do ya want for nothing?", 28);
+    bool hmacOk = HarnessHexEqual(digest,
+        "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+        "9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737");
+    printf("[CRYPTO] SHA-512 %s, HMAC-SHA512 %s\n", shaOk ? "ok" : "ERRADO", hmacOk ? "ok" : "ERRADO");
+    if (!shaOk || !hmacOk) failures++;
+    failures += CryptoKnownAnswers();
+
+    // Handshake: mesmo código fecha, código errado (um caractere) não confirma
+    SecureSession host, client;
+    const uint32_t HANDSHAKES = 20;
+    uint64_t start = HarnessNanos();
+    bool handshakeOk = true;
+    for (uint32_t i = 0; i < HANDSHAKES; i++) {
+        handshakeOk = HarnessHandshake(host, client, "K7QX2M", "K7QX2M", CipherSuite::CHACHA20_POLY1305) && handshakeOk;
+    }
+    double handshakeMs = (double)(HarnessNanos() - start) / HANDSHAKES / 1e6;
+
+    SecureSession wrongHost, wrongClient;
+    bool wrongRejected = !HarnessHandshake(wrongHost, wrongClient, "K7QX2M", "K7QX2N", CipherSuite::CHACHA20_POLY1305);
+    printf("  Handshake CPace (os dois lados): %.2f ms; código certo %s, código errado %s\n",
+           handshakeMs, handshakeOk ? "confirma" : "NÃO CONFIRMA", wrongRejected ? "recusado" : "ACEITO");
+    if (!handshakeOk || !wrongRejected) failures++;
+
+    // Registro adulterado e registro repetido não abrem
+    uint8_t plain[64] = {1, 2, 3};
+    uint8_t record[64 + SECURE_RECORD_OVERHEAD];
+    uint8_t body[64 + AEAD_TAG_SIZE];
+    uint32_t plainSize = 0;
+    uint32_t length = client.Seal(plain, sizeof(plain), record);
+    memcpy(body, record + SECURE_LENGTH_SIZE, length - SECURE_LENGTH_SIZE);
+    body[5] ^= 0x40;
+    bool tamperRejected = !host.Open(record, body, length - SECURE_LENGTH_SIZE, plainSize);
+    memcpy(body, record + SECURE_LENGTH_SIZE, length - SECURE_LENGTH_SIZE);
+    bool firstOpens = host.Open(record, body, length - SECURE_LENGTH_SIZE, plainSize);
+    memcpy(body, record + SECURE_LENGTH_SIZE, length - SECURE_LENGTH_SIZE);
+    bool replayRejected = !host.Open(record, body, length - SECURE_LENGTH_SIZE, plainSize);
+    printf("  Registro adulterado %s, original %s, repetido %s\n\n", tamperRejected ? "recusado" : "ACEITO",
+           firstOpens ? "abre" : "NÃO ABRE", replayRejected ? "recusado" : "ACEITO");
+    if (!tamperRejected || !firstOpens || !replayRejected) failures++;
+
+    // Custo por pacote contra o caminho em claro
+    struct Path {
+        CipherSuite suite;
+        const char* name;
+    };
+    const Path paths[] = {
+        { CipherSuite::NONE,              "em claro (cópias)" },
+        { CipherSuite::CHACHA20_POLY1305, "ChaCha20-Poly1305" },
+        { CipherSuite::AES256_GCM,        "AES-256-GCM" },
+    };
+    const uint32_t sizes[] = { 64, (uint32_t)sizeof(GameStatePacket), 512 };
+    const uint32_t ITERATIONS = 200000;
+
+    printf("  %-20s", "Seal+Open (ns/pacote)");
+    for (uint32_t size : sizes) printf(" %9u B", size);
+    printf("   MB/s @512\n");
+    for (const Path& path : paths) {
+        if (path.suite == CipherSuite::AES256_GCM && !CpuHasAesGcm()) {
+            printf("  %-20s (CPU sem AES-NI/PCLMUL)\n", path.name);
+            continue;
+        }
+        if (path.suite != CipherSuite::NONE) HarnessHandshake(host, client, "K7QX2M", "K7QX2M", path.suite);
+
+        double last = 0;
+        printf("  %-20s", path.name);
+        for (uint32_t size : sizes) {
+            last = CryptoNanosPerPacket(host, client, path.suite, size, ITERATIONS);
+            if (last < 0) failures++;
+            printf(" %11.0f", last);
+        }
+        printf("   %9.0f\n", last > 0 ? 512.0 * 1000.0 / last : 0.0);
+    }
+
+    // Orçamento: 30 GAME_STATE + 30 PLAYER_INPUT por segundo por lado
+    HarnessHandshake(host, client, "K7QX2M", "K7QX2M", CipherSuite::CHACHA20_POLY1305);
+    double perPacket = CryptoNanosPerPacket(host, client, CipherSuite::CHACHA20_POLY1305, sizeof(GameStatePacket), ITERATIONS);
+    printf("\n  ChaCha20 a 60 pacotes/s: %.1f us de CPU por segundo (%.4f%% de um núcleo)\n",
+           perPacket * 60.0 / 1000.0, perPacket * 60.0 / 1e7);
+
+    printf("\n  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
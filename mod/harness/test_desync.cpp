@@ -0,0 +1,311 @@
+/**
+ * RE4 CO-OP MOD - Harness: Desync (--desync)
+ *
+ * Mede o hash de estado (SSE2 contra escalar, 16 a 1024 entidades,
+ * conferindo um contra o outro) e simula host e cliente trocando checks
+ * com uma deriva injetada (vida da Ashley, inimigo a mais, posição): tick
+ * e entidade reportados contra os esperados.
+ *
+ * Manda também um DESYNC_DETAIL cheio pelo canal selado de verdade (Seal,
+ * TCP de loopback, RecordReader, Open): o detalhe só sai numa rajada de
+ * desync, e um par a mais no pacote já passa do registro que o outro lado
+ * aceita.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// DESYNC
+//=============================================================================
+
+constexpr uint32_t HARNESS_DESYNC_SIZES[] = { 16, 64, 256, 512, 1024 };
+constexpr uint32_t HARNESS_DESYNC_REPS = 4000;
+constexpr uint32_t HARNESS_DESYNC_ENTITIES = 300;       // Players + inimigos na simulação
+constexpr uint32_t HARNESS_DESYNC_TICKS = 600;          // Ticks de rede por cenário
+constexpr uint32_t HARNESS_DESYNC_DRIFT_AT = 301;       // Tick da deriva (fora da grade de checks)
+constexpr uint16_t HARNESS_DESYNC_PORT = 27216;         // Loopback do DESYNC_DETAIL selado
+
+enum class DesyncDrift : uint8_t {
+    ASHLEY_HP,
+    EXTRA_ENEMY,                // Cliente não viu o inimigo morrer
+    ENEMY_POS,
+};
+
+struct DesyncRun {
+    uint32_t firstCheck;        // Primeiro check depois da deriva (esperado)
+    uint32_t expectedEntity;
+    uint32_t falseMismatches;   // Antes da deriva
+    uint32_t checks;
+    bool reported;
+    DesyncReport report;
+};
+
+// Entidade i de from de volta em to, no mesmo lugar da ordem
+static void InsertSnapshotEntity(EntitySnapshot& to, uint32_t i, const EntitySnapshot& from, uint32_t j) {
+    uint32_t tail = to.count - i;
+    memmove(&to.id[i + 1], &to.id[i], tail * sizeof(to.id[0]));
+    memmove(&to.posX[i + 1], &to.posX[i], tail * sizeof(to.posX[0]));
+    memmove(&to.posY[i + 1], &to.posY[i], tail * sizeof(to.posY[0]));
+    memmove(&to.posZ[i + 1], &to.posZ[i], tail * sizeof(to.posZ[0]));
+    memmove(&to.hp[i + 1], &to.hp[i], tail * sizeof(to.hp[0]));
+    memmove(&to.hpMax[i + 1], &to.hpMax[i], tail * sizeof(to.hpMax[0]));
+    memmove(&to.flags[i + 1], &to.flags[i], tail * sizeof(to.flags[0]));
+    memmove(&to.state[i + 1], &to.state[i], tail * sizeof(to.state[0]));
+    to.id[i] = from.id[j];
+    to.posX[i] = from.posX[j];
+    to.posY[i] = from.posY[j];
+    to.posZ[i] = from.posZ[j];
+    to.hp[i] = from.hp[j];
+    to.hpMax[i] = from.hpMax[j];
+    to.flags[i] = from.flags[j];
+    to.state[i] = from.state[j];
+    to.count++;
+}
+
+// Host e cliente com a mesma sala; o cliente recebe tudo pelo fio e a
+// partir de HARNESS_DESYNC_DRIFT_AT deriva. Checks e detalhe como na rede.
+static void SimulateDesync(DesyncDrift drift, DesyncRun& run) {
+    static EntitySnapshot host;
+    static EntitySnapshot client;
+    static EntitySnapshot ghost;                        // Inimigo que o cliente não viu morrer
+    static DesyncMonitor hostMonitor("host", "cliente");
+    static DesyncMonitor clientMonitor("cliente", "host");
+    hostMonitor.Reset();
+    clientMonitor.Reset();
+
+    uint32_t rng = 0xD35C + (uint32_t)drift;
+    FillDesyncSnapshot(host, HARNESS_DESYNC_ENTITIES, rng);
+    memset(&client, 0, sizeof(client));
+    const uint32_t ashley = 1;
+    const uint32_t enemy = 37;
+    run = {};
+    run.expectedEntity = drift == DesyncDrift::ASHLEY_HP ? host.id[ashley] : host.id[enemy];
+
+    for (uint32_t tick = 1; tick <= HARNESS_DESYNC_TICKS; tick++) {
+        // Jogo anda no host: players e inimigos mexem, alguns tomam dano
+        for (uint32_t i = 0; i < host.count; i++) {
+            host.posX[i] += (HarnessRandom(rng) - 0.5f) * 8.0f;
+            host.posZ[i] += (HarnessRandom(rng) - 0.5f) * 8.0f;
+            if (HarnessRandom(rng) < 0.01f) host.hp[i]--;
+        }
+
+        bool drifting = tick >= HARNESS_DESYNC_DRIFT_AT;
+        if (drift == DesyncDrift::EXTRA_ENEMY && tick == HARNESS_DESYNC_DRIFT_AT) {
+            memcpy(&ghost, &client, sizeof(ghost));     // Última versão que o cliente aplicou
+            RemoveSnapshotEntity(host, enemy);
+        }
+
+        WireSnapshot(host, client);
+        if (drifting) {
+            if (drift == DesyncDrift::ASHLEY_HP) client.hp[ashley] -= 10;
+            else if (drift == DesyncDrift::ENEMY_POS) client.posX[enemy] += 0.25f;
+            else InsertSnapshotEntity(client, enemy, ghost, enemy);
+        }
+
+        if (tick % DESYNC_CHECK_INTERVAL) continue;
+        if (tick >= HARNESS_DESYNC_DRIFT_AT && !run.firstCheck) run.firstCheck = tick;
+
+        // Host grava e manda; cliente aplica, grava, compara e devolve
+        uint64_t hostRoot = hostMonitor.Record(tick, host);
+        uint64_t clientRoot = clientMonitor.Record(tick, client);
+        DesyncResult result = clientMonitor.Compare(tick, hostRoot);
+        hostMonitor.Compare(tick, clientRoot);
+        if (result != DesyncResult::MATCH && tick < HARNESS_DESYNC_DRIFT_AT) run.falseMismatches++;
+
+        if (result == DesyncResult::DIVERGED) {
+            // DESYNC_REQUEST -> DESYNC_DETAIL em pedaços
+            const DesyncCheck* check = hostMonitor.Find(clientMonitor.Report().tick);
+            DesyncEntityHash chunk[DESYNC_DETAIL_PER_PACKET];
+            for (uint32_t first = 0; check && first < check->count; first += DESYNC_DETAIL_PER_PACKET) {
+                uint32_t n = std::min(check->count - first, DESYNC_DETAIL_PER_PACKET);
+                for (uint32_t k = 0; k < n; k++) chunk[k] = { check->ids[first + k], check->hashes[first + k] };
+                if (clientMonitor.AddRemoteDetail(check->tick, first, check->count, chunk, n)) {
+                    run.reported = true;
+                    run.report = clientMonitor.Report();
+                }
+            }
+        }
+    }
+    run.checks = clientMonitor.Checks();
+}
+
+// Duas pontas TCP ligadas no loopback (a = quem conectou, b = quem aceitou)
+static bool LoopbackPair(uint16_t port, SOCKET& a, SOCKET& b) {
+    a = b = INVALID_SOCKET;
+    SOCKET listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener == INVALID_SOCKET) return false;
+
+    int enable = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&enable, sizeof(enable));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (bind(listener, (sockaddr*)&addr, sizeof(addr)) != SOCKET_ERROR && listen(listener, 1) != SOCKET_ERROR) {
+        a = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (a != INVALID_SOCKET && connect(a, (sockaddr*)&addr, sizeof(addr)) != SOCKET_ERROR) {
+            b = accept(listener, nullptr, nullptr);
+        }
+    }
+    closesocket(listener);
+    return b != INVALID_SOCKET;
+}
+
+// Um registro pelo caminho das threads de envio e recepção: Seal, send,
+// RecordReader e Open no buffer de um pacote. READY só se o outro lado
+// abriu exatamente o que saiu.
+static RecordStatus SealedRoundTrip(SecureSession& sender, SecureSession& receiver, SOCKET out, SOCKET in,
+                                    RecordReader& reader, const uint8_t* packet, uint32_t size) {
+    static uint8_t record[2 * PACKET_BUFFER_SIZE];
+    static uint8_t rx[PACKET_BUFFER_SIZE];
+    uint32_t sealed = sender.Seal(packet, size, record);
+    if (!SendAll(out, record, sealed)) return RecordStatus::INVALID;
+
+    uint8_t* at;
+    uint32_t bodySize;
+    RecordStatus status;
+    while ((status = reader.Next(at, bodySize)) == RecordStatus::NEED_MORE) {
+        if (!reader.Fill(in)) return RecordStatus::INVALID;
+    }
+    if (status != RecordStatus::READY) return status;
+
+    memcpy(rx, at + SECURE_LENGTH_SIZE, bodySize);
+    uint32_t plainSize;
+    if (!receiver.Open(at, rx, bodySize, plainSize) || plainSize != size || memcmp(rx, packet, size)) {
+        return RecordStatus::INVALID;
+    }
+    return RecordStatus::READY;
+}
+
+// DESYNC_DETAIL cheio de um check de verdade, do host para o cliente
+static uint32_t CheckSealedDetail() {
+    SecureSession host, client;
+    SOCKET out = INVALID_SOCKET, in = INVALID_SOCKET;
+    if (!HarnessHandshake(host, client, "K7QX2M", "K7QX2M", CipherSuite::CHACHA20_POLY1305) ||
+        !LoopbackPair(HARNESS_DESYNC_PORT, out, in)) {
+        printf("\n[DESYNC] Loopback na porta %u não abriu\n", HARNESS_DESYNC_PORT);
+        if (out != INVALID_SOCKET) closesocket(out);
+        return 1;
+    }
+
+    static EntitySnapshot snapshot;
+    static DesyncMonitor monitor("host", "cliente");
+    uint32_t rng = 0xDE7A;
+    FillDesyncSnapshot(snapshot, DESYNC_DETAIL_PER_PACKET + 1, rng);
+    monitor.Record(8, snapshot);
+    const DesyncCheck* check = monitor.Find(8);
+
+    // Como CoopServer::PumpDesyncDetail, com um par a mais no fim do buffer
+    static uint8_t buffer[sizeof(DesyncDetailPacket) + sizeof(DesyncEntityHash)];
+    DesyncDetailPacket& packet = *(DesyncDetailPacket*)buffer;
+    memset(buffer, 0, sizeof(buffer));
+    packet.header.type = PacketType::DESYNC_DETAIL;
+    packet.tick = check->tick;
+    packet.total = (uint16_t)check->count;
+    packet.count = DESYNC_DETAIL_PER_PACKET;
+    for (uint32_t k = 0; k < check->count; k++) {
+        packet.entities[k].id = check->ids[k];
+        packet.entities[k].hash = check->hashes[k];
+    }
+    uint32_t full = (uint32_t)(offsetof(DesyncDetailPacket, entities) + DESYNC_DETAIL_PER_PACKET * sizeof(DesyncEntityHash));
+    uint32_t over = full + (uint32_t)sizeof(DesyncEntityHash);
+
+    static RecordReader reader;
+    reader.Reset();
+    bool fullOk = SealedRoundTrip(host, client, out, in, reader, buffer, full) == RecordStatus::READY;
+    bool overRejected = SealedRoundTrip(host, client, out, in, reader, buffer, over) == RecordStatus::INVALID;
+    closesocket(out);
+    closesocket(in);
+
+    printf("\n[DESYNC] DESYNC_DETAIL cheio pelo canal selado: %u pares, %u + %u de tag (limite %u) -> %s\n",
+           DESYNC_DETAIL_PER_PACKET, full, AEAD_TAG_SIZE, PACKET_BUFFER_SIZE, fullOk ? "ok" : "ERRADO");
+    printf("  Um par a mais (%u + %u): RecordReader recusa -> %s\n", over, AEAD_TAG_SIZE,
+           overRejected ? "ok" : "ERRADO");
+    return (fullOk ? 0 : 1) + (overRejected ? 0 : 1);
+}
+
+int RunDesyncBench() {
+    static EntitySnapshot snapshot;
+    static uint32_t hashes[SNAPSHOT_MAX_ENTITIES];
+    static uint32_t scalarHashes[SNAPSHOT_MAX_ENTITIES];
+    uint32_t rng = 0x5EED;
+    uint32_t failures = 0;
+
+#ifdef COOP_DESYNC_SSE2
+    printf("[DESYNC] Hash de estado (SSE2, 4 entidades por vez) contra o escalar, %u chamadas por tamanho\n\n",
+           HARNESS_DESYNC_REPS);
+#else
+    printf("[DESYNC] Hash de estado (sem SSE2: só o escalar), %u chamadas por tamanho\n\n", HARNESS_DESYNC_REPS);
+#endif
+    printf("  %-22s %10s  %8s %8s %8s %8s %8s %10s\n", "ns por chamada", "amostras",
+           "média", "p50", "p90", "p99", "p99.9", "máx");
+
+    char names[2 * (sizeof(HARNESS_DESYNC_SIZES) / sizeof(HARNESS_DESYNC_SIZES[0]))][32];
+    uint32_t nameIndex = 0;
+    for (uint32_t size : HARNESS_DESYNC_SIZES) {
+        FillDesyncSnapshot(snapshot, size, rng);
+        // Casos de borda na conversão: NaN, infinito, fora da faixa, exatamente no limite
+        snapshot.posX[0] = NAN;
+        snapshot.posY[1 % size] = INFINITY;
+        snapshot.posZ[2 % size] = -1.0e9f;
+        snapshot.posX[3 % size] = (float)DESYNC_POS_MAX;
+        snapshot.posZ[4 % size] = (float)DESYNC_POS_MIN;
+
+        char* simdName = names[nameIndex++];
+        char* scalarName = names[nameIndex++];
+        snprintf(simdName, 32, "HashSnapshot %u", size);
+        snprintf(scalarName, 32, "  escalar %u", size);
+        LatencyStats simd(simdName);
+        LatencyStats scalar(scalarName);
+
+        uint64_t root = 0, scalarRoot = 0;
+        for (uint32_t rep = 0; rep < HARNESS_DESYNC_REPS; rep++) {
+            uint64_t t0 = HarnessNanos();
+            root = HashSnapshot(snapshot, hashes);
+            uint64_t t1 = HarnessNanos();
+            scalarRoot = HashSnapshotScalar(snapshot, scalarHashes);
+            uint64_t t2 = HarnessNanos();
+            simd.Record(t1 - t0);
+            scalar.Record(t2 - t1);
+        }
+        simd.Print();
+        scalar.Print();
+
+        if (root != scalarRoot || memcmp(hashes, scalarHashes, size * sizeof(hashes[0]))) {
+            printf("  -> SSE2 e escalar discordam com %u entidades\n", size);
+            failures++;
+        }
+    }
+
+    // Uma entidade mudando um passo de quantização muda o root
+    FillDesyncSnapshot(snapshot, 256, rng);
+    uint64_t before = HashSnapshot(snapshot);
+    snapshot.posY[200] += 1.0f / 32.0f;
+    if (HashSnapshot(snapshot) == before) {
+        printf("  -> Passo de 1/32 de unidade não mudou o hash\n");
+        failures++;
+    }
+
+    static const char* DRIFT_NAMES[] = { "Vida da Ashley", "Inimigo a mais", "Posição de inimigo" };
+    printf("\n[DESYNC] Host e cliente, %u entidades, check a cada %u ticks de rede, deriva no tick %u\n",
+           HARNESS_DESYNC_ENTITIES, DESYNC_CHECK_INTERVAL, HARNESS_DESYNC_DRIFT_AT);
+    for (uint32_t d = 0; d < 3; d++) {
+        DesyncRun run;
+        SimulateDesync((DesyncDrift)d, run);
+
+        bool ok = run.reported && run.falseMismatches == 0 && run.report.tick == run.firstCheck &&
+                  run.report.entity == run.expectedEntity;
+        if (!ok) failures++;
+        printf("  %-20s %u checks, %u falsos antes da deriva; reportado: tick %u, entidade %u:%u (%s) -> %s\n",
+               DRIFT_NAMES[d], run.checks, run.falseMismatches, run.report.tick,
+               run.report.entity >> 16, run.report.entity & 0xFFFF,
+               run.report.presence == DESYNC_LOCAL ? "só no cliente" :
+               run.report.presence == DESYNC_REMOTE ? "só no host" : "nos dois",
+               ok ? "ok" : "ERRADO");
+    }
+
+    failures += CheckSealedDetail();
+
+    printf("\n  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
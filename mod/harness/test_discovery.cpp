@@ -0,0 +1,189 @@
+/**
+ * RE4 CO-OP MOD - Harness: Descoberta na LAN (--discovery)
+ *
+ * Anuncia salas na LAN (multicast e broadcast, no loopback e na interface
+ * local) e mede quanto o cliente leva para achar a sala com a tela de
+ * join já aberta e abrindo depois do host, para tirar a sala na despedida
+ * e quando o host cai; com 8 salas ao mesmo tempo, confere que o código
+ * (que não vai no beacon) só completa o handshake com a sala certa e
+ * quantas o cliente tenta até achá-la.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// DESCOBERTA NA LAN
+//=============================================================================
+
+constexpr uint32_t HARNESS_DISCOVERY_TRIALS = 20;
+constexpr uint32_t HARNESS_DISCOVERY_LATE_TRIALS = 8;   // Join aberto depois do host (até 1 intervalo)
+constexpr uint32_t HARNESS_DISCOVERY_HOSTS = 8;
+constexpr uint16_t HARNESS_DISCOVERY_GAME_PORT = 28000;
+constexpr uint32_t HARNESS_DISCOVERY_POLL_MS = 1;       // Frame do menu bem mais curto que os beacons
+
+static void PrintDiscoveryLatency(const char* name, std::vector<double>& millis, uint32_t trials) {
+    if (millis.empty()) {
+        printf("  %-34s nenhuma de %u\n", name, trials);
+        return;
+    }
+    std::sort(millis.begin(), millis.end());
+    printf("  %-34s %3u/%-3u p50 %8.2f ms  p90 %8.2f ms  máx %8.2f ms\n", name, (uint32_t)millis.size(), trials,
+           millis[millis.size() / 2], millis[millis.size() * 9 / 10], millis.back());
+}
+
+// Poll no ritmo do menu até a sala aparecer (ou sumir). Retorna ms ou -1.
+static double WaitDiscovery(DiscoveryListener& listener, uint32_t session, bool present, uint32_t timeoutMs) {
+    uint64_t t0 = HarnessNanos();
+    for (;;) {
+        listener.Poll(GetTickCount());
+        bool found = listener.Find(session, GetTickCount()) != nullptr;
+        double elapsed = (HarnessNanos() - t0) / 1e6;
+        if (found == present) return elapsed;
+        if (elapsed > timeoutMs) return -1.0;
+        Sleep(HARNESS_DISCOVERY_POLL_MS);
+    }
+}
+
+static void DiscoveryCode(uint32_t n, char* code) {
+    snprintf(code, 8, "H%05u", n % 100000);
+}
+
+int RunDiscoveryBench() {
+    uint32_t failures = 0;
+    DiscoveryListener listener;
+    if (!listener.Start()) {
+        printf("[DISCOVERY] Porta UDP %u não abriu\n", DISCOVERY_PORT);
+        return 1;
+    }
+
+    printf("[DISCOVERY] Beacon de %u bytes para %s e 255.255.255.255:%u; burst de %u a cada %u ms, "
+           "depois a cada %u ms; expira em %u ms\n\n",
+           (uint32_t)sizeof(DiscoveryBeacon), DISCOVERY_GROUP, DISCOVERY_PORT, DISCOVERY_BURST,
+           DISCOVERY_BURST_MS, DISCOVERY_INTERVAL_MS, DISCOVERY_EXPIRE_MS);
+
+    // Tela de join aberta, host começa: primeiro beacon sai no Start
+    std::vector<double> found, closed;
+    for (uint32_t trial = 0; trial < HARNESS_DISCOVERY_TRIALS; trial++) {
+        DiscoveryAdvertiser host;
+        uint64_t t0 = HarnessNanos();
+        host.Start(HARNESS_DISCOVERY_GAME_PORT);
+        double waited = WaitDiscovery(listener, host.Session(), true, 2 * DISCOVERY_INTERVAL_MS);
+        if (waited >= 0) found.push_back((HarnessNanos() - t0) / 1e6);
+
+        host.Stop();
+        waited = WaitDiscovery(listener, host.Session(), false, 2 * DISCOVERY_EXPIRE_MS);
+        if (waited >= 0) closed.push_back(waited);
+    }
+
+    // Host já anunciando há um tempo, tela de join abre depois: espera o
+    // próximo beacon (até um intervalo)
+    std::vector<double> late;
+    uint32_t rng = 0xD15C;
+    for (uint32_t trial = 0; trial < HARNESS_DISCOVERY_LATE_TRIALS; trial++) {
+        DiscoveryAdvertiser host;
+        host.Start(HARNESS_DISCOVERY_GAME_PORT);
+        uint32_t delay = DISCOVERY_BURST * DISCOVERY_BURST_MS + (uint32_t)(HarnessRandom(rng) * DISCOVERY_INTERVAL_MS);
+        uint64_t start = HarnessNanos();
+        while ((HarnessNanos() - start) / 1000000 < delay) {
+            host.Update(GetTickCount());
+            Sleep(HARNESS_DISCOVERY_POLL_MS);
+        }
+
+        DiscoveryListener joiner;
+        joiner.Start();
+        uint64_t t0 = HarnessNanos();
+        for (;;) {
+            host.Update(GetTickCount());
+            joiner.Poll(GetTickCount());
+            double elapsed = (HarnessNanos() - t0) / 1e6;
+            if (joiner.Find(host.Session(), GetTickCount())) {
+                late.push_back(elapsed);
+                break;
+            }
+            if (elapsed > 2 * DISCOVERY_INTERVAL_MS) break;
+            Sleep(HARNESS_DISCOVERY_POLL_MS);
+        }
+        host.Stop();
+    }
+
+    // Host cai sem despedida: some por expiração
+    std::vector<double> expired;
+    {
+        DiscoveryAdvertiser host;
+        host.Start(HARNESS_DISCOVERY_GAME_PORT);
+        if (WaitDiscovery(listener, host.Session(), true, 2 * DISCOVERY_INTERVAL_MS) >= 0) {
+            host.Abandon();
+            double waited = WaitDiscovery(listener, host.Session(), false, 2 * DISCOVERY_EXPIRE_MS);
+            if (waited >= 0) expired.push_back(waited);
+        }
+    }
+
+    PrintDiscoveryLatency("Join aberto, host começa", found, HARNESS_DISCOVERY_TRIALS);
+    PrintDiscoveryLatency("Join abre depois do host", late, HARNESS_DISCOVERY_LATE_TRIALS);
+    PrintDiscoveryLatency("Despedida tira da tabela", closed, HARNESS_DISCOVERY_TRIALS);
+    PrintDiscoveryLatency("Host caiu: expira", expired, 1);
+    if (found.size() != HARNESS_DISCOVERY_TRIALS || closed.size() != HARNESS_DISCOVERY_TRIALS ||
+        late.size() != HARNESS_DISCOVERY_LATE_TRIALS || expired.size() != 1) {
+        failures++;
+    }
+
+    // Várias salas na mesma LAN: cada sessão aparece com a sua porta
+    static DiscoveryAdvertiser hosts[HARNESS_DISCOVERY_HOSTS];
+    char codes[HARNESS_DISCOVERY_HOSTS][8];
+    for (uint32_t i = 0; i < HARNESS_DISCOVERY_HOSTS; i++) {
+        DiscoveryCode(2000 + i, codes[i]);
+        hosts[i].Start((uint16_t)(HARNESS_DISCOVERY_GAME_PORT + i));
+    }
+    uint32_t resolved = 0;
+    for (uint32_t wait = 0; wait < 500 && resolved < HARNESS_DISCOVERY_HOSTS; wait++) {
+        Sleep(HARNESS_DISCOVERY_POLL_MS);
+        for (DiscoveryAdvertiser& host : hosts) host.Update(GetTickCount());
+        listener.Poll(GetTickCount());
+        resolved = 0;
+        for (uint32_t i = 0; i < HARNESS_DISCOVERY_HOSTS; i++) {
+            const DiscoverySession* session = listener.Find(hosts[i].Session(), GetTickCount());
+            if (session && session->port == HARNESS_DISCOVERY_GAME_PORT + i) resolved++;
+        }
+    }
+    printf("\n  %u salas ao mesmo tempo: %u na tabela com a porta certa, %u na tabela", HARNESS_DISCOVERY_HOSTS,
+           resolved, listener.Count());
+    if (listener.Count()) printf(" (ex.: sessão %08X em %s:%u)", listener.At(0).session, listener.At(0).ip, listener.At(0).port);
+    printf("\n");
+    if (resolved != HARNESS_DISCOVERY_HOSTS) failures++;
+
+    // Como o menu: com o código de cada sala, tenta as salas vivas em
+    // ordem; o CPace (em memória, com o código de cada host) só fecha na certa
+    const DiscoverySession* sessions[DISCOVERY_MAX_SESSIONS];
+    uint32_t live = listener.Sessions(sessions, DISCOVERY_MAX_SESSIONS, GetTickCount());
+    uint32_t joined = 0, attempts = 0, maxAttempts = 0;
+    for (uint32_t want = 0; want < HARNESS_DISCOVERY_HOSTS; want++) {
+        uint32_t tried = 0, accepted = 0, acceptedHost = HARNESS_DISCOVERY_HOSTS;
+        for (uint32_t k = 0; k < live; k++) {
+            uint32_t host = sessions[k]->port - HARNESS_DISCOVERY_GAME_PORT;
+            if (host >= HARNESS_DISCOVERY_HOSTS) continue;
+            SecureSession hostSide, clientSide;
+            tried++;
+            if (HarnessHandshake(hostSide, clientSide, codes[host], codes[want], CipherSuite::CHACHA20_POLY1305)) {
+                accepted++;
+                acceptedHost = host;
+                break;
+            }
+        }
+        if (accepted == 1 && acceptedHost == want) joined++;
+        attempts += tried;
+        maxAttempts = std::max(maxAttempts, tried);
+    }
+    printf("  Código digitado: %u/%u acharam a própria sala, %.1f handshakes em média (máx %u)\n", joined,
+           HARNESS_DISCOVERY_HOSTS, (double)attempts / HARNESS_DISCOVERY_HOSTS, maxAttempts);
+    if (joined != HARNESS_DISCOVERY_HOSTS) failures++;
+    for (DiscoveryAdvertiser& host : hosts) host.Stop();
+
+    // Custo na rede: um datagrama por destino por intervalo (+ cabeçalho IP/UDP)
+    printf("  Banda por host em regime: %.0f bytes/s; %u beacons recebidos, %u rejeitados\n",
+           2.0 * (sizeof(DiscoveryBeacon) + 28) * 1000.0 / DISCOVERY_INTERVAL_MS, listener.Received(),
+           listener.Rejected());
+
+    listener.Stop();
+    printf("\n  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,178 @@
+/**
+ * RE4 CO-OP MOD - Harness: Cache de Entidades (--entities)
+ *
+ * Confere handles e validação do EntityCache (troca de ponteiro, de
+ * vtable e de sala, página só leitura ou sem mapeamento) e mede Refresh +
+ * 10 leituras por frame contra reler os globais.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// CACHE DE ENTIDADES
+//=============================================================================
+
+constexpr uint32_t HARNESS_ENTITY_FRAMES = 1000000;
+constexpr uint32_t HARNESS_ENTITY_LOOKUPS = 10;         // Leituras de Leon/Ashley por frame (câmera, teleporte...)
+constexpr uint32_t HARNESS_ENTITY_ROOMS = 200;
+
+// Cada leitura num sistema diferente do frame: o compilador não pode juntar
+#define HARNESS_BARRIER() asm volatile("" ::: "memory")
+
+static uint16_t& HarnessRoomId() { return *(uint16_t*)(pGlobals + Table::RoomId::OFFSET); }
+
+// Handles, trocas de ponteiro/vtable/sala e objetos inválidos
+static uint32_t CheckEntityCache(MockGame& game) {
+    EntityCache& entities = EntityCache::Instance();
+    uint32_t failures = 0;
+    auto check = [&](bool ok, const char* what) {
+        printf("  %-44s %s\n", what, ok ? "ok" : "ERRADO");
+        if (!ok) failures++;
+    };
+
+    entities.Refresh();
+    cPlayer* ashley = entities.Ashley();
+    cPlayer* extra = entities.Player(3);
+    EntityHandle handle = entities.Handle(ENTITY_SLOT_ASHLEY);
+    uint32_t queries = entities.QueryCount();
+    for (uint32_t i = 0; i < 100; i++) entities.Refresh();
+    check(entities.ValidCount() == COOP_MAX_PLAYERS && entities.QueryCount() == queries &&
+          entities.Resolve(handle) == ashley, "frames estáveis: 4 slots, sem VirtualQuery");
+
+    // Global passa a apontar para outro objeto
+    cPlayer** source = game.SlotSource(ENTITY_SLOT_ASHLEY);
+    *source = extra;
+    entities.Refresh();
+    check(entities.Ashley() == extra && !entities.Resolve(handle) && entities.QueryCount() == queries + 1,
+          "ponteiro trocado: handle antigo não resolve");
+    *source = ashley;
+    entities.Refresh();
+    handle = entities.Handle(ENTITY_SLOT_ASHLEY);
+
+    // Mesmo endereço, outra vtable (objeto reconstruído): a entrada seguinte
+    // da vtable falsa também aponta para o RET da imagem
+    GameAddress& vtable = *(GameAddress*)ashley;
+    GameAddress original = vtable;
+    vtable += sizeof(GameAddress);
+    entities.Refresh();
+    check(entities.Ashley() == ashley && !entities.Resolve(handle), "vtable trocada no lugar: geração nova");
+    vtable = 0x1234;
+    entities.Refresh();
+    check(!entities.Ashley(), "vtable fora da imagem: recusado");
+    vtable = original;
+    entities.Refresh();
+    handle = entities.Handle(ENTITY_SLOT_ASHLEY);
+
+    // Objetos em página só leitura e sem mapeamento
+    uint8_t* pages = (uint8_t*)mmap(nullptr, 0x3000, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    memcpy(pages, ashley, 0x1000);
+    mprotect(pages, 0x1000, PROT_READ);
+    munmap(pages + 0x2000, 0x1000);
+    *source = (cPlayer*)pages;
+    entities.Refresh();
+    check(!entities.Ashley(), "objeto em página só leitura: recusado");
+    *source = (cPlayer*)(pages + 0x2000);
+    entities.Refresh();
+    check(!entities.Ashley(), "objeto sem mapeamento: recusado");
+    *source = ashley;
+    entities.Refresh();
+    check(entities.Ashley() == ashley && !entities.Resolve(handle), "volta ao objeto: handle antigo não resolve");
+    munmap(pages, 0x2000);
+
+    // Troca de sala: tudo é revalidado
+    handle = entities.Handle(ENTITY_SLOT_PLAYER);
+    queries = entities.QueryCount();
+    HarnessRoomId()++;
+    entities.Refresh();
+    check(entities.ValidCount() == COOP_MAX_PLAYERS && !entities.Resolve(handle) &&
+          entities.QueryCount() == queries + COOP_MAX_PLAYERS, "sala nova: um VirtualQuery por slot");
+    return failures;
+}
+
+// Como o código antes do cache: cada sistema relia o global
+__attribute__((noinline)) static uintptr_t LegacyLookups() {
+    uintptr_t sum = 0;
+    for (uint32_t i = 0; i < HARNESS_ENTITY_LOOKUPS; i++) {
+        sum += (uintptr_t)((i & 1) ? AshleyPtr() : PlayerPtr());
+        HARNESS_BARRIER();
+    }
+    return sum;
+}
+
+__attribute__((noinline)) static uintptr_t CachedLookups() {
+    EntityCache& entities = EntityCache::Instance();
+    entities.Refresh();
+    uintptr_t sum = 0;
+    for (uint32_t i = 0; i < HARNESS_ENTITY_LOOKUPS; i++) {
+        sum += (uintptr_t)((i & 1) ? entities.Ashley() : entities.Leon());
+        HARNESS_BARRIER();
+    }
+    return sum;
+}
+
+__attribute__((noinline)) static uintptr_t HandleLookups(EntityHandle leon, EntityHandle ashley) {
+    EntityCache& entities = EntityCache::Instance();
+    entities.Refresh();
+    uintptr_t sum = 0;
+    for (uint32_t i = 0; i < HARNESS_ENTITY_LOOKUPS; i++) {
+        sum += (uintptr_t)entities.Resolve((i & 1) ? ashley : leon);
+        HARNESS_BARRIER();
+    }
+    return sum;
+}
+
+int RunEntityBench() {
+    static MockGame game;               // Um só: o EntityCache guarda a faixa da imagem
+    if (!game.Create(0)) {
+        printf("[HARNESS] Falha ao alocar a memória do jogo falso\n");
+        return 1;
+    }
+    SelectGameVersion(GameVersion::V1_1_0);
+    for (uint16_t slot = 0; slot < COOP_MAX_PLAYERS; slot++) {
+        CoopMod::BindPlayerSlot(slot, game.SlotSource(slot), (PlayerCharacter)slot);
+    }
+
+    printf("[ENTITIES] EntityCache contra o jogo falso\n");
+    uint32_t failures = CheckEntityCache(game);
+
+    EntityCache& entities = EntityCache::Instance();
+    entities.Refresh();
+    EntityHandle leon = entities.Handle(ENTITY_SLOT_PLAYER);
+    EntityHandle ashley = entities.Handle(ENTITY_SLOT_ASHLEY);
+    volatile uintptr_t sink = 0;
+
+    auto time = [&](auto&& frame) {
+        double best = 1e30;
+        for (uint32_t trial = 0; trial < 5; trial++) {
+            uint64_t start = HarnessNanos();
+            for (uint32_t i = 0; i < HARNESS_ENTITY_FRAMES; i++) sink = sink + frame();
+            best = std::min(best, (double)(HarnessNanos() - start) / HARNESS_ENTITY_FRAMES);
+        }
+        return best;
+    };
+
+    double legacy = time(LegacyLookups);
+    double cached = time(CachedLookups);
+    double handles = time([&] { return HandleLookups(leon, ashley); });
+    double refresh = time([&] { entities.Refresh(); return (uintptr_t)entities.ValidMask(); });
+
+    // Troca de sala: VirtualQuery em cada slot (no compat, /proc/self/maps)
+    uint64_t start = HarnessNanos();
+    for (uint32_t i = 0; i < HARNESS_ENTITY_ROOMS; i++) {
+        HarnessRoomId()++;
+        entities.Refresh();
+    }
+    double roomChange = (double)(HarnessNanos() - start) / HARNESS_ENTITY_ROOMS;
+    if (entities.ValidCount() != COOP_MAX_PLAYERS) failures++;
+
+    printf("\n  %-46s %8s\n", "por frame (10 leituras de Leon/Ashley)", "ns");
+    printf("  %-46s %8.1f\n", "global lido a cada vez (PlayerPtr/AshleyPtr)", legacy);
+    printf("  %-46s %8.1f\n", "Refresh + Leon()/Ashley()", cached);
+    printf("  %-46s %8.1f\n", "Refresh + Resolve(handle)", handles);
+    printf("  %-46s %8.1f\n", "só Refresh (4 slots)", refresh);
+    printf("  %-46s %8.0f\n", "Refresh com sala nova (4 VirtualQuery)", roomChange);
+
+    game.Destroy();
+    printf("\n  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
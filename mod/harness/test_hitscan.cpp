@@ -0,0 +1,82 @@
+/**
+ * RE4 CO-OP MOD - Harness: Hitscan (--hitscan)
+ *
+ * Mede raios/s do HitscanWorld contra 10 a 500 inimigos (e confere cada
+ * acerto contra o teste de força bruta; qualquer diferença falha).
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// HITSCAN
+//=============================================================================
+
+constexpr uint32_t HARNESS_HITSCAN_RAYS = 200000;
+
+// Raios da altura do peito, em direções aleatórias quase horizontais,
+// saindo de dentro da área onde MockGame espalha os inimigos
+int RunHitscanBench() {
+    static HitscanWorld world;
+    static Vec origins[HARNESS_HITSCAN_RAYS];
+    static Vec directions[HARNESS_HITSCAN_RAYS];
+
+    const uint32_t counts[] = { 10, 50, 100, 250, 500 };
+
+    printf("[HITSCAN] %u raios por cenário\n\n", HARNESS_HITSCAN_RAYS);
+    printf("  %8s %10s %14s %14s %8s %10s\n", "inimigos", "acertos", "hash (raios/s)",
+           "bruto (raios/s)", "ganho", "diferenças");
+
+    uint32_t totalMismatches = 0;
+    for (uint32_t count : counts) {
+        MockGame game;
+        if (!game.Create(count)) {
+            printf("[HARNESS] Falha ao alocar a memória do jogo falso\n");
+            return 1;
+        }
+
+        uint64_t t0 = HarnessNanos();
+        world.Rebuild(Table(), EmListView(Table(), pEmMgr));
+        uint64_t buildNanos = HarnessNanos() - t0;
+
+        float width = 16.0f * 150.0f;
+        float depth = (float)((count + 15) / 16) * 150.0f;
+        uint32_t rng = 0x9E3779B9u;
+        for (uint32_t i = 0; i < HARNESS_HITSCAN_RAYS; i++) {
+            float angle = HarnessRandom(rng) * 6.2831853f;
+            origins[i] = { HarnessRandom(rng) * width, 120.0f, HarnessRandom(rng) * depth };
+            directions[i] = { cosf(angle), (HarnessRandom(rng) - 0.5f) * 0.2f, sinf(angle) };
+        }
+
+        HitscanHit hit;
+        uint32_t hits = 0;
+        uint64_t t1 = HarnessNanos();
+        for (uint32_t i = 0; i < HARNESS_HITSCAN_RAYS; i++) {
+            hits += world.Raycast(origins[i], directions[i], HITSCAN_MAX_DISTANCE, hit);
+        }
+        uint64_t t2 = HarnessNanos();
+        uint32_t bruteHits = 0;
+        for (uint32_t i = 0; i < HARNESS_HITSCAN_RAYS; i++) {
+            bruteHits += world.RaycastBruteForce(origins[i], directions[i], HITSCAN_MAX_DISTANCE, hit);
+        }
+        uint64_t t3 = HarnessNanos();
+
+        // Mesmo alvo e mesma distância nos dois caminhos
+        uint32_t mismatches = bruteHits > hits ? bruteHits - hits : hits - bruteHits;
+        for (uint32_t i = 0; i < HARNESS_HITSCAN_RAYS; i += 16) {
+            HitscanHit a, b;
+            bool hitA = world.Raycast(origins[i], directions[i], HITSCAN_MAX_DISTANCE, a);
+            bool hitB = world.RaycastBruteForce(origins[i], directions[i], HITSCAN_MAX_DISTANCE, b);
+            if (hitA != hitB || (hitA && (a.index != b.index || fabsf(a.distance - b.distance) > 0.5f))) {
+                mismatches++;
+            }
+        }
+
+        double gridRate = HARNESS_HITSCAN_RAYS / ((double)(t2 - t1) / 1e9);
+        double bruteRate = HARNESS_HITSCAN_RAYS / ((double)(t3 - t2) / 1e9);
+        printf("  %8u %10u %14.0f %14.0f %7.1fx %10u   (rebuild %llu ns)\n", world.Count(), hits,
+               gridRate, bruteRate, gridRate / bruteRate, mismatches, (unsigned long long)buildNanos);
+        totalMismatches += mismatches;
+        game.Destroy();
+    }
+    return totalMismatches ? 1 : 0;
+}
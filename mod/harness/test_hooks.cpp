@@ -0,0 +1,227 @@
+/**
+ * RE4 CO-OP MOD - Harness: Hooks (--hooks)
+ *
+ * Monta funções num buffer só leitura+execução (prólogo curto, jcc
+ * rel8/rel32, jmp rel8, call rel32 e os casos recusados), confere o
+ * HookStatus de cada uma, executa detours e trampolins e mede o Apply()
+ * dos 64 hooks contra uma troca de proteção por hook.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// HOOKS
+//=============================================================================
+
+// O motor decodifica x86 de 32 bits; as funções de teste usam só
+// instruções com a mesma codificação e tamanho no x86-64 (sem 0x40-0x4F,
+// sem moffs), então rodam de verdade no harness
+
+constexpr uint32_t HARNESS_HOOK_CODE_SIZE = 64 * 1024;
+constexpr uint32_t HARNESS_HOOK_SLOT = 64;              // Bytes por função
+constexpr uint32_t HARNESS_HOOK_SPREAD = 256;           // Cópias extras: 16 por página
+
+typedef int (*HookedFn)(int);
+
+struct HookCase {
+    const char* name;
+    uint8_t code[32];
+    uint32_t length;
+    HookStatus expected;
+    int32_t relAt;              // rel32 para o slot + relTarget (-1: nenhum)
+    uint32_t relTarget;
+};
+
+// lea eax,[rdi+7] no meio de push/mov ebp,esp/pop: o prólogo clássico do jogo
+static const uint8_t HOOK_PROLOGUE[] = { 0x55, 0x89, 0xE5, 0x8D, 0x47, 0x07, 0x5D, 0xC3 };
+
+static const HookCase HOOK_CASES[] = {
+    { "prólogo push/mov ebp",   { 0x55, 0x89, 0xE5, 0x8D, 0x47, 0x07, 0x5D, 0xC3 }, 8, HookStatus::OK, -1, 0 },
+    // test edi,edi; jz rel8 (vira 0F 84 rel32); lea eax,[rdi+1]; ret; mov eax,42; ret
+    { "jcc rel8",               { 0x85, 0xFF, 0x74, 0x04, 0x8D, 0x47, 0x01, 0xC3, 0xB8, 0x2A, 0x00, 0x00, 0x00, 0xC3 }, 14,
+      HookStatus::OK, -1, 0 },
+    // test edi,edi; jnz rel32 -> +16; xor eax,eax; ret; ...; lea eax,[rdi-1]; ret
+    { "jcc rel32",              { 0x85, 0xFF, 0x0F, 0x85, 0x08, 0x00, 0x00, 0x00, 0x31, 0xC0, 0xC3, 0xCC, 0xCC, 0xCC, 0xCC,
+                                  0xCC, 0x8D, 0x47, 0xFF, 0xC3 }, 20, HookStatus::OK, -1, 0 },
+    // lea eax,[rdi+3]; jmp rel8 (vira E9 rel32) por cima de um int3; ret
+    { "jmp rel8 no fim",        { 0x8D, 0x47, 0x03, 0xEB, 0x01, 0xCC, 0xC3 }, 7, HookStatus::OK, -1, 0 },
+    // call rel32 (helper no slot + 32: lea eax,[rdi+rdi*2]; ret); add eax,1; ret
+    { "call rel32",             { 0xE8, 0x00, 0x00, 0x00, 0x00, 0x83, 0xC0, 0x01, 0xC3 }, 9, HookStatus::OK, 1, 32 },
+    { "função curta",           { 0x31, 0xC0, 0xC3 }, 3, HookStatus::FUNCTION_TOO_SHORT, -1, 0 },
+    { "jmp rel8 antes de 5",    { 0xEB, 0x03, 0xCC, 0xCC, 0xCC, 0x8D, 0x47, 0x02, 0xC3 }, 9, HookStatus::FUNCTION_TOO_SHORT, -1, 0 },
+    // jz para o nop dentro dos 5 bytes roubados
+    { "salto interno",          { 0x85, 0xFF, 0x74, 0x00, 0x90, 0x8D, 0x47, 0x05, 0xC3 }, 9, HookStatus::INTERNAL_JUMP, -1, 0 },
+    { "jecxz",                  { 0xE3, 0x03, 0x8D, 0x47, 0x01, 0xC3 }, 6, HookStatus::UNSUPPORTED_INSTRUCTION, -1, 0 },
+    { "jcc com prefixo 3E",     { 0x3E, 0x74, 0x04, 0x8D, 0x47, 0x01, 0xC3 }, 7, HookStatus::UNSUPPORTED_INSTRUCTION, -1, 0 },
+    { "call far (9A)",          { 0x9A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC3 }, 8, HookStatus::UNSUPPORTED_INSTRUCTION, -1, 0 },
+};
+constexpr uint32_t HOOK_CASE_COUNT = sizeof(HOOK_CASES) / sizeof(HOOK_CASES[0]);
+
+static HookedFn s_HookOriginal[HOOK_CASE_COUNT];
+
+// Detour que passa pelo trampolim: prova que a original ainda funciona
+template<uint32_t N>
+static int HookChain(int x) { return s_HookOriginal[N](x) * 10; }
+
+static int HookNegate(int x) { return -x; }
+
+static const HookedFn HOOK_CHAIN[] = { HookChain<0>, HookChain<1>, HookChain<2>, HookChain<3>, HookChain<4> };
+
+static const char* HookStatusName(HookStatus status) {
+    static const char* const NAMES[] = { "OK", "BAD_ARGUMENT", "UNSUPPORTED_INSTRUCTION", "FUNCTION_TOO_SHORT",
+                                         "INTERNAL_JUMP", "OUT_OF_RANGE", "POOL_FULL", "TOO_MANY_HOOKS",
+                                         "PROTECT_FAILED" };
+    return (uint32_t)status < sizeof(NAMES) / sizeof(NAMES[0]) ? NAMES[(uint32_t)status] : "?";
+}
+
+static bool HookPageProtect(const void* at, DWORD expected) {
+    MEMORY_BASIC_INFORMATION mbi;
+    return VirtualQuery(at, &mbi, sizeof(mbi)) && mbi.Protect == expected;
+}
+
+int RunHookBench() {
+    // Perto do binário: os detours em C++ precisam caber em rel32
+    void* hint = (void*)((((uintptr_t)&RunHookBench) + (256u << 20)) & ~(uintptr_t)0xFFFF);
+    uint8_t* code = (uint8_t*)mmap(hint, HARNESS_HOOK_CODE_SIZE, PROT_READ | PROT_WRITE,
+                                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code == MAP_FAILED || !HookRel32Reachable(code, (void*)&HookNegate)) {
+        printf("[HARNESS] Buffer de código fora do alcance dos detours\n");
+        return 1;
+    }
+    memset(code, 0xCC, HARNESS_HOOK_CODE_SIZE);
+
+    // Casos na primeira página, cópias do prólogo a partir da segunda
+    const uint32_t extras = HOOK_MAX_HOOKS - (uint32_t)std::count_if(HOOK_CASES, HOOK_CASES + HOOK_CASE_COUNT,
+                                                                     [](const HookCase& c) { return c.expected == HookStatus::OK; });
+    uint8_t* extraBase = code + 4096;
+    for (uint32_t i = 0; i < HOOK_CASE_COUNT; i++) {
+        const HookCase& c = HOOK_CASES[i];
+        uint8_t* at = code + i * HARNESS_HOOK_SLOT;
+        memcpy(at, c.code, c.length);
+        if (c.relAt >= 0) {
+            int32_t rel = (int32_t)c.relTarget - (c.relAt + 4);
+            memcpy(at + c.relAt, &rel, 4);
+            static const uint8_t helper[] = { 0x8D, 0x04, 0x7F, 0xC3 };
+            memcpy(at + c.relTarget, helper, sizeof(helper));
+        }
+    }
+    for (uint32_t i = 0; i < extras; i++) memcpy(extraBase + i * HARNESS_HOOK_SPREAD, HOOK_PROLOGUE, sizeof(HOOK_PROLOGUE));
+    uint32_t pages = 1 + (extras * HARNESS_HOOK_SPREAD + 4095) / 4096;
+
+    // Só leitura + execução, como o .text do jogo
+    mprotect(code, HARNESS_HOOK_CODE_SIZE, PROT_READ | PROT_EXEC);
+    std::vector<uint8_t> pristine(code, code + HARNESS_HOOK_CODE_SIZE);
+
+    const int inputs[] = { 0, 5, -3, 1000 };
+    int expected[HOOK_CASE_COUNT][4];
+    for (uint32_t i = 0; i < HOOK_CASE_COUNT; i++) {
+        for (uint32_t k = 0; k < 4 && HOOK_CASES[i].expected == HookStatus::OK; k++) {
+            expected[i][k] = ((HookedFn)(code + i * HARNESS_HOOK_SLOT))(inputs[k]);
+        }
+    }
+
+    printf("[HOOKS] Funções em buffer só leitura+execução, trampolins no pool\n");
+    HookEngine& hooks = HookEngine::Instance();
+    uint32_t failures = 0;
+    auto expect = [&](const char* name, HookStatus status, HookStatus wanted) {
+        bool ok = status == wanted;
+        printf("  %-24s %s%s\n", name, HookStatusName(status), ok ? "" : "  ERRADO");
+        if (!ok) failures++;
+    };
+
+    for (uint32_t i = 0; i < HOOK_CASE_COUNT; i++) {
+        const HookCase& c = HOOK_CASES[i];
+        uint8_t* target = code + i * HARNESS_HOOK_SLOT;
+        void* detour = c.expected == HookStatus::OK ? (void*)HOOK_CHAIN[i] : (void*)HookNegate;
+        expect(c.name, hooks.Create(target, detour, (void**)&s_HookOriginal[i]), c.expected);
+    }
+    expect("alvo nulo", hooks.Create(nullptr, (void*)HookNegate, nullptr), HookStatus::BAD_ARGUMENT);
+    expect("detour a 4 GB", hooks.Create(code, (void*)((uintptr_t)code + 0x100000000ull), nullptr),
+           HookStatus::OUT_OF_RANGE);
+
+    std::vector<HookedFn> extraOriginal(extras);
+    uint32_t created = 0;
+    for (uint32_t i = 0; i < extras; i++) {
+        created += hooks.Create(extraBase + i * HARNESS_HOOK_SPREAD, (void*)HookNegate, (void**)&extraOriginal[i]) ==
+                   HookStatus::OK;
+    }
+    if (created != extras || hooks.HookCount() != HOOK_MAX_HOOKS) {
+        printf("  Cópias do prólogo: %u de %u criadas\n", created, extras);
+        failures++;
+    }
+    expect("hook 65", hooks.Create(code, (void*)HookNegate, nullptr), HookStatus::TOO_MANY_HOOKS);
+
+    // Create não toca no alvo; só o Apply escreve
+    if (memcmp(code, pristine.data(), HARNESS_HOOK_CODE_SIZE)) {
+        printf("  Create escreveu no alvo antes do Apply\n");
+        failures++;
+    }
+
+    auto check = [&](bool hooked) {
+        uint32_t wrong = 0;
+        for (uint32_t i = 0; i < HOOK_CASE_COUNT; i++) {
+            if (HOOK_CASES[i].expected != HookStatus::OK) continue;
+            HookedFn target = (HookedFn)(code + i * HARNESS_HOOK_SLOT);
+            for (uint32_t k = 0; k < 4; k++) {
+                int want = hooked ? expected[i][k] * 10 : expected[i][k];
+                if (target(inputs[k]) != want || s_HookOriginal[i](inputs[k]) != expected[i][k]) wrong++;
+            }
+        }
+        for (uint32_t i = 0; i < extras; i++) {
+            HookedFn target = (HookedFn)(extraBase + i * HARNESS_HOOK_SPREAD);
+            if (target(9) != (hooked ? -9 : 16) || extraOriginal[i](9) != 16) wrong++;
+        }
+        if (!HookPageProtect(code, PAGE_EXECUTE_READ) || !HookPageProtect(extraBase, PAGE_EXECUTE_READ)) wrong++;
+        return wrong;
+    };
+
+    hooks.SetAllEnabled(true);
+    uint64_t t0 = HarnessNanos();
+    HookStatus applied = hooks.Apply();
+    double enableMicros = (double)(HarnessNanos() - t0) / 1e3;
+    uint32_t wrongOn = applied == HookStatus::OK ? check(true) : 1;
+
+    hooks.SetAllEnabled(false);
+    t0 = HarnessNanos();
+    applied = hooks.Apply();
+    double disableMicros = (double)(HarnessNanos() - t0) / 1e3;
+    uint32_t wrongOff = applied == HookStatus::OK ? check(false) : 1;
+    if (memcmp(code, pristine.data(), HARNESS_HOOK_CODE_SIZE)) wrongOff++;
+
+    printf("\n  Ligados: %s (detours, trampolins e proteção das páginas)\n", wrongOn ? "ERRADO" : "ok");
+    printf("  Desligados: %s (bytes originais de volta)\n", wrongOff ? "ERRADO" : "ok");
+    failures += wrongOn + wrongOff;
+
+    // Apply em lote contra uma troca de proteção por hook (o que cada
+    // InjectHook fazia). No Linux o VirtualProtect do compat lê
+    // /proc/self/maps, então o custo absoluto é maior que no Windows.
+    double batched = 1e30, perHook = 1e30;
+    for (uint32_t trial = 0; trial < 5; trial++) {
+        hooks.SetAllEnabled(trial % 2 == 0);
+        t0 = HarnessNanos();
+        hooks.Apply();
+        batched = std::min(batched, (double)(HarnessNanos() - t0) / 1e3);
+
+        t0 = HarnessNanos();
+        for (uint32_t i = 0; i < HOOK_MAX_HOOKS; i++) {
+            uint8_t* target = i < HOOK_CASE_COUNT ? code + i * HARNESS_HOOK_SLOT
+                                                  : extraBase + (i - HOOK_CASE_COUNT) % extras * HARNESS_HOOK_SPREAD;
+            DWORD old;
+            VirtualProtect(target, HOOK_JMP_SIZE, PAGE_EXECUTE_READWRITE, &old);
+            memmove(target, target, HOOK_JMP_SIZE);
+            VirtualProtect(target, HOOK_JMP_SIZE, old, &old);
+            FlushInstructionCache(GetCurrentProcess(), target, HOOK_JMP_SIZE);
+        }
+        perHook = std::min(perHook, (double)(HarnessNanos() - t0) / 1e3);
+    }
+    hooks.SetAllEnabled(false);
+    hooks.Apply();
+
+    printf("\n  Apply de %u hooks em %u páginas: ligar %.0f us, desligar %.0f us, melhor de 5 %.0f us\n",
+           hooks.HookCount(), pages, enableMicros, disableMicros, batched);
+    printf("  Uma troca de proteção por hook: %.0f us (%.1fx)\n", perHook, perHook / batched);
+
+    munmap(code, HARNESS_HOOK_CODE_SIZE);
+    printf("\n  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,99 @@
+/**
+ * RE4 CO-OP MOD - Harness: Input em Tempo Real (--input S)
+ *
+ * Roda S segundos em tempo real com a thread de poll lendo um controle
+ * sintético (toques de poucos ms) e compara com ler uma vez por frame:
+ * toques vistos e latência mudança -> ApplyInputToAshley.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// INPUT EM TEMPO REAL
+//=============================================================================
+
+constexpr uint64_t HARNESS_TAP_PERIOD = 263000;         // Um toque de A a cada 263 ms
+constexpr uint64_t HARNESS_TAP_MICROS = 3000;           // ...que dura 3 ms
+constexpr uint64_t HARNESS_SHOT_PERIOD = 409000;        // Gatilho direito a cada 409 ms
+constexpr uint64_t HARNESS_SHOT_MICROS = 5000;
+
+static uint64_t s_InputStart = 0;
+
+// Controle 2 conectado: analógico girando, toques curtos de A e RT (períodos
+// fora de fase com o frame, senão a leitura por frame cai sempre no mesmo ponto)
+static bool SyntheticPad(uint32_t pad, PadState& out, void*) {
+    if (pad != P2_INPUT_PAD) return false;
+
+    uint64_t t = CoopNowMicros() - s_InputStart;
+    float angle = (float)t * 1e-6f;
+    out.thumbLX = (int16_t)(cosf(angle) * 32767.0f);
+    out.thumbLY = (int16_t)(sinf(angle) * 32767.0f);
+    out.buttons = t % HARNESS_TAP_PERIOD < HARNESS_TAP_MICROS ? PAD_BUTTON_A : 0;
+    out.rightTrigger = t % HARNESS_SHOT_PERIOD < HARNESS_SHOT_MICROS ? 255 : 0;
+    return true;
+}
+
+int RunInputBench(uint32_t seconds, uint32_t enemies) {
+    MockGame game;
+    if (!game.Create(enemies) || !CoopMod::Initialize()) {
+        printf("[INPUT] Falha ao montar o jogo falso\n");
+        return 1;
+    }
+    g_CoopConfig.enabled = true;
+
+    s_InputStart = CoopNowMicros();
+    InputPoller& poller = InputPoller::Instance();
+    poller.Start(SyntheticPad, nullptr);
+
+    uint64_t frames = (uint64_t)seconds * 60;
+    uint32_t tapsPoller = 0, tapsFrame = 0, shotsPoller = 0, shotsFrame = 0;
+    bool lastAction = false, lastShoot = false, lastFrameA = false, lastFrameRT = false;
+
+    using namespace std::chrono;
+    steady_clock::time_point next = steady_clock::now();
+    uint64_t last = CoopNowMicros();
+    for (uint64_t frame = 0; frame < frames; frame++) {
+        next += microseconds(HARNESS_FRAME_MICROS);
+        std::this_thread::sleep_until(next);
+
+        uint64_t now = CoopNowMicros();
+        game.Step(frame, 0);
+        CoopMod::Advance(now - last);
+        last = now;
+
+        // Thread de poll: toques juntados no frame
+        if (g_P2_Input.action && !lastAction) tapsPoller++;
+        if (g_P2_Input.shoot && !lastShoot) shotsPoller++;
+        lastAction = g_P2_Input.action;
+        lastShoot = g_P2_Input.shoot;
+
+        // Como era: uma leitura no começo do frame
+        PadState sample = {};
+        SyntheticPad(P2_INPUT_PAD, sample, nullptr);
+        bool a = (sample.buttons & PAD_BUTTON_A) != 0, rt = sample.rightTrigger > 127;
+        if (a && !lastFrameA) tapsFrame++;
+        if (rt && !lastFrameRT) shotsFrame++;
+        lastFrameA = a;
+        lastFrameRT = rt;
+    }
+    double elapsed = (double)(CoopNowMicros() - s_InputStart) / 1e6;
+    poller.Stop();
+
+    uint64_t taps = (uint64_t)(elapsed * 1e6) / HARNESS_TAP_PERIOD;
+    uint64_t shots = (uint64_t)(elapsed * 1e6) / HARNESS_SHOT_PERIOD;
+    const TelemetryHistogram& latency = poller.Latency();
+    printf("[INPUT] %.1f s a 60 FPS, poll a %u Hz: %llu leituras, %llu eventos, %u descartados\n",
+           elapsed, INPUT_POLL_HZ, (unsigned long long)poller.Polls(),
+           (unsigned long long)poller.Events(), poller.Dropped());
+    printf("  Toques de A (%llu ms):      thread de poll %u, uma leitura por frame %u (de ~%llu)\n",
+           (unsigned long long)(HARNESS_TAP_MICROS / 1000), tapsPoller, tapsFrame, (unsigned long long)taps);
+    printf("  Tiros no RT (%llu ms):      thread de poll %u, uma leitura por frame %u (de ~%llu)\n",
+           (unsigned long long)(HARNESS_SHOT_MICROS / 1000), shotsPoller, shotsFrame, (unsigned long long)shots);
+    printf("  Mudança -> ApplyInputToAshley (us): média %u  p50 %u  p90 %u  p99 %u  máx %u  (n=%llu)\n",
+           latency.Mean(), latency.Percentile(0.50), latency.Percentile(0.90),
+           latency.Percentile(0.99), latency.max, (unsigned long long)latency.count);
+
+    CoopMod::Shutdown();
+    game.Destroy();
+    return tapsPoller + 1 >= taps ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+/**
+ * RE4 CO-OP MOD - Harness: Log (--log)
+ *
+ * Confere a formatação adiada do Logger contra o snprintf, mede o custo
+ * de CoopLog para quem loga (contra fprintf + fflush síncrono) e põe 4
+ * threads logando sem parar e 4 num ritmo de jogo: quanto é descartado e
+ * se toda linha aceita chega no arquivo; depois 64 threads curtas em
+ * levas, conferindo que os anéis voltam.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// LOG
+//=============================================================================
+
+constexpr uint32_t HARNESS_LOG_BURST = LOG_RING_ENTRIES / 2;   // Cabe no anel entre dois drenos
+constexpr uint32_t HARNESS_LOG_BURSTS = 40;
+constexpr uint32_t HARNESS_LOG_THREADS = 4;
+constexpr uint32_t HARNESS_LOG_FLOOD_MS = 1000;
+constexpr uint32_t HARNESS_LOG_PACED_PER_SECOND = 2000;        // Por thread (bem acima do mod real)
+constexpr uint32_t HARNESS_LOG_CHURN_THREADS = LOG_MAX_THREADS * 4;
+constexpr const char* HARNESS_LOG_FILE = "re4coop_log_bench.log";
+constexpr const char* HARNESS_LOG_SYNC_FILE = "re4coop_log_sync.log";
+
+// Formatação adiada contra o snprintf com os mesmos argumentos
+template<typename... Args>
+static bool CheckLogFormat(const char* format, const Args&... args) {
+    LogEntry entry;
+    char deferred[256];
+    char direct[256];
+    LogCapture(entry, format, args...);
+    LogFormat(entry, deferred, sizeof(deferred));
+    snprintf(direct, sizeof(direct), format, args...);
+    if (!strcmp(deferred, direct)) return true;
+    printf("  -> \"%s\": adiado \"%s\", snprintf \"%s\"\n", format, deferred, direct);
+    return false;
+}
+
+static uint32_t CountLogLines(const char* path, const char* marker) {
+    FILE* file = fopen(path, "r");
+    if (!file) return 0;
+    char line[LOG_LINE_BYTES];
+    uint32_t count = 0;
+    while (fgets(line, sizeof(line), file)) {
+        if (strstr(line, marker)) count++;
+    }
+    fclose(file);
+    return count;
+}
+
+struct LogLoad {
+    const char* marker;         // Literal que vai no formato (para contar no arquivo)
+    uint32_t produced;          // Chamadas de CoopLog
+    uint32_t dropped;
+    uint32_t lines;             // Linhas com o marcador no arquivo
+};
+
+// Threads logando por HARNESS_LOG_FLOOD_MS: sem pausa (perSecond = 0) ou
+// no ritmo pedido
+static void RunLogLoad(LogLoad& load, uint32_t perSecond) {
+    remove(HARNESS_LOG_FILE);
+    Logger& logger = Logger::Instance();
+    uint32_t droppedBefore = logger.Dropped();
+    logger.Start(HARNESS_LOG_FILE, false);
+
+    std::atomic<uint32_t> produced{0};
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < HARNESS_LOG_THREADS; t++) {
+        threads.emplace_back([&, t]() {
+            using namespace std::chrono;
+            steady_clock::time_point start = steady_clock::now();
+            steady_clock::time_point end = start + milliseconds(HARNESS_LOG_FLOOD_MS);
+            uint32_t count = 0;
+            while (steady_clock::now() < end) {
+                if (perSecond) {
+                    std::this_thread::sleep_until(start + microseconds((uint64_t)count * 1000000 / perSecond));
+                }
+                CoopLog("%s thread %u mensagem %u posição %.2f %s", load.marker, t, count, count * 0.5f, "ok");
+                count++;
+            }
+            produced.fetch_add(count);
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    logger.Stop();
+    load.produced = produced.load();
+    load.dropped = logger.Dropped() - droppedBefore;
+    load.lines = CountLogLines(HARNESS_LOG_FILE, load.marker);
+}
+
+int RunLogBench() {
+    uint32_t failures = 0;
+
+    printf("[LOG] Formatação adiada contra o snprintf\n");
+    int value = -42;
+    uint64_t big = 0xFEDCBA9876543210ull;
+    char buffer[16] = "buffer local";
+    bool ok = CheckLogFormat("sem argumentos 100%%") &
+              CheckLogFormat("%d %i %u %x %X %o", value, value, 7u, 0xBEEFu, 0xBEEFu, 8) &
+              CheckLogFormat("[%5d] [%-5d] [%05d] [%+d]", 42, 42, 42, 42) &
+              CheckLogFormat("%lld %llu %016llX", (long long)-5, (unsigned long long)big, (unsigned long long)big) &
+              CheckLogFormat("%f %.3f %10.2f %e %g", 1.5f, 3.14159, -2.5, 12345.678, 0.0001) &
+              CheckLogFormat("%s/%s %10s|%-6s|", "host", buffer, "dir", "esq") &
+              CheckLogFormat("%c%c %p", 'o', 'k', (void*)&value) &
+              CheckLogFormat("%u hooks, %s, %.1f%%", 3u, "sim", 99.5);
+    if (!ok) failures++;
+
+    // %s além de LOG_TEXT_BYTES é cortado, sem passar do registro
+    LogEntry entry;
+    char line[256];
+    LogCapture(entry, "%s|%s|%s", "0123456789012345678901234567890123456789", "b", "c");
+    LogFormat(entry, line, sizeof(line));
+    printf("  Strings além de %u bytes: \"%s\"\n", LOG_TEXT_BYTES, line);
+    if (strlen(line) != LOG_TEXT_BYTES - 1 + 2) failures++;
+    printf("  Formatos conferidos: %s\n", ok ? "ok" : "ERRADO");
+
+    // Custo para quem loga, em rajadas que cabem no anel (o dreno esvazia
+    // entre elas), contra o fprintf + fflush síncrono do Log antigo
+    remove(HARNESS_LOG_FILE);
+    remove(HARNESS_LOG_SYNC_FILE);
+    Logger& logger = Logger::Instance();
+    logger.Start(HARNESS_LOG_FILE, false);
+    FILE* sync = fopen(HARNESS_LOG_SYNC_FILE, "w");
+
+    LatencyStats empty("CoopLog sem args");
+    LatencyStats three("CoopLog 3 args");
+    LatencyStats eight("CoopLog 8 args + %s");
+    LatencyStats direct("fprintf + fflush");
+    uint32_t droppedBefore = logger.Dropped();
+    for (uint32_t burst = 0; burst < HARNESS_LOG_BURSTS; burst++) {
+        for (uint32_t i = 0; i < HARNESS_LOG_BURST / 4; i++) {
+            uint64_t t0 = HarnessNanos();
+            CoopLog("[BENCH] sem argumentos");
+            uint64_t t1 = HarnessNanos();
+            CoopLog("[BENCH] %u hooks %d %p", i, -(int)i, (void*)&i);
+            uint64_t t2 = HarnessNanos();
+            CoopLog("[BENCH] %s %u %u %u %.2f %.2f %08X %s", "DESYNC", burst, i, i * 3, i * 0.5f, i * 0.25, i, "host");
+            uint64_t t3 = HarnessNanos();
+            fprintf(sync, "[BENCH] %u hooks %d %p\n", i, -(int)i, (void*)&i);
+            fflush(sync);
+            uint64_t t4 = HarnessNanos();
+            empty.Record(t1 - t0);
+            three.Record(t2 - t1);
+            eight.Record(t3 - t2);
+            direct.Record(t4 - t3);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(LOG_DRAIN_MS * 2));
+    }
+    logger.Stop();
+    fclose(sync);
+    uint32_t burstDropped = logger.Dropped() - droppedBefore;
+
+    printf("\n[LOG] Custo para quem loga (%u rajadas de %u chamadas, anel de %u por thread)\n\n",
+           HARNESS_LOG_BURSTS, HARNESS_LOG_BURST, LOG_RING_ENTRIES);
+    printf("  %-22s %10s  %8s %8s %8s %8s %8s %10s\n", "ns por chamada", "amostras",
+           "média", "p50", "p90", "p99", "p99.9", "máx");
+    empty.Print();
+    three.Print();
+    eight.Print();
+    direct.Print();
+    uint32_t expected = HARNESS_LOG_BURSTS * (HARNESS_LOG_BURST / 4) * 3;
+    uint32_t lines = CountLogLines(HARNESS_LOG_FILE, "[BENCH]");
+    printf("  %u linhas no arquivo de %u, %u descartadas\n", lines, expected, burstDropped);
+    if (lines + burstDropped != expected) failures++;
+
+    // Sobrecarga: o anel enche, quem loga descarta e segue
+    printf("\n[LOG] %u threads por %u ms\n", HARNESS_LOG_THREADS, HARNESS_LOG_FLOOD_MS);
+    printf("  %-26s %11s %11s %9s %11s %8s\n", "carga", "chamadas", "descartes", "%", "no arquivo", "conta");
+    LogLoad loads[2] = { { "[FLOOD]", 0, 0, 0 }, { "[PACED]", 0, 0, 0 } };
+    RunLogLoad(loads[0], 0);
+    RunLogLoad(loads[1], HARNESS_LOG_PACED_PER_SECOND);
+    static const char* LOAD_NAMES[] = { "sem pausa", "2000/s por thread" };
+    for (uint32_t i = 0; i < 2; i++) {
+        const LogLoad& load = loads[i];
+        bool balanced = load.lines + load.dropped == load.produced;
+        if (!balanced) failures++;
+        printf("  %-26s %11u %11u %8.2f%% %11u %8s\n", LOAD_NAMES[i], load.produced, load.dropped,
+               load.produced ? 100.0 * load.dropped / load.produced : 0.0, load.lines, balanced ? "ok" : "ERRADO");
+    }
+
+    // Threads curtas, em levas de HARNESS_LOG_THREADS, cada uma com três
+    // listas de argumentos: o anel é por thread e volta quando ela termina
+    remove(HARNESS_LOG_FILE);
+    droppedBefore = logger.Dropped();
+    logger.Start(HARNESS_LOG_FILE, false);
+    for (uint32_t wave = 0; wave < HARNESS_LOG_CHURN_THREADS / HARNESS_LOG_THREADS; wave++) {
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < HARNESS_LOG_THREADS; t++) {
+            uint32_t id = wave * HARNESS_LOG_THREADS + t;
+            threads.emplace_back([id]() {
+                CoopLog("[CHURN] thread %u", id);
+                CoopLog("[CHURN] thread %u %s", id, "saindo");
+                CoopLog("[CHURN] thread %u %.1f", id, id * 0.5);
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+        std::this_thread::sleep_for(std::chrono::milliseconds(LOG_DRAIN_MS * 2));
+    }
+    logger.Stop();
+    uint32_t churnDropped = logger.Dropped() - droppedBefore;
+    uint32_t churnLines = CountLogLines(HARNESS_LOG_FILE, "[CHURN]");
+    bool churnOk = churnLines == HARNESS_LOG_CHURN_THREADS * 3 && !churnDropped;
+    if (!churnOk) failures++;
+    printf("\n[LOG] %u threads que terminam: %u linhas de %u, %u descartadas, %u anéis de %u criados -> %s\n",
+           HARNESS_LOG_CHURN_THREADS, churnLines, HARNESS_LOG_CHURN_THREADS * 3, churnDropped,
+           logger.RingCount(), LOG_MAX_THREADS, churnOk ? "ok" : "ERRADO");
+
+    printf("\n  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
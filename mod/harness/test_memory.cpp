@@ -0,0 +1,267 @@
+/**
+ * RE4 CO-OP MOD - Harness: Memória do Jogo (--memory)
+ *
+ * Confere EmView/PlayerView/GlobalsView/EmListView e o GatherEntities
+ * contra uma imagem falsa escrita com os offsets do SDK (literais), e
+ * mede pose + vida de 64 a 16384 entidades pelas views contra as macros
+ * GET_* de antes.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// MEMÓRIA DO JOGO
+//=============================================================================
+
+// Macros de antes das views (offsets da v1.1.0 escritos à mão)
+#define LEGACY_GET_HP(entity) (*(int16_t*)((uint8_t*)(entity) + 0x324))
+#define LEGACY_GET_HP_MAX(entity) (*(int16_t*)((uint8_t*)(entity) + 0x326))
+#define LEGACY_GET_POS(entity) (*(Vec*)((uint8_t*)(entity) + 0x94))
+#define LEGACY_GET_FLAGS(entity) (*(uint32_t*)((uint8_t*)(entity) + 0x3E8))
+
+// Imagem falsa escrita só com os offsets do SDK do re4_tweaks (literais,
+// sem passar pela OffsetTable): confere a tabela contra a documentação
+struct MemoryImage {
+    uint8_t* arena = nullptr;
+    size_t size = 0;
+    uint8_t* player = nullptr;
+    uint8_t* globals = nullptr;
+    uint8_t* manager = nullptr;
+    uint8_t* slots = nullptr;
+
+    template<typename T>
+    static void Poke(uint8_t* base, uint32_t offset, T value) { memcpy(base + offset, &value, sizeof(T)); }
+
+    template<typename T>
+    static T Peek(const uint8_t* base, uint32_t offset) {
+        T value;
+        memcpy(&value, base + offset, sizeof(T));
+        return value;
+    }
+
+    bool Create(uint32_t slotCount, uint32_t stride) {
+        size = 0x1000 + 0x8000 + 0x1000 + (size_t)slotCount * stride;
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+        if (memory == MAP_FAILED) return false;
+        arena = (uint8_t*)memory;
+        player = arena;
+        globals = arena + 0x1000;
+        manager = globals + 0x8000;
+        slots = manager + 0x1000;
+
+        Poke<Vec>(player, 0x94, { 10.5f, -2.0f, 300.25f });
+        Poke<Vec>(player, 0x110, { 10.0f, -2.0f, 300.0f });
+        Poke<int16_t>(player, 0x324, 850);
+        Poke<int16_t>(player, 0x326, 1200);
+        Poke<uint32_t>(player, 0x3E8, 0xA5A50F0Fu);
+        Poke<uint16_t>(player, 0x2B4 + 0x1A, 0xFF00 | SAT_SCA_ENABLE | SAT_OBA_ENABLE);
+        Poke<uint32_t>(player, 0x464, 0x00400000u);
+        Poke<uint32_t>(player, 0x468, 7);
+        Poke<uint32_t>(player, 0x7D8, (uint32_t)(uintptr_t)(globals + 0x100));
+        Poke<uint32_t>(player, 0x804, 2);
+
+        Poke<uint16_t>(globals, 0x4FAC, 0x10D);
+        Poke<uint8_t>(globals, 0x4FC8, (uint8_t)PlayerCharacter::Ashley);
+        Poke<uint8_t>(globals, 0x4FC9, 3);
+        Poke<uint8_t>(globals, 0x4FCB, (uint8_t)AshleyCostume::Armor);
+
+        // EmMgr: slot i vivo se i % 3 != 2
+        Poke<uint32_t>(manager, 0x4, (uint32_t)(uintptr_t)slots);
+        Poke<uint32_t>(manager, 0x8, slotCount);
+        Poke<uint32_t>(manager, 0xC, stride);
+        for (uint32_t i = 0; i < slotCount; i++) {
+            uint8_t* em = slots + (size_t)i * stride;
+            Poke<uint32_t>(em, 0x4, i % 3 != 2 ? 0x1u : 0x0u);
+            Poke<Vec>(em, 0x94, { (float)i, 1.0f, -(float)i });
+            Poke<int16_t>(em, 0x324, (int16_t)(100 + i));
+            Poke<int16_t>(em, 0x326, 200);
+            Poke<uint32_t>(em, 0x3E8, i);
+        }
+        return true;
+    }
+
+    void Destroy() {
+        if (arena) munmap(arena, size);
+        arena = nullptr;
+    }
+};
+
+static uint32_t CheckMemoryViews() {
+    uint32_t failures = 0;
+    auto check = [&](bool ok, const char* what) {
+        if (!ok) {
+            printf("  ERRADO: %s\n", what);
+            failures++;
+        }
+    };
+
+    const uint32_t SLOTS = 12, STRIDE = 0x7F0;
+    MemoryImage image;
+    if (!image.Create(SLOTS, STRIDE)) {
+        printf("  mmap falhou\n");
+        return 1;
+    }
+
+    // Versão desconhecida: WithGameVersion não chama o lambda
+    bool called = false;
+    check(!SelectGameVersion(GameVersion::UNKNOWN), "SelectGameVersion(UNKNOWN) aceita");
+    check(!WithGameVersion([&](auto) { called = true; }) && !called, "WithGameVersion roda sem versão");
+    check(SelectGameVersion(GameVersion::V1_1_0), "SelectGameVersion(V1_1_0) recusada");
+
+    WithGameVersion([&](auto table) {
+        cPlayer* player = (cPlayer*)image.player;
+        PlayerView view(table, player);
+        Vec pos = view.Pos();
+        check(pos.x == 10.5f && pos.y == -2.0f && pos.z == 300.25f, "Pos");
+        check(view.PosOld().z == 300.0f, "PosOld");
+        check(view.HP() == 850 && view.HPMax() == 1200, "HP/HPMax");
+        check(view.Flags() == 0xA5A50F0Fu, "Flags");
+        check(view.PlayerFlag() == 0x00400000u && view.PlayerState() == 7, "PlayerFlag/PlayerState");
+        check(view.Weapon() == (cPlWep*)(image.globals + 0x100), "Weapon (ponteiro de 32 bits)");
+        check(view.LaserType() == 2, "LaserType");
+
+        // Escritas caem nos offsets documentados e em nenhum outro lugar
+        std::vector<uint8_t> before(image.player, image.player + 0x1000);
+        view.SetHP(-5);
+        view.SetPos({ 1.0f, 2.0f, 3.0f });
+        view.SetPlayerFlag(0x80000001u);
+        check(MemoryImage::Peek<int16_t>(image.player, 0x324) == -5, "SetHP");
+        check(MemoryImage::Peek<Vec>(image.player, 0x94).y == 2.0f, "SetPos");
+        check(MemoryImage::Peek<uint32_t>(image.player, 0x464) == 0x80000001u, "SetPlayerFlag");
+        uint32_t touched = 0;
+        for (uint32_t i = 0; i < 0x1000; i++) touched += before[i] != image.player[i];
+        check(touched <= sizeof(int16_t) + sizeof(Vec) + sizeof(uint32_t), "escrita fora do campo");
+
+        CoopMod::DisableCollision(player);
+        check(MemoryImage::Peek<uint16_t>(image.player, 0x2B4 + 0x1A) == 0xFF00, "DisableCollision");
+        CoopMod::EnableCollision(player);
+        check(MemoryImage::Peek<uint16_t>(image.player, 0x2B4 + 0x1A) == (0xFF00 | SAT_SCA_ENABLE | SAT_OBA_ENABLE),
+              "EnableCollision");
+
+        GlobalsView globals(table, image.globals);
+        check(globals.RoomId() == 0x10D, "RoomId");
+        check(globals.PlayerType() == (uint8_t)PlayerCharacter::Ashley, "PlayerType");
+        check(globals.PlayerCostume() == 3 && globals.SubCostume() == (uint8_t)AshleyCostume::Armor, "Costume");
+
+        // EmMgr: stride, contagem e vivos
+        EmListView list(table, (cEmMgr*)image.manager);
+        check(list.Count() == SLOTS && list.Stride() == STRIDE, "EmListView Count/Stride");
+        uint32_t alive = 0;
+        for (uint32_t i = 0; i < list.Count(); i++) {
+            if (!list.IsAlive(i)) continue;
+            alive++;
+            check(EmView(table, list.At(i)).HP() == (int16_t)(100 + i), "EmListView At");
+        }
+        check(alive == SLOTS - SLOTS / 3, "EmListView IsAlive");
+        check(EmListView(table, (cEmMgr*)nullptr).Count() == 0, "EmListView nulo");
+
+        // Gather em lote = leituras uma a uma, nulos pulados
+        cEm* entities[SLOTS + 2];
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < SLOTS; i++) {
+            entities[count++] = list.At(i);
+            if (i == 4 || i == 9) entities[count++] = nullptr;
+        }
+        EntityState states[SLOTS + 2];
+        uint32_t gathered = GatherEntities(table, entities, count, states);
+        check(gathered == SLOTS, "GatherEntities pula nulos");
+        bool same = true;
+        for (uint32_t i = 0; i < gathered; i++) {
+            cEm* em = list.At(i);
+            same = same && states[i].pos.x == LEGACY_GET_POS(em).x && states[i].hp == LEGACY_GET_HP(em) &&
+                   states[i].hpMax == LEGACY_GET_HP_MAX(em) && states[i].flags == LEGACY_GET_FLAGS(em);
+        }
+        check(same, "GatherEntities contra as macros");
+    });
+
+    image.Destroy();
+    return failures;
+}
+
+// Pose + vida de todos os slots vivos do EmMgr, por cada caminho
+struct MemoryBenchResult {
+    double macros;
+    double views;
+    double gather;
+    double perAccess;
+};
+
+static MemoryBenchResult RunMemoryPass(const MemoryImage& image, uint32_t slotCount, uint32_t rounds) {
+    std::vector<cEm*> entities(slotCount);
+    for (uint32_t i = 0; i < slotCount; i++) {
+        entities[i] = (cEm*)(image.slots + (size_t)i * MemoryImage::Peek<uint32_t>(image.manager, 0xC));
+    }
+    std::vector<EntityState> out(slotCount);
+    volatile float sink = 0;
+
+    auto time = [&](auto&& body) {
+        double best = 1e30;
+        for (uint32_t trial = 0; trial < 5; trial++) {
+            uint64_t start = HarnessNanos();
+            for (uint32_t round = 0; round < rounds; round++) body();
+            double ns = (double)(HarnessNanos() - start) / ((double)rounds * slotCount);
+            if (ns < best) best = ns;
+        }
+        return best;
+    };
+
+    MemoryBenchResult result;
+    result.macros = time([&] {
+        for (uint32_t i = 0; i < slotCount; i++) {
+            cEm* em = entities[i];
+            out[i].pos = LEGACY_GET_POS(em);
+            out[i].hp = LEGACY_GET_HP(em);
+            out[i].hpMax = LEGACY_GET_HP_MAX(em);
+            out[i].flags = LEGACY_GET_FLAGS(em);
+        }
+        sink = sink + out[slotCount - 1].pos.x;
+    });
+    result.views = time([&] {
+        WithGameVersion([&](auto table) {
+            for (uint32_t i = 0; i < slotCount; i++) out[i] = EmView(table, entities[i]).Gather();
+        });
+        sink = sink + out[slotCount - 1].pos.x;
+    });
+    result.gather = time([&] {
+        WithGameVersion([&](auto table) {
+            GatherEntities(table, entities.data(), slotCount, out.data());
+        });
+        sink = sink + out[slotCount - 1].pos.x;
+    });
+    // Uso errado: um WithGameVersion por leitura (o switch entra no laço)
+    result.perAccess = time([&] {
+        for (uint32_t i = 0; i < slotCount; i++) {
+            WithGameVersion([&](auto table) { out[i] = EmView(table, entities[i]).Gather(); });
+        }
+        sink = sink + out[slotCount - 1].pos.x;
+    });
+    return result;
+}
+
+int RunMemoryBench() {
+    printf("[MEMORY] Views contra uma imagem falsa escrita com os offsets do SDK\n");
+    uint32_t failures = CheckMemoryViews();
+    printf("  %s\n\n", failures ? "views ERRADAS" : "Views, EmListView, GatherEntities e helpers de colisão ok");
+
+    printf("  %-9s %-9s %10s %10s %10s %14s   (ns por entidade)\n", "entidades", "stride", "macros", "EmView",
+           "Gather", "switch/leitura");
+    struct Case {
+        uint32_t slots;
+        uint32_t stride;
+    };
+    const Case cases[] = { { 64, 0x7F0 }, { 1024, 0x7F0 }, { 16384, 0x7F0 } };
+    for (const Case& c : cases) {
+        MemoryImage image;
+        if (!image.Create(c.slots, c.stride)) {
+            failures++;
+            continue;
+        }
+        uint32_t rounds = (uint32_t)(2000000 / c.slots) + 1;
+        MemoryBenchResult r = RunMemoryPass(image, c.slots, rounds);
+        printf("  %-9u %#-9x %10.2f %10.2f %10.2f %14.2f\n", c.slots, c.stride, r.macros, r.views, r.gather, r.perAccess);
+        image.Destroy();
+    }
+
+    printf("\n  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,218 @@
+/**
+ * RE4 CO-OP MOD - Harness: Resync por Merkle (--merkle)
+ *
+ * Deriva o cliente de 0 a 100% das entidades de uma sala de 1000 e faz o
+ * resync por árvore de Merkle contra o host: bytes, pacotes, rodadas e
+ * tempo estimado contra mandar a sala inteira de novo, conferindo que a
+ * raiz do cliente termina igual à do host; cada deriva roda também sem a
+ * saída pela sala inteira, para mostrar onde a descida inteira passa da
+ * sala (cruzamento).
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// MERKLE
+//=============================================================================
+
+constexpr float HARNESS_MERKLE_RATES[] = { 0.0f, 0.001f, 0.01f, 0.05f, 0.2f, 0.5f, 0.6f, 0.7f, 0.8f, 1.0f };
+constexpr uint32_t HARNESS_MERKLE_ENTITIES = 1000;      // 2 players + 998 inimigos
+constexpr uint32_t HARNESS_MERKLE_RTT_MS = 60;
+constexpr uint32_t HARNESS_MERKLE_BUILD_REPS = 500;
+
+struct MerkleRun {
+    uint32_t diverged;          // Entidades diferentes entre host e cliente
+    uint32_t rounds;
+    uint32_t packets;           // Ida e volta
+    uint32_t bytes;             // Ida e volta, com o overhead do registro cifrado
+    uint32_t blocks;            // Folhas que o cliente aplicou
+    double millis;              // RTT por rodada + ritmo do orçamento de bulk
+    double cpuMicros;           // Árvores dos dois lados + todas as rodadas
+    bool converged;             // Raiz do cliente = raiz do host no fim
+    bool fullRoom;              // Parou na rodada das entidades e pediu a sala inteira
+};
+
+// Sala inteira pelo canal em massa: BULK_RECORDS_PER_CHUNK registros por chunk
+struct MerkleRoomCost {
+    uint32_t chunks;
+    uint32_t bytes;
+    double millis;
+};
+
+// Pacotes que o host solta por rodada saem no ritmo do estado da sala
+static double MerklePacingMillis(uint32_t packets) {
+    double tickMillis = 1000.0 * g_CoopConfig.netSendInterval / 60.0;
+    uint32_t ticks = (packets + g_CoopConfig.bulkChunksPerTick - 1) / g_CoopConfig.bulkChunksPerTick;
+    return ticks * tickMillis;
+}
+
+// Cliente com uma fração das entidades errada: posição (60%), vida e flags
+// (20%), inimigo que o cliente não tem (10%) e que o host não tem mais (10%)
+static uint32_t DivergeMerkleSnapshot(EntitySnapshot& host, EntitySnapshot& client, float rate, uint32_t& rng) {
+    static uint8_t chosen[SNAPSHOT_MAX_ENTITIES];
+    memset(chosen, 0, sizeof(chosen));
+
+    uint32_t wanted = (uint32_t)(rate * host.count + 0.5f);
+    uint32_t diverged = 0;
+    while (diverged < wanted) {
+        uint32_t i = (uint32_t)(HarnessRandom(rng) * host.count) % host.count;
+        if (chosen[i]) continue;
+        chosen[i] = 1 + (uint8_t)(diverged % 10);
+        diverged++;
+    }
+
+    // Campos primeiro (índices ainda iguais nos dois), depois as remoções
+    // de trás para frente
+    for (uint32_t i = 0; i < host.count; i++) {
+        if (!chosen[i]) continue;
+        if (chosen[i] <= 6) client.posX[i] += 1.0f + HarnessRandom(rng) * 50.0f;
+        else if (chosen[i] <= 8) {
+            client.hp[i] -= 25;
+            client.flags[i] ^= 0x40;
+        }
+    }
+    for (uint32_t i = host.count; i-- > 0;) {
+        if (chosen[i] == 9) RemoveSnapshotEntity(client, i);
+        else if (chosen[i] == 10) RemoveSnapshotEntity(host, i);
+    }
+    return diverged;
+}
+
+static MerkleRoomCost MerkleFullRoom(uint32_t entities) {
+    MerkleRoomCost cost;
+    cost.chunks = (entities + BULK_RECORDS_PER_CHUNK - 1) / BULK_RECORDS_PER_CHUNK;
+    cost.bytes = cost.chunks * (uint32_t)(offsetof(RoomChunkPacket, records) + SECURE_RECORD_OVERHEAD) +
+                 entities * (uint32_t)sizeof(RoomEntityRecord);
+    cost.millis = HARNESS_MERKLE_RTT_MS + MerklePacingMillis(cost.chunks);
+    return cost;
+}
+
+// Host e cliente trocando MERKLE_REQUEST / MERKLE_HASHES / MERKLE_BLOCKS
+// como na rede, sem perda (o resync só desiste por timeout). Pedido de
+// sala inteira soma o custo dela (a transferência em si é o --bulk).
+static void SimulateMerkle(const EntitySnapshot& host, const EntitySnapshot& client, uint32_t fullRoomPercent,
+                           MerkleRun& run) {
+    static MerkleResyncHost hostSide;
+    static MerkleResyncClient clientSide;
+    static uint16_t session = 0;
+    static uint16_t nodes[MERKLE_NODES_PER_PACKET];
+    static MerkleNodeHash hashes[MERKLE_HASHES_PER_PACKET];
+    static MerkleBlockData blocks[MERKLE_BLOCKS_PER_PACKET];
+    static uint32_t slots[MERKLE_BLOCKS_PER_PACKET];
+
+    uint64_t t0 = HarnessNanos();
+    hostSide.Reset();
+    clientSide.Begin(++session, client, 0, fullRoomPercent);
+
+    while (clientSide.IsActive()) {
+        // Cliente pede a rodada inteira
+        MerkleRequestKind kind;
+        uint32_t n;
+        while ((n = clientSide.NextRequest(kind, nodes, MERKLE_NODES_PER_PACKET)) != 0) {
+            run.packets++;
+            run.bytes += (uint32_t)(offsetof(MerkleRequestPacket, nodes) + n * sizeof(uint16_t) + SECURE_RECORD_OVERHEAD);
+            hostSide.OnRequest(session, kind, nodes, n, host);
+        }
+
+        // Host responde no orçamento de bulk
+        uint32_t replies = 0;
+        while (hostSide.HasPending()) {
+            replies++;
+            if (hostSide.PendingKind() == MerkleRequestKind::CHILDREN) {
+                n = hostSide.NextHashes(hashes, MERKLE_HASHES_PER_PACKET);
+                run.bytes += (uint32_t)(offsetof(MerkleHashesPacket, entries) + n * sizeof(MerkleNodeHash) + SECURE_RECORD_OVERHEAD);
+                clientSide.OnHashes(session, hashes, n, 0);
+            }
+            else {
+                n = hostSide.NextBlocks(blocks, MERKLE_BLOCKS_PER_PACKET);
+                run.bytes += (uint32_t)(offsetof(MerkleBlocksPacket, blocks) + n * sizeof(MerkleBlockData) + SECURE_RECORD_OVERHEAD);
+                clientSide.OnBlocks(session, blocks, n, slots, 0);
+            }
+        }
+        run.packets += replies;
+        run.millis += HARNESS_MERKLE_RTT_MS + MerklePacingMillis(replies);
+    }
+    run.cpuMicros = (HarnessNanos() - t0) / 1000.0;
+
+    run.rounds = clientSide.Rounds();
+    run.blocks = clientSide.BlocksApplied();
+    run.fullRoom = clientSide.TakeRoomRequest();
+    run.converged = run.fullRoom || clientSide.Tree().Root() == hostSide.Tree().Root();
+    if (run.fullRoom) {
+        MerkleRoomCost room = MerkleFullRoom(host.count);
+        run.packets += 1 + room.chunks;
+        run.bytes += (uint32_t)(offsetof(MerkleRequestPacket, nodes) + SECURE_RECORD_OVERHEAD) + room.bytes;
+        run.millis += room.millis;
+    }
+}
+
+int RunMerkleBench() {
+    static EntitySnapshot host;
+    static EntitySnapshot client;
+    static MerkleTree tree;
+    uint32_t rng = 0x3E4C;
+    uint32_t failures = 0;
+
+    // Custo da árvore inteira (o que cada lado paga ao congelar)
+    FillDesyncSnapshot(host, HARNESS_MERKLE_ENTITIES, rng);
+    LatencyStats build("MerkleTree::Build");
+    for (uint32_t rep = 0; rep < HARNESS_MERKLE_BUILD_REPS; rep++) {
+        uint64_t t0 = HarnessNanos();
+        tree.Build(host);
+        build.Record(HarnessNanos() - t0);
+    }
+    printf("[MERKLE] Árvore de %u slots x %u blocos, fanout %u, %u níveis; %u entidades\n\n",
+           MERKLE_SLOTS, MERKLE_BLOCKS, MERKLE_FANOUT, tree.Levels(), HARNESS_MERKLE_ENTITIES);
+    printf("  %-22s %10s  %8s %8s %8s %8s %8s %10s\n", "ns por chamada", "amostras",
+           "média", "p50", "p90", "p99", "p99.9", "máx");
+    build.Print();
+
+    MerkleRoomCost full = MerkleFullRoom(HARNESS_MERKLE_ENTITIES);
+    printf("\n[MERKLE] Resync contra a sala inteira (%u chunks, %u bytes, ~%.0f ms), RTT %u ms, %u chunks por tick de rede\n",
+           full.chunks, full.bytes, full.millis, HARNESS_MERKLE_RTT_MS, g_CoopConfig.bulkChunksPerTick);
+    printf("  Sala inteira a partir de %u%% das entidades diferentes; \"só árvore\" desce até o fim\n",
+           MERKLE_FULL_ROOM_PERCENT);
+    printf("  %7s %9s %7s %8s %9s %8s %9s %9s %9s %8s %17s\n", "deriva", "entidades", "rodadas", "pacotes",
+           "bytes", "% sala", "ms", "% tempo", "CPU us", "raiz", "só árvore (tempo)");
+
+    // Cruzamento: primeira deriva em que descer a árvore até o fim passa da sala inteira
+    float crossover = -1.0f;
+    float fallbackFrom = -1.0f;
+    for (float rate : HARNESS_MERKLE_RATES) {
+        uint32_t stateRng = rng;
+        FillDesyncSnapshot(host, HARNESS_MERKLE_ENTITIES, rng);
+        WireSnapshot(host, client);
+        uint32_t diverged = DivergeMerkleSnapshot(host, client, rate, rng);
+
+        MerkleRun run = {};
+        run.diverged = diverged;
+        SimulateMerkle(host, client, MERKLE_FULL_ROOM_PERCENT, run);
+
+        // Mesma deriva de novo, sem a saída pela sala inteira
+        MerkleRun treeOnly = {};
+        FillDesyncSnapshot(host, HARNESS_MERKLE_ENTITIES, stateRng);
+        WireSnapshot(host, client);
+        DivergeMerkleSnapshot(host, client, rate, stateRng);
+        SimulateMerkle(host, client, 101, treeOnly);
+        if (crossover < 0.0f && treeOnly.bytes > full.bytes) crossover = rate;
+        if (fallbackFrom < 0.0f && run.fullRoom) fallbackFrom = rate;
+
+        // Divergência zero tem que parar na primeira rodada, a árvore
+        // inteira sempre converge e, com tudo diferente, a sala inteira
+        // tem que sair mais barata que descer até o fim
+        bool ok = run.converged && treeOnly.converged && !treeOnly.fullRoom &&
+                  (diverged || (run.rounds == 1 && run.blocks == 0 && !run.fullRoom)) &&
+                  (rate < 1.0f || (run.fullRoom && run.bytes < treeOnly.bytes));
+        if (!ok) failures++;
+        printf("  %6.1f%% %9u %7u %8u %9u %7.1f%% %9.0f %8.1f%% %9.1f %8s %8.1f%% (%5.1f%%)\n",
+               rate * 100.0f, run.diverged, run.rounds, run.packets, run.bytes,
+               100.0 * run.bytes / full.bytes, run.millis, 100.0 * run.millis / full.millis,
+               run.cpuMicros, !ok ? "ERRADO" : run.fullRoom ? "sala" : "igual",
+               100.0 * treeOnly.bytes / full.bytes, 100.0 * treeOnly.millis / full.millis);
+    }
+
+    printf("\n  Só árvore passa da sala inteira a partir de %.0f%% de deriva; sala inteira pedida a partir de %.0f%%\n",
+           crossover * 100.0f, fallbackFrom * 100.0f);
+    printf("  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
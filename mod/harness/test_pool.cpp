@@ -0,0 +1,145 @@
+/**
+ * RE4 CO-OP MOD - Harness: Pool de Pacotes (--pool)
+ *
+ * Mede o pool de pacotes (Acquire/Release e a fila SPSC entre duas
+ * threads, contra a std::queue com mutex de antes) contando as alocações
+ * do processo: o caminho do pool tem que dar zero.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// POOL DE PACOTES
+//=============================================================================
+
+constexpr uint32_t HARNESS_POOL_OPS = 5000000;
+constexpr uint32_t HARNESS_POOL_QUEUE_OPS = 2000000;
+
+// Caminho de antes do pool: pacote na pilha, cópia para a std::queue com
+// mutex, outra cópia no pop
+struct LegacySendQueue {
+    std::mutex mutex;
+    std::queue<GameStatePacket> queue;
+
+    void Push(const GameStatePacket& packet) {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push(packet);
+    }
+
+    bool Pop(GameStatePacket& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.empty()) return false;
+        out = queue.front();
+        queue.pop();
+        return true;
+    }
+};
+
+struct PoolRun {
+    double millionsPerSecond;
+    uint64_t allocations;
+    uint64_t checksum;
+};
+
+// Produtor (jogo) e consumidor (thread de envio) em threads separadas
+template<typename Produce, typename Consume>
+static PoolRun RunPoolPair(uint32_t ops, Produce&& produce, Consume&& consume) {
+    PoolRun run = {};
+    std::atomic<bool> go{false};
+    std::thread consumer([&] {
+        while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+        for (uint32_t done = 0; done < ops;) {
+            if (consume(run.checksum)) done++;
+            else std::this_thread::yield();
+        }
+    });
+
+    uint64_t allocs = HarnessAllocations();
+    uint64_t t0 = HarnessNanos();
+    go.store(true, std::memory_order_release);
+    for (uint32_t i = 0; i < ops;) {
+        if (produce(i)) i++;
+        else std::this_thread::yield();
+    }
+    consumer.join();
+    run.millionsPerSecond = ops / ((double)(HarnessNanos() - t0) / 1e3);
+    run.allocations = HarnessAllocations() - allocs;
+    return run;
+}
+
+int RunPoolBench() {
+    uint32_t failures = 0;
+    PacketPool& pool = PacketPool::Instance();
+
+    printf("[POOL] %u buffers de %u bytes; GameStatePacket tem %u bytes\n\n", PACKET_POOL_CAPACITY,
+           PACKET_BUFFER_SIZE, (uint32_t)sizeof(GameStatePacket));
+    printf("  %-40s %12s %12s\n", "caminho", "Mops/s", "alocações");
+
+    // Acquire + Emplace + Release numa thread só
+    {
+        PacketHandle warm = pool.Acquire();
+        warm.Reset();
+        uint64_t allocs = HarnessAllocations();
+        uint64_t t0 = HarnessNanos();
+        for (uint32_t i = 0; i < HARNESS_POOL_OPS; i++) {
+            PacketHandle handle = pool.Acquire();
+            if (!handle) break;
+            handle.Emplace<GameStatePacket>()->header.sequence = i;
+        }
+        uint64_t elapsed = HarnessNanos() - t0;
+        allocs = HarnessAllocations() - allocs;
+        printf("  %-40s %12.1f %12llu\n", "Acquire + Emplace + Release", HARNESS_POOL_OPS / (elapsed / 1e3),
+               (unsigned long long)allocs);
+        if (allocs) failures++;
+    }
+
+    // Mesma coisa passando pela fila SPSC até a "thread de envio"
+    {
+        PacketQueue<256> queue;
+        PoolRun run = RunPoolPair(HARNESS_POOL_QUEUE_OPS,
+            [&](uint32_t i) {
+                PacketHandle handle = pool.Acquire();
+                if (!handle) return false;
+                handle.Emplace<GameStatePacket>()->header.sequence = i;
+                return queue.Push(handle);
+            },
+            [&](uint64_t& checksum) {
+                PacketHandle handle;
+                if (!queue.Pop(handle)) return false;
+                checksum += handle.As<PacketHeader>()->sequence;
+                return true;
+            });
+        bool ok = run.checksum == (uint64_t)HARNESS_POOL_QUEUE_OPS * (HARNESS_POOL_QUEUE_OPS - 1) / 2;
+        printf("  %-40s %12.1f %12llu%s\n", "PacketQueue (jogo -> envio)", run.millionsPerSecond,
+               (unsigned long long)run.allocations, ok ? "" : "  (pacotes trocados!)");
+        if (run.allocations || !ok) failures++;
+    }
+
+    // Antes: std::queue + mutex, duas cópias do pacote
+    {
+        LegacySendQueue queue;
+        PoolRun run = RunPoolPair(HARNESS_POOL_QUEUE_OPS,
+            [&](uint32_t i) {
+                GameStatePacket packet = {};
+                packet.header.sequence = i;
+                queue.Push(packet);
+                return true;
+            },
+            [&](uint64_t& checksum) {
+                GameStatePacket packet;
+                if (!queue.Pop(packet)) return false;
+                checksum += packet.header.sequence;
+                return true;
+            });
+        printf("  %-40s %12.1f %12llu\n", "antes: std::queue + mutex + cópias", run.millionsPerSecond,
+               (unsigned long long)run.allocations);
+    }
+
+    PacketPoolStats stats = pool.GetStats();
+    printf("\n  Pool: %llu acquires, %llu sem buffer livre, pico de %u em uso, %u em uso agora\n",
+           (unsigned long long)stats.acquired, (unsigned long long)stats.exhausted, stats.highWater, stats.inUse);
+    if (stats.inUse) failures++;
+
+    printf("\n  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
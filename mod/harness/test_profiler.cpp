@@ -0,0 +1,140 @@
+/**
+ * RE4 CO-OP MOD - Harness: Profiler (--profiler)
+ *
+ * Mede o custo de uma zona (parado, gravando, aninhada e com o anel
+ * cheio) e confere que todo evento gravado foi escrito no trace ou
+ * contado como descartado. Depois, levas de threads curtas: o anel de
+ * quem termina volta para a próxima, e nenhum evento se perde.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// PROFILER
+//=============================================================================
+
+constexpr uint32_t HARNESS_PROFILE_BATCH = PROFILER_RING_EVENTS / 4;   // Zonas por rajada (cabe no anel)
+constexpr uint32_t HARNESS_PROFILE_BATCHES = 200;
+constexpr const char* HARNESS_PROFILE_TRACE = "re4coop_harness_trace.json";
+constexpr uint32_t HARNESS_PROFILE_CHURN_WAVE = 8;                    // Threads por leva
+constexpr uint32_t HARNESS_PROFILE_CHURN_THREADS = PROFILER_MAX_THREADS * 8;
+constexpr uint32_t HARNESS_PROFILE_CHURN_ZONES = 100;                 // Por thread
+
+static volatile uint32_t s_ProfileWork = 0;
+
+// Corpo mínimo: o que sobra de diferença entre as variantes é a zona
+__attribute__((noinline)) static void ProfileBare() { s_ProfileWork = s_ProfileWork + 1; }
+
+// Só os dois RDTSC da zona (a maior parte do custo gravando)
+__attribute__((noinline)) static void ProfileTimestamps() {
+    uint64_t start = ProfilerTimestamp();
+    s_ProfileWork = s_ProfileWork + 1;
+    s_ProfileWork = s_ProfileWork + (uint32_t)(ProfilerTimestamp() - start);
+}
+
+__attribute__((noinline)) static void ProfileZoned() {
+    ProfileScope zone("harness::zona");
+    s_ProfileWork = s_ProfileWork + 1;
+}
+
+__attribute__((noinline)) static void ProfileNested() {
+    ProfileScope outer("harness::fora");
+    {
+        ProfileScope inner("harness::dentro");
+        s_ProfileWork = s_ProfileWork + 1;
+    }
+}
+
+// ns por chamada: rajadas de HARNESS_PROFILE_BATCH, melhor rajada de todas.
+// Gravando (events > 0), espera o dreno antes que o anel encha.
+template<typename Fn>
+static double ProfileNanos(Fn&& fn, uint32_t events) {
+    uint32_t perDrain = events ? PROFILER_RING_EVENTS / (HARNESS_PROFILE_BATCH * events) : 0;
+    double best = 1e30;
+    for (uint32_t batch = 0; batch < HARNESS_PROFILE_BATCHES; batch++) {
+        uint64_t start = HarnessNanos();
+        for (uint32_t i = 0; i < HARNESS_PROFILE_BATCH; i++) fn();
+        best = std::min(best, (double)(HarnessNanos() - start) / HARNESS_PROFILE_BATCH);
+        if (perDrain && batch % perDrain == perDrain - 1) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(PROFILER_DRAIN_MS * 2));
+        }
+    }
+    return best;
+}
+
+int RunProfilerBench() {
+    Profiler& profiler = Profiler::Instance();
+    uint32_t failures = 0;
+
+    printf("[PROFILER] Custo por zona (ProfileScope), %u rajadas de %u zonas\n\n", HARNESS_PROFILE_BATCHES,
+           HARNESS_PROFILE_BATCH);
+
+    double bare = ProfileNanos(ProfileBare, 0);
+    double stopped = ProfileNanos(ProfileZoned, 0);
+    double timestamps = ProfileNanos(ProfileTimestamps, 0);
+    if (profiler.EventsWritten() || profiler.Dropped()) failures++;
+
+    if (!profiler.Start(HARNESS_PROFILE_TRACE)) {
+        printf("[HARNESS] Profiler não abriu %s\n", HARNESS_PROFILE_TRACE);
+        return 1;
+    }
+    double recording = ProfileNanos(ProfileZoned, 1);
+    double nested = ProfileNanos(ProfileNested, 2);
+    uint32_t droppedBefore = profiler.Dropped();
+
+    // Anel cheio: sem dreno entre rajadas, quase tudo é descartado
+    std::this_thread::sleep_for(std::chrono::milliseconds(PROFILER_DRAIN_MS + 5));
+    uint64_t start = HarnessNanos();
+    uint32_t burst = PROFILER_RING_EVENTS * 8;
+    for (uint32_t i = 0; i < burst; i++) ProfileZoned();
+    double full = (double)(HarnessNanos() - start) / burst;
+    profiler.Stop();
+
+    // Tudo que entrou no anel foi para o arquivo
+    uint64_t recorded = (uint64_t)HARNESS_PROFILE_BATCHES * HARNESS_PROFILE_BATCH * 3 + burst;
+    uint64_t accounted = profiler.EventsWritten() + profiler.Dropped();
+    bool ok = accounted == recorded && profiler.Dropped() > droppedBefore;
+    if (!ok) failures++;
+
+    printf("  %-40s %8s %8s\n", "", "ns", "zona");
+    printf("  %-40s %8.2f %8s\n", "chamada sem zona", bare, "-");
+    printf("  %-40s %8.2f %8.2f\n", "zona, profiler parado", stopped, stopped - bare);
+    printf("  %-40s %8.2f %8.2f\n", "só os dois RDTSC", timestamps, timestamps - bare);
+    printf("  %-40s %8.2f %8.2f\n", "zona, gravando", recording, recording - bare);
+    printf("  %-40s %8.2f %8.2f\n", "duas zonas aninhadas, gravando", nested, (nested - bare) / 2);
+    printf("  %-40s %8.2f %8.2f\n", "zona, anel cheio (descartada)", full, full - bare);
+    printf("\n  %llu eventos escritos + %u descartados (%u nas rajadas com dreno) = %llu gravados (%s)\n",
+           (unsigned long long)profiler.EventsWritten(), profiler.Dropped(), droppedBefore,
+           (unsigned long long)recorded, ok ? "ok" : "ERRADO");
+    printf("  Frame com 50 zonas: ~%.1f us gravando, ~%.2f us parado\n", 50.0 * (recording - bare) / 1000.0,
+           50.0 * std::max(0.0, stopped - bare) / 1000.0);
+
+    // Threads que terminam, bem mais que PROFILER_MAX_THREADS no total: o
+    // anel volta para a próxima leva e nenhuma zona fica sem anel
+    uint64_t writtenBefore = profiler.EventsWritten();
+    droppedBefore = profiler.Dropped();
+    profiler.Start(HARNESS_PROFILE_TRACE);
+    for (uint32_t wave = 0; wave < HARNESS_PROFILE_CHURN_THREADS / HARNESS_PROFILE_CHURN_WAVE; wave++) {
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < HARNESS_PROFILE_CHURN_WAVE; t++) {
+            threads.emplace_back([]() {
+                for (uint32_t i = 0; i < HARNESS_PROFILE_CHURN_ZONES; i++) ProfileZoned();
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+        std::this_thread::sleep_for(std::chrono::milliseconds(PROFILER_DRAIN_MS * 2));
+    }
+    profiler.Stop();
+    uint64_t churnWritten = profiler.EventsWritten() - writtenBefore;
+    uint32_t churnDropped = profiler.Dropped() - droppedBefore;
+    uint64_t churnZones = (uint64_t)HARNESS_PROFILE_CHURN_THREADS * HARNESS_PROFILE_CHURN_ZONES;
+    bool churnOk = churnWritten == churnZones && !churnDropped;
+    if (!churnOk) failures++;
+    printf("\n  %u threads que terminam: %llu eventos de %llu, %u descartados, %u anéis de %u criados -> %s\n",
+           HARNESS_PROFILE_CHURN_THREADS, (unsigned long long)churnWritten, (unsigned long long)churnZones,
+           churnDropped, profiler.RingCount(), PROFILER_MAX_THREADS, churnOk ? "ok" : "ERRADO");
+
+    remove(HARNESS_PROFILE_TRACE);
+    printf("\n  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
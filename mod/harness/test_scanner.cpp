@@ -0,0 +1,253 @@
+/**
+ * RE4 CO-OP MOD - Harness: Scanner de Assinaturas (--scanner)
+ *
+ * Registra 128 e depois 240 assinaturas numa imagem sintética de 16 MB,
+ * confere cada resultado contra uma busca ingênua e mede a passada fria,
+ * a quente, um padrão por vez e a volta do cache (que precisa cair quando
+ * a imagem ou os headers mudam).
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// SCANNER DE ASSINATURAS
+//=============================================================================
+
+constexpr uint32_t HARNESS_SCAN_IMAGE_SIZE = 16 << 20;  // Perto do .text do executável
+constexpr uint32_t HARNESS_SCAN_SMALL_SIZE = 4 << 20;
+
+// Bytes com a frequência de código x86 compilado (metade comuns, metade aleatórios)
+static uint8_t SyntheticCodeByte(uint32_t& rng) {
+    static const uint8_t COMMON[] = { 0x8B, 0x8B, 0x8B, 0x89, 0x89, 0x8D, 0xE8, 0x83, 0x85, 0x0F, 0x45, 0x44,
+                                      0x24, 0x00, 0x00, 0x00, 0xFF, 0xCC, 0x50, 0x51, 0x53, 0x55, 0x56, 0x57,
+                                      0x5D, 0x5E, 0x5F, 0xC3, 0x74, 0x75, 0x90, 0x04 };
+    rng = rng * 1664525u + 1013904223u;
+    uint32_t r = rng >> 8;
+    return (r & 1) ? COMMON[(r >> 1) % sizeof(COMMON)] : (uint8_t)(r >> 9);
+}
+
+// Executável falso: headers PE de verdade (ScanModule e a chave do cache
+// leem deles) e código sintético no resto
+static uint8_t* BuildScanImage(uint32_t size, uint32_t& rng) {
+    uint8_t* image = (uint8_t*)calloc(size, 1);
+    if (!image) return nullptr;
+
+    IMAGE_DOS_HEADER* dos = (IMAGE_DOS_HEADER*)image;
+    dos->e_magic = 0x5A4D;
+    dos->e_lfanew = 0x80;
+    IMAGE_NT_HEADERS* nt = (IMAGE_NT_HEADERS*)(image + dos->e_lfanew);
+    nt->Signature = 0x4550;
+    nt->FileHeader.Machine = 0x14C;
+    nt->FileHeader.TimeDateStamp = 0x5C8A1B2D;
+    nt->FileHeader.SizeOfOptionalHeader = sizeof(IMAGE_OPTIONAL_HEADER);
+    nt->OptionalHeader.Magic = 0x10B;
+    nt->OptionalHeader.SizeOfImage = size;
+    nt->OptionalHeader.SizeOfHeaders = 0x400;
+
+    for (uint32_t i = 0x400; i < size; i++) image[i] = SyntheticCodeByte(rng);
+    return image;
+}
+
+struct ScanSignature {
+    char name[16];
+    char text[SCAN_MAX_PATTERN_BYTES * 3 + 1];
+};
+
+// Assinaturas como as do re4_tweaks: um trecho da imagem com displacements
+// e imediatos trocados por '?'. Uma em 8 é inventada (quase nunca acha) e
+// uma em 16 é copiada para outro lugar (match duplicado).
+static void MakeScanSignatures(uint8_t* image, uint32_t size, uint32_t first, uint32_t count, uint32_t& rng,
+                               std::vector<ScanSignature>& out) {
+    for (uint32_t n = first; n < first + count; n++) {
+        ScanSignature sig;
+        snprintf(sig.name, sizeof(sig.name), "sig%03u", n);
+
+        uint32_t length = 6 + (rng >> 8) % 19;
+        rng = rng * 1664525u + 1013904223u;
+        uint32_t offset = 0x400 + (rng >> 4) % (size - 0x400 - length);
+        rng = rng * 1664525u + 1013904223u;
+
+        uint8_t bytes[SCAN_MAX_PATTERN_BYTES];
+        for (uint32_t i = 0; i < length; i++) bytes[i] = (n % 8 == 7) ? (uint8_t)(rng >> (i % 24)) ^ (uint8_t)i
+                                                                       : image[offset + i];
+        if (n % 16 == 5) {
+            uint32_t copy = 0x400 + (rng >> 3) % (size - 0x400 - length);
+            memcpy(image + copy, image + offset, length);
+        }
+
+        char* at = sig.text;
+        for (uint32_t i = 0; i < length; i++) {
+            // Um rel32/disp32 no meio, nunca nos 2 primeiros bytes (a âncora precisa de um par fixo)
+            bool wild = length >= 10 && i >= 2 + n % 3 && i < 6 + n % 3;
+            at += wild ? sprintf(at, i ? " ?" : "?") : sprintf(at, i ? " %02X" : "%02X", bytes[i]);
+        }
+        out.push_back(sig);
+    }
+}
+
+// Um padrão por vez, memchr no primeiro byte fixo (como hook::pattern por chamada)
+__attribute__((noinline)) static void NaiveScan(const ScanPattern& p, const uint8_t* image, uint32_t size,
+                                                uint32_t& firstOffset, uint32_t& matchCount) {
+    uint32_t fixed = 0;
+    while (!p.mask[fixed]) fixed++;
+
+    firstOffset = SCAN_NOT_FOUND;
+    matchCount = 0;
+    for (uint32_t pos = fixed; pos < size;) {
+        const uint8_t* hit = (const uint8_t*)memchr(image + pos, p.bytes[fixed], size - pos);
+        if (!hit) break;
+        uint32_t start = (uint32_t)(hit - image) - fixed;
+        if (p.MatchesAt(image, size, start)) {
+            if (matchCount == 0) firstOffset = start;
+            matchCount++;
+        }
+        pos = (uint32_t)(hit - image) + 1;
+    }
+}
+
+// Resultado do scanner igual ao da busca ingênua para todos os padrões
+static uint32_t CheckScanResults(const PatternScanner& scanner, const uint8_t* image, uint32_t size, const char* when) {
+    uint32_t failures = 0;
+    for (uint32_t i = 0; i < scanner.PatternCount(); i++) {
+        uint32_t firstOffset, matchCount;
+        NaiveScan(scanner.Pattern((int)i), image, size, firstOffset, matchCount);
+        if (scanner.Pattern((int)i).firstOffset != firstOffset || scanner.MatchCount((int)i) != matchCount) {
+            if (failures++ < 4) {
+                printf("  %s: %s achou %u em %#x, busca ingênua %u em %#x\n", when, scanner.Pattern((int)i).name,
+                       scanner.MatchCount((int)i), scanner.Pattern((int)i).firstOffset, matchCount, firstOffset);
+            }
+        }
+    }
+    return failures;
+}
+
+int RunScannerBench() {
+    PatternScanner& scanner = PatternScanner::Instance();
+    uint32_t rng = 0xBADC0DE5u;
+    uint8_t* image = BuildScanImage(HARNESS_SCAN_IMAGE_SIZE, rng);
+    if (!image) {
+        printf("[HARNESS] Falha ao alocar a imagem do scanner\n");
+        return 1;
+    }
+    CompatSetMainModule(image);
+
+    char cachePath[MAX_PATH];
+    CoopDataPath(SCAN_CACHE_FILE, cachePath);
+
+    std::vector<ScanSignature> signatures;
+    signatures.reserve(SCAN_MAX_PATTERNS);
+    uint32_t failures = 0;
+    volatile uint32_t sink = 0;
+
+    printf("[SCANNER] Imagem sintética de %u MB, todos os padrões numa passada\n\n", HARNESS_SCAN_IMAGE_SIZE >> 20);
+    printf("  %-7s %-7s %10s %10s %10s %12s %10s %10s   (ms)\n", "padrões", "achados", "frio", "quente 4MB",
+           "quente", "um por vez", "salva", "do cache");
+
+    // 128 padrões e depois mais 112 (o scanner só cresce: Add invalida as tabelas)
+    const uint32_t steps[] = { 128, SCAN_MAX_PATTERNS - 16 };
+    for (uint32_t total : steps) {
+        uint32_t first = (uint32_t)signatures.size();
+        MakeScanSignatures(image, HARNESS_SCAN_IMAGE_SIZE, first, total - first, rng, signatures);
+        for (uint32_t i = first; i < total; i++) {
+            if (scanner.Add(signatures[i].name, signatures[i].text) < 0) {
+                printf("  Add recusou %s: %s\n", signatures[i].name, signatures[i].text);
+                failures++;
+            }
+        }
+        remove(cachePath);
+
+        // Frio: tabelas por montar, sem cache, imagem fora do cache da CPU
+        uint64_t t0 = HarnessNanos();
+        bool cached = scanner.ScanModule();
+        double cold = (double)(HarnessNanos() - t0) / 1e6;
+        if (cached) {
+            printf("  Primeira passada veio de um cache apagado\n");
+            failures++;
+        }
+        failures += CheckScanResults(scanner, image, HARNESS_SCAN_IMAGE_SIZE, "frio");
+
+        uint32_t found = 0;
+        for (uint32_t i = 0; i < scanner.PatternCount(); i++) found += scanner.MatchCount((int)i) ? 1 : 0;
+
+        // Quente: tabelas prontas, só a passada
+        auto best = [&](uint32_t size) {
+            scanner.SetImage(image, size);
+            double ms = 1e30;
+            for (uint32_t trial = 0; trial < 5; trial++) {
+                uint64_t start = HarnessNanos();
+                scanner.Scan();
+                ms = std::min(ms, (double)(HarnessNanos() - start) / 1e6);
+            }
+            return ms;
+        };
+        double warmSmall = best(HARNESS_SCAN_SMALL_SIZE);
+        failures += CheckScanResults(scanner, image, HARNESS_SCAN_SMALL_SIZE, "4 MB");
+        double warm = best(HARNESS_SCAN_IMAGE_SIZE);
+
+        t0 = HarnessNanos();
+        for (uint32_t i = 0; i < scanner.PatternCount(); i++) {
+            uint32_t firstOffset, matchCount;
+            NaiveScan(scanner.Pattern((int)i), image, HARNESS_SCAN_IMAGE_SIZE, firstOffset, matchCount);
+            sink = sink + matchCount;
+        }
+        double naive = (double)(HarnessNanos() - t0) / 1e6;
+
+        uint64_t imageKey = ScanHash(image, 0x400);
+        t0 = HarnessNanos();
+        bool saved = scanner.SaveCache(cachePath, imageKey);
+        double save = (double)(HarnessNanos() - t0) / 1e6;
+
+        // Volta do cache: ScanModule não escaneia e os resultados são os mesmos
+        t0 = HarnessNanos();
+        cached = scanner.ScanModule();
+        double load = (double)(HarnessNanos() - t0) / 1e6;
+        if (!saved || !cached) {
+            printf("  Cache não voltou (salvo %d, lido %d)\n", saved, cached);
+            failures++;
+        }
+        failures += CheckScanResults(scanner, image, HARNESS_SCAN_IMAGE_SIZE, "cache");
+
+        printf("  %-7u %-7u %10.2f %10.2f %10.2f %12.2f %10.3f %10.3f\n", scanner.PatternCount(), found, cold,
+               warmSmall, warm, naive, save, load);
+    }
+
+    // O cache não pode sobreviver a uma imagem diferente
+    printf("\n");
+    auto expectRescan = [&](const char* what) {
+        bool cached = scanner.ScanModule();
+        bool ok = !cached && CheckScanResults(scanner, image, HARNESS_SCAN_IMAGE_SIZE, what) == 0;
+        printf("  %-36s %s\n", what, ok ? "escaneou de novo" : "ERRO: usou o cache");
+        if (!ok) failures++;
+    };
+
+    // Byte de um hit mudou (mesmos headers): a conferência contra a imagem pega
+    int victim = 0;
+    while (!scanner.MatchCount(victim) || scanner.MatchCount(victim) > 1) victim++;
+    const ScanPattern& pattern = scanner.Pattern(victim);
+    uint8_t* hit = image + pattern.firstOffset + pattern.anchorOffset;
+    uint8_t saved = *hit;
+    *hit ^= 0x5A;
+    expectRescan("hit alterado, headers iguais");
+    *hit = saved;
+    scanner.ScanModule();
+
+    IMAGE_NT_HEADERS* nt = (IMAGE_NT_HEADERS*)(image + ((IMAGE_DOS_HEADER*)image)->e_lfanew);
+    nt->FileHeader.TimeDateStamp++;
+    expectRescan("outro build (TimeDateStamp)");
+
+    // Arquivo cortado no meio
+    FILE* file = fopen(cachePath, "r+b");
+    if (file) {
+        fseek(file, 0, SEEK_END);
+        long length = ftell(file);
+        fclose(file);
+        if (truncate(cachePath, length / 2) != 0) failures++;
+    }
+    expectRescan("cache truncado");
+
+    remove(cachePath);
+    CompatSetMainModule(nullptr);
+    free(image);
+    printf("\n  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,235 @@
+/**
+ * RE4 CO-OP MOD - Harness: Schema de Pacotes (--schema)
+ *
+ * Confere o GameStateSchema contra o mesmo formato escrito à mão (bytes e
+ * decode iguais) e mede encode/decode completo e delta contra o código à
+ * mão e contra o struct + checksum de antes.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// SCHEMA DE PACOTES
+//=============================================================================
+
+// O mesmo formato do GameStateSchema escrito à mão, campo a campo, como
+// seria sem o schema (faixa em float de runtime, laço nos slots). Fora de
+// linha como o GameStateSchema::Encode no mod: inline aqui, com o buffer
+// local, o compilador dobraria todos os testes de capacidade.
+static uint32_t HandQuantize(float v, float min, float max, uint32_t bits) {
+    uint32_t steps = (1u << bits) - 1;
+    if (!(v > min)) return 0;
+    if (v >= max) return steps;
+    return (uint32_t)((v - min) * ((float)steps / (max - min)) + 0.5f);
+}
+
+static float HandDequantize(uint32_t q, float min, float max, uint32_t bits) {
+    return min + (float)q / ((float)((1u << bits) - 1) / (max - min));
+}
+
+__attribute__((noinline)) static void HandEncodeGameState(BitWriter& w, const GameStatePacket& packet) {
+    w.Write(packet.playerMask, COOP_MAX_PLAYERS);
+    for (uint32_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+        PlayerSlotState slot = packet.players[i];
+        w.Write(HandQuantize(slot.pos.x, -131072.0f, 131072.0f, 24), 24);
+        w.Write(HandQuantize(slot.pos.y, -131072.0f, 131072.0f, 24), 24);
+        w.Write(HandQuantize(slot.pos.z, -131072.0f, 131072.0f, 24), 24);
+        w.Write(HandQuantize(slot.rotation, -4.0f, 4.0f, 16), 16);
+        w.Write((uint16_t)slot.hp, 16);
+        w.Write(slot.state, 8);
+        AnimKeyCodec::Write(w, slot.anim);
+        w.Write(slot.weapon, 8);
+    }
+    w.Write(packet.roomId, 16);
+    w.Write(packet.enemyCount, 8);
+    w.Write(packet.checkTick, 32);
+    w.Write((uint32_t)packet.checkHash, 32);
+    w.Write((uint32_t)(packet.checkHash >> 32), 32);
+}
+
+__attribute__((noinline)) static void HandDecodeGameState(BitReader& r, GameStatePacket& packet) {
+    packet.playerMask = (uint8_t)r.Read(COOP_MAX_PLAYERS);
+    for (uint32_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+        PlayerSlotState slot;
+        slot.pos.x = HandDequantize(r.Read(24), -131072.0f, 131072.0f, 24);
+        slot.pos.y = HandDequantize(r.Read(24), -131072.0f, 131072.0f, 24);
+        slot.pos.z = HandDequantize(r.Read(24), -131072.0f, 131072.0f, 24);
+        slot.rotation = HandDequantize(r.Read(16), -4.0f, 4.0f, 16);
+        slot.hp = (int16_t)r.Read(16);
+        slot.state = (uint8_t)r.Read(8);
+        AnimKeyCodec::Read(r, slot.anim);
+        slot.weapon = (uint8_t)r.Read(8);
+        packet.players[i] = slot;
+    }
+    packet.roomId = (uint16_t)r.Read(16);
+    packet.enemyCount = (uint8_t)r.Read(8);
+    packet.checkTick = r.Read(32);
+    uint64_t lo = r.Read(32);
+    packet.checkHash = lo | ((uint64_t)r.Read(32) << 32);
+}
+
+// Caminho de antes do schema: struct inteiro no fio + checksum
+static uint32_t LegacyStateChecksum(const void* data, size_t size) {
+    uint32_t checksum = 0;
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) {
+        checksum += bytes[i];
+        checksum = (checksum << 1) | (checksum >> 31);
+    }
+    return checksum;
+}
+
+// Sequência de estados de 30 Hz: Leon e Ashley andando, extras parados,
+// animação e hash mudando só de vez em quando
+static void FillSchemaStates(std::vector<GameStatePacket>& states) {
+    uint32_t seed = 0x5C4E3Au;
+    GameStatePacket packet = {};
+    packet.header.type = PacketType::GAME_STATE;
+    packet.playerMask = 0x0F;
+    packet.roomId = 0x100;
+    packet.enemyCount = 24;
+    for (uint32_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+        packet.players[i].pos = { 1000.0f * i, 0.0f, -500.0f * i };
+        packet.players[i].hp = 1200;
+        packet.players[i].anim.id = (uint16_t)(10 + i);
+        packet.players[i].anim.blend = 255;
+    }
+
+    for (size_t k = 0; k < states.size(); k++) {
+        packet.header.sequence = (uint16_t)k;
+        for (uint32_t i = 0; i < 2; i++) {
+            PlayerSlotState slot = packet.players[i];
+            slot.pos.x += (HarnessRandom(seed) - 0.5f) * 200.0f;
+            slot.pos.z += (HarnessRandom(seed) - 0.5f) * 200.0f;
+            slot.rotation = (HarnessRandom(seed) - 0.5f) * 6.0f;
+            if (HarnessRandom(seed) < 0.05f) slot.anim.id = (uint16_t)(HarnessRandom(seed) * 400.0f);
+            slot.anim.stamp = (uint16_t)k;
+            packet.players[i] = slot;
+        }
+        if (k % 30 == 0) {
+            packet.checkTick = (uint32_t)k;
+            packet.checkHash = ((uint64_t)seed << 32) | (uint32_t)(k * 2654435761u);
+        }
+        states[k] = packet;
+    }
+}
+
+int RunSchemaBench() {
+    uint32_t failures = 0;
+    const uint32_t STATES = 1024;
+    const uint32_t ROUNDS = 500;
+    std::vector<GameStatePacket> states(STATES);
+    FillSchemaStates(states);
+
+    // Mesmo formato: bytes iguais e o decode de um lê o do outro
+    uint8_t handBytes[GameStateSchema::MAX_BYTES];
+    uint8_t schemaBytes[GameStateSchema::MAX_BYTES];
+    uint32_t mismatches = 0;
+    for (const GameStatePacket& state : states) {
+        BitWriter hand(handBytes, sizeof(handBytes));
+        HandEncodeGameState(hand, state);
+        BitWriter schema(schemaBytes, sizeof(schemaBytes));
+        GameStateSchema::Encode(schema, state);
+        uint32_t size = hand.Flush();
+        if (size != schema.Flush() || memcmp(handBytes, schemaBytes, size)) mismatches++;
+
+        GameStatePacket a = {}, b = {};
+        BitReader handReader(schemaBytes, size);
+        HandDecodeGameState(handReader, a);
+        BitReader schemaReader(schemaBytes, size);
+        GameStateSchema::Decode(schemaReader, b);
+        if (memcmp(&a, &b, sizeof(a))) mismatches++;
+    }
+    printf("[SCHEMA] GAME_STATE: %u estados, manual contra schema: %s\n", STATES,
+           mismatches ? "DIFERENTES" : "mesmos bytes e mesmo decode");
+    if (mismatches) failures++;
+
+    // Tamanho no fio (corpo, sem o PacketHeader)
+    uint64_t deltaBytes = 0;
+    for (uint32_t k = 1; k < STATES; k++) {
+        BitWriter writer(schemaBytes, sizeof(schemaBytes));
+        GameStateSchema::EncodeDelta(writer, states[k - 1], states[k]);
+        deltaBytes += writer.Flush() + 1;
+    }
+    printf("  Bytes: struct + checksum %u, schema completo %u, delta médio %.1f\n\n",
+           (uint32_t)(sizeof(GameStatePacket) - sizeof(PacketHeader) + 4), (GameStateSchema::FULL_BITS + 7) / 8 + 1,
+           (double)deltaBytes / (STATES - 1));
+
+    // ns por pacote, a melhor de 5 tentativas (a máquina é compartilhada);
+    // sink segura o compilador de jogar o trabalho fora
+    volatile uint32_t sink = 0;
+    uint8_t raw[sizeof(GameStatePacket) + 4];
+    auto time = [&](const char* name, auto&& body) {
+        double best = 1e30;
+        for (uint32_t trial = 0; trial < 5; trial++) {
+            uint64_t start = HarnessNanos();
+            for (uint32_t round = 0; round < ROUNDS / 5; round++) {
+                for (uint32_t k = 1; k < STATES; k++) body(k);
+            }
+            double ns = (double)(HarnessNanos() - start) / ((double)(ROUNDS / 5) * (STATES - 1));
+            if (ns < best) best = ns;
+        }
+        printf("  %-34s %7.1f ns\n", name, best);
+        return best;
+    };
+
+    time("struct + checksum (antes)", [&](uint32_t k) {
+        memcpy(raw, &states[k], sizeof(GameStatePacket));
+        uint32_t checksum = LegacyStateChecksum(raw, sizeof(GameStatePacket));
+        memcpy(raw + sizeof(GameStatePacket), &checksum, 4);
+        sink = sink + raw[sizeof(GameStatePacket)];
+    });
+    double handEncode = time("encode completo manual", [&](uint32_t k) {
+        BitWriter writer(handBytes, sizeof(handBytes));
+        HandEncodeGameState(writer, states[k]);
+        sink = sink + writer.Flush();
+    });
+    double schemaEncode = time("encode completo (schema)", [&](uint32_t k) {
+        BitWriter writer(schemaBytes, sizeof(schemaBytes));
+        GameStateSchema::Encode(writer, states[k]);
+        sink = sink + writer.Flush();
+    });
+    time("encode delta (schema)", [&](uint32_t k) {
+        BitWriter writer(schemaBytes, sizeof(schemaBytes));
+        GameStateSchema::EncodeDelta(writer, states[k - 1], states[k]);
+        sink = sink + writer.Flush();
+    });
+
+    // Decode do mesmo completo codificado
+    BitWriter full(schemaBytes, sizeof(schemaBytes));
+    GameStateSchema::Encode(full, states[STATES / 2]);
+    uint32_t fullSize = full.Flush();
+    uint8_t deltaBytesBuf[GameStateSchema::MAX_BYTES];
+    BitWriter delta(deltaBytesBuf, sizeof(deltaBytesBuf));
+    GameStateSchema::EncodeDelta(delta, states[STATES / 2 - 1], states[STATES / 2]);
+    uint32_t deltaSize = delta.Flush();
+
+    GameStatePacket out = {};
+    double handDecode = time("decode completo manual", [&](uint32_t k) {
+        schemaBytes[fullSize - 1] ^= (uint8_t)k;        // Muda o hash: nada constante
+        BitReader reader(schemaBytes, fullSize);
+        HandDecodeGameState(reader, out);
+        sink = sink + out.enemyCount;
+    });
+    double schemaDecode = time("decode completo (schema)", [&](uint32_t k) {
+        schemaBytes[fullSize - 1] ^= (uint8_t)k;
+        BitReader reader(schemaBytes, fullSize);
+        GameStateSchema::Decode(reader, out);
+        sink = sink + out.enemyCount;
+    });
+    time("decode delta (schema)", [&](uint32_t k) {
+        BitReader reader(deltaBytesBuf, deltaSize);
+        GameStateSchema::DecodeDelta(reader, states[k], out);
+        sink = sink + out.enemyCount;
+    });
+    time("Validate (schema)", [&](uint32_t k) {
+        sink = sink + GameStateSchema::Validate(states[k]);
+    });
+
+    // O schema desenrola os 4 slots (um bit de máscara por campo de slot);
+    // o manual é um laço, com menos código para o front-end da CPU
+    printf("\n  Schema / manual: encode %.2fx, decode %.2fx\n", schemaEncode / handEncode, schemaDecode / handDecode);
+
+    printf("\n  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
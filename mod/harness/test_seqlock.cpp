@@ -0,0 +1,146 @@
+/**
+ * RE4 CO-OP MOD - Harness: SeqLock (--seqlock S)
+ *
+ * Estressa o SeqLock por S segundos (1 escritor, 3 leitores) conferindo
+ * cada leitura contra leitura rasgada, e mede o custo de Load/Store com e
+ * sem concorrência.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// SEQLOCK
+//=============================================================================
+
+constexpr uint32_t HARNESS_SEQLOCK_READERS = 3;
+constexpr uint32_t HARNESS_SEQLOCK_OPS = 2000000;
+
+// Do tamanho do GameStatePacket; toda palavra igual = leitura inteira
+struct SeqlockProbe {
+    uint32_t words[(sizeof(GameStatePacket) + 3) / 4];
+
+    void Fill(uint32_t value) {
+        for (uint32_t& w : words) w = value;
+    }
+
+    bool Torn() const {
+        for (uint32_t w : words) {
+            if (w != words[0]) return true;
+        }
+        return false;
+    }
+};
+
+// Mesma cópia palavra por palavra, sem a sequência (controle do detector)
+struct UnprotectedProbe {
+    std::atomic<uint32_t> words[sizeof(SeqlockProbe) / 4];
+
+    void Store(const SeqlockProbe& value) {
+        for (uint32_t i = 0; i < sizeof(SeqlockProbe) / 4; i++) words[i].store(value.words[i], std::memory_order_relaxed);
+    }
+
+    void Load(SeqlockProbe& out) const {
+        for (uint32_t i = 0; i < sizeof(SeqlockProbe) / 4; i++) out.words[i] = words[i].load(std::memory_order_relaxed);
+    }
+};
+
+struct SeqlockStress {
+    uint64_t writes;
+    uint64_t reads;
+    uint64_t torn;
+    uint64_t backwards;         // Versão menor que a anterior do mesmo leitor
+};
+
+template<typename Shared>
+static SeqlockStress RunSeqlockStress(Shared& shared, uint32_t seconds) {
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> reads{0}, torn{0}, backwards{0};
+    uint64_t writes = 0;
+
+    std::thread readers[HARNESS_SEQLOCK_READERS];
+    for (std::thread& reader : readers) {
+        reader = std::thread([&]() {
+            uint64_t n = 0, bad = 0, back = 0;
+            uint32_t last = 0;
+            SeqlockProbe probe;
+            while (running.load(std::memory_order_relaxed)) {
+                shared.Load(probe);
+                n++;
+                if (probe.Torn()) bad++;
+                else if (probe.words[0] < last) back++;
+                else last = probe.words[0];
+            }
+            reads += n;
+            torn += bad;
+            backwards += back;
+        });
+    }
+
+    std::thread writer([&]() {
+        SeqlockProbe probe;
+        uint64_t end = CoopNowMicros() + seconds * 1000000ull;
+        for (uint32_t value = 1; CoopNowMicros() < end;) {
+            for (uint32_t k = 0; k < 256; k++, value++) {
+                probe.Fill(value);
+                shared.Store(probe);
+                writes++;
+            }
+        }
+        running.store(false, std::memory_order_relaxed);
+    });
+
+    writer.join();
+    for (std::thread& reader : readers) reader.join();
+    return { writes, reads.load(), torn.load(), backwards.load() };
+}
+
+int RunSeqlockBench(uint32_t seconds) {
+    static SeqLock<SeqlockProbe> seqlock;
+    static UnprotectedProbe unprotected;
+
+    SeqlockStress guarded = RunSeqlockStress(seqlock, seconds);
+    SeqlockStress control = RunSeqlockStress(unprotected, 1);
+
+    printf("[SEQLOCK] %u B por valor, 1 escritor e %u leitores, %u CPUs\n", (uint32_t)sizeof(SeqlockProbe),
+           HARNESS_SEQLOCK_READERS, std::thread::hardware_concurrency());
+    printf("  SeqLock (%u s):     %llu escritas, %llu leituras, %llu rasgadas, %llu fora de ordem\n", seconds,
+           (unsigned long long)guarded.writes, (unsigned long long)guarded.reads,
+           (unsigned long long)guarded.torn, (unsigned long long)guarded.backwards);
+    printf("  Sem sequência (1 s): %llu escritas, %llu leituras, %llu rasgadas (controle do detector)\n\n",
+           (unsigned long long)control.writes, (unsigned long long)control.reads, (unsigned long long)control.torn);
+
+    // Custo sem concorrência
+    LatencyStats storeStats("SeqLock::Store");
+    LatencyStats loadStats("SeqLock::Load");
+    LatencyStats mutexStats("mutex + cópia");
+    SeqlockProbe probe;
+    probe.Fill(0);
+    std::mutex mutex;
+    SeqlockProbe locked = probe;
+
+    for (uint32_t batch = 0; batch < HARNESS_SEQLOCK_OPS / 64; batch++) {
+        uint64_t t0 = HarnessNanos();
+        for (uint32_t i = 0; i < 64; i++) seqlock.Store(probe);
+        uint64_t t1 = HarnessNanos();
+        for (uint32_t i = 0; i < 64; i++) seqlock.Load(probe);
+        uint64_t t2 = HarnessNanos();
+        for (uint32_t i = 0; i < 64; i++) {
+            std::lock_guard<std::mutex> lock(mutex);
+            probe = locked;
+        }
+        uint64_t t3 = HarnessNanos();
+        storeStats.Record((t1 - t0) / 64);
+        loadStats.Record((t2 - t1) / 64);
+        mutexStats.Record((t3 - t2) / 64);
+    }
+
+    printf("  %-22s %10s  %8s %8s %8s %8s %8s %10s\n", "ns (lotes de 64)", "amostras",
+           "média", "p50", "p90", "p99", "p99.9", "máx");
+    storeStats.Print();
+    loadStats.Print();
+    mutexStats.Print();
+    printf("\n  Com o escritor rodando: %.1f M leituras/s por leitor, %.1f M escritas/s\n",
+           (double)guarded.reads / HARNESS_SEQLOCK_READERS / seconds / 1e6, (double)guarded.writes / seconds / 1e6);
+
+    return guarded.torn || guarded.backwards || !control.torn ? 1 : 0;
+}
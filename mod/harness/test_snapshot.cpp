@@ -0,0 +1,291 @@
+/**
+ * RE4 CO-OP MOD - Harness: Snapshot de Entidades (--snapshot)
+ *
+ * Confere as máscaras sujas do DiffSnapshots (SSE2) e do
+ * SnapshotExtractor contra um diff escalar e mede extração + diff de 1 a
+ * 1000 entidades contra a leitura AoS campo a campo de antes.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// SNAPSHOT DE ENTIDADES
+//=============================================================================
+
+constexpr uint32_t HARNESS_SNAPSHOT_SLOTS = 1200;       // Slots do EmMgr (1 em 8 livre): até ~1000 vivos
+
+// O ramo escalar de DiffSnapshots, fora de linha: referência das máscaras
+// e base de comparação do SSE2
+__attribute__((noinline)) static uint32_t ScalarDiffSnapshots(const EntitySnapshot& prev, const EntitySnapshot& cur,
+                                                              uint8_t* dirty) {
+    uint32_t dirtyCount = 0;
+    for (uint32_t i = 0; i < cur.count; i++) {
+        uint8_t bits = 0;
+        if (cur.posX[i] != prev.posX[i] || cur.posY[i] != prev.posY[i] || cur.posZ[i] != prev.posZ[i]) bits |= DIRTY_POS;
+        if (cur.hp[i] != prev.hp[i] || cur.hpMax[i] != prev.hpMax[i]) bits |= DIRTY_HP;
+        if (cur.flags[i] != prev.flags[i]) bits |= DIRTY_FLAGS;
+        if (cur.state[i] != prev.state[i]) bits |= DIRTY_STATE;
+        if (cur.id[i] != prev.id[i]) bits = DIRTY_ALL;
+        dirty[i] = bits;
+        if (bits) dirtyCount++;
+    }
+    return dirtyCount;
+}
+
+// Como a replicação fazia antes do snapshot: cada entidade lida direto do
+// jogo e comparada campo a campo com o último registro enviado (AoS)
+struct LegacySnapshotScan {
+    RoomEntityRecord sent[SNAPSHOT_MAX_ENTITIES];
+    uint8_t dirty[SNAPSHOT_MAX_ENTITIES];
+    uint32_t count = 0;
+
+    __attribute__((noinline)) uint32_t Scan() {
+        uint32_t n = 0;
+        uint32_t dirtyCount = 0;
+        auto visit = [&](RoomRecordKind kind, uint16_t index, const EntityState& state) {
+            RoomEntityRecord& record = sent[n];
+            uint8_t bits = 0;
+            if (n >= count || record.kind != kind || record.index != index) {
+                bits = DIRTY_ALL;
+            }
+            else {
+                if (memcmp(&record.pos, &state.pos, sizeof(Vec))) bits |= DIRTY_POS;
+                if (record.hp != state.hp || record.hpMax != state.hpMax) bits |= DIRTY_HP;
+                if (record.flags != state.flags) bits |= DIRTY_FLAGS;
+            }
+            if (bits) {
+                record.kind = kind;
+                record.index = index;
+                record.pos = state.pos;
+                record.hp = state.hp;
+                record.hpMax = state.hpMax;
+                record.flags = state.flags;
+                dirtyCount++;
+            }
+            dirty[n++] = bits;
+        };
+
+        const EntityCache& entities = EntityCache::Instance();
+        WithGameVersion([&](auto table) {
+            for (uint16_t i = 0; i < ENTITY_CACHE_SLOTS; i++) {
+                cPlayer* entity = entities.Player(i);
+                if (entity) visit(RoomRecordKind::PLAYER, i, PlayerView(table, entity).Gather());
+            }
+            EmListView enemies(table, pEmMgr);
+            uint32_t enemyCount = enemies.Count();
+            for (uint32_t i = 0; i < enemyCount && n < SNAPSHOT_MAX_ENTITIES; i++) {
+                if (enemies.IsAlive(i)) visit(RoomRecordKind::ENEMY, (uint16_t)i, EmView(table, enemies.At(i)).Gather());
+            }
+        });
+        count = n;
+        return dirtyCount;
+    }
+};
+
+// count entidades aleatórias; o resto do buffer zerado, como o extrator deixa
+static void FillEntitySnapshot(EntitySnapshot& s, uint32_t count, uint32_t& rng) {
+    memset(&s, 0, sizeof(s));
+    s.count = count;
+    for (uint32_t i = 0; i < count; i++) {
+        s.id[i] = SnapshotId(i < 2 ? RoomRecordKind::PLAYER : RoomRecordKind::ENEMY, (uint16_t)i);
+        s.posX[i] = HarnessRandom(rng) * 2000.0f;
+        s.posY[i] = HarnessRandom(rng) * 100.0f;
+        s.posZ[i] = HarnessRandom(rng) * 2000.0f;
+        s.hp[i] = (int16_t)(1 + HarnessRandom(rng) * 200.0f);
+        s.hpMax[i] = 200;
+        s.flags[i] = rng & 0xFFFF;
+        s.state[i] = i < 2 ? (rng >> 16) & 0xFF : 0;
+    }
+}
+
+// Muda um campo de cerca de rate das entidades de cur (uma em 16 troca de id)
+static void MutateEntitySnapshot(EntitySnapshot& cur, float rate, uint32_t& rng) {
+    for (uint32_t i = 0; i < cur.count; i++) {
+        if (HarnessRandom(rng) >= rate) continue;
+        switch ((rng >> 8) % 16) {
+        case 0: case 1: case 2: cur.posX[i] += 1.0f; break;
+        case 3: case 4: cur.posY[i] -= 0.5f; break;
+        case 5: case 6: cur.posZ[i] += 0.25f; break;
+        case 7: case 8: cur.hp[i]--; break;
+        case 9: cur.hpMax[i]++; break;
+        case 10: case 11: cur.flags[i] ^= 1u << (rng & 31); break;
+        case 12: case 13: case 14: cur.state[i]++; break;
+        default: cur.id[i] = SnapshotId(RoomRecordKind::ENEMY, (uint16_t)(0x8000 | i)); break;
+        }
+    }
+}
+
+// DiffSnapshots contra a referência escalar: tamanhos fora do múltiplo de
+// 4, 0/25/100% de mudança e prev maior ou menor que cur
+static uint32_t CheckSnapshotDiff() {
+    static EntitySnapshot prev;
+    static EntitySnapshot cur;
+    static uint8_t dirty[SNAPSHOT_MAX_ENTITIES];
+    static EntitySnapshot extra;
+    static EntitySnapshot empty;
+    static uint8_t expected[SNAPSHOT_MAX_ENTITIES];
+
+    auto copy = [&](uint32_t i, const EntitySnapshot& from) {
+        cur.id[i] = from.id[i];
+        cur.posX[i] = from.posX[i];
+        cur.posY[i] = from.posY[i];
+        cur.posZ[i] = from.posZ[i];
+        cur.hp[i] = from.hp[i];
+        cur.hpMax[i] = from.hpMax[i];
+        cur.flags[i] = from.flags[i];
+        cur.state[i] = from.state[i];
+    };
+
+    const uint32_t counts[] = { 1, 2, 3, 4, 5, 7, 10, 255, 257, 1000, 1021, SNAPSHOT_MAX_ENTITIES };
+    const float rates[] = { 0.0f, 0.25f, 1.0f };
+    uint32_t rng = 0x5A17C0DEu;
+    uint32_t failures = 0;
+
+    for (uint32_t count : counts) {
+        for (float rate : rates) {
+            for (int32_t shift = -3; shift <= 3; shift += 3) {
+                uint32_t prevCount = (uint32_t)std::max<int32_t>(1, std::min<int32_t>((int32_t)count + shift,
+                                                                                     (int32_t)SNAPSHOT_MAX_ENTITIES));
+                // cur = prev com count entidades: as de sobra saem, as que faltam entram
+                FillEntitySnapshot(prev, prevCount, rng);
+                FillEntitySnapshot(extra, count, rng);
+                memcpy(&cur, &prev, sizeof(cur));
+                for (uint32_t i = prevCount; i < count; i++) copy(i, extra);
+                for (uint32_t i = count; i < prevCount; i++) copy(i, empty);
+                uint32_t common = std::min(prevCount, count);
+                cur.count = count;
+                MutateEntitySnapshot(cur, rate, rng);
+
+                memset(dirty, 0xEE, sizeof(dirty));
+                uint32_t dirtyCount = DiffSnapshots(prev, cur, dirty);
+                uint32_t expectedCount = ScalarDiffSnapshots(prev, cur, expected);
+                bool ok = dirtyCount == expectedCount && !memcmp(dirty, expected, count);
+                for (uint32_t i = count; i < SNAPSHOT_MAX_ENTITIES && ok; i++) ok = dirty[i] == 0xEE;   // Nada além de count
+                if (rate == 0.0f) ok = ok && expectedCount == (count > common ? count - common : 0);
+                if (!ok) {
+                    printf("  DiffSnapshots ERRADO: %u entidades (prev %u), %.0f%% mudando: %u sujas, esperado %u\n",
+                           count, prevCount, rate * 100.0f, dirtyCount, expectedCount);
+                    failures++;
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+// Players ligados e slots do EmMgr para chegar a total entidades no snapshot
+static void SetSnapshotScene(MockGame& game, uint32_t total) {
+    uint16_t players = (uint16_t)std::min<uint32_t>(total, COOP_MAX_PLAYERS);
+    for (uint16_t slot = 0; slot < COOP_MAX_PLAYERS; slot++) {
+        CoopMod::BindPlayerSlot(slot, slot < players ? game.SlotSource(slot) : nullptr, (PlayerCharacter)slot);
+    }
+    uint32_t slots = 0;
+    while (slots - slots / 8 < total - players) slots++;
+    game.SetEnemyCount(slots);
+    EntityCache::Instance().Refresh();
+}
+
+// Capture() de um jogo que anda confere com o jogo e com o diff escalar
+static uint32_t CheckSnapshotCapture(MockGame& game, SnapshotExtractor& extractor) {
+    static uint8_t expected[SNAPSHOT_MAX_ENTITIES];
+    uint32_t failures = 0;
+
+    SetSnapshotScene(game, 1000);
+    extractor.Reset();
+    for (uint64_t frame = 1; frame <= 120; frame++) {
+        game.Step(frame, 0);
+        EntityCache::Instance().Refresh();
+        extractor.Capture();
+
+        const EntitySnapshot& cur = extractor.Current();
+        uint32_t expectedCount = ScalarDiffSnapshots(extractor.Previous(), cur, expected);
+        bool ok = cur.count == 1000 && extractor.DirtyCount() == expectedCount &&
+                  !memcmp(extractor.Dirty(), expected, cur.count);
+        if (frame == 1) ok = ok && expectedCount == cur.count;     // Primeiro snapshot: tudo novo
+        WithGameVersion([&](auto table) {
+            for (uint32_t i = 0; i < cur.count && ok; i++) {
+                EntityState state = EmView(table, cur.entity[i]).Gather();
+                Vec pos = cur.Pos(i);
+                ok = !memcmp(&state.pos, &pos, sizeof(Vec)) && state.hp == cur.hp[i] && state.flags == cur.flags[i];
+            }
+        });
+        if (!ok) {
+            printf("  Capture ERRADO no frame %llu: %u entidades, %u sujas (escalar %u)\n", (unsigned long long)frame,
+                   cur.count, extractor.DirtyCount(), expectedCount);
+            failures++;
+            break;
+        }
+    }
+    return failures;
+}
+
+int RunSnapshotBench() {
+    static MockGame game;               // Um só: o EntityCache guarda a faixa da imagem
+    static SnapshotExtractor extractor;
+    static LegacySnapshotScan legacy;
+    static EntitySnapshot prev;
+    static EntitySnapshot cur;
+    static uint8_t dirty[SNAPSHOT_MAX_ENTITIES];
+
+    if (!game.Create(HARNESS_SNAPSHOT_SLOTS)) {
+        printf("[HARNESS] Falha ao alocar a memória do jogo falso\n");
+        return 1;
+    }
+    SelectGameVersion(GameVersion::V1_1_0);     // O resto do Initialize não é preciso
+
+    printf("[SNAPSHOT] Extração SoA + máscaras sujas contra o jogo falso\n");
+    uint32_t failures = CheckSnapshotDiff();
+    failures += CheckSnapshotCapture(game, extractor);
+    printf("  %s\n\n", failures ? "máscaras ERRADAS" : "DiffSnapshots (SSE2) e Capture iguais à referência escalar");
+
+    auto time = [](uint32_t rounds, auto&& body) {
+        double best = 1e30;
+        for (uint32_t trial = 0; trial < 5; trial++) {
+            uint64_t start = HarnessNanos();
+            for (uint32_t round = 0; round < rounds; round++) body();
+            double ns = (double)(HarnessNanos() - start) / rounds;
+            if (ns < best) best = ns;
+        }
+        return best;
+    };
+
+    printf("  %-9s %11s %10s %10s %10s %12s %9s   (ns por tick; diff com 25%% mudando)\n", "entidades", "Capture",
+           "por ent.", "diff SSE2", "escalar", "AoS antigo", "sujas");
+    const uint32_t totals[] = { 1, 10, 100, 250, 500, 1000 };
+    uint32_t rng = 0xC0FFEEu;
+    volatile uint32_t sink = 0;
+
+    for (uint32_t total : totals) {
+        SetSnapshotScene(game, total);
+        uint32_t rounds = 400000 / total + 100;
+
+        // Sujas por tick com o jogo andando (1 em 4 inimigos, Leon e extras)
+        extractor.Reset();
+        extractor.Capture();
+        uint64_t dirtySum = 0;
+        for (uint64_t frame = 1; frame <= 60; frame++) {
+            game.Step(frame, 0);
+            EntityCache::Instance().Refresh();
+            dirtySum += extractor.Capture().count ? extractor.DirtyCount() : 0;
+        }
+
+        // Mundo parado: custo fixo de ler e comparar (o diff não tem ramo por mudança)
+        double capture = time(rounds, [&] { sink = sink + extractor.Capture().count; });
+        legacy.count = 0;
+        legacy.Scan();
+        double aos = time(rounds, [&] { sink = sink + legacy.Scan(); });
+
+        FillEntitySnapshot(prev, total, rng);
+        memcpy(&cur, &prev, sizeof(cur));
+        MutateEntitySnapshot(cur, 0.25f, rng);
+        double simd = time(rounds, [&] { sink = sink + DiffSnapshots(prev, cur, dirty); });
+        double scalar = time(rounds, [&] { sink = sink + ScalarDiffSnapshots(prev, cur, dirty); });
+
+        printf("  %-9u %11.0f %10.2f %10.0f %10.0f %12.0f %9.1f\n", extractor.Current().count, capture,
+               capture / total, simd, scalar, aos, (double)dirtySum / 60.0);
+    }
+
+    game.Destroy();
+    printf("\n  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
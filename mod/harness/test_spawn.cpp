@@ -0,0 +1,112 @@
+/**
+ * RE4 CO-OP MOD - Harness: Pontos Seguros (--spawn)
+ *
+ * Monta o índice de pontos seguros de uma sala sintética (dois andares,
+ * buracos e paredes), grava/lê do disco e mede consultas.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// PONTOS SEGUROS
+//=============================================================================
+
+constexpr uint16_t HARNESS_SPAWN_ROOM = 0xFFFE;
+constexpr uint32_t HARNESS_SPAWN_QUERIES = 200000;
+
+// Sala de 80 x 80 m: chão em y = 0 com buracos e paredes, mezanino em y = 450
+static uint32_t SyntheticFloors(float x, float z, float* floors, uint32_t max, void*) {
+    uint32_t n = 0;
+
+    bool wall = fmodf(x + 8000.0f, 1600.0f) < 60.0f && fmodf(z + 8000.0f, 800.0f) > 200.0f;
+    float px = roundf(x / 1000.0f) * 1000.0f, pz = roundf(z / 1000.0f) * 1000.0f;
+    bool pit = (x - px) * (x - px) + (z - pz) * (z - pz) < 150.0f * 150.0f && ((int)(px + pz) / 1000) % 3 == 0;
+    if (!wall && !pit && n < max) floors[n++] = 0.0f;
+
+    if (x > -2000.0f && x < 1500.0f && z > 500.0f && z < 1800.0f && n < max) floors[n++] = 450.0f;
+    return n;
+}
+
+int RunSpawnBench() {
+    static SafeSpawnIndex spawns;
+    static Vec queries[HARNESS_SPAWN_QUERIES];
+
+    char path[MAX_PATH];
+    char file[64];
+    snprintf(file, sizeof(file), SPAWN_CACHE_FORMAT, HARNESS_SPAWN_ROOM);
+    CoopDataPath(file, path);
+    remove(path);
+
+    // Entrada na sala sem cache: varredura com a sonda
+    spawns.SetFloorProbe(SyntheticFloors, nullptr);
+    uint64_t t0 = HarnessNanos();
+    spawns.EnterRoom(HARNESS_SPAWN_ROOM);
+    uint32_t built = spawns.BuildFromProbe({ -4000.0f, 0.0f, -4000.0f }, { 4000.0f, 0.0f, 4000.0f });
+    uint64_t t1 = HarnessNanos();
+    spawns.Save();
+    uint64_t t2 = HarnessNanos();
+
+    // Próxima entrada: direto do disco
+    spawns.Clear();
+    uint64_t t3 = HarnessNanos();
+    bool loaded = spawns.Load();
+    uint64_t t4 = HarnessNanos();
+    if (!loaded || spawns.Count() != built) {
+        printf("[SPAWN] Cache não voltou igual (%u de %u pontos)\n", spawns.Count(), built);
+        return 1;
+    }
+
+    uint32_t rng = 0x2545F491u;
+    for (uint32_t i = 0; i < HARNESS_SPAWN_QUERIES; i++) {
+        queries[i] = { HarnessRandom(rng) * 8000.0f - 4000.0f, HarnessRandom(rng) < 0.2f ? 450.0f : 0.0f,
+                       HarnessRandom(rng) * 8000.0f - 4000.0f };
+    }
+
+    LatencyStats queryStats("SafeSpawnIndex::Nearest");
+    uint32_t found = 0;
+    Vec spot;
+    for (uint32_t i = 0; i < HARNESS_SPAWN_QUERIES; i++) {
+        uint64_t q0 = HarnessNanos();
+        found += spawns.Nearest(queries[i], SPAWN_SEARCH_RADIUS, spot);
+        queryStats.Record(HarnessNanos() - q0);
+    }
+
+    // Confere uma amostra contra a busca linear
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < HARNESS_SPAWN_QUERIES; i += 64) {
+        const Vec& q = queries[i];
+        float bestSq = SPAWN_SEARCH_RADIUS * SPAWN_SEARCH_RADIUS;
+        bool any = false;
+        for (uint32_t k = 0; k < spawns.Count(); k++) {
+            Vec p = spawns.Point(k);
+            if (fabsf(p.y - q.y) > SPAWN_FLOOR_TOLERANCE) continue;
+            float d = (p.x - q.x) * (p.x - q.x) + (p.z - q.z) * (p.z - q.z);
+            if (d < bestSq) { bestSq = d; any = true; }
+        }
+        bool hit = spawns.Nearest(q, SPAWN_SEARCH_RADIUS, spot);
+        float d = (spot.x - q.x) * (spot.x - q.x) + (spot.z - q.z) * (spot.z - q.z);
+        if (hit != any || (hit && fabsf(d - bestSq) > 1.0f)) mismatches++;
+    }
+
+    // Rastro: um ponto por chamada, a maioria já coberta
+    LatencyStats trailStats("SafeSpawnIndex::AddPoint");
+    for (uint32_t i = 0; i < 20000; i++) {
+        uint64_t q0 = HarnessNanos();
+        spawns.AddPoint(queries[i]);
+        trailStats.Record(HarnessNanos() - q0);
+    }
+
+    printf("[SPAWN] Sala sintética 80 x 80 m, dois andares: %u pontos\n", built);
+    printf("  Varredura (sonda):      %.2f ms\n", (double)(t1 - t0) / 1e6);
+    printf("  Gravação em disco:      %.2f ms\n", (double)(t2 - t1) / 1e6);
+    printf("  Leitura do cache:       %.2f ms\n\n", (double)(t4 - t3) / 1e6);
+    printf("  %-22s %10s  %8s %8s %8s %8s %8s %10s\n", "ns por chamada", "amostras",
+           "média", "p50", "p90", "p99", "p99.9", "máx");
+    queryStats.Print();
+    trailStats.Print();
+    printf("\n  Consultas com ponto:    %.1f%%, divergências da busca linear: %u\n",
+           100.0 * found / HARNESS_SPAWN_QUERIES, mismatches);
+
+    remove(path);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+/**
+ * RE4 CO-OP MOD - Harness: Tick Fixo (--tick)
+ *
+ * Roda 30 s do CoopMod a 30, 60, 144 e 20-200 FPS com o P2 segurando o
+ * analógico: ticks, ticks de rede e posição final da Ashley têm que sair
+ * iguais; e uma hora de scheduler a 30/60/144 ticks/s sem ganhar nem
+ * perder tick.
+ */
+
+#include "coop_harness.h"
+
+//=============================================================================
+// TICK FIXO
+//=============================================================================
+
+constexpr uint64_t HARNESS_TICK_SECONDS = 30;
+constexpr uint64_t HARNESS_TICK_DRIFT_SECONDS = 3600;
+
+// Frames que somam exatamente seconds: fps fixo (frame i dura a diferença
+// entre os instantes inteiros i e i+1) ou variável entre 20 e 200 FPS
+template<typename FrameFn>
+static uint64_t RunFrames(uint64_t seconds, uint32_t fps, FrameFn&& frame) {
+    uint64_t total = seconds * 1000000ull;
+    uint64_t elapsed = 0;
+    uint64_t frames = 0;
+    uint32_t rng = 0x7153;
+    while (elapsed < total) {
+        uint64_t next = fps ? (frames + 1) * 1000000ull / fps
+                            : elapsed + 5000 + (uint64_t)(HarnessRandom(rng) * 45000.0f);
+        if (next > total) next = total;
+        frame(next - elapsed);
+        elapsed = next;
+        frames++;
+    }
+    return frames;
+}
+
+struct TickRun {
+    uint64_t frames;
+    uint64_t ticks;
+    uint32_t netTicks;
+    uint64_t netGapMin;
+    uint64_t netGapMax;
+    Vec ashley;
+};
+
+static TickRun* s_TickRun = nullptr;
+static uint64_t s_TickLastNet = 0;
+
+static void CountNetworkTick() {
+    uint64_t tick = CoopMod::GetSimTick();
+    if (s_TickRun->netTicks) {
+        uint64_t gap = tick - s_TickLastNet;
+        s_TickRun->netGapMin = std::min(s_TickRun->netGapMin, gap);
+        s_TickRun->netGapMax = std::max(s_TickRun->netGapMax, gap);
+    }
+    s_TickLastNet = tick;
+    s_TickRun->netTicks++;
+}
+
+// CoopMod de verdade (P2 segurando o analógico) a um FPS qualquer. O jogo
+// falso é o mesmo em todas as rodadas (a imagem não muda de lugar no jogo
+// e o EntityCache guarda a faixa dela); a Ashley volta para o começo.
+static bool RunCoopAtFps(MockGame& game, uint32_t fps, TickRun& run) {
+    EmView(Table(), game.Ashley()).SetPos({ 100.0f, 0.0f, 0.0f });
+    if (!CoopMod::Initialize()) return false;
+    g_CoopConfig.enabled = true;
+    g_CoopConfig.teleportIfTooFar = false;
+
+    run = {};
+    run.netGapMin = UINT64_MAX;
+    s_TickRun = &run;
+    CoopMod::SetNetworkTickHandler(CountNetworkTick);
+
+    run.frames = RunFrames(HARNESS_TICK_SECONDS, fps, [&](uint64_t micros) {
+        g_P2_Input.connected = true;
+        g_P2_Input.moveX = 0.6f;
+        g_P2_Input.moveY = -0.8f;
+        CoopMod::Advance(micros);
+    });
+    run.ticks = CoopMod::GetSimTick();
+    run.ashley = EmView(Table(), game.Ashley()).Pos();
+
+    CoopMod::SetNetworkTickHandler(nullptr);
+    CoopMod::Shutdown();
+    s_TickRun = nullptr;
+    return true;
+}
+
+int RunTickBench() {
+    uint32_t failures = 0;
+    const uint32_t rates[] = { 30, 60, 144, 0 };
+
+    printf("[TICK] %llu s de jogo a %u ticks/s, replicação a cada %u ticks\n\n",
+           (unsigned long long)HARNESS_TICK_SECONDS, CoopConfig().tickRate, CoopConfig().netSendInterval);
+    printf("  %-10s %8s %8s %8s %10s %24s\n", "FPS", "frames", "ticks", "rede", "intervalo", "Ashley (x, z)");
+
+    MockGame game;
+    if (!game.Create(16)) {
+        printf("[HARNESS] Falha ao alocar a memória do jogo falso\n");
+        return 1;
+    }
+
+    TickRun reference = {};
+    for (uint32_t fps : rates) {
+        TickRun run;
+        if (!RunCoopAtFps(game, fps, run)) {
+            printf("[HARNESS] CoopMod::Initialize falhou\n");
+            game.Destroy();
+            return 1;
+        }
+
+        char name[16];
+        if (fps) snprintf(name, sizeof(name), "%u", fps);
+        else snprintf(name, sizeof(name), "20-200");
+        printf("  %-10s %8llu %8llu %8u %5llu-%-4llu %11.3f, %11.3f\n", name, (unsigned long long)run.frames,
+               (unsigned long long)run.ticks, run.netTicks, (unsigned long long)run.netGapMin,
+               (unsigned long long)run.netGapMax, run.ashley.x, run.ashley.z);
+
+        // Mesma sequência de ticks = mesmo estado, bit a bit
+        if (fps == rates[0]) reference = run;
+        bool same = run.ticks == HARNESS_TICK_SECONDS * CoopConfig().tickRate && run.ticks == reference.ticks &&
+                    run.netTicks == reference.netTicks && run.netGapMin == CoopConfig().netSendInterval &&
+                    run.netGapMax == CoopConfig().netSendInterval &&
+                    !memcmp(&run.ashley, &reference.ashley, sizeof(Vec));
+        if (!same) failures++;
+    }
+    game.Destroy();
+
+    // Deriva do acumulador: uma hora a 60 FPS para várias taxas de tick
+    printf("\n  Uma hora a 60 FPS:\n");
+    for (uint32_t rate : { 30u, 60u, 144u }) {
+        FixedTickScheduler scheduler(rate);
+        RunFrames(HARNESS_TICK_DRIFT_SECONDS, 60, [&](uint64_t micros) {
+            scheduler.Advance(micros, [](uint64_t, float) {});
+        });
+        uint64_t expected = HARNESS_TICK_DRIFT_SECONDS * rate;
+        printf("    %3u ticks/s: %llu ticks (esperado %llu), descartado %llu us\n", rate,
+               (unsigned long long)scheduler.TickIndex(), (unsigned long long)expected,
+               (unsigned long long)scheduler.DroppedMicros());
+        if (scheduler.TickIndex() != expected) failures++;
+    }
+
+    printf("\n  Falhas: %u\n", failures);
+    return failures ? 1 : 0;
+}
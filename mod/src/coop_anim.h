@@ -0,0 +1,213 @@
+/**
+ * RE4 CO-OP MOD - Replicação de Animação
+ *
+ * Mandar só o id da animação deixa o outro lado com a fase e o blend
+ * errados (recarga, faca e QTE ficam visivelmente fora de sincronia).
+ * Mandar a fase todo tick custa banda à toa, porque entre duas mudanças
+ * ela só anda em linha reta. Aqui o host manda uma AnimKey (id, fase,
+ * velocidade, blend e o instante disso no relógio do host) só quando:
+ *
+ * - A animação troca (id ou loop) ou muda de velocidade
+ * - A fase ou o blend real se afastam do que o cliente vai prever
+ * - A chave fica velha demais para o carimbo de 16 bits
+ *
+ * Entre chaves os dois lados rodam PredictAnim() com o relógio do host
+ * (no cliente, via ClockSync), então a fase continua certa sem pacote.
+ *
+ *   AnimKeyEncoder encoder;                         // Host, um por slot
+ *   encoder.Update(sample, CoopClockMicros32(), player.anim);
+ *   AnimPose pose = PredictAnim(player.anim, clock.RemoteMicros(CoopClockMicros32()));
+ *
+ * No mod isto só liga com ANIM_REPLICATION: por enquanto só o harness
+ * (--anim) usa o codec e a previsão.
+ */
+
+#pragma once
+#include "coop_schema.h"
+#include <cmath>
+#include <cstdint>
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+constexpr uint32_t ANIM_PHASE_BITS = 12;                // 1/4096 de ciclo
+constexpr uint32_t ANIM_RATE_BITS = 12;
+constexpr int32_t ANIM_RATE_MAX = 8;                    // Ciclos por segundo (clipe de 125 ms)
+constexpr uint32_t ANIM_STAMP_SHIFT = 10;               // Carimbo em unidades de 1.024 ms
+
+// Quando a previsão erra mais que isso, vai chave nova
+constexpr float ANIM_PHASE_TOLERANCE = 0.004f;          // Segundos de animação (1/4 de frame)
+constexpr float ANIM_BLEND_TOLERANCE = 1.0f / 32.0f;
+constexpr float ANIM_RATE_TOLERANCE = 0.02f;            // Velocidade mudou 2%: a fase vai divergir
+constexpr uint32_t ANIM_KEY_REFRESH_MICROS = 30000000;  // Carimbo de 16 bits dá a volta em 67 s
+
+// O offset do cMot (id, fase, velocidade, blend) ainda não foi mapeado e o
+// cliente não aplica pose no player remoto: sem isso o host só mandaria
+// chaves zeradas. Desligado, o campo anim do GAME_STATE fica zerado (e o
+// delta não o manda). Liga junto com a leitura e a aplicação.
+constexpr bool ANIM_REPLICATION = false;
+
+enum AnimKeyFlags : uint8_t {
+    ANIM_LOOP = 1 << 0,         // Fase dá a volta em 1; sem isso para no último frame
+};
+
+//=============================================================================
+// CHAVE (formato no fio, já quantizado)
+//=============================================================================
+
+#pragma pack(push, 1)
+struct AnimKey {
+    uint16_t id;
+    uint16_t phase;             // Fase normalizada em ANIM_PHASE_BITS
+    uint16_t rate;              // Ciclos/s em ANIM_RATE_BITS sobre [0, ANIM_RATE_MAX]
+    uint8_t blend;              // Peso da animação atual (0-255)
+    uint8_t blendSpeed;         // Peso/s em 1/16 (0-255 = 0 a ~16/s)
+    uint8_t flags;
+    uint16_t stamp;             // Relógio do host >> ANIM_STAMP_SHIFT (16 bits baixos)
+};
+#pragma pack(pop)
+
+// O que o jogo mostra agora (lido do player no host)
+struct AnimSample {
+    uint16_t id;
+    float phase;                // 0.0 a 1.0
+    float rate;                 // Ciclos por segundo (1 / duração do clipe)
+    float blend;                // 0.0 a 1.0
+    float blendSpeed;           // Peso por segundo (crossfade em andamento)
+    bool loop;
+};
+
+// Resultado da previsão (o que aplicar no player remoto)
+struct AnimPose {
+    uint16_t id;
+    float phase;
+    float blend;
+};
+
+using AnimPhaseCodec = QuantFloat<0, 1, ANIM_PHASE_BITS>;
+using AnimRateCodec = QuantFloat<0, ANIM_RATE_MAX, ANIM_RATE_BITS>;
+
+inline uint16_t AnimStamp(uint32_t hostMicros) {
+    return (uint16_t)(hostMicros >> ANIM_STAMP_SHIFT);
+}
+
+//=============================================================================
+// PREVISÃO (igual nos dois lados)
+//=============================================================================
+
+inline AnimPose PredictAnim(const AnimKey& key, uint32_t hostMicros) {
+    // Idade da chave; carimbo no futuro (relógio ainda convergindo) = 0
+    uint16_t ticks = (uint16_t)(AnimStamp(hostMicros) - key.stamp);
+    float age = ticks < 0x8000 ? (float)ticks * (float)(1u << ANIM_STAMP_SHIFT) * 1e-6f : 0.0f;
+
+    float phase = AnimPhaseCodec::Dequantize(key.phase) + AnimRateCodec::Dequantize(key.rate) * age;
+    if (key.flags & ANIM_LOOP) phase -= floorf(phase);
+    else if (phase > 1.0f) phase = 1.0f;
+
+    float blend = key.blend / 255.0f + key.blendSpeed / 16.0f * age;
+
+    AnimPose pose;
+    pose.id = key.id;
+    pose.phase = phase;
+    pose.blend = blend < 1.0f ? blend : 1.0f;
+    return pose;
+}
+
+// Distância entre fases em ciclos (com volta, para animação em loop)
+inline float AnimPhaseDistance(float a, float b, bool loop) {
+    float d = fabsf(a - b);
+    return loop && d > 0.5f ? 1.0f - d : d;
+}
+
+//=============================================================================
+// CODEC DO SCHEMA
+//=============================================================================
+
+struct AnimKeyCodec {
+    static constexpr uint32_t BITS = 16 + ANIM_PHASE_BITS + ANIM_RATE_BITS + 8 + 8 + 1 + 16;
+
+    static void Write(BitWriter& w, const AnimKey& k) {
+        w.Write(k.id, 16);
+        w.Write(k.phase, ANIM_PHASE_BITS);
+        w.Write(k.rate, ANIM_RATE_BITS);
+        w.Write(k.blend, 8);
+        w.Write(k.blendSpeed, 8);
+        w.Write(k.flags, 1);
+        w.Write(k.stamp, 16);
+    }
+
+    static void Read(BitReader& r, AnimKey& k) {
+        k.id = (uint16_t)r.Read(16);
+        k.phase = (uint16_t)r.Read(ANIM_PHASE_BITS);
+        k.rate = (uint16_t)r.Read(ANIM_RATE_BITS);
+        k.blend = (uint8_t)r.Read(8);
+        k.blendSpeed = (uint8_t)r.Read(8);
+        k.flags = (uint8_t)r.Read(1);
+        k.stamp = (uint16_t)r.Read(16);
+    }
+
+    // Chave só muda quando o host manda outra: no delta custa 1 bit parada
+    static bool Same(const AnimKey& a, const AnimKey& b) {
+        return a.id == b.id && a.phase == b.phase && a.rate == b.rate && a.blend == b.blend &&
+               a.blendSpeed == b.blendSpeed && a.flags == b.flags && a.stamp == b.stamp;
+    }
+
+    static bool Valid(const AnimKey& k) {
+        return (k.phase >> ANIM_PHASE_BITS) == 0 && (k.rate >> ANIM_RATE_BITS) == 0 && k.flags <= ANIM_LOOP;
+    }
+};
+
+//=============================================================================
+// HOST: QUANDO MANDAR CHAVE NOVA
+//=============================================================================
+
+class AnimKeyEncoder {
+public:
+    void Reset() { m_hasKey = false; }
+
+    // Atualiza key se a previsão da chave atual não serve mais.
+    // Retorna true quando trocou (descontinuidade).
+    bool Update(const AnimSample& sample, uint32_t hostMicros, AnimKey& key) {
+        if (m_hasKey && !NeedsKey(sample, hostMicros)) {
+            key = m_key;
+            return false;
+        }
+
+        float blendSpeed = sample.blendSpeed * 16.0f + 0.5f;
+        m_key.id = sample.id;
+        m_key.phase = (uint16_t)AnimPhaseCodec::Quantize(sample.phase);
+        m_key.rate = (uint16_t)AnimRateCodec::Quantize(sample.rate);
+        m_key.blend = (uint8_t)(sample.blend <= 0.0f ? 0 : sample.blend >= 1.0f ? 255 : sample.blend * 255.0f + 0.5f);
+        m_key.blendSpeed = (uint8_t)(blendSpeed <= 0.0f ? 0 : blendSpeed >= 255.0f ? 255 : blendSpeed);
+        m_key.flags = sample.loop ? ANIM_LOOP : 0;
+        m_key.stamp = AnimStamp(hostMicros);
+        m_keyMicros = hostMicros;
+        m_hasKey = true;
+
+        key = m_key;
+        return true;
+    }
+
+private:
+    bool NeedsKey(const AnimSample& sample, uint32_t hostMicros) const {
+        if (sample.id != m_key.id || sample.loop != ((m_key.flags & ANIM_LOOP) != 0)) return true;
+        if (hostMicros - m_keyMicros > ANIM_KEY_REFRESH_MICROS) return true;
+
+        // Mudança de velocidade vai já, antes de a fase acumular erro
+        float rate = AnimRateCodec::Dequantize(m_key.rate);
+        if (fabsf(sample.rate - rate) > ANIM_RATE_TOLERANCE * (rate > 0.1f ? rate : 0.1f)) return true;
+
+        AnimPose predicted = PredictAnim(m_key, hostMicros);
+        if (fabsf(predicted.blend - sample.blend) > ANIM_BLEND_TOLERANCE) return true;
+
+        // Erro em segundos de animação; parada, qualquer passo de quantização
+        float error = AnimPhaseDistance(predicted.phase, sample.phase, sample.loop);
+        float tolerance = sample.rate * ANIM_PHASE_TOLERANCE;
+        return error > (tolerance > 2.0f / 4096.0f ? tolerance : 2.0f / 4096.0f);
+    }
+
+    AnimKey m_key = {};
+    uint32_t m_keyMicros = 0;
+    bool m_hasKey = false;
+};
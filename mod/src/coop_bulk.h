@@ -0,0 +1,276 @@
+/**
+ * RE4 CO-OP MOD - Canal de Transferência em Massa (estado da sala)
+ *
+ * Quando o host troca de sala, o cliente precisa do estado inteiro da
+ * sala nova (inimigos, itens, portas) antes de poder jogar. Mandar isso
+ * pelo caminho de tempo real travaria input e GAME_STATE, então:
+ *
+ * - O estado é dividido em chunks com CRC32 próprio
+ * - O host só libera chunks quando a fila de tempo real está vazia, com
+ *   um orçamento fixo por tick de rede
+ * - O cliente aplica cada chunk assim que ele chega (não espera o fim)
+ * - Chunk corrompido ou faltando vira NACK e é reenviado
+ */
+
+#pragma once
+#include "coop_core.h"
+#include "coop_tick.h"
+#include <cstring>
+
+//=============================================================================
+// FORMATO
+//=============================================================================
+
+#pragma pack(push, 1)
+
+// Tipos de registro do estado da sala
+enum class RoomRecordKind : uint8_t {
+    PLAYER = 0x01,
+    ENEMY = 0x02,
+    ITEM = 0x03,
+    DOOR = 0x04,
+};
+
+// Um registro por entidade
+struct RoomEntityRecord {
+    RoomRecordKind kind;
+    uint8_t reserved;
+    uint16_t index;         // Índice da entidade (slot do player, índice no EmMgr, ...)
+    Vec pos;
+    int16_t hp;
+    int16_t hpMax;
+    uint32_t flags;
+};
+
+// Cabeçalho de cada chunk (vai depois do PacketHeader)
+struct BulkChunkHeader {
+    uint16_t transferId;    // Muda a cada troca de sala
+    uint16_t roomId;
+    uint16_t chunkIndex;
+    uint16_t chunkCount;
+    uint16_t recordCount;   // Registros neste chunk
+    uint32_t crc;           // CRC32 dos registros
+};
+
+#pragma pack(pop)
+
+// Registros por chunk (chunk inteiro cabe num buffer do PacketPool)
+constexpr uint32_t BULK_RECORDS_PER_CHUNK = 10;
+
+// Maior sala suportada
+constexpr uint32_t BULK_MAX_RECORDS = 1024;
+constexpr uint32_t BULK_MAX_CHUNKS = (BULK_MAX_RECORDS + BULK_RECORDS_PER_CHUNK - 1) / BULK_RECORDS_PER_CHUNK;
+
+//=============================================================================
+// CRC32 (polinômio IEEE, tabela gerada em compile-time)
+//=============================================================================
+
+struct Crc32Table {
+    uint32_t entries[256];
+
+    constexpr Crc32Table() : entries() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[i] = c;
+        }
+    }
+};
+
+inline uint32_t Crc32(const void* data, size_t size) {
+    static constexpr Crc32Table table;
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc = table.entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+//=============================================================================
+// LADO DO HOST
+//=============================================================================
+
+// Usado só pela thread do jogo
+class BulkTransferSender {
+public:
+    // Começa a transferir uma sala nova (descarta a anterior, se houver)
+    void Begin(uint16_t roomId, const RoomEntityRecord* records, uint32_t count) {
+        if (count > BULK_MAX_RECORDS) count = BULK_MAX_RECORDS;
+
+        memcpy(m_records, records, count * sizeof(RoomEntityRecord));
+        m_recordCount = count;
+        m_roomId = roomId;
+        m_transferId++;
+        m_chunkCount = (uint16_t)((count + BULK_RECORDS_PER_CHUNK - 1) / BULK_RECORDS_PER_CHUNK);
+        if (m_chunkCount == 0) m_chunkCount = 1;    // Sala vazia ainda manda 1 chunk
+        m_nextChunk = 0;
+        m_resendHead = m_resendTail = 0;
+    }
+
+    bool HasPending() const {
+        return m_nextChunk < m_chunkCount || m_resendHead != m_resendTail;
+    }
+
+    // Preenche o próximo chunk (reenvios têm prioridade).
+    // out precisa ter espaço para BULK_RECORDS_PER_CHUNK registros.
+    bool NextChunk(BulkChunkHeader& header, RoomEntityRecord* out) {
+        uint16_t index;
+        if (m_resendHead != m_resendTail) {
+            index = m_resend[m_resendHead % RESEND_CAPACITY];
+            m_resendHead++;
+        }
+        else if (m_nextChunk < m_chunkCount) {
+            index = m_nextChunk++;
+        }
+        else {
+            return false;
+        }
+
+        uint32_t first = index * BULK_RECORDS_PER_CHUNK;
+        uint32_t count = m_recordCount > first ? m_recordCount - first : 0;
+        if (count > BULK_RECORDS_PER_CHUNK) count = BULK_RECORDS_PER_CHUNK;
+
+        memcpy(out, &m_records[first], count * sizeof(RoomEntityRecord));
+
+        header.transferId = m_transferId;
+        header.roomId = m_roomId;
+        header.chunkIndex = index;
+        header.chunkCount = m_chunkCount;
+        header.recordCount = (uint16_t)count;
+        header.crc = Crc32(out, count * sizeof(RoomEntityRecord));
+        return true;
+    }
+
+    // NACK do cliente. Retorna false se o pedido é de outra transferência.
+    bool Resend(uint16_t transferId, uint16_t chunkIndex) {
+        if (transferId != m_transferId || chunkIndex >= m_chunkCount) return false;
+        if (m_resendTail - m_resendHead >= RESEND_CAPACITY) return false;
+
+        m_resend[m_resendTail % RESEND_CAPACITY] = chunkIndex;
+        m_resendTail++;
+        return true;
+    }
+
+    uint16_t TransferId() const { return m_transferId; }
+
+private:
+    static constexpr uint32_t RESEND_CAPACITY = 64;
+
+    RoomEntityRecord m_records[BULK_MAX_RECORDS];
+    uint32_t m_recordCount = 0;
+    uint16_t m_roomId = 0;
+    uint16_t m_transferId = 0;
+    uint16_t m_chunkCount = 0;
+    uint16_t m_nextChunk = 0;
+
+    uint16_t m_resend[RESEND_CAPACITY];
+    uint32_t m_resendHead = 0;
+    uint32_t m_resendTail = 0;
+};
+
+//=============================================================================
+// LADO DO CLIENTE
+//=============================================================================
+
+// Chamado para cada chunk válido, na ordem em que chegam
+typedef void (*BulkApplyFn)(uint16_t roomId, const RoomEntityRecord* records, uint32_t count, void* user);
+
+enum class BulkChunkResult : uint8_t {
+    APPLIED,
+    DUPLICATE,
+    STALE,          // Chunk de uma transferência antiga
+    CORRUPT,        // CRC não bate: pedir de novo
+};
+
+// Usado só pela thread do jogo
+class BulkTransferReceiver {
+public:
+    BulkChunkResult OnChunk(const BulkChunkHeader& header, const RoomEntityRecord* records,
+                            BulkApplyFn apply, void* user) {
+        if (header.chunkCount == 0 || header.chunkCount > BULK_MAX_CHUNKS ||
+            header.chunkIndex >= header.chunkCount ||
+            header.recordCount > BULK_RECORDS_PER_CHUNK) {
+            return BulkChunkResult::CORRUPT;
+        }
+
+        if (Crc32(records, header.recordCount * sizeof(RoomEntityRecord)) != header.crc) {
+            return BulkChunkResult::CORRUPT;
+        }
+
+        // Transferência nova substitui a anterior
+        if (!m_active || header.transferId != m_transferId) {
+            if (m_active && (int16_t)(header.transferId - m_transferId) < 0) {
+                return BulkChunkResult::STALE;
+            }
+            StartTransfer(header);
+        }
+
+        uint32_t word = header.chunkIndex / 32;
+        uint32_t bit = 1u << (header.chunkIndex % 32);
+        if (m_received[word] & bit) return BulkChunkResult::DUPLICATE;
+
+        if (apply) apply(m_roomId, records, header.recordCount, user);
+
+        m_received[word] |= bit;
+        m_receivedCount++;
+        m_lastChunkTick = m_tick;
+
+        if (m_receivedCount == m_chunkCount) {
+            m_readyMicros = CoopNowMicros();
+        }
+        return BulkChunkResult::APPLIED;
+    }
+
+    // Chamado a cada tick de rede; preenche até max chunks faltando se a
+    // transferência está parada há stallTicks. Retorna quantos preencheu.
+    uint32_t CollectMissing(uint32_t stallTicks, uint16_t* out, uint32_t max) {
+        m_tick++;
+        if (!m_active || IsReady() || m_tick - m_lastChunkTick < stallTicks) return 0;
+
+        uint32_t n = 0;
+        for (uint16_t i = 0; i < m_chunkCount && n < max; i++) {
+            if (!(m_received[i / 32] & (1u << (i % 32)))) out[n++] = i;
+        }
+        m_lastChunkTick = m_tick;   // Espera de novo antes do próximo NACK
+        return n;
+    }
+
+    bool IsActive() const { return m_active; }
+    bool IsReady() const { return m_active && m_receivedCount == m_chunkCount; }
+    uint16_t RoomId() const { return m_roomId; }
+    uint16_t TransferId() const { return m_transferId; }
+    float Progress() const { return m_chunkCount ? (float)m_receivedCount / m_chunkCount : 0.0f; }
+
+    // Tempo entre o primeiro chunk e a sala completa (0 se ainda não completou)
+    uint64_t RoomReadyMicros() const {
+        return IsReady() ? m_readyMicros - m_startMicros : 0;
+    }
+
+private:
+    void StartTransfer(const BulkChunkHeader& header) {
+        m_active = true;
+        m_transferId = header.transferId;
+        m_roomId = header.roomId;
+        m_chunkCount = header.chunkCount;
+        m_receivedCount = 0;
+        memset(m_received, 0, sizeof(m_received));
+        m_startMicros = CoopNowMicros();
+        m_readyMicros = 0;
+        m_lastChunkTick = m_tick;
+    }
+
+    bool m_active = false;
+    uint16_t m_transferId = 0;
+    uint16_t m_roomId = 0;
+    uint16_t m_chunkCount = 0;
+    uint16_t m_receivedCount = 0;
+    uint32_t m_received[(BULK_MAX_CHUNKS + 31) / 32] = {};
+
+    uint32_t m_tick = 0;
+    uint32_t m_lastChunkTick = 0;
+    uint64_t m_startMicros = 0;
+    uint64_t m_readyMicros = 0;
+};
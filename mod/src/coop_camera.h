@@ -0,0 +1,351 @@
+/**
+ * RE4 CO-OP MOD - Câmera Co-op (enquadramento)
+ *
+ * A cada frame o solver acha o alvo, a distância e o FOV que mantêm todos
+ * os players dentro do quadro:
+ *
+ * - Alvo: centro do grupo (PlayerFraming), na altura do peito
+ * - FOV: o menor que cobre a esfera do grupo (+ margem) na distância
+ *   mínima; passou do FOV máximo, a câmera recua em vez de abrir mais
+ * - Suavização: mola criticamente amortecida em cada valor (chega no
+ *   alvo sem passar dele e sem oscilar, independente do FPS). Se a mola
+ *   atrasada deixaria alguém fora do quadro, FOV/distância abrem só o
+ *   que falta (o grupo anda poucas unidades por frame, então o salto é
+ *   pequeno)
+ * - Visada: se a parede tapa algum player, a câmera sobe em passos até
+ *   ver todos. Cada teste de visada (caro, vai no jogo) fica num cache
+ *   por sala, indexado pelas células de 50 cm da câmera e do player
+ * - Parado: players no mesmo lugar e molas em repouso devolvem o último
+ *   quadro sem recalcular nada
+ *
+ * O teste de visada vem de fora (SetLineOfSight); sem ele tudo é visível.
+ *
+ *   CoopCameraSolver camera;
+ *   const CoopCameraFrame& frame = camera.Solve(players, roomId, yaw, dt);
+ */
+
+#pragma once
+#include "coop_core.h"
+#include "coop_players.h"
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+constexpr float CAMERA_PI = 3.14159265f;
+constexpr float CAMERA_DEG = CAMERA_PI / 180.0f;
+
+constexpr float CAMERA_FOV_MIN = 50.0f * CAMERA_DEG;        // FOV vertical
+constexpr float CAMERA_FOV_MAX = 75.0f * CAMERA_DEG;
+constexpr float CAMERA_DISTANCE_MIN = 350.0f;
+constexpr float CAMERA_DISTANCE_MAX = 3600.0f;              // Grupo espalhado até o limite de teleporte
+constexpr float CAMERA_MARGIN = 120.0f;                     // Folga em volta do grupo
+constexpr float CAMERA_TARGET_HEIGHT = 120.0f;
+constexpr float CAMERA_PITCH = 25.0f * CAMERA_DEG;
+constexpr float CAMERA_PITCH_STEP = 15.0f * CAMERA_DEG;     // Subida quando algo tapa
+constexpr uint32_t CAMERA_PITCH_STEPS = 3;
+constexpr float CAMERA_SMOOTH_TIME = 0.35f;                 // Segundos até ~assentar
+
+// Parado: abaixo disso nada é recalculado
+constexpr float CAMERA_REST_MOVE = 0.5f;
+constexpr float CAMERA_REST_SPEED = 0.5f;
+
+// Cache de visada
+constexpr uint32_t CAMERA_PROBE_SLOTS = 256;                // Potência de 2
+constexpr uint32_t CAMERA_PROBE_WINDOW = 4;                 // Slots tentados por chave
+constexpr float CAMERA_PROBE_CELL = 50.0f;
+
+// true se nada bloqueia o segmento from -> to
+typedef bool (*CameraLineOfSight)(const Vec& from, const Vec& to, void* user);
+
+struct CoopCameraFrame {
+    Vec target;
+    Vec eye;
+    float fovy;             // Radianos
+    float distance;
+    float pitch;
+    uint32_t occludedMask;  // Players sem visada mesmo no passo mais alto
+};
+
+//=============================================================================
+// MOLA CRITICAMENTE AMORTECIDA
+//=============================================================================
+
+// Aproximação de Padé de exp(-omega * dt): estável com qualquer dt
+struct CameraSpring {
+    float value = 0.0f;
+    float velocity = 0.0f;
+
+    void Reset(float to) { value = to; velocity = 0.0f; }
+
+    float Update(float target, float smoothTime, float dt) {
+        float omega = 2.0f / smoothTime;
+        float x = omega * dt;
+        float decay = 1.0f / (1.0f + x + 0.48f * x * x + 0.235f * x * x * x);
+        float change = value - target;
+        float temp = (velocity + omega * change) * dt;
+        velocity = (velocity - omega * temp) * decay;
+        value = target + (change + temp) * decay;
+        return value;
+    }
+};
+
+//=============================================================================
+// CACHE DE VISADA (por sala)
+//=============================================================================
+
+class CameraProbeCache {
+public:
+    void Reset(uint16_t roomId) {
+        memset(m_slots, 0, sizeof(m_slots));
+        m_roomId = roomId;
+    }
+
+    uint16_t RoomId() const { return m_roomId; }
+
+    // Visada do segmento, do cache ou do teste (que então é guardado)
+    bool Visible(const Vec& from, const Vec& to, CameraLineOfSight test, void* user) {
+        if (!test) return true;
+
+        uint64_t key = ProbeKey(from, to);
+        uint32_t home = (uint32_t)key & (CAMERA_PROBE_SLOTS - 1);
+        for (uint32_t i = 0; i < CAMERA_PROBE_WINDOW; i++) {
+            const Probe& probe = m_slots[(home + i) & (CAMERA_PROBE_SLOTS - 1)];
+            if (probe.key == key) {
+                m_hits++;
+                return probe.visible != 0;
+            }
+        }
+
+        bool visible = test(from, to, user);
+        m_misses++;
+
+        // Slot vazio da janela, senão gira entre os da janela
+        uint32_t slot = (home + m_evict++ % CAMERA_PROBE_WINDOW) & (CAMERA_PROBE_SLOTS - 1);
+        for (uint32_t i = 0; i < CAMERA_PROBE_WINDOW; i++) {
+            uint32_t at = (home + i) & (CAMERA_PROBE_SLOTS - 1);
+            if (!m_slots[at].key) { slot = at; break; }
+        }
+        m_slots[slot].key = key;
+        m_slots[slot].visible = visible ? 1 : 0;
+        return visible;
+    }
+
+    uint64_t Hits() const { return m_hits; }
+    uint64_t Misses() const { return m_misses; }
+
+private:
+    struct Probe {
+        uint64_t key;       // 0 = vazio
+        uint8_t visible;
+    };
+
+    static int32_t Cell(float v) { return (int32_t)floorf(v * (1.0f / CAMERA_PROBE_CELL)); }
+
+    // Hash das células das duas pontas (colisão de 64 bits é desprezível aqui)
+    static uint64_t ProbeKey(const Vec& from, const Vec& to) {
+        const int32_t cells[6] = { Cell(from.x), Cell(from.y), Cell(from.z), Cell(to.x), Cell(to.y), Cell(to.z) };
+        uint64_t h = 0xCBF29CE484222325ull;
+        for (int32_t c : cells) {
+            h ^= (uint32_t)c;
+            h *= 0x100000001B3ull;
+            h ^= h >> 29;
+        }
+        return h ? h : 1;
+    }
+
+    Probe m_slots[CAMERA_PROBE_SLOTS];
+    uint16_t m_roomId = 0;
+    uint32_t m_evict = 0;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+};
+
+//=============================================================================
+// SOLVER
+//=============================================================================
+
+class CoopCameraSolver {
+public:
+    CoopCameraSolver() { Reset(); }
+
+    // Próximo Solve salta direto para o enquadramento (troca de sala, corte)
+    void Reset() {
+        m_settled = false;
+        m_hasFrame = false;
+        m_solves = 0;
+        memset(&m_frame, 0, sizeof(m_frame));
+        memset(&m_lastPlayers, 0, sizeof(m_lastPlayers));
+    }
+
+    void SetLineOfSight(CameraLineOfSight test, void* user) {
+        m_lineOfSight = test;
+        m_lineOfSightUser = user;
+    }
+
+    // yaw: direção para onde a câmera olha (radianos, 0 = +Z)
+    const CoopCameraFrame& Solve(const PlayerPositions& players, uint16_t roomId, float yaw, float dt) {
+        if (!players.count) return m_frame;
+
+        if (roomId != m_probes.RoomId()) {
+            m_probes.Reset(roomId);
+            m_hasFrame = false;
+        }
+
+        // Ninguém andou e a câmera já assentou: mesmo quadro
+        if (m_hasFrame && m_settled && yaw == m_lastYaw && !PlayersMoved(players)) {
+            return m_frame;
+        }
+        m_lastPlayers = players;
+        m_lastYaw = yaw;
+        m_solves++;
+
+        // Quadro desejado
+        PlayerFraming framing = ComputePlayerFraming(players);
+        Vec target = framing.center;
+        target.y += CAMERA_TARGET_HEIGHT;
+
+        float fovy, distance;
+        FitGroup(framing.radius + CAMERA_MARGIN, fovy, distance);
+
+        float pitch = CAMERA_PITCH;
+        uint32_t occluded = 0;
+        for (uint32_t step = 0; step <= CAMERA_PITCH_STEPS; step++) {
+            pitch = CAMERA_PITCH + CAMERA_PITCH_STEP * step;
+            occluded = OccludedPlayers(players, EyeFor(target, distance, pitch, yaw));
+            if (!occluded) break;
+        }
+
+        // Corte (primeiro quadro ou sala nova): sem suavizar
+        if (!m_hasFrame) {
+            m_targetX.Reset(target.x);
+            m_targetY.Reset(target.y);
+            m_targetZ.Reset(target.z);
+            m_fovy.Reset(fovy);
+            m_distance.Reset(distance);
+            m_pitch.Reset(pitch);
+            m_hasFrame = true;
+        }
+        else {
+            m_targetX.Update(target.x, CAMERA_SMOOTH_TIME, dt);
+            m_targetY.Update(target.y, CAMERA_SMOOTH_TIME, dt);
+            m_targetZ.Update(target.z, CAMERA_SMOOTH_TIME, dt);
+            m_fovy.Update(fovy, CAMERA_SMOOTH_TIME, dt);
+            m_distance.Update(distance, CAMERA_SMOOTH_TIME, dt);
+            m_pitch.Update(pitch, CAMERA_SMOOTH_TIME, dt);
+        }
+
+        m_frame.target = { m_targetX.value, m_targetY.value, m_targetZ.value };
+        ContainPlayers(players, m_frame.target);
+        m_frame.fovy = m_fovy.value;
+        m_frame.distance = m_distance.value;
+        m_frame.pitch = m_pitch.value;
+        m_frame.eye = EyeFor(m_frame.target, m_frame.distance, m_frame.pitch, yaw);
+        m_frame.occludedMask = occluded;
+
+        m_settled = Settled(target, fovy, distance, pitch);
+        return m_frame;
+    }
+
+    const CoopCameraFrame& Frame() const { return m_frame; }
+    const CameraProbeCache& Probes() const { return m_probes; }
+    uint64_t SolveCount() const { return m_solves; }
+
+private:
+    // FOV e distância para uma esfera de raio radius caber no quadro
+    static void FitGroup(float radius, float& fovy, float& distance) {
+        distance = CAMERA_DISTANCE_MIN;
+        float needed = 2.0f * asinf(fminf(radius / distance, 1.0f));
+        if (needed <= CAMERA_FOV_MAX) {
+            fovy = fmaxf(needed, CAMERA_FOV_MIN);
+            return;
+        }
+        fovy = CAMERA_FOV_MAX;
+        distance = fminf(radius / sinf(CAMERA_FOV_MAX * 0.5f), CAMERA_DISTANCE_MAX);
+    }
+
+    // Alvo suavizado atrás do grupo: garante que a esfera em volta dele
+    // que contém todos os players cabe no quadro
+    void ContainPlayers(const PlayerPositions& players, const Vec& target) {
+        float radiusSq = 0.0f;
+        for (uint32_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+            if (!players.Has(i)) continue;
+            float dx = players.x[i] - target.x;
+            float dy = players.y[i] + CAMERA_TARGET_HEIGHT - target.y;
+            float dz = players.z[i] - target.z;
+            radiusSq = fmaxf(radiusSq, dx * dx + dy * dy + dz * dz);
+        }
+        float radius = sqrtf(radiusSq);
+        
+        // Na distância atual, se der; senão FOV máximo e recua
+        float needed = 2.0f * asinf(fminf(radius / m_distance.value, 1.0f));
+        if (needed <= CAMERA_FOV_MAX) {
+            if (needed > m_fovy.value) m_fovy.value = needed;
+            return;
+        }
+        m_fovy.value = CAMERA_FOV_MAX;
+        m_distance.value = fmaxf(m_distance.value, fminf(radius / sinf(CAMERA_FOV_MAX * 0.5f), CAMERA_DISTANCE_MAX));
+    }
+
+    static Vec EyeFor(const Vec& target, float distance, float pitch, float yaw) {
+        float horizontal = distance * cosf(pitch);
+        return {
+            target.x - horizontal * sinf(yaw),
+            target.y + distance * sinf(pitch),
+            target.z - horizontal * cosf(yaw)
+        };
+    }
+
+    uint32_t OccludedPlayers(const PlayerPositions& players, const Vec& eye) {
+        if (!m_lineOfSight) return 0;
+
+        uint32_t occluded = 0;
+        for (uint32_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+            if (!players.Has(i)) continue;
+            Vec chest = players.Pos(i);
+            chest.y += CAMERA_TARGET_HEIGHT;
+            if (!m_probes.Visible(eye, chest, m_lineOfSight, m_lineOfSightUser)) occluded |= 1u << i;
+        }
+        return occluded;
+    }
+
+    bool PlayersMoved(const PlayerPositions& players) const {
+        if (players.mask != m_lastPlayers.mask) return true;
+        for (uint32_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+            if (!players.Has(i)) continue;
+            if (fabsf(players.x[i] - m_lastPlayers.x[i]) > CAMERA_REST_MOVE ||
+                fabsf(players.y[i] - m_lastPlayers.y[i]) > CAMERA_REST_MOVE ||
+                fabsf(players.z[i] - m_lastPlayers.z[i]) > CAMERA_REST_MOVE) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Settled(const Vec& target, float fovy, float distance, float pitch) const {
+        const CameraSpring* springs[] = { &m_targetX, &m_targetY, &m_targetZ, &m_distance };
+        const float goals[] = { target.x, target.y, target.z, distance };
+        for (uint32_t i = 0; i < 4; i++) {
+            if (fabsf(springs[i]->value - goals[i]) > CAMERA_REST_MOVE) return false;
+            if (fabsf(springs[i]->velocity) > CAMERA_REST_SPEED) return false;
+        }
+        return fabsf(m_fovy.value - fovy) < 0.001f && fabsf(m_pitch.value - pitch) < 0.001f &&
+               fabsf(m_fovy.velocity) < 0.001f && fabsf(m_pitch.velocity) < 0.001f;
+    }
+
+    CoopCameraFrame m_frame;
+    CameraSpring m_targetX, m_targetY, m_targetZ;
+    CameraSpring m_fovy, m_distance, m_pitch;
+    CameraProbeCache m_probes;
+    CameraLineOfSight m_lineOfSight = nullptr;
+    void* m_lineOfSightUser = nullptr;
+
+    PlayerPositions m_lastPlayers;
+    float m_lastYaw = 0.0f;
+    bool m_settled = false;
+    bool m_hasFrame = false;
+    uint64_t m_solves = 0;
+};
@@ -0,0 +1,551 @@
+/**
+ * RE4 CO-OP MOD - Checkpoints Incrementais de Memória
+ *
+ * Para rollback e resync é preciso voltar regiões inteiras do jogo
+ * (structs dos players, array do EmMgr, inventário) a um tick anterior.
+ * Copiar tudo a cada tick custa megabytes por tick; aqui só vai o que o
+ * jogo escreveu desde o checkpoint anterior:
+ *
+ * - Arm() copia as regiões para uma sombra e deixa as páginas só leitura
+ * - A primeira escrita numa página cai no handler vetorizado, que marca
+ *   a página suja e devolve a proteção original (a instrução repete e
+ *   segue; as próximas escritas na página não custam nada)
+ * - Checkpoint() protege de novo só as páginas sujas e, para cada uma,
+ *   guarda a versão da sombra (conteúdo no checkpoint anterior) num ring
+ *   de undo e atualiza a sombra com a memória atual
+ * - Restore(id) volta as páginas sujas desde o último checkpoint a partir
+ *   da sombra e desfaz os intervalos mais novos que id, do mais novo para
+ *   o mais velho. Só toca as páginas que mudaram nesse meio-tempo
+ * - Página suja em vários checkpoints seguidos (player andando) fica sem
+ *   proteção e é comparada com a sombra a cada checkpoint: uma falta por
+ *   tick custa mais que um memcmp de 4 KB
+ *
+ * Cada página protegida que o jogo escreve num tick custa uma falta
+ * (exceção, handler, VirtualProtect: microssegundos). Tick normal toca
+ * poucas páginas, mas recarregar a sala reescreve o EmMgr inteiro: 8 MB
+ * são 2048 faltas, milissegundos num tick só. Por isso fica desligado
+ * por padrão (g_CoopConfig.memoryCheckpoints).
+ *
+ * A memória do jogo não é nossa, então não dá para alocar com
+ * MEM_WRITE_WATCH e usar GetWriteWatch: o rastreio é por proteção.
+ * Escrita do kernel numa página protegida (ReadFile direto no buffer)
+ * falha em vez de gerar exceção, então só registre structs de jogo.
+ *
+ *   MemoryCheckpoints& checkpoints = MemoryCheckpoints::Instance();
+ *   checkpoints.AddRegion(ashley, PLAYER_READ_SIZE);
+ *   checkpoints.Arm();
+ *   uint32_t id = checkpoints.Checkpoint();     // Todo tick de rede
+ *   checkpoints.Restore(id);                    // Rollback
+ *
+ * Checkpoint/Restore/Arm só na thread do jogo, entre ticks.
+ */
+
+#pragma once
+#include <Windows.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+constexpr uint32_t CHECKPOINT_MAX_REGIONS = 16;
+constexpr uint32_t CHECKPOINT_MAX_PAGES = 4096;         // 16 MB rastreados (páginas de 4 KB)
+constexpr uint32_t CHECKPOINT_RING = 32;                // Checkpoints para trás (~1 s a 30 Hz)
+constexpr uint32_t CHECKPOINT_POOL_PAGES = 4096;        // Páginas de undo no ring inteiro
+
+// Página com falta em CHECKPOINT_HOT_STREAK checkpoints seguidos (com
+// folga de CHECKPOINT_HOT_GAP entre uma e outra) fica sem proteção:
+// comparar 4 KB com a sombra sai mais barato que a falta. Parada por
+// CHECKPOINT_HOT_IDLE checkpoints volta a ser rastreada por falta.
+constexpr uint8_t CHECKPOINT_HOT_STREAK = 3;
+constexpr uint32_t CHECKPOINT_HOT_GAP = 2;              // Suja em tick sim, tick não ainda conta
+constexpr uint8_t CHECKPOINT_HOT_IDLE = 8;
+
+//=============================================================================
+// PROTEÇÃO DE PÁGINA
+//=============================================================================
+
+// Troca a proteção sem consultar a antiga. No harness o VirtualProtect do
+// compat lê /proc/self/maps para devolver a antiga, o que não cabe dentro
+// do handler de SIGSEGV (nem no custo de um checkpoint).
+inline bool CheckpointProtect(void* address, size_t size, DWORD protect) {
+#ifdef _WIN32
+    DWORD old;
+    return VirtualProtect(address, size, protect, &old) != 0;
+#else
+    return mprotect(address, size, CompatProtectFlags(protect)) == 0;
+#endif
+}
+
+//=============================================================================
+// CHECKPOINTS
+//=============================================================================
+
+class MemoryCheckpoints {
+public:
+    static MemoryCheckpoints& Instance() {
+        static MemoryCheckpoints instance;
+        return instance;
+    }
+
+    ~MemoryCheckpoints() { Disarm(); }
+
+    // Registra [address, address + size) arredondado para páginas. Faixas
+    // que se encostam ou se sobrepõem viram uma região só. Só desarmado.
+    bool AddRegion(const void* address, size_t size) {
+        if (m_armed || !size) return false;
+
+        uintptr_t start = (uintptr_t)address & ~(uintptr_t)(m_pageSize - 1);
+        uintptr_t end = ((uintptr_t)address + size + m_pageSize - 1) & ~(uintptr_t)(m_pageSize - 1);
+        if (end <= start) return false;
+
+        // Junta com o que já existe (a lista fica sem sobreposição). Em
+        // cópia: se a faixa juntada não servir, nada muda.
+        Region merged[CHECKPOINT_MAX_REGIONS];
+        uint32_t count = m_regionCount;
+        memcpy(merged, m_regions, count * sizeof(Region));
+        for (bool grew = true; grew;) {
+            // Depois de crescer, a faixa pode encostar numa que já passou
+            grew = false;
+            for (uint32_t i = 0; i < count;) {
+                const Region& r = merged[i];
+                if (r.start <= end && start <= r.end) {
+                    grew |= r.start < start || r.end > end;
+                    if (r.start < start) start = r.start;
+                    if (r.end > end) end = r.end;
+                    merged[i] = merged[--count];
+                    continue;
+                }
+                i++;
+            }
+        }
+
+        uint32_t pages = (uint32_t)((end - start) / m_pageSize);
+        for (uint32_t i = 0; i < count; i++) pages += (uint32_t)((merged[i].end - merged[i].start) / m_pageSize);
+        if (count >= CHECKPOINT_MAX_REGIONS || pages > CHECKPOINT_MAX_PAGES) return false;
+
+        DWORD protect;
+        if (!QueryWritable(start, end, protect)) return false;
+
+        Region& region = merged[count++];
+        region.start = start;
+        region.end = end;
+        region.protect = protect;
+        region.firstPage = 0;
+
+        memcpy(m_regions, merged, count * sizeof(Region));
+        m_regionCount = count;
+        return true;
+    }
+
+    // Desarma e esquece as regiões
+    void ClearRegions() {
+        Disarm();
+        m_regionCount = 0;
+    }
+
+    // Copia as regiões para a sombra e começa a rastrear. Vira o
+    // checkpoint Latest() (nada para trás dele).
+    bool Arm() {
+        if (m_armed) return true;
+        uint32_t pages = TotalPages();
+        if (!pages) return false;
+
+        m_shadow = (uint8_t*)VirtualAlloc(nullptr, (SIZE_T)pages * m_pageSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        m_pool = (uint8_t*)VirtualAlloc(nullptr, (SIZE_T)CHECKPOINT_POOL_PAGES * m_pageSize,
+                                        MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (!m_shadow || !m_pool) {
+            FreeBuffers();
+            return false;
+        }
+
+        uint32_t first = 0;
+        for (uint32_t i = 0; i < m_regionCount; i++) {
+            Region& r = m_regions[i];
+            r.firstPage = first;
+            first += (uint32_t)((r.end - r.start) / m_pageSize);
+            memcpy(m_shadow + (size_t)r.firstPage * m_pageSize, (const void*)r.start, r.end - r.start);
+        }
+        m_pageCount = pages;
+
+        for (uint32_t w = 0; w < DIRTY_WORDS; w++) m_dirty[w].store(0, std::memory_order_relaxed);
+        memset(m_touched, 0, sizeof(m_touched));
+        memset(m_hot, 0, sizeof(m_hot));
+        memset(m_lastDirty, 0, sizeof(m_lastDirty));
+        memset(m_streak, 0, sizeof(m_streak));
+        m_poolHead = m_poolTail = 0;
+        m_latest = m_oldest = m_latest + 1;
+
+        // Handler antes da proteção: nenhuma escrita fica sem dono
+        m_handler = AddVectoredExceptionHandler(1, OnException);
+        if (!m_handler) {
+            FreeBuffers();
+            return false;
+        }
+        m_armed = true;
+
+        for (uint32_t i = 0; i < m_regionCount; i++) {
+            const Region& r = m_regions[i];
+            CheckpointProtect((void*)r.start, r.end - r.start, TrackedProtect(r.protect));
+        }
+        return true;
+    }
+
+    // Devolve a proteção original e para de rastrear (a memória fica como está)
+    void Disarm() {
+        if (!m_armed) return;
+
+        // Proteção antes do handler: nenhuma escrita pega página protegida sem handler
+        for (uint32_t i = 0; i < m_regionCount; i++) {
+            const Region& r = m_regions[i];
+            CheckpointProtect((void*)r.start, r.end - r.start, r.protect);
+        }
+        RemoveVectoredExceptionHandler(m_handler);
+        m_handler = nullptr;
+        m_armed = false;
+        FreeBuffers();
+    }
+
+    // Fecha o intervalo atual. Retorna o id do checkpoint (0 se desarmado).
+    uint32_t Checkpoint() {
+        if (!m_armed) return 0;
+        uint32_t id = m_latest + 1;
+
+        // Candidatas: páginas que tomaram falta e páginas quentes (sem proteção)
+        uint32_t n = 0;
+        uint32_t p = 0;
+        uint32_t words = (m_pageCount + 31) / 32;
+        for (uint32_t w = 0; w < words; w++) {
+            uint32_t faulted = m_dirty[w].load(std::memory_order_relaxed) ? m_dirty[w].exchange(0, std::memory_order_acq_rel) : 0;
+            uint32_t bits = faulted | m_hot[w];
+            while (bits) {
+                uint32_t page = w * 32 + CountTrailingZeros(bits);
+                bits &= bits - 1;
+                m_work[n++] = page;
+
+                if (Hot(page)) {
+                    // Parada tempo demais: volta a ser rastreada por falta
+                    if (m_idle[page] >= CHECKPOINT_HOT_IDLE) {
+                        m_hot[w] &= ~(1u << (page & 31));
+                        m_protect[p++] = page;
+                    }
+                    continue;
+                }
+
+                bool recent = m_lastDirty[page] && id - m_lastDirty[page] <= CHECKPOINT_HOT_GAP;
+                m_streak[page] = recent && m_streak[page] < 255 ? m_streak[page] + 1 : 1;
+                m_lastDirty[page] = id;
+                if (m_streak[page] >= CHECKPOINT_HOT_STREAK) {
+                    // Suja todo checkpoint: a falta custa mais que comparar
+                    m_hot[w] |= 1u << (page & 31);
+                    m_idle[page] = 0;
+                }
+                else {
+                    m_protect[p++] = page;
+                }
+            }
+        }
+
+        // Protege antes de comparar: escrita depois disso gera falta (e
+        // entra no próximo intervalo); escrita antes já está na comparação
+        ProtectList(m_protect, p);
+
+        // Só o que mudou de fato vai para o undo
+        uint32_t changed = 0;
+        for (uint32_t k = 0; k < n; k++) {
+            uint32_t page = m_work[k];
+            bool same = memcmp(PageAddress(page), ShadowPage(page), m_pageSize) == 0;
+            if (Hot(page)) m_idle[page] = same ? m_idle[page] + 1 : 0;
+            if (!same) m_work[changed++] = page;
+        }
+        n = changed;
+
+        if (n > CHECKPOINT_POOL_PAGES) {
+            // Intervalo maior que o ring: a história inteira vai embora
+            for (uint32_t k = 0; k < n; k++) memcpy(ShadowPage(m_work[k]), PageAddress(m_work[k]), m_pageSize);
+            m_poolTail = m_poolHead;
+            m_latest = m_oldest = id;
+            m_lastPages = n;
+            return id;
+        }
+
+        while (id - m_oldest > CHECKPOINT_RING || PoolFree() < n) DropOldest();
+
+        Record& record = m_records[id % CHECKPOINT_RING];
+        record.first = m_poolHead;
+        record.count = n;
+        for (uint32_t k = 0; k < n; k++) {
+            uint32_t page = m_work[k];
+            uint32_t slot = (m_poolHead + k) % CHECKPOINT_POOL_PAGES;
+            m_poolPage[slot] = page;
+            memcpy(m_pool + (size_t)slot * m_pageSize, ShadowPage(page), m_pageSize);
+            memcpy(ShadowPage(page), PageAddress(page), m_pageSize);
+        }
+        m_poolHead += n;
+        m_latest = id;
+        m_lastPages = n;
+        return id;
+    }
+
+    // Volta a memória para o checkpoint id (entre Oldest() e Latest()).
+    // Os checkpoints mais novos que id são descartados; o próximo é id + 1.
+    bool Restore(uint32_t id) {
+        if (!m_armed || id < m_oldest || id > m_latest) return false;
+
+        // Mudadas desde o último checkpoint: as que tomaram falta e as
+        // quentes que não batem com a sombra (todas já desprotegidas)
+        uint32_t n = 0;
+        uint32_t words = (m_pageCount + 31) / 32;
+        for (uint32_t w = 0; w < words; w++) {
+            uint32_t bits = m_dirty[w].exchange(0, std::memory_order_acq_rel) | m_hot[w];
+            while (bits) {
+                uint32_t page = w * 32 + CountTrailingZeros(bits);
+                bits &= bits - 1;
+                Touch(page);
+                if (memcmp(PageAddress(page), ShadowPage(page), m_pageSize) == 0) continue;
+                n++;
+                memcpy(PageAddress(page), ShadowPage(page), m_pageSize);
+            }
+        }
+
+        // Intervalos mais novos que id, do mais novo para o mais velho
+        for (uint32_t j = m_latest; j > id; j--) {
+            const Record& record = m_records[j % CHECKPOINT_RING];
+            for (uint32_t k = 0; k < record.count; k++) {
+                uint32_t slot = (record.first + k) % CHECKPOINT_POOL_PAGES;
+                uint32_t page = m_poolPage[slot];
+                if (!Touched(page)) {
+                    Touch(page);
+                    if (!Hot(page)) CheckpointProtect(PageAddress(page), m_pageSize, m_regions[RegionOf(page)].protect);
+                }
+                n++;
+                const uint8_t* before = m_pool + (size_t)slot * m_pageSize;
+                memcpy(ShadowPage(page), before, m_pageSize);
+                memcpy(PageAddress(page), before, m_pageSize);
+            }
+        }
+        if (id < m_latest) m_poolHead = m_records[(id + 1) % CHECKPOINT_RING].first;
+
+        // Tudo que foi tocado volta a ser rastreado, em ordem; quentes continuam sem proteção
+        uint32_t p = 0;
+        for (uint32_t w = 0; w < words; w++) {
+            uint32_t bits = m_touched[w] & ~m_hot[w];
+            m_touched[w] = 0;
+            while (bits) {
+                m_protect[p++] = w * 32 + CountTrailingZeros(bits);
+                bits &= bits - 1;
+            }
+        }
+        ProtectList(m_protect, p);
+
+        m_latest = id;
+        m_lastPages = n;
+        return true;
+    }
+
+    bool IsArmed() const { return m_armed; }
+    uint32_t Latest() const { return m_latest; }
+    uint32_t Oldest() const { return m_oldest; }
+    uint32_t RegionCount() const { return m_regionCount; }
+    uint32_t PageCount() const { return m_armed ? m_pageCount : TotalPages(); }
+    uint32_t PageSize() const { return m_pageSize; }
+
+    // Páginas guardadas pelo último Checkpoint (ou cópias feitas pelo último Restore)
+    uint32_t LastPages() const { return m_lastPages; }
+
+    // Faltas de escrita tratadas desde o início
+    uint64_t Faults() const { return m_faults.load(std::memory_order_relaxed); }
+
+    // true se todas as páginas de [address, address + size) estão rastreadas
+    // (só leitura por enquanto, mas graváveis pelo handler)
+    bool Covers(const void* address, size_t size) const {
+        if (!m_armed) return false;
+        uintptr_t start = (uintptr_t)address;
+        uintptr_t end = start + size;
+        for (uint32_t i = 0; i < m_regionCount; i++) {
+            if (start >= m_regions[i].start && end <= m_regions[i].end) return true;
+        }
+        return false;
+    }
+
+private:
+    struct Region {
+        uintptr_t start;
+        uintptr_t end;
+        DWORD protect;          // Original (volta no handler e no Disarm)
+        uint32_t firstPage;     // Índice da primeira página na sombra
+    };
+
+    // Páginas de undo do intervalo que termina num checkpoint (conteúdo
+    // no checkpoint anterior)
+    struct Record {
+        uint32_t first;         // Posição absoluta no pool (mod CHECKPOINT_POOL_PAGES)
+        uint32_t count;
+    };
+
+    static constexpr uint32_t DIRTY_WORDS = CHECKPOINT_MAX_PAGES / 32;
+
+    MemoryCheckpoints() {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        m_pageSize = info.dwPageSize ? info.dwPageSize : 4096;
+        for (uint32_t w = 0; w < DIRTY_WORDS; w++) m_dirty[w].store(0, std::memory_order_relaxed);
+    }
+
+    static LONG WINAPI OnException(EXCEPTION_POINTERS* info) {
+        const EXCEPTION_RECORD* record = info->ExceptionRecord;
+        if (record->ExceptionCode != EXCEPTION_ACCESS_VIOLATION || record->NumberParameters < 2) {
+            return EXCEPTION_CONTINUE_SEARCH;
+        }
+        // ExceptionInformation[0]: 1 = escrita
+        if (record->ExceptionInformation[0] != 1) return EXCEPTION_CONTINUE_SEARCH;
+        return Instance().OnWrite((uintptr_t)record->ExceptionInformation[1])
+                   ? EXCEPTION_CONTINUE_EXECUTION : EXCEPTION_CONTINUE_SEARCH;
+    }
+
+    // Dentro do handler: sem lock, sem alocação
+    bool OnWrite(uintptr_t address) {
+        if (!m_armed) return false;
+        for (uint32_t i = 0; i < m_regionCount; i++) {
+            const Region& r = m_regions[i];
+            if (address < r.start || address >= r.end) continue;
+
+            // Proteção antes do bit. Com o bit primeiro, um Checkpoint() no
+            // meio zeraria o bit e protegeria a página, e a desproteção de
+            // depois a deixaria gravável sem marca (escritas perdidas). Assim,
+            // um Checkpoint() no meio não vê a página e o bit leva a escrita
+            // para o próximo intervalo. Desprotege mesmo se outra thread já
+            // marcou: a proteção pode ainda não ter voltado
+            uint32_t page = r.firstPage + (uint32_t)((address - r.start) / m_pageSize);
+            CheckpointProtect(PageAddress(page), m_pageSize, r.protect);
+            m_dirty[page >> 5].fetch_or(1u << (page & 31), std::memory_order_release);
+            m_faults.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    // Só leitura, mantendo execução se a original tinha
+    static DWORD TrackedProtect(DWORD protect) {
+        return (protect & (PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY)) ? PAGE_EXECUTE_READ : PAGE_READONLY;
+    }
+
+    bool QueryWritable(uintptr_t start, uintptr_t end, DWORD& protect) const {
+        protect = 0;
+        for (uintptr_t at = start; at < end;) {
+            MEMORY_BASIC_INFORMATION info;
+            if (!VirtualQuery((const void*)at, &info, sizeof(info))) return false;
+            if (info.State != MEM_COMMIT || (info.Protect & (PAGE_GUARD | PAGE_NOACCESS))) return false;
+            if (!(info.Protect & (PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY))) {
+                return false;
+            }
+            // Uma proteção por região (a que volta no handler)
+            if (protect && info.Protect != protect) return false;
+            protect = info.Protect;
+            at = (uintptr_t)info.BaseAddress + info.RegionSize;
+        }
+        return true;
+    }
+
+    uint32_t TotalPages() const {
+        uint32_t pages = 0;
+        for (uint32_t i = 0; i < m_regionCount; i++) {
+            pages += (uint32_t)((m_regions[i].end - m_regions[i].start) / m_pageSize);
+        }
+        return pages;
+    }
+
+    uint32_t RegionOf(uint32_t page) const {
+        for (uint32_t i = 0; i < m_regionCount; i++) {
+            const Region& r = m_regions[i];
+            if (page >= r.firstPage && page < r.firstPage + (uint32_t)((r.end - r.start) / m_pageSize)) return i;
+        }
+        return 0;
+    }
+
+    uint8_t* PageAddress(uint32_t page) const {
+        const Region& r = m_regions[RegionOf(page)];
+        return (uint8_t*)r.start + (size_t)(page - r.firstPage) * m_pageSize;
+    }
+
+    uint8_t* ShadowPage(uint32_t page) const { return m_shadow + (size_t)page * m_pageSize; }
+
+    // Volta as páginas da lista (em ordem) para só leitura, uma chamada por sequência contígua
+    void ProtectList(const uint32_t* pages, uint32_t n) {
+        for (uint32_t k = 0; k < n;) {
+            const Region& r = m_regions[RegionOf(pages[k])];
+            uint32_t regionEnd = r.firstPage + (uint32_t)((r.end - r.start) / m_pageSize);
+            uint32_t run = 1;
+            while (k + run < n && pages[k + run] == pages[k] + run && pages[k + run] < regionEnd) run++;
+            CheckpointProtect(PageAddress(pages[k]), (size_t)run * m_pageSize, TrackedProtect(r.protect));
+            k += run;
+        }
+    }
+
+    bool Touched(uint32_t page) const { return (m_touched[page >> 5] >> (page & 31)) & 1; }
+    void Touch(uint32_t page) { m_touched[page >> 5] |= 1u << (page & 31); }
+    bool Hot(uint32_t page) const { return (m_hot[page >> 5] >> (page & 31)) & 1; }
+
+    uint32_t PoolFree() const { return CHECKPOINT_POOL_PAGES - (m_poolHead - m_poolTail); }
+
+    void DropOldest() {
+        const Record& record = m_records[(m_oldest + 1) % CHECKPOINT_RING];
+        m_poolTail += record.count;
+        m_oldest++;
+    }
+
+    static uint32_t CountTrailingZeros(uint32_t v) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, v);
+        return (uint32_t)index;
+#else
+        return (uint32_t)__builtin_ctz(v);
+#endif
+    }
+
+    void FreeBuffers() {
+        if (m_shadow) VirtualFree(m_shadow, 0, MEM_RELEASE);
+        if (m_pool) VirtualFree(m_pool, 0, MEM_RELEASE);
+        m_shadow = nullptr;
+        m_pool = nullptr;
+        m_pageCount = 0;
+    }
+
+    Region m_regions[CHECKPOINT_MAX_REGIONS];
+    uint32_t m_regionCount = 0;
+    uint32_t m_pageSize = 4096;
+    uint32_t m_pageCount = 0;
+
+    std::atomic<uint32_t> m_dirty[DIRTY_WORDS];     // Escrito pelo handler
+    std::atomic<uint64_t> m_faults{0};
+    uint32_t m_touched[DIRTY_WORDS];
+    uint32_t m_work[CHECKPOINT_MAX_PAGES];
+    uint32_t m_protect[CHECKPOINT_MAX_PAGES];
+
+    // Páginas quentes: sem proteção, comparadas com a sombra a cada checkpoint
+    uint32_t m_hot[DIRTY_WORDS];
+    uint32_t m_lastDirty[CHECKPOINT_MAX_PAGES];     // Último checkpoint em que tomou falta
+    uint8_t m_streak[CHECKPOINT_MAX_PAGES];         // Faltas seguidas (dentro de CHECKPOINT_HOT_GAP)
+    uint8_t m_idle[CHECKPOINT_MAX_PAGES];           // Checkpoints seguidos sem mudar (quente)
+
+    uint8_t* m_shadow = nullptr;                    // Memória no checkpoint Latest()
+    uint8_t* m_pool = nullptr;
+    uint32_t m_poolPage[CHECKPOINT_POOL_PAGES];     // Página rastreada de cada slot do pool
+    uint32_t m_poolHead = 0;
+    uint32_t m_poolTail = 0;
+
+    Record m_records[CHECKPOINT_RING];              // Record de j em j % CHECKPOINT_RING
+    uint32_t m_latest = 0;
+    uint32_t m_oldest = 0;
+    uint32_t m_lastPages = 0;
+
+    void* m_handler = nullptr;
+    volatile bool m_armed = false;
+};
@@ -11,6 +11,7 @@
 #pragma once
 #include <Windows.h>
 #include <cstdint>
+#include <cstring>
 #include <dinput.h>
 
 //=============================================================================
@@ -43,6 +44,7 @@ enum class AshleyCostume : uint8_t {
 // Forward declarations
 class cModel;
 class cEm;
+class cEmMgr;
 class cPlayer;
 class cPlWep;
 class CameraControl;
@@ -55,7 +57,27 @@ class CameraControl;
 extern cPlayer** pPL_ptr;  // Leon/Player atual
 extern cPlayer** pAS_ptr;  // Ashley
 
-// Funções para obter ponteiros
+// Estrutura de globais do jogo (GLOBAL_WK, em OffsetTable<V>::GLOBALS_BASE)
+extern uint8_t* pGlobals;
+
+// Gerenciador de inimigos (cManager<cEm>)
+extern cEmMgr* pEmMgr;
+
+//=============================================================================
+// SLOTS DE PLAYER
+//=============================================================================
+
+// Slot 0 = Leon (host), 1 = Ashley, 2+ = players extras (Ada, HUNK...)
+constexpr uint16_t COOP_MAX_PLAYERS = 4;
+
+struct CoopPlayerSlot {
+    cPlayer** source;                // Global do jogo com o ponteiro (nullptr = slot vazio)
+    PlayerCharacter character;
+};
+
+extern CoopPlayerSlot g_PlayerSlots[COOP_MAX_PLAYERS];
+
+// Leitura direta dos globais (o resto do mod usa EntityCache, validado por frame)
 inline cPlayer* PlayerPtr() {
     if (!pPL_ptr || !*pPL_ptr) return nullptr;
     if (**(int**)pPL_ptr < 0x10000) return nullptr;
@@ -68,6 +90,23 @@ inline cPlayer* AshleyPtr() {
     return *pAS_ptr;
 }
 
+//=============================================================================
+// ARQUIVOS DO MOD
+//=============================================================================
+
+// Caminho de um arquivo do mod ao lado do executável do jogo (ou no
+// diretório atual, se o caminho do exe não couber). path: MAX_PATH bytes.
+inline void CoopDataPath(const char* file, char* path) {
+    DWORD length = GetModuleFileNameA(nullptr, path, MAX_PATH);
+    char* slash = length ? strrchr(path, '\\') : nullptr;
+    if (slash && (size_t)(slash + 1 - path) + strlen(file) < MAX_PATH) {
+        strcpy(slash + 1, file);
+    }
+    else {
+        strcpy(path, file);
+    }
+}
+
 //=============================================================================
 // SISTEMA DE INPUT DO PLAYER 2
 //=============================================================================
@@ -107,7 +146,8 @@ struct CoopInput {
     }
 };
 
-// Input global do Player 2
+// Input do Player 2 no frame atual. Só a thread do jogo lê e escreve;
+// outras threads usam CoopMod::GetPlayer2Input() (cópia publicada).
 extern CoopInput g_P2_Input;
 
 //=============================================================================
@@ -122,6 +162,17 @@ struct CoopConfig {
     float maxDistance;               // Distância máxima entre players
     bool teleportIfTooFar;           // Teleportar se muito longe?
     
+    // Simulação em tick fixo (independente do FPS)
+    uint32_t tickRate;               // Ticks de simulação por segundo
+    uint32_t netSendInterval;        // Replicação a cada N ticks
+    uint32_t maxCatchUpTicks;        // Máximo de ticks por frame lento
+    
+    // Transferência do estado da sala (baixa prioridade)
+    uint32_t bulkChunksPerTick;      // Chunks liberados por tick de rede
+    
+    // Checkpoints de memória dos players e do EmMgr (rollback/resync)
+    bool memoryCheckpoints;          // Deixa as páginas só leitura entre ticks
+    
     CoopConfig() {
         enabled = false;
         ashleyHasWeapons = true;
@@ -129,6 +180,11 @@ struct CoopConfig {
         splitScreen = false;
         maxDistance = 2000.0f;
         teleportIfTooFar = true;
+        tickRate = 60;
+        netSendInterval = 2;         // 30 Hz
+        maxCatchUpTicks = 8;
+        bulkChunksPerTick = 4;       // ~1 KB por tick de rede
+        memoryCheckpoints = false;
     }
 };
 
@@ -138,24 +194,51 @@ extern CoopConfig g_CoopConfig;
 // FUNÇÕES PRINCIPAIS DO MOD
 //=============================================================================
 
+class SnapshotExtractor;    // coop_snapshot.h
+struct CoopCameraFrame;     // coop_camera.h
+
 namespace CoopMod {
     
     // Inicialização
     bool Initialize();
+    
+    // Unload explícito, fora do DllMain: para as threads e salva em disco
     void Shutdown();
     
+    // Do DllMain, com o loader lock: só restaura a memória do jogo, sem
+    // join nem arquivo. processExit = lpReserved != nullptr.
+    void ShutdownFromDllMain(bool processExit);
+    
     // Update loop (chamado todo frame)
     void Update();
     
+    // Avança o scheduler com um tempo de frame explícito (microssegundos).
+    // Update() mede o frame real e chama isto.
+    void Advance(uint64_t frameMicros);
+    
+    // Um tick fixo de simulação (input, teleporte, replicação)
+    void SimulationTick(uint64_t tick, float dt);
+    
+    // Fração do próximo tick já acumulada (para interpolar a apresentação)
+    float GetTickAlpha();
+    uint64_t GetSimTick();
+    
+    // Chamado a cada g_CoopConfig.netSendInterval ticks (servidor/cliente)
+    void SetNetworkTickHandler(void (*handler)());
+    
+    // Snapshot das entidades do último tick de rede (capturado antes do handler)
+    const SnapshotExtractor& GetSnapshot();
+    
     // Sistema de input
     void UpdatePlayer2Input();
     bool IsController2Connected();
+    CoopInput GetPlayer2Input();            // Qualquer thread, sem lock
     void ProcessController2(DIJOYSTATE2* state);
     
     // Controle da Ashley
     void TakeOverAshleyControl();
     void ReleaseAshleyControl();
-    void ApplyInputToAshley(cPlayer* ashley, const CoopInput& input);
+    void ApplyInputToAshley(cPlayer* ashley, const CoopInput& input, float dt);
     
     // Sistema de combate para Ashley
     void EnableAshleyCombat(cPlayer* ashley);
@@ -163,12 +246,17 @@ namespace CoopMod {
     void ProcessAshleyAim(cPlayer* ashley);
     void ProcessAshleyShoot(cPlayer* ashley);
     
-    // Câmera
-    void UpdateCoopCamera();
-    float GetPlayerDistance();
-    Vec GetMidpointBetweenPlayers();
+    // Câmera (uma vez por frame; dt em segundos)
+    void UpdateCoopCamera(float dt);
+    const CoopCameraFrame& GetCameraFrame();
+    float GetPlayerDistance();              // Player mais longe do Leon
+    Vec GetMidpointBetweenPlayers();        // Centro de todos os slots válidos
+    
+    // Slots de player (0 e 1 são ligados a pPL_ptr/pAS_ptr no Initialize)
+    void BindPlayerSlot(uint16_t slot, cPlayer** source, PlayerCharacter character);
     
     // Utilitários
+    void TeleportPlayerToLeon(uint16_t slot);
     void TeleportAshleyToLeon();
     void SyncPositions();
     
@@ -185,40 +273,6 @@ namespace CoopMod {
     }
 }
 
-//=============================================================================
-// OFFSETS IMPORTANTES (versão 1.1.0)
-//=============================================================================
-
-namespace Offsets {
-    // Dentro de cEm (base entity)
-    constexpr uint32_t HP = 0x324;
-    constexpr uint32_t HP_MAX = 0x326;
-    constexpr uint32_t FLAGS = 0x3E8;
-    
-    // Dentro de cModel/cCoord (posição)
-    constexpr uint32_t POS = 0x94;          // Vec pos
-    constexpr uint32_t POS_OLD = 0x110;     // Vec pos_old
-    
-    // Dentro de cPlayer
-    constexpr uint32_t PLAYER_FLAG = 0x464;
-    constexpr uint32_t PLAYER_STATE = 0x468;
-    constexpr uint32_t WEAPON_PTR = 0x7D8;  // cPlWep*
-    constexpr uint32_t LASER_TYPE = 0x804;
-    
-    // Atributos de colisão
-    constexpr uint32_t ATARI_FLAG = 0x2B4 + 0x1A;  // atari.m_flag
-    
-    // Globais
-    constexpr uint32_t GLOBALS_BASE = 0x85A760;
-    constexpr uint32_t JOY_ARRAY = 0xC63008;   // Joy[4]
-    constexpr uint32_t KEY_INPUT = 0xC62EF0;
-    
-    // Player type está em GLOBALS + 0x4FC8
-    constexpr uint32_t PLAYER_TYPE = 0x4FC8;
-    constexpr uint32_t PLAYER_COSTUME = 0x4FC9;
-    constexpr uint32_t SUB_COSTUME = 0x4FCB;    // Ashley costume
-}
-
 //=============================================================================
 // FLAGS DE COLISÃO
 //=============================================================================
@@ -228,22 +282,6 @@ enum CollisionFlags : uint16_t {
     SAT_OBA_ENABLE = 0x0002,  // Colisão com entidades
 };
 
-//=============================================================================
-// MACROS DE ACESSO RÁPIDO
-//=============================================================================
-
-// Acesso a HP
-#define GET_HP(entity) (*(int16_t*)((uint8_t*)(entity) + Offsets::HP))
-#define SET_HP(entity, val) (*(int16_t*)((uint8_t*)(entity) + Offsets::HP) = (val))
-
-// Acesso a posição
-#define GET_POS(entity) (*(Vec*)((uint8_t*)(entity) + Offsets::POS))
-#define SET_POS(entity, pos) (*(Vec*)((uint8_t*)(entity) + Offsets::POS) = (pos))
-
-// Acesso a flags
-#define GET_FLAGS(entity) (*(uint32_t*)((uint8_t*)(entity) + Offsets::FLAGS))
-#define SET_FLAGS(entity, val) (*(uint32_t*)((uint8_t*)(entity) + Offsets::FLAGS) = (val))
-
 //=============================================================================
 // IMPLEMENTAÇÃO DAS FUNÇÕES CORE
 //=============================================================================
@@ -264,32 +302,6 @@ namespace CoopMod {
             (a.z + b.z) / 2.0f
         };
     }
-    
-    inline void CopyPosition(cPlayer* from, cPlayer* to) {
-        if (!from || !to) return;
-        
-        Vec* fromPos = (Vec*)((uint8_t*)from + Offsets::POS);
-        Vec* toPos = (Vec*)((uint8_t*)to + Offsets::POS);
-        Vec* fromPosOld = (Vec*)((uint8_t*)from + Offsets::POS_OLD);
-        Vec* toPosOld = (Vec*)((uint8_t*)to + Offsets::POS_OLD);
-        
-        *toPos = *fromPos;
-        *toPosOld = *fromPosOld;
-    }
-    
-    inline void DisableCollision(cPlayer* entity) {
-        if (!entity) return;
-        
-        uint16_t* flags = (uint16_t*)((uint8_t*)entity + Offsets::ATARI_FLAG);
-        *flags &= ~(SAT_SCA_ENABLE | SAT_OBA_ENABLE);
-    }
-    
-    inline void EnableCollision(cPlayer* entity) {
-        if (!entity) return;
-        
-        uint16_t* flags = (uint16_t*)((uint8_t*)entity + Offsets::ATARI_FLAG);
-        *flags |= (SAT_SCA_ENABLE | SAT_OBA_ENABLE);
-    }
 }
 
 //=============================================================================
@@ -0,0 +1,1097 @@
+/**
+ * RE4 CO-OP MOD - Criptografia do Canal
+ *
+ * Implementa:
+ * - CPace sobre X25519 (handshake autenticado pelo código da sala)
+ * - SHA-512 e HMAC-SHA512 (transcript do CPace, chave e confirmação)
+ * - ChaCha20-Poly1305 (RFC 8439), portátil
+ * - AES-256-GCM com AES-NI/PCLMUL, quando a CPU dos dois lados suporta
+ * - SecureSession: registros [tamanho][cifrado][tag] com nonce derivado
+ *   da direção e do contador de registros
+ *
+ * O TCP já garante ordem, então o contador não vai no fio: cada lado
+ * conta os registros que mandou/recebeu. Registro repetido, reordenado
+ * ou injetado não autentica e derruba a conexão.
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define COOP_CRYPTO_X86 1
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define COOP_TARGET_AESNI
+#else
+#include <cpuid.h>
+#define COOP_TARGET_AESNI __attribute__((target("aes,pclmul,ssse3")))
+#endif
+#endif
+
+//=============================================================================
+// UTILITÁRIOS
+//=============================================================================
+
+inline uint32_t CryptoLoad32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline void CryptoStore32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+inline void CryptoStore64(uint8_t* p, uint64_t v) {
+    CryptoStore32(p, (uint32_t)v);
+    CryptoStore32(p + 4, (uint32_t)(v >> 32));
+}
+
+// Comparação em tempo constante
+inline bool CryptoEqual(const uint8_t* a, const uint8_t* b, size_t size) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < size; i++) diff |= a[i] ^ b[i];
+    return diff == 0;
+}
+
+// Zera memória sensível sem o compilador otimizar fora
+inline void CryptoWipe(void* p, size_t size) {
+    volatile uint8_t* bytes = (volatile uint8_t*)p;
+    while (size--) *bytes++ = 0;
+}
+
+// Aleatoriedade do sistema (rand_s no MSVC, /dev/urandom ou RDRAND no libstdc++)
+inline void CryptoRandom(uint8_t* out, size_t size) {
+    std::random_device rd;
+    for (size_t i = 0; i < size; i += 4) {
+        uint32_t v = rd();
+        for (size_t k = 0; k < 4 && i + k < size; k++) out[i + k] = (uint8_t)(v >> (8 * k));
+    }
+}
+
+//=============================================================================
+// CHACHA20
+//=============================================================================
+
+#define COOP_CHACHA_QR(a, b, c, d)                 \
+    a += b; d ^= a; d = (d << 16) | (d >> 16);     \
+    c += d; b ^= c; b = (b << 12) | (b >> 20);     \
+    a += b; d ^= a; d = (d << 8) | (d >> 24);      \
+    c += d; b ^= c; b = (b << 7) | (b >> 25);
+
+inline void ChaCha20Rounds(uint32_t x[16]) {
+    for (int i = 0; i < 10; i++) {
+        COOP_CHACHA_QR(x[0], x[4], x[8], x[12]);
+        COOP_CHACHA_QR(x[1], x[5], x[9], x[13]);
+        COOP_CHACHA_QR(x[2], x[6], x[10], x[14]);
+        COOP_CHACHA_QR(x[3], x[7], x[11], x[15]);
+        COOP_CHACHA_QR(x[0], x[5], x[10], x[15]);
+        COOP_CHACHA_QR(x[1], x[6], x[11], x[12]);
+        COOP_CHACHA_QR(x[2], x[7], x[8], x[13]);
+        COOP_CHACHA_QR(x[3], x[4], x[9], x[14]);
+    }
+}
+
+inline void ChaCha20Init(uint32_t state[16], const uint8_t key[32], const uint8_t nonce[12], uint32_t counter) {
+    state[0] = 0x61707865; state[1] = 0x3320646e; state[2] = 0x79622d32; state[3] = 0x6b206574;
+    for (int i = 0; i < 8; i++) state[4 + i] = CryptoLoad32(key + 4 * i);
+    state[12] = counter;
+    for (int i = 0; i < 3; i++) state[13 + i] = CryptoLoad32(nonce + 4 * i);
+}
+
+// data ^= keystream (começando no bloco counter)
+inline void ChaCha20Xor(const uint8_t key[32], const uint8_t nonce[12], uint32_t counter,
+                        uint8_t* data, size_t size) {
+    uint32_t state[16], x[16];
+    uint8_t block[64];
+    ChaCha20Init(state, key, nonce, counter);
+
+    while (size > 0) {
+        memcpy(x, state, sizeof(x));
+        ChaCha20Rounds(x);
+        for (int i = 0; i < 16; i++) CryptoStore32(block + 4 * i, x[i] + state[i]);
+
+        size_t n = size < 64 ? size : 64;
+        for (size_t i = 0; i < n; i++) data[i] ^= block[i];
+        data += n;
+        size -= n;
+        state[12]++;
+    }
+    CryptoWipe(block, sizeof(block));
+}
+
+//=============================================================================
+// POLY1305 (limbs de 26 bits: só multiplicações 32x32 -> 64, boas em x86)
+//=============================================================================
+
+class Poly1305 {
+public:
+    explicit Poly1305(const uint8_t key[32]) {
+        m_r[0] = CryptoLoad32(key + 0) & 0x3ffffff;
+        m_r[1] = (CryptoLoad32(key + 3) >> 2) & 0x3ffff03;
+        m_r[2] = (CryptoLoad32(key + 6) >> 4) & 0x3ffc0ff;
+        m_r[3] = (CryptoLoad32(key + 9) >> 6) & 0x3f03fff;
+        m_r[4] = (CryptoLoad32(key + 12) >> 8) & 0x00fffff;
+        for (int i = 0; i < 4; i++) m_pad[i] = CryptoLoad32(key + 16 + 4 * i);
+    }
+
+    ~Poly1305() { CryptoWipe(this, sizeof(*this)); }
+
+    void Update(const uint8_t* data, size_t size) {
+        if (m_leftover) {
+            size_t want = 16 - m_leftover;
+            if (want > size) want = size;
+            memcpy(m_buffer + m_leftover, data, want);
+            m_leftover += want;
+            data += want;
+            size -= want;
+            if (m_leftover < 16) return;
+            Blocks(m_buffer, 16, 1u << 24);
+            m_leftover = 0;
+        }
+
+        size_t full = size & ~(size_t)15;
+        if (full) {
+            Blocks(data, full, 1u << 24);
+            data += full;
+            size -= full;
+        }
+
+        if (size) {
+            memcpy(m_buffer, data, size);
+            m_leftover = size;
+        }
+    }
+
+    // Completa com zeros até múltiplo de 16 (formato do AEAD)
+    void PadTo16() {
+        if (!m_leftover) return;
+        memset(m_buffer + m_leftover, 0, 16 - m_leftover);
+        Blocks(m_buffer, 16, 1u << 24);
+        m_leftover = 0;
+    }
+
+    void Finish(uint8_t mac[16]) {
+        if (m_leftover) {
+            m_buffer[m_leftover] = 1;
+            memset(m_buffer + m_leftover + 1, 0, 15 - m_leftover);
+            Blocks(m_buffer, 16, 0);
+        }
+
+        uint32_t h0 = m_h[0], h1 = m_h[1], h2 = m_h[2], h3 = m_h[3], h4 = m_h[4];
+        uint32_t c;
+        c = h1 >> 26; h1 &= 0x3ffffff; h2 += c;
+        c = h2 >> 26; h2 &= 0x3ffffff; h3 += c;
+        c = h3 >> 26; h3 &= 0x3ffffff; h4 += c;
+        c = h4 >> 26; h4 &= 0x3ffffff; h0 += c * 5;
+        c = h0 >> 26; h0 &= 0x3ffffff; h1 += c;
+
+        // g = h - p; escolhe h ou g sem desvio
+        uint32_t g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+        uint32_t g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+        uint32_t g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+        uint32_t g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+        uint32_t g4 = h4 + c - (1u << 26);
+
+        uint32_t mask = (g4 >> 31) - 1;
+        g0 &= mask; g1 &= mask; g2 &= mask; g3 &= mask; g4 &= mask;
+        mask = ~mask;
+        h0 = (h0 & mask) | g0; h1 = (h1 & mask) | g1; h2 = (h2 & mask) | g2;
+        h3 = (h3 & mask) | g3; h4 = (h4 & mask) | g4;
+
+        h0 = h0 | (h1 << 26);
+        h1 = (h1 >> 6) | (h2 << 20);
+        h2 = (h2 >> 12) | (h3 << 14);
+        h3 = (h3 >> 18) | (h4 << 8);
+
+        uint64_t f;
+        f = (uint64_t)h0 + m_pad[0];             CryptoStore32(mac + 0, (uint32_t)f);
+        f = (uint64_t)h1 + m_pad[1] + (f >> 32); CryptoStore32(mac + 4, (uint32_t)f);
+        f = (uint64_t)h2 + m_pad[2] + (f >> 32); CryptoStore32(mac + 8, (uint32_t)f);
+        f = (uint64_t)h3 + m_pad[3] + (f >> 32); CryptoStore32(mac + 12, (uint32_t)f);
+    }
+
+private:
+    void Blocks(const uint8_t* m, size_t size, uint32_t hibit) {
+        const uint32_t r0 = m_r[0], r1 = m_r[1], r2 = m_r[2], r3 = m_r[3], r4 = m_r[4];
+        const uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+        uint32_t h0 = m_h[0], h1 = m_h[1], h2 = m_h[2], h3 = m_h[3], h4 = m_h[4];
+
+        while (size >= 16) {
+            h0 += CryptoLoad32(m + 0) & 0x3ffffff;
+            h1 += (CryptoLoad32(m + 3) >> 2) & 0x3ffffff;
+            h2 += (CryptoLoad32(m + 6) >> 4) & 0x3ffffff;
+            h3 += (CryptoLoad32(m + 9) >> 6) & 0x3ffffff;
+            h4 += (CryptoLoad32(m + 12) >> 8) | hibit;
+
+            uint64_t d0 = (uint64_t)h0 * r0 + (uint64_t)h1 * s4 + (uint64_t)h2 * s3 + (uint64_t)h3 * s2 + (uint64_t)h4 * s1;
+            uint64_t d1 = (uint64_t)h0 * r1 + (uint64_t)h1 * r0 + (uint64_t)h2 * s4 + (uint64_t)h3 * s3 + (uint64_t)h4 * s2;
+            uint64_t d2 = (uint64_t)h0 * r2 + (uint64_t)h1 * r1 + (uint64_t)h2 * r0 + (uint64_t)h3 * s4 + (uint64_t)h4 * s3;
+            uint64_t d3 = (uint64_t)h0 * r3 + (uint64_t)h1 * r2 + (uint64_t)h2 * r1 + (uint64_t)h3 * r0 + (uint64_t)h4 * s4;
+            uint64_t d4 = (uint64_t)h0 * r4 + (uint64_t)h1 * r3 + (uint64_t)h2 * r2 + (uint64_t)h3 * r1 + (uint64_t)h4 * r0;
+
+            uint32_t c;
+            c = (uint32_t)(d0 >> 26); h0 = (uint32_t)d0 & 0x3ffffff; d1 += c;
+            c = (uint32_t)(d1 >> 26); h1 = (uint32_t)d1 & 0x3ffffff; d2 += c;
+            c = (uint32_t)(d2 >> 26); h2 = (uint32_t)d2 & 0x3ffffff; d3 += c;
+            c = (uint32_t)(d3 >> 26); h3 = (uint32_t)d3 & 0x3ffffff; d4 += c;
+            c = (uint32_t)(d4 >> 26); h4 = (uint32_t)d4 & 0x3ffffff; h0 += c * 5;
+            c = h0 >> 26; h0 &= 0x3ffffff; h1 += c;
+
+            m += 16;
+            size -= 16;
+        }
+
+        m_h[0] = h0; m_h[1] = h1; m_h[2] = h2; m_h[3] = h3; m_h[4] = h4;
+    }
+
+    uint32_t m_r[5];
+    uint32_t m_h[5] = {};
+    uint32_t m_pad[4];
+    uint8_t m_buffer[16];
+    size_t m_leftover = 0;
+};
+
+//=============================================================================
+// CHACHA20-POLY1305 (RFC 8439)
+//=============================================================================
+
+inline void ChaChaPolyTag(const uint8_t key[32], const uint8_t nonce[12],
+                          const uint8_t* aad, size_t aadSize,
+                          const uint8_t* cipher, size_t size, uint8_t tag[16]) {
+    uint8_t polyKey[32] = {};
+    ChaCha20Xor(key, nonce, 0, polyKey, sizeof(polyKey));
+
+    Poly1305 mac(polyKey);
+    mac.Update(aad, aadSize);
+    mac.PadTo16();
+    mac.Update(cipher, size);
+    mac.PadTo16();
+
+    uint8_t lengths[16];
+    CryptoStore64(lengths, aadSize);
+    CryptoStore64(lengths + 8, size);
+    mac.Update(lengths, sizeof(lengths));
+    mac.Finish(tag);
+
+    CryptoWipe(polyKey, sizeof(polyKey));
+}
+
+// Cifra data no lugar e escreve a tag
+inline void ChaChaPolySeal(const uint8_t key[32], const uint8_t nonce[12],
+                           const uint8_t* aad, size_t aadSize,
+                           uint8_t* data, size_t size, uint8_t tag[16]) {
+    ChaCha20Xor(key, nonce, 1, data, size);
+    ChaChaPolyTag(key, nonce, aad, aadSize, data, size, tag);
+}
+
+// Verifica a tag e decifra no lugar (data não é tocado se a tag não bate)
+inline bool ChaChaPolyOpen(const uint8_t key[32], const uint8_t nonce[12],
+                           const uint8_t* aad, size_t aadSize,
+                           uint8_t* data, size_t size, const uint8_t tag[16]) {
+    uint8_t expected[16];
+    ChaChaPolyTag(key, nonce, aad, aadSize, data, size, expected);
+    if (!CryptoEqual(expected, tag, 16)) return false;
+    ChaCha20Xor(key, nonce, 1, data, size);
+    return true;
+}
+
+//=============================================================================
+// AES-256-GCM (AES-NI + PCLMULQDQ)
+//=============================================================================
+
+// Suporte da CPU, detectado uma vez
+inline bool CpuHasAesGcm() {
+#ifdef COOP_CRYPTO_X86
+    static const bool supported = [] {
+        unsigned int ecx;
+#ifdef _MSC_VER
+        int regs[4];
+        __cpuid(regs, 1);
+        ecx = (unsigned int)regs[2];
+#else
+        unsigned int eax, ebx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+#endif
+        const unsigned int PCLMUL = 1u << 1, SSSE3 = 1u << 9, AES = 1u << 25;
+        return (ecx & (PCLMUL | SSSE3 | AES)) == (PCLMUL | SSSE3 | AES);
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+#ifdef COOP_CRYPTO_X86
+
+class Aes256Gcm {
+public:
+    // Só chamar se CpuHasAesGcm()
+    COOP_TARGET_AESNI void SetKey(const uint8_t key[32]) {
+        __m128i k0 = _mm_loadu_si128((const __m128i*)key);
+        __m128i k1 = _mm_loadu_si128((const __m128i*)(key + 16));
+        m_round[0] = k0;
+        m_round[1] = k1;
+
+        // aeskeygenassist exige rcon imediato: expansão desenrolada
+#define COOP_AES256_EXPAND(i, rcon)                                               \
+        k0 = ExpandLow(k0, _mm_aeskeygenassist_si128(k1, rcon)); m_round[i] = k0;  \
+        if (i + 1 < 15) { k1 = ExpandHigh(k0, k1); m_round[i + 1] = k1; }
+        COOP_AES256_EXPAND(2, 0x01)
+        COOP_AES256_EXPAND(4, 0x02)
+        COOP_AES256_EXPAND(6, 0x04)
+        COOP_AES256_EXPAND(8, 0x08)
+        COOP_AES256_EXPAND(10, 0x10)
+        COOP_AES256_EXPAND(12, 0x20)
+        COOP_AES256_EXPAND(14, 0x40)
+#undef COOP_AES256_EXPAND
+
+        // H = AES(K, 0), guardado com os bytes invertidos para o GHASH
+        m_hashKey = _mm_shuffle_epi8(Encrypt(_mm_setzero_si128()), ByteSwapMask());
+    }
+
+    COOP_TARGET_AESNI void Seal(const uint8_t nonce[12], const uint8_t* aad, size_t aadSize,
+                                uint8_t* data, size_t size, uint8_t tag[16]) const {
+        __m128i j0 = CounterBlock(nonce, 1);
+        Ctr(nonce, data, size);
+        ComputeTag(j0, aad, aadSize, data, size, tag);
+    }
+
+    COOP_TARGET_AESNI bool Open(const uint8_t nonce[12], const uint8_t* aad, size_t aadSize,
+                                uint8_t* data, size_t size, const uint8_t tag[16]) const {
+        uint8_t expected[16];
+        ComputeTag(CounterBlock(nonce, 1), aad, aadSize, data, size, expected);
+        if (!CryptoEqual(expected, tag, 16)) return false;
+        Ctr(nonce, data, size);
+        return true;
+    }
+
+    void Wipe() { CryptoWipe(this, sizeof(*this)); }
+
+private:
+    COOP_TARGET_AESNI static __m128i ByteSwapMask() {
+        return _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    }
+
+    COOP_TARGET_AESNI static __m128i ExpandLow(__m128i k0, __m128i assist) {
+        assist = _mm_shuffle_epi32(assist, 0xff);
+        __m128i t = _mm_slli_si128(k0, 4);
+        k0 = _mm_xor_si128(k0, t); t = _mm_slli_si128(t, 4);
+        k0 = _mm_xor_si128(k0, t); t = _mm_slli_si128(t, 4);
+        k0 = _mm_xor_si128(k0, t);
+        return _mm_xor_si128(k0, assist);
+    }
+
+    COOP_TARGET_AESNI static __m128i ExpandHigh(__m128i k0, __m128i k1) {
+        __m128i assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(k0, 0x00), 0xaa);
+        __m128i t = _mm_slli_si128(k1, 4);
+        k1 = _mm_xor_si128(k1, t); t = _mm_slli_si128(t, 4);
+        k1 = _mm_xor_si128(k1, t); t = _mm_slli_si128(t, 4);
+        k1 = _mm_xor_si128(k1, t);
+        return _mm_xor_si128(k1, assist);
+    }
+
+    COOP_TARGET_AESNI __m128i Encrypt(__m128i block) const {
+        block = _mm_xor_si128(block, m_round[0]);
+        for (int i = 1; i < 14; i++) block = _mm_aesenc_si128(block, m_round[i]);
+        return _mm_aesenclast_si128(block, m_round[14]);
+    }
+
+    // nonce || contador big-endian
+    COOP_TARGET_AESNI static __m128i CounterBlock(const uint8_t nonce[12], uint32_t counter) {
+        alignas(16) uint8_t block[16];
+        memcpy(block, nonce, 12);
+        block[12] = (uint8_t)(counter >> 24); block[13] = (uint8_t)(counter >> 16);
+        block[14] = (uint8_t)(counter >> 8);  block[15] = (uint8_t)counter;
+        return _mm_load_si128((const __m128i*)block);
+    }
+
+    // CTR começando no contador 2, 4 blocos por vez para encher o pipeline do AES
+    COOP_TARGET_AESNI void Ctr(const uint8_t nonce[12], uint8_t* data, size_t size) const {
+        uint32_t counter = 2;
+
+        while (size >= 64) {
+            __m128i b0 = _mm_xor_si128(CounterBlock(nonce, counter + 0), m_round[0]);
+            __m128i b1 = _mm_xor_si128(CounterBlock(nonce, counter + 1), m_round[0]);
+            __m128i b2 = _mm_xor_si128(CounterBlock(nonce, counter + 2), m_round[0]);
+            __m128i b3 = _mm_xor_si128(CounterBlock(nonce, counter + 3), m_round[0]);
+            for (int i = 1; i < 14; i++) {
+                b0 = _mm_aesenc_si128(b0, m_round[i]);
+                b1 = _mm_aesenc_si128(b1, m_round[i]);
+                b2 = _mm_aesenc_si128(b2, m_round[i]);
+                b3 = _mm_aesenc_si128(b3, m_round[i]);
+            }
+            b0 = _mm_aesenclast_si128(b0, m_round[14]);
+            b1 = _mm_aesenclast_si128(b1, m_round[14]);
+            b2 = _mm_aesenclast_si128(b2, m_round[14]);
+            b3 = _mm_aesenclast_si128(b3, m_round[14]);
+
+            __m128i* p = (__m128i*)data;
+            _mm_storeu_si128(p + 0, _mm_xor_si128(_mm_loadu_si128(p + 0), b0));
+            _mm_storeu_si128(p + 1, _mm_xor_si128(_mm_loadu_si128(p + 1), b1));
+            _mm_storeu_si128(p + 2, _mm_xor_si128(_mm_loadu_si128(p + 2), b2));
+            _mm_storeu_si128(p + 3, _mm_xor_si128(_mm_loadu_si128(p + 3), b3));
+
+            counter += 4;
+            data += 64;
+            size -= 64;
+        }
+
+        while (size > 0) {
+            alignas(16) uint8_t keystream[16];
+            _mm_store_si128((__m128i*)keystream, Encrypt(CounterBlock(nonce, counter++)));
+            size_t n = size < 16 ? size : 16;
+            for (size_t i = 0; i < n; i++) data[i] ^= keystream[i];
+            data += n;
+            size -= n;
+        }
+    }
+
+    // Multiplicação em GF(2^128) com operandos de bytes invertidos
+    COOP_TARGET_AESNI static __m128i GfMul(__m128i a, __m128i b) {
+        __m128i lo = _mm_clmulepi64_si128(a, b, 0x00);
+        __m128i mid = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+        __m128i hi = _mm_clmulepi64_si128(a, b, 0x11);
+        lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+        hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+        // Produto de 256 bits << 1 (representação refletida do GCM)
+        __m128i loCarry = _mm_srli_epi32(lo, 31);
+        __m128i hiCarry = _mm_srli_epi32(hi, 31);
+        lo = _mm_slli_epi32(lo, 1);
+        hi = _mm_slli_epi32(hi, 1);
+        __m128i cross = _mm_srli_si128(loCarry, 12);
+        hiCarry = _mm_slli_si128(hiCarry, 4);
+        loCarry = _mm_slli_si128(loCarry, 4);
+        lo = _mm_or_si128(lo, loCarry);
+        hi = _mm_or_si128(_mm_or_si128(hi, hiCarry), cross);
+
+        // Redução módulo x^128 + x^7 + x^2 + x + 1
+        __m128i a1 = _mm_slli_epi32(lo, 31);
+        __m128i a2 = _mm_slli_epi32(lo, 30);
+        __m128i a3 = _mm_slli_epi32(lo, 25);
+        a1 = _mm_xor_si128(_mm_xor_si128(a1, a2), a3);
+        __m128i spill = _mm_srli_si128(a1, 4);
+        lo = _mm_xor_si128(lo, _mm_slli_si128(a1, 12));
+
+        __m128i b1 = _mm_srli_epi32(lo, 1);
+        __m128i b2 = _mm_srli_epi32(lo, 2);
+        __m128i b3 = _mm_srli_epi32(lo, 7);
+        b1 = _mm_xor_si128(_mm_xor_si128(b1, b2), _mm_xor_si128(b3, spill));
+        lo = _mm_xor_si128(lo, b1);
+        return _mm_xor_si128(hi, lo);
+    }
+
+    COOP_TARGET_AESNI __m128i GhashBlocks(__m128i x, const uint8_t* data, size_t size) const {
+        const __m128i bswap = ByteSwapMask();
+        while (size >= 16) {
+            __m128i block = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), bswap);
+            x = GfMul(_mm_xor_si128(x, block), m_hashKey);
+            data += 16;
+            size -= 16;
+        }
+        if (size) {
+            alignas(16) uint8_t last[16] = {};
+            memcpy(last, data, size);
+            __m128i block = _mm_shuffle_epi8(_mm_load_si128((const __m128i*)last), bswap);
+            x = GfMul(_mm_xor_si128(x, block), m_hashKey);
+        }
+        return x;
+    }
+
+    COOP_TARGET_AESNI void ComputeTag(__m128i j0, const uint8_t* aad, size_t aadSize,
+                                      const uint8_t* cipher, size_t size, uint8_t tag[16]) const {
+        __m128i x = _mm_setzero_si128();
+        x = GhashBlocks(x, aad, aadSize);
+        x = GhashBlocks(x, cipher, size);
+
+        // Bloco de tamanhos: bits do AAD || bits do texto (big-endian)
+        __m128i lengths = _mm_set_epi64x((long long)aadSize * 8, (long long)size * 8);
+        x = GfMul(_mm_xor_si128(x, lengths), m_hashKey);
+
+        __m128i s = _mm_shuffle_epi8(x, ByteSwapMask());
+        _mm_storeu_si128((__m128i*)tag, _mm_xor_si128(s, Encrypt(j0)));
+    }
+
+    __m128i m_round[15];
+    __m128i m_hashKey;
+};
+
+#endif // COOP_CRYPTO_X86
+
+//=============================================================================
+// SHA-512 / HMAC (FIPS 180-4, RFC 2104; só no handshake)
+//=============================================================================
+
+class Sha512 {
+public:
+    static constexpr uint32_t DIGEST_SIZE = 64;
+    static constexpr uint32_t BLOCK_SIZE = 128;
+
+    Sha512() {
+        static const uint64_t IV[8] = {
+            0x6a09e667f3bcc908ull, 0xbb67ae8584caa73bull, 0x3c6ef372fe94f82bull, 0xa54ff53a5f1d36f1ull,
+            0x510e527fade682d1ull, 0x9b05688c2b3e6c1full, 0x1f83d9abfb41bd6bull, 0x5be0cd19137e2179ull,
+        };
+        memcpy(m_state, IV, sizeof(m_state));
+    }
+
+    void Update(const void* data, size_t size) {
+        const uint8_t* p = (const uint8_t*)data;
+        m_length += size;
+        while (size > 0) {
+            size_t take = BLOCK_SIZE - m_used;
+            if (take > size) take = size;
+            memcpy(m_block + m_used, p, take);
+            m_used += (uint32_t)take;
+            p += take;
+            size -= take;
+            if (m_used == BLOCK_SIZE) {
+                Compress(m_block);
+                m_used = 0;
+            }
+        }
+    }
+
+    // Campo com prefixo de tamanho (lv_cat do CPace; campos < 128 bytes)
+    void UpdateLv(const void* data, size_t size) {
+        uint8_t length = (uint8_t)size;
+        Update(&length, 1);
+        Update(data, size);
+    }
+
+    void Finish(uint8_t digest[DIGEST_SIZE]) {
+        uint64_t bits = m_length * 8;
+        uint8_t pad = 0x80;
+        Update(&pad, 1);
+        pad = 0;
+        while (m_used != BLOCK_SIZE - 16) Update(&pad, 1);
+        uint8_t length[16] = {};
+        for (int i = 0; i < 8; i++) length[15 - i] = (uint8_t)(bits >> (8 * i));
+        Update(length, sizeof(length));
+        for (int i = 0; i < 8; i++) {
+            for (int j = 0; j < 8; j++) digest[8 * i + j] = (uint8_t)(m_state[i] >> (56 - 8 * j));
+        }
+        CryptoWipe(this, sizeof(*this));
+    }
+
+private:
+    static uint64_t Rotr(uint64_t x, int n) { return (x >> n) | (x << (64 - n)); }
+
+    void Compress(const uint8_t block[BLOCK_SIZE]) {
+        static const uint64_t K[80] = {
+            0x428a2f98d728ae22ull, 0x7137449123ef65cdull, 0xb5c0fbcfec4d3b2full, 0xe9b5dba58189dbbcull,
+            0x3956c25bf348b538ull, 0x59f111f1b605d019ull, 0x923f82a4af194f9bull, 0xab1c5ed5da6d8118ull,
+            0xd807aa98a3030242ull, 0x12835b0145706fbeull, 0x243185be4ee4b28cull, 0x550c7dc3d5ffb4e2ull,
+            0x72be5d74f27b896full, 0x80deb1fe3b1696b1ull, 0x9bdc06a725c71235ull, 0xc19bf174cf692694ull,
+            0xe49b69c19ef14ad2ull, 0xefbe4786384f25e3ull, 0x0fc19dc68b8cd5b5ull, 0x240ca1cc77ac9c65ull,
+            0x2de92c6f592b0275ull, 0x4a7484aa6ea6e483ull, 0x5cb0a9dcbd41fbd4ull, 0x76f988da831153b5ull,
+            0x983e5152ee66dfabull, 0xa831c66d2db43210ull, 0xb00327c898fb213full, 0xbf597fc7beef0ee4ull,
+            0xc6e00bf33da88fc2ull, 0xd5a79147930aa725ull, 0x06ca6351e003826full, 0x142929670a0e6e70ull,
+            0x27b70a8546d22ffcull, 0x2e1b21385c26c926ull, 0x4d2c6dfc5ac42aedull, 0x53380d139d95b3dfull,
+            0x650a73548baf63deull, 0x766a0abb3c77b2a8ull, 0x81c2c92e47edaee6ull, 0x92722c851482353bull,
+            0xa2bfe8a14cf10364ull, 0xa81a664bbc423001ull, 0xc24b8b70d0f89791ull, 0xc76c51a30654be30ull,
+            0xd192e819d6ef5218ull, 0xd69906245565a910ull, 0xf40e35855771202aull, 0x106aa07032bbd1b8ull,
+            0x19a4c116b8d2d0c8ull, 0x1e376c085141ab53ull, 0x2748774cdf8eeb99ull, 0x34b0bcb5e19b48a8ull,
+            0x391c0cb3c5c95a63ull, 0x4ed8aa4ae3418acbull, 0x5b9cca4f7763e373ull, 0x682e6ff3d6b2b8a3ull,
+            0x748f82ee5defb2fcull, 0x78a5636f43172f60ull, 0x84c87814a1f0ab72ull, 0x8cc702081a6439ecull,
+            0x90befffa23631e28ull, 0xa4506cebde82bde9ull, 0xbef9a3f7b2c67915ull, 0xc67178f2e372532bull,
+            0xca273eceea26619cull, 0xd186b8c721c0c207ull, 0xeada7dd6cde0eb1eull, 0xf57d4f7fee6ed178ull,
+            0x06f067aa72176fbaull, 0x0a637dc5a2c898a6ull, 0x113f9804bef90daeull, 0x1b710b35131c471bull,
+            0x28db77f523047d84ull, 0x32caab7b40c72493ull, 0x3c9ebe0a15c9bebcull, 0x431d67c49c100d4cull,
+            0x4cc5d4becb3e42b6ull, 0x597f299cfc657e2aull, 0x5fcb6fab3ad6faecull, 0x6c44198c4a475817ull,
+        };
+
+        uint64_t w[80];
+        for (int i = 0; i < 16; i++) {
+            w[i] = 0;
+            for (int j = 0; j < 8; j++) w[i] = (w[i] << 8) | block[8 * i + j];
+        }
+        for (int i = 16; i < 80; i++) {
+            uint64_t s0 = Rotr(w[i - 15], 1) ^ Rotr(w[i - 15], 8) ^ (w[i - 15] >> 7);
+            uint64_t s1 = Rotr(w[i - 2], 19) ^ Rotr(w[i - 2], 61) ^ (w[i - 2] >> 6);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint64_t v[8];
+        memcpy(v, m_state, sizeof(v));
+        for (int i = 0; i < 80; i++) {
+            uint64_t s1 = Rotr(v[4], 14) ^ Rotr(v[4], 18) ^ Rotr(v[4], 41);
+            uint64_t ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+            uint64_t t1 = v[7] + s1 + ch + K[i] + w[i];
+            uint64_t s0 = Rotr(v[0], 28) ^ Rotr(v[0], 34) ^ Rotr(v[0], 39);
+            uint64_t maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+            memmove(v + 1, v, 7 * sizeof(uint64_t));
+            v[4] += t1;
+            v[0] = t1 + s0 + maj;
+        }
+        for (int i = 0; i < 8; i++) m_state[i] += v[i];
+        CryptoWipe(w, sizeof(w));
+    }
+
+    uint64_t m_state[8];
+    uint8_t m_block[BLOCK_SIZE] = {};
+    uint32_t m_used = 0;
+    uint64_t m_length = 0;
+};
+
+// HMAC-SHA512 de (a || b)
+inline void HmacSha512(uint8_t mac[Sha512::DIGEST_SIZE], const uint8_t* key, size_t keySize,
+                       const void* a, size_t aSize, const void* b = nullptr, size_t bSize = 0) {
+    uint8_t pad[Sha512::BLOCK_SIZE] = {};
+    if (keySize > Sha512::BLOCK_SIZE) {
+        Sha512 hash;
+        hash.Update(key, keySize);
+        hash.Finish(pad);
+    }
+    else {
+        memcpy(pad, key, keySize);
+    }
+
+    for (uint32_t i = 0; i < Sha512::BLOCK_SIZE; i++) pad[i] ^= 0x36;
+    Sha512 inner;
+    inner.Update(pad, sizeof(pad));
+    inner.Update(a, aSize);
+    if (bSize) inner.Update(b, bSize);
+    inner.Finish(mac);
+
+    for (uint32_t i = 0; i < Sha512::BLOCK_SIZE; i++) pad[i] ^= 0x36 ^ 0x5c;
+    Sha512 outer;
+    outer.Update(pad, sizeof(pad));
+    outer.Update(mac, Sha512::DIGEST_SIZE);
+    outer.Finish(mac);
+    CryptoWipe(pad, sizeof(pad));
+}
+
+//=============================================================================
+// X25519 (aritmética em 16 limbs de 16 bits, só para o handshake)
+//=============================================================================
+
+namespace x25519 {
+
+typedef int64_t Fe[16];
+
+inline void Carry(Fe o) {
+    for (int i = 0; i < 16; i++) {
+        o[i] += (int64_t)1 << 16;
+        int64_t c = o[i] >> 16;
+        o[(i + 1) * (i < 15)] += c - 1 + 37 * (c - 1) * (i == 15);
+        o[i] -= c * 65536;
+    }
+}
+
+// Troca p e q se b == 1, sem desvio
+inline void Select(Fe p, Fe q, int64_t b) {
+    int64_t mask = ~(b - 1);
+    for (int i = 0; i < 16; i++) {
+        int64_t t = mask & (p[i] ^ q[i]);
+        p[i] ^= t;
+        q[i] ^= t;
+    }
+}
+
+inline void Pack(uint8_t out[32], const Fe n) {
+    Fe m, t;
+    for (int i = 0; i < 16; i++) t[i] = n[i];
+    Carry(t);
+    Carry(t);
+    Carry(t);
+    for (int j = 0; j < 2; j++) {
+        m[0] = t[0] - 0xffed;
+        for (int i = 1; i < 15; i++) {
+            m[i] = t[i] - 0xffff - ((m[i - 1] >> 16) & 1);
+            m[i - 1] &= 0xffff;
+        }
+        m[15] = t[15] - 0x7fff - ((m[14] >> 16) & 1);
+        int64_t b = (m[15] >> 16) & 1;
+        m[14] &= 0xffff;
+        Select(t, m, 1 - b);
+    }
+    for (int i = 0; i < 16; i++) {
+        out[2 * i] = (uint8_t)(t[i] & 0xff);
+        out[2 * i + 1] = (uint8_t)(t[i] >> 8);
+    }
+}
+
+inline void Unpack(Fe o, const uint8_t in[32]) {
+    for (int i = 0; i < 16; i++) o[i] = in[2 * i] + ((int64_t)in[2 * i + 1] << 8);
+    o[15] &= 0x7fff;
+}
+
+inline void Add(Fe o, const Fe a, const Fe b) { for (int i = 0; i < 16; i++) o[i] = a[i] + b[i]; }
+inline void Sub(Fe o, const Fe a, const Fe b) { for (int i = 0; i < 16; i++) o[i] = a[i] - b[i]; }
+
+inline void Mul(Fe o, const Fe a, const Fe b) {
+    int64_t t[31] = {};
+    for (int i = 0; i < 16; i++)
+        for (int j = 0; j < 16; j++) t[i + j] += a[i] * b[j];
+    for (int i = 0; i < 15; i++) t[i] += 38 * t[i + 16];
+    for (int i = 0; i < 16; i++) o[i] = t[i];
+    Carry(o);
+    Carry(o);
+}
+
+inline void Square(Fe o, const Fe a) { Mul(o, a, a); }
+
+inline void Invert(Fe o, const Fe in) {
+    Fe c;
+    for (int i = 0; i < 16; i++) c[i] = in[i];
+    for (int a = 253; a >= 0; a--) {
+        Square(c, c);
+        if (a != 2 && a != 4) Mul(c, c, in);
+    }
+    for (int i = 0; i < 16; i++) o[i] = c[i];
+}
+
+// Ladder de Montgomery (RFC 7748)
+inline void ScalarMult(uint8_t out[32], const uint8_t scalar[32], const uint8_t point[32]) {
+    static const Fe A24 = {0xDB41, 1};
+    uint8_t z[32];
+    Fe x, a, b, c, d, e, f;
+
+    memcpy(z, scalar, 32);
+    z[31] = (z[31] & 127) | 64;
+    z[0] &= 248;
+
+    Unpack(x, point);
+    for (int i = 0; i < 16; i++) {
+        b[i] = x[i];
+        a[i] = c[i] = d[i] = 0;
+    }
+    a[0] = d[0] = 1;
+
+    for (int i = 254; i >= 0; i--) {
+        int64_t r = (z[i >> 3] >> (i & 7)) & 1;
+        Select(a, b, r);
+        Select(c, d, r);
+        Add(e, a, c);
+        Sub(a, a, c);
+        Add(c, b, d);
+        Sub(b, b, d);
+        Square(d, e);
+        Square(f, a);
+        Mul(a, c, a);
+        Mul(c, b, e);
+        Add(e, a, c);
+        Sub(a, a, c);
+        Square(b, a);
+        Sub(c, d, f);
+        Mul(a, c, A24);
+        Add(a, a, d);
+        Mul(c, c, a);
+        Mul(a, d, f);
+        Mul(d, b, x);
+        Square(b, e);
+        Select(a, b, r);
+        Select(c, d, r);
+    }
+
+    Invert(c, c);
+    Mul(a, a, c);
+    Pack(out, a);
+    CryptoWipe(z, sizeof(z));
+}
+
+inline void PublicKey(uint8_t out[32], const uint8_t secret[32]) {
+    static const uint8_t BASE[32] = {9};
+    ScalarMult(out, secret, BASE);
+}
+
+// in^((p-1)/2): 1 se in é quadrado, 0 se in é zero, p-1 se não é.
+// Expoente 2^254 - 10: bits 253..4, 2 e 1 ligados.
+inline void Legendre(Fe o, const Fe in) {
+    Fe c;
+    for (int i = 0; i < 16; i++) c[i] = in[i];
+    for (int a = 252; a >= 0; a--) {
+        Square(c, c);
+        if (a != 3 && a != 0) Mul(c, c, in);
+    }
+    for (int i = 0; i < 16; i++) o[i] = c[i];
+}
+
+// Elligator2 (RFC 9380, Z = 2): leva 32 bytes uniformes a um ponto da
+// curva (coordenada u), sem desvio dependente da entrada
+inline void Elligator2(uint8_t out[32], const uint8_t in[32]) {
+    static const Fe ZERO = {};
+    static const Fe ONE = {1};
+    static const Fe A = {0x6D06, 0x0007};      // 486662
+    static const uint8_t ONE_BYTES[32] = {1};
+    static const uint8_t ZERO_BYTES[32] = {};
+    Fe u, t, x1, x2, gx;
+    uint8_t check[32];
+
+    // x1 = -A / (1 + 2u²); denominador zero vira x1 = -A
+    Unpack(u, in);
+    Square(t, u);
+    Add(t, t, t);
+    Add(t, t, ONE);
+    Invert(t, t);
+    Mul(x1, A, t);
+    Sub(x1, ZERO, x1);
+    Mul(x1, x1, ONE);
+    Pack(check, x1);
+    Sub(x2, ZERO, A);
+    Mul(x2, x2, ONE);
+    Select(x1, x2, CryptoEqual(check, ZERO_BYTES, 32));
+
+    // gx1 = x1³ + A·x1² + x1
+    Square(t, x1);
+    Mul(gx, A, x1);
+    Add(t, t, gx);
+    Add(t, t, ONE);
+    Mul(gx, t, x1);
+
+    // x2 = -x1 - A; fica x1 se gx1 é quadrado, senão x2
+    Sub(x2, ZERO, x1);
+    Sub(x2, x2, A);
+    Mul(x2, x2, ONE);
+    Legendre(t, gx);
+    Pack(check, t);
+    int64_t square = CryptoEqual(check, ONE_BYTES, 32) | CryptoEqual(check, ZERO_BYTES, 32);
+    Select(x1, x2, 1 - square);
+    Pack(out, x1);
+}
+
+} // namespace x25519
+
+//=============================================================================
+// CPACE (PAKE balanceado, draft-irtf-cfrg-cpace, X25519 + SHA-512)
+//=============================================================================
+
+// O código da sala tem só ~30 bits: não pode entrar num KDF depois de um
+// DH anônimo (quem está no meio faz DH com os dois lados, e o primeiro
+// registro permite testar todos os códigos offline). No CPace o código vira
+// o gerador da curva; cada conexão permite testar um único palpite, online.
+
+constexpr uint32_t CPACE_CONFIRM_SIZE = 16;
+
+// Gerador = Elligator2(SHA-512(lv_cat(DSI, PRS, zpad, CI, sid))[0:32])
+inline void CpaceGenerator(uint8_t out[32], const char* password) {
+    static const char DSI[] = "CPace255";
+    static const char CI[] = "RE4COOP";
+    static const uint8_t ZERO_PAD[Sha512::BLOCK_SIZE] = {};
+
+    size_t prsSize = password ? strlen(password) : 0;
+    if (prsSize > 64) prsSize = 64;
+    size_t zpadSize = Sha512::BLOCK_SIZE - 1 - (1 + prsSize) - (1 + sizeof(DSI) - 1);
+
+    Sha512 hash;
+    hash.UpdateLv(DSI, sizeof(DSI) - 1);
+    hash.UpdateLv(password, prsSize);
+    hash.UpdateLv(ZERO_PAD, zpadSize);
+    hash.UpdateLv(CI, sizeof(CI) - 1);
+    hash.UpdateLv(nullptr, 0);              // sid vazio: os shares já são efêmeros
+    uint8_t digest[Sha512::DIGEST_SIZE];
+    hash.Finish(digest);
+
+    x25519::Elligator2(out, digest);
+    CryptoWipe(digest, sizeof(digest));
+}
+
+//=============================================================================
+// SESSÃO SEGURA
+//=============================================================================
+
+enum class CipherSuite : uint8_t {
+    NONE = 0,
+    CHACHA20_POLY1305 = 0x01,
+    AES256_GCM = 0x02,
+};
+
+constexpr uint32_t AEAD_TAG_SIZE = 16;
+constexpr uint32_t SECURE_LENGTH_SIZE = 2;      // Prefixo de tamanho de cada registro
+constexpr uint32_t SECURE_RECORD_OVERHEAD = SECURE_LENGTH_SIZE + AEAD_TAG_SIZE;
+constexpr uint32_t X25519_KEY_SIZE = 32;
+
+// Direção no nonce: nunca há dois registros com o mesmo (chave, nonce)
+enum class SecureRole : uint32_t {
+    HOST = 0x484F5354,      // "HOST"
+    CLIENT = 0x434C4E54,    // "CLNT"
+};
+
+class SecureSession {
+public:
+    ~SecureSession() { Reset(); }
+
+    void Reset() {
+        CryptoWipe(m_secret, sizeof(m_secret));
+        CryptoWipe(m_key, sizeof(m_key));
+        CryptoWipe(m_localConfirm, sizeof(m_localConfirm));
+        CryptoWipe(m_peerConfirm, sizeof(m_peerConfirm));
+#ifdef COOP_CRYPTO_X86
+        m_aes.Wipe();
+#endif
+        m_suite = CipherSuite::NONE;
+        m_sendCounter = 0;
+        m_recvCounter = 0;
+    }
+
+    // Suítes que esta máquina roda (bitmask de CipherSuite)
+    static uint8_t LocalSuites() {
+        uint8_t suites = (uint8_t)CipherSuite::CHACHA20_POLY1305;
+        if (CpuHasAesGcm()) suites |= (uint8_t)CipherSuite::AES256_GCM;
+        return suites;
+    }
+
+    // Host escolhe: AES-GCM se os dois lados têm AES-NI, senão ChaCha20
+    static CipherSuite ChooseSuite(uint8_t peerSuites) {
+        uint8_t common = peerSuites & LocalSuites();
+        if (common & (uint8_t)CipherSuite::AES256_GCM) return CipherSuite::AES256_GCM;
+        if (common & (uint8_t)CipherSuite::CHACHA20_POLY1305) return CipherSuite::CHACHA20_POLY1305;
+        return CipherSuite::NONE;
+    }
+
+    // Começa o CPace: gerador tirado do código da sala, escalar efêmero e o
+    // share que vai no handshake (um por conexão)
+    void Begin(SecureRole role, const char* roomCode) {
+        Reset();
+        m_role = role;
+        uint8_t generator[32];
+        CpaceGenerator(generator, roomCode);
+        CryptoRandom(m_secret, sizeof(m_secret));
+        x25519::ScalarMult(m_public, m_secret, generator);
+        CryptoWipe(generator, sizeof(generator));
+    }
+
+    const uint8_t* PublicKey() const { return m_public; }
+
+    // Deriva a chave da sessão e as tags de confirmação. offered (bitmask do
+    // cliente) e suite (escolha do host) entram no transcript: rebaixar a
+    // suíte no meio do caminho derruba a confirmação. Com o código errado o
+    // K sai diferente nos dois lados e a confirmação do outro não bate.
+    bool Establish(const uint8_t peerPublic[32], uint8_t offered, CipherSuite suite) {
+        if (suite == CipherSuite::NONE) return false;
+        if (suite == CipherSuite::AES256_GCM && !CpuHasAesGcm()) return false;
+
+        uint8_t shared[32];
+        x25519::ScalarMult(shared, m_secret, peerPublic);
+        CryptoWipe(m_secret, sizeof(m_secret));
+
+        // Ponto de ordem baixa gera segredo zero: recusa
+        uint8_t zero[32] = {};
+        if (CryptoEqual(shared, zero, sizeof(shared))) return false;
+
+        // ISK = H(lv_cat(DSI_ISK, sid, K) || lv_cat(Ya, ADa) || lv_cat(Yb, ADb)),
+        // com o cliente como iniciador (a) e o host como respondedor (b)
+        const uint8_t* clientPublic = (m_role == SecureRole::HOST) ? peerPublic : m_public;
+        const uint8_t* hostPublic = (m_role == SecureRole::HOST) ? m_public : peerPublic;
+        uint8_t chosen = (uint8_t)suite;
+        Sha512 hash;
+        hash.UpdateLv("CPace255_ISK", 12);
+        hash.UpdateLv(nullptr, 0);
+        hash.UpdateLv(shared, sizeof(shared));
+        hash.UpdateLv(clientPublic, X25519_KEY_SIZE);
+        hash.UpdateLv(&offered, 1);
+        hash.UpdateLv(hostPublic, X25519_KEY_SIZE);
+        hash.UpdateLv(&chosen, 1);
+        uint8_t isk[Sha512::DIGEST_SIZE];
+        hash.Finish(isk);
+        CryptoWipe(shared, sizeof(shared));
+
+        // Chave do canal e uma tag por lado, todas separadas por rótulo
+        uint8_t mac[Sha512::DIGEST_SIZE];
+        HmacSha512(mac, isk, sizeof(isk), "RE4COOP key", 11);
+        memcpy(m_key, mac, sizeof(m_key));
+        HmacSha512(mac, isk, sizeof(isk), "RE4COOP host", 12);
+        memcpy(m_role == SecureRole::HOST ? m_localConfirm : m_peerConfirm, mac, CPACE_CONFIRM_SIZE);
+        HmacSha512(mac, isk, sizeof(isk), "RE4COOP client", 14);
+        memcpy(m_role == SecureRole::HOST ? m_peerConfirm : m_localConfirm, mac, CPACE_CONFIRM_SIZE);
+        CryptoWipe(mac, sizeof(mac));
+        CryptoWipe(isk, sizeof(isk));
+
+#ifdef COOP_CRYPTO_X86
+        if (suite == CipherSuite::AES256_GCM) m_aes.SetKey(m_key);
+#endif
+        m_suite = suite;
+        m_sendCounter = 0;
+        m_recvCounter = 0;
+        return true;
+    }
+
+    // Tag que este lado manda (host no CONNECT_ACCEPT, cliente no CONNECT_CONFIRM)
+    const uint8_t* LocalConfirm() const { return m_localConfirm; }
+
+    // Confere a tag do outro lado. Até ela bater, nenhum registro cifrado
+    // deve sair: o outro pode não saber o código.
+    bool VerifyConfirm(const uint8_t tag[CPACE_CONFIRM_SIZE]) const {
+        return m_suite != CipherSuite::NONE && CryptoEqual(tag, m_peerConfirm, CPACE_CONFIRM_SIZE);
+    }
+
+    bool IsEstablished() const { return m_suite != CipherSuite::NONE; }
+    CipherSuite Suite() const { return m_suite; }
+
+    // Monta um registro [tamanho][cifrado][tag] em out (out precisa de
+    // size + SECURE_RECORD_OVERHEAD bytes). Só a thread de envio chama.
+    uint32_t Seal(const uint8_t* plain, uint32_t size, uint8_t* out) {
+        uint32_t body = size + AEAD_TAG_SIZE;
+        out[0] = (uint8_t)body;
+        out[1] = (uint8_t)(body >> 8);
+
+        uint8_t* data = out + SECURE_LENGTH_SIZE;
+        memmove(data, plain, size);
+
+        uint8_t nonce[12];
+        MakeNonce(nonce, (uint32_t)m_role, m_sendCounter++);
+        SealInPlace(nonce, out, data, size, data + size);
+        return size + SECURE_RECORD_OVERHEAD;
+    }
+
+    // Abre o corpo de um registro (cifrado + tag) no lugar. length é o
+    // prefixo lido do fio (autenticado como AAD). Só a thread de recepção chama.
+    bool Open(const uint8_t length[SECURE_LENGTH_SIZE], uint8_t* body, uint32_t bodySize, uint32_t& plainSize) {
+        if (bodySize < AEAD_TAG_SIZE) return false;
+        plainSize = bodySize - AEAD_TAG_SIZE;
+
+        uint32_t peer = (m_role == SecureRole::HOST) ? (uint32_t)SecureRole::CLIENT : (uint32_t)SecureRole::HOST;
+        uint8_t nonce[12];
+        MakeNonce(nonce, peer, m_recvCounter);
+
+        if (!OpenInPlace(nonce, length, body, plainSize, body + plainSize)) return false;
+        m_recvCounter++;
+        return true;
+    }
+
+private:
+    static void MakeNonce(uint8_t nonce[12], uint32_t direction, uint64_t counter) {
+        CryptoStore32(nonce, direction);
+        CryptoStore64(nonce + 4, counter);
+    }
+
+    void SealInPlace(const uint8_t nonce[12], const uint8_t* aad, uint8_t* data, uint32_t size, uint8_t* tag) {
+#ifdef COOP_CRYPTO_X86
+        if (m_suite == CipherSuite::AES256_GCM) {
+            m_aes.Seal(nonce, aad, SECURE_LENGTH_SIZE, data, size, tag);
+            return;
+        }
+#endif
+        ChaChaPolySeal(m_key, nonce, aad, SECURE_LENGTH_SIZE, data, size, tag);
+    }
+
+    bool OpenInPlace(const uint8_t nonce[12], const uint8_t* aad, uint8_t* data, uint32_t size, const uint8_t* tag) {
+#ifdef COOP_CRYPTO_X86
+        if (m_suite == CipherSuite::AES256_GCM) {
+            return m_aes.Open(nonce, aad, SECURE_LENGTH_SIZE, data, size, tag);
+        }
+#endif
+        return ChaChaPolyOpen(m_key, nonce, aad, SECURE_LENGTH_SIZE, data, size, tag);
+    }
+
+    SecureRole m_role = SecureRole::HOST;
+    CipherSuite m_suite = CipherSuite::NONE;
+
+    uint8_t m_secret[32] = {};
+    uint8_t m_public[32] = {};
+    uint8_t m_key[32] = {};
+    uint8_t m_localConfirm[CPACE_CONFIRM_SIZE] = {};
+    uint8_t m_peerConfirm[CPACE_CONFIRM_SIZE] = {};
+
+#ifdef COOP_CRYPTO_X86
+    Aes256Gcm m_aes;
+#endif
+
+    uint64_t m_sendCounter = 0;
+    uint64_t m_recvCounter = 0;
+};
@@ -0,0 +1,506 @@
+/**
+ * RE4 CO-OP MOD - Detecção de Desync por Hash de Estado
+ *
+ * Host e cliente podem se afastar em silêncio (posição ou vida da Ashley,
+ * um inimigo a mais de um lado) e ninguém percebe até o jogo quebrar na
+ * tela. Aqui os dois lados tiram um hash de 64 bits do EntitySnapshot em
+ * ticks combinados e comparam:
+ *
+ * - O host grava um check a cada DESYNC_CHECK_INTERVAL ticks de rede e
+ *   manda (tick, hash) no próprio GAME_STATE
+ * - O cliente, no tick de rede em que aplica esse GAME_STATE, tira o hash
+ *   do próprio snapshot com o mesmo tick, compara e devolve o dele no
+ *   PLAYER_INPUT (o host compara também)
+ * - Erro em DESYNC_CONFIRM_CHECKS checks seguidos vira desync: o cliente
+ *   pede ao host os hashes por entidade do primeiro check que errou e
+ *   loga (CoopLog) o tick e a primeira entidade diferente
+ *
+ * Tudo isso só liga com DESYNC_CHECKS: enquanto o cliente não escreve o
+ * estado do host nas próprias entidades, o hash dele é da memória local e
+ * não tem com o que bater, e o host não hasheia nada à toa.
+ *
+ * O estado é canonizado antes do hash: posição na quantização do fio
+ * (WorldPos, 1/64 de unidade), hp/hpMax num word e só os bits de flags
+ * que são gameplay. Cada entidade vira um hash de 32 bits (rodadas do
+ * xxHash32); o jogo é 32 bits e não tem multiplicação de 64 bits rápida,
+ * então o SSE2 roda 4 entidades por vez, uma por lane, e o root de 64
+ * bits sai de 4 acumuladores (um por lane) dobrados no final.
+ *
+ *   DesyncMonitor monitor("host", "cliente");
+ *   uint64_t root = monitor.Record(tick, snapshot);
+ *   if (monitor.Compare(tick, remoteRoot) == DesyncResult::DIVERGED) ...
+ */
+
+#pragma once
+#include "coop_core.h"
+#include "coop_log.h"
+#include "coop_schema.h"
+#include "coop_snapshot.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define COOP_DESYNC_SSE2 1
+#include <emmintrin.h>
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+#endif
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+constexpr uint32_t DESYNC_CHECK_INTERVAL = 8;           // Ticks de rede entre checks
+constexpr uint32_t DESYNC_HISTORY = 16;                 // Checks guardados para o detalhe
+constexpr uint32_t DESYNC_CONFIRM_CHECKS = 2;           // Erros seguidos até chamar de desync
+constexpr uint32_t DESYNC_DETAIL_PER_PACKET = 59;       // Pares (id, hash) por DESYNC_DETAIL (cabe selado)
+
+// Bits de cEm::flags que são estado de jogo (o resto é render/culling
+// local). Nenhum mapeado ainda: flags ficam fora do hash.
+constexpr uint32_t DESYNC_FLAGS_MASK = 0;
+
+// O cliente ainda não escreve o estado do host nas entidades locais
+// (TODOs em CoopClient::ApplyRoomRecords/PatchRoomState): o snapshot
+// dele é a memória do próprio jogo, que não tem como bater com o do host,
+// e todo check acusaria desync. Desligado, nenhum lado hasheia e o
+// GAME_STATE leva check zerado (que o delta não manda). Liga junto com a
+// escrita.
+constexpr bool DESYNC_CHECKS = false;
+
+// Posição na mesma faixa e resolução do GAME_STATE: o que o cliente
+// recebeu e aplicou quantiza de volta para o mesmo inteiro (WorldPos
+// confere com static_assert em coop_network.h)
+constexpr int32_t DESYNC_POS_MIN = -131072;
+constexpr int32_t DESYNC_POS_MAX = 131072;
+constexpr uint32_t DESYNC_POS_BITS = 24;
+using DesyncPosAxis = QuantFloat<DESYNC_POS_MIN, DESYNC_POS_MAX, DESYNC_POS_BITS>;
+
+//=============================================================================
+// HASH
+//=============================================================================
+
+namespace DesyncHashDetail {
+    constexpr uint32_t PRIME1 = 0x9E3779B1u;
+    constexpr uint32_t PRIME2 = 0x85EBCA77u;
+    constexpr uint32_t PRIME3 = 0xC2B2AE3Du;
+    constexpr uint32_t PRIME4 = 0x27D4EB2Fu;
+    constexpr uint32_t PRIME5 = 0x165667B1u;
+    constexpr uint32_t SEED = 0x52453443u;              // "RE4C"
+    constexpr uint32_t WORDS = 7;                       // Words canônicos por entidade
+
+    inline uint32_t Rotl(uint32_t x, uint32_t r) { return (x << r) | (x >> (32 - r)); }
+
+    inline uint32_t Avalanche(uint32_t h) {
+        h ^= h >> 15;
+        h *= PRIME2;
+        h ^= h >> 13;
+        h *= PRIME3;
+        return h ^ (h >> 16);
+    }
+
+    // Saturado como no fio; NaN vai para o mínimo
+    inline uint32_t QuantizePos(float v) {
+        if (!(v > (float)DESYNC_POS_MIN)) v = (float)DESYNC_POS_MIN;
+        if (v > (float)DESYNC_POS_MAX) v = (float)DESYNC_POS_MAX;
+        return (uint32_t)((v - (float)DESYNC_POS_MIN) * DesyncPosAxis::SCALE + 0.5f);
+    }
+
+    inline uint32_t EntityHash(const EntitySnapshot& s, uint32_t i) {
+        uint32_t words[WORDS] = {
+            s.id[i],
+            QuantizePos(s.posX[i]),
+            QuantizePos(s.posY[i]),
+            QuantizePos(s.posZ[i]),
+            (uint32_t)(uint16_t)s.hp[i] | ((uint32_t)(uint16_t)s.hpMax[i] << 16),
+            s.flags[i] & DESYNC_FLAGS_MASK,
+            s.state[i],
+        };
+        uint32_t h = SEED + PRIME5 + WORDS * 4;
+        for (uint32_t w = 0; w < WORDS; w++) h = Rotl(h + words[w] * PRIME3, 17) * PRIME4;
+        return Avalanche(h);
+    }
+
+    inline uint32_t Accumulate(uint32_t acc, uint32_t entity) {
+        return Rotl(acc + entity * PRIME2, 13) * PRIME1;
+    }
+
+    // 4 acumuladores -> 64 bits (duas dobras com rotações diferentes)
+    inline uint64_t Fold(const uint32_t acc[4], uint32_t count, uint16_t roomId) {
+        uint32_t lo = Rotl(acc[0], 1) + Rotl(acc[1], 7) + Rotl(acc[2], 12) + Rotl(acc[3], 18);
+        uint32_t hi = Rotl(acc[0], 18) + Rotl(acc[1], 12) + Rotl(acc[2], 7) + Rotl(acc[3], 1);
+        lo = Avalanche((lo + count * PRIME5) ^ roomId);
+        hi = Avalanche((hi ^ (count * PRIME4)) + roomId * PRIME3 + lo);
+        return ((uint64_t)hi << 32) | lo;
+    }
+
+    inline void InitAccumulators(uint32_t acc[4]) {
+        acc[0] = SEED + PRIME1 + PRIME2;
+        acc[1] = SEED + PRIME2;
+        acc[2] = SEED;
+        acc[3] = SEED - PRIME1;
+    }
+
+#ifdef COOP_DESYNC_SSE2
+    // _mm_mullo_epi32 é SSE4.1: sem ele, dois _mm_mul_epu32 (lanes pares e ímpares)
+    inline __m128i Mul32(__m128i a, __m128i b) {
+#ifdef __SSE4_1__
+        return _mm_mullo_epi32(a, b);
+#else
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+    }
+
+    template<int R>
+    inline __m128i Rotl4(__m128i x) {
+        return _mm_or_si128(_mm_slli_epi32(x, R), _mm_srli_epi32(x, 32 - R));
+    }
+
+    inline __m128i Avalanche4(__m128i h) {
+        h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+        h = Mul32(h, _mm_set1_epi32((int)PRIME2));
+        h = _mm_xor_si128(h, _mm_srli_epi32(h, 13));
+        h = Mul32(h, _mm_set1_epi32((int)PRIME3));
+        return _mm_xor_si128(h, _mm_srli_epi32(h, 16));
+    }
+
+    inline __m128i QuantizePos4(const float* v) {
+        __m128 x = _mm_max_ps(_mm_load_ps(v), _mm_set1_ps((float)DESYNC_POS_MIN));  // NaN -> mínimo
+        x = _mm_min_ps(x, _mm_set1_ps((float)DESYNC_POS_MAX));
+        x = _mm_sub_ps(x, _mm_set1_ps((float)DESYNC_POS_MIN));
+        x = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(DesyncPosAxis::SCALE)), _mm_set1_ps(0.5f));
+        return _mm_cvttps_epi32(x);
+    }
+#endif
+}
+
+// Root de 64 bits do snapshot. Com entityHashes, grava também o hash de
+// cada entidade (precisa de SnapshotLanes(count) posições).
+inline uint64_t HashSnapshotScalar(const EntitySnapshot& s, uint32_t* entityHashes = nullptr) {
+    using namespace DesyncHashDetail;
+    uint32_t acc[4];
+    InitAccumulators(acc);
+
+    for (uint32_t i = 0; i < s.count; i++) {
+        uint32_t h = EntityHash(s, i);
+        if (entityHashes) entityHashes[i] = h;
+        acc[i & 3] = Accumulate(acc[i & 3], h);
+    }
+    return Fold(acc, s.count, s.roomId);
+}
+
+inline uint64_t HashSnapshot(const EntitySnapshot& s, uint32_t* entityHashes = nullptr) {
+#ifdef COOP_DESYNC_SSE2
+    using namespace DesyncHashDetail;
+    const __m128i prime1 = _mm_set1_epi32((int)PRIME1);
+    const __m128i prime2 = _mm_set1_epi32((int)PRIME2);
+    const __m128i prime3 = _mm_set1_epi32((int)PRIME3);
+    const __m128i prime4 = _mm_set1_epi32((int)PRIME4);
+    const __m128i flagsMask = _mm_set1_epi32((int)DESYNC_FLAGS_MASK);
+    const __m128i seed = _mm_set1_epi32((int)(SEED + PRIME5 + WORDS * 4));
+    const __m128i count = _mm_set1_epi32((int)s.count);
+    __m128i lane = _mm_set_epi32(3, 2, 1, 0);
+
+    uint32_t init[4];
+    InitAccumulators(init);
+    __m128i acc = _mm_loadu_si128((const __m128i*)init);
+
+    uint32_t lanes = SnapshotLanes(s.count);
+    for (uint32_t i = 0; i < lanes; i += 4) {
+        #define DESYNC_ROUND(word) h = Mul32(Rotl4<17>(_mm_add_epi32(h, Mul32(word, prime3))), prime4)
+
+        // hp e hpMax intercalados: (uint16_t)hp | hpMax << 16 por lane
+        __m128i hp = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)&s.hp[i]),
+                                        _mm_loadl_epi64((const __m128i*)&s.hpMax[i]));
+
+        __m128i h = seed;
+        DESYNC_ROUND(_mm_load_si128((const __m128i*)&s.id[i]));
+        DESYNC_ROUND(QuantizePos4(&s.posX[i]));
+        DESYNC_ROUND(QuantizePos4(&s.posY[i]));
+        DESYNC_ROUND(QuantizePos4(&s.posZ[i]));
+        DESYNC_ROUND(hp);
+        DESYNC_ROUND(_mm_and_si128(_mm_load_si128((const __m128i*)&s.flags[i]), flagsMask));
+        DESYNC_ROUND(_mm_load_si128((const __m128i*)&s.state[i]));
+        h = Avalanche4(h);
+
+        #undef DESYNC_ROUND
+
+        if (entityHashes) _mm_storeu_si128((__m128i*)&entityHashes[i], h);
+
+        // Lanes de padding (depois de count) não entram no acumulador
+        __m128i live = _mm_cmpgt_epi32(count, lane);
+        __m128i next = Mul32(Rotl4<13>(_mm_add_epi32(acc, Mul32(h, prime2))), prime1);
+        acc = _mm_or_si128(_mm_and_si128(live, next), _mm_andnot_si128(live, acc));
+        lane = _mm_add_epi32(lane, _mm_set1_epi32(4));
+    }
+
+    uint32_t folded[4];
+    _mm_storeu_si128((__m128i*)folded, acc);
+    return Fold(folded, s.count, s.roomId);
+#else
+    return HashSnapshotScalar(s, entityHashes);
+#endif
+}
+
+//=============================================================================
+// CODEC DO SCHEMA
+//=============================================================================
+
+// Hash de 64 bits em dois words (RawInt vai só até 32 bits)
+struct DesyncHashCodec {
+    static constexpr uint32_t BITS = 64;
+
+    static void Write(BitWriter& w, uint64_t v) {
+        w.Write((uint32_t)v, 32);
+        w.Write((uint32_t)(v >> 32), 32);
+    }
+
+    static void Read(BitReader& r, uint64_t& v) {
+        uint64_t lo = r.Read(32);
+        v = lo | ((uint64_t)r.Read(32) << 32);
+    }
+
+    static bool Same(uint64_t a, uint64_t b) { return a == b; }
+    static bool Valid(uint64_t) { return true; }
+};
+
+#pragma pack(push, 1)
+struct DesyncEntityHash {
+    uint32_t id;                // SnapshotId
+    uint32_t hash;
+};
+#pragma pack(pop)
+
+//=============================================================================
+// MONITOR (thread do jogo)
+//=============================================================================
+
+enum class DesyncResult : uint8_t {
+    UNKNOWN,                    // Tick fora do histórico local
+    MATCH,
+    MISMATCH,                   // Ainda não confirmado (ou desync já reportado)
+    DIVERGED,                   // Desync novo: pedir o detalhe de Report().tick
+};
+
+// De que lado a entidade do relatório existe
+enum DesyncPresence : uint8_t {
+    DESYNC_LOCAL = 1 << 0,
+    DESYNC_REMOTE = 1 << 1,
+    DESYNC_BOTH = DESYNC_LOCAL | DESYNC_REMOTE,
+};
+
+struct DesyncReport {
+    uint32_t tick;              // Primeiro check do episódio que não bateu
+    uint32_t entity;            // SnapshotId da primeira entidade diferente (0 = sem detalhe ainda)
+    uint8_t presence;           // DesyncPresence
+    uint32_t localHash;
+    uint32_t remoteHash;
+};
+
+struct DesyncCheck {
+    uint32_t tick;
+    uint64_t root;
+    uint32_t count;
+    uint32_t ids[SNAPSHOT_MAX_ENTITIES];
+    uint32_t hashes[SNAPSHOT_MAX_ENTITIES];
+};
+
+class DesyncMonitor {
+public:
+    // Nomes para o log ("host"/"cliente")
+    DesyncMonitor(const char* localName, const char* remoteName)
+        : m_localName(localName), m_remoteName(remoteName) {
+        Reset();
+    }
+
+    void Reset() {
+        for (uint32_t i = 0; i < DESYNC_HISTORY; i++) m_history[i].tick = 0;
+        m_next = 0;
+        m_streak = 0;
+        m_pendingTick = 0;
+        m_diverged = false;
+        m_report = {};
+        m_remoteTick = 0;
+        m_remoteTotal = 0;
+        m_remoteReceived = 0;
+        m_checks = 0;
+        m_mismatches = 0;
+        m_episodes = 0;
+    }
+
+    // Hash do snapshot no tick combinado. Tick 0 é reservado (sem check).
+    uint64_t Record(uint32_t tick, const EntitySnapshot& s) {
+        DesyncCheck& check = m_history[m_next];
+        m_next = (m_next + 1) % DESYNC_HISTORY;
+
+        check.tick = tick;
+        check.count = s.count;
+        check.root = HashSnapshot(s, check.hashes);
+        memcpy(check.ids, s.id, s.count * sizeof(s.id[0]));
+        return check.root;
+    }
+
+    const DesyncCheck* Find(uint32_t tick) const {
+        if (!tick) return nullptr;
+        for (uint32_t i = 0; i < DESYNC_HISTORY; i++) {
+            if (m_history[i].tick == tick) return &m_history[i];
+        }
+        return nullptr;
+    }
+
+    DesyncResult Compare(uint32_t tick, uint64_t remoteRoot) {
+        const DesyncCheck* check = Find(tick);
+        if (!check) return DesyncResult::UNKNOWN;
+        m_checks++;
+
+        if (check->root == remoteRoot) {
+            if (m_diverged) {
+                Log("[DESYNC] %s: tick %u voltou a bater com o %s", m_localName, tick, m_remoteName);
+            }
+            m_streak = 0;
+            m_diverged = false;
+            return DesyncResult::MATCH;
+        }
+
+        m_mismatches++;
+        if (m_streak++ == 0) m_pendingTick = tick;
+        if (m_diverged || m_streak < DESYNC_CONFIRM_CHECKS) return DesyncResult::MISMATCH;
+
+        m_diverged = true;
+        m_episodes++;
+        m_report = {};
+        m_report.tick = m_pendingTick;
+        m_remoteTick = 0;
+
+        const DesyncCheck* first = Find(m_pendingTick);
+        Log("[DESYNC] %s: estado diverge do %s desde o tick %u (%u entidades aqui, hash %016llX)",
+            m_localName, m_remoteName, m_pendingTick, first ? first->count : 0,
+            first ? (unsigned long long)first->root : 0ull);
+        return DesyncResult::DIVERGED;
+    }
+
+    // Hashes por entidade do outro lado para Report().tick, em pedaços
+    // [first, first + n) de total. Retorna true quando fechou o relatório.
+    bool AddRemoteDetail(uint32_t tick, uint32_t first, uint32_t total,
+                         const DesyncEntityHash* entities, uint32_t n) {
+        if (!m_diverged || tick != m_report.tick || m_report.entity) return false;
+        if (total > SNAPSHOT_MAX_ENTITIES || first > total || n > total - first) return false;
+
+        if (m_remoteTick != tick || m_remoteTotal != total) {
+            m_remoteTick = tick;
+            m_remoteTotal = total;
+            m_remoteReceived = 0;
+        }
+        for (uint32_t k = 0; k < n; k++) {
+            m_remoteIds[first + k] = entities[k].id;
+            m_remoteHashes[first + k] = entities[k].hash;
+        }
+        m_remoteReceived += n;
+        if (m_remoteReceived < total) return false;
+
+        const DesyncCheck* check = Find(tick);
+        if (!check) {
+            Log("[DESYNC] %s: tick %u saiu do histórico antes do detalhe chegar", m_localName, tick);
+            return false;
+        }
+        FindFirstEntity(*check);
+        LogEntity();
+        return true;
+    }
+
+    bool IsDiverged() const { return m_diverged; }
+    const DesyncReport& Report() const { return m_report; }
+    uint32_t Checks() const { return m_checks; }
+    uint32_t Mismatches() const { return m_mismatches; }
+    uint32_t Episodes() const { return m_episodes; }
+
+private:
+    // Os dois lados em ordem de id (o snapshot já sai assim): merge
+    void FindFirstEntity(const DesyncCheck& check) {
+        uint32_t a = 0, b = 0;
+        while (a < check.count || b < m_remoteTotal) {
+            uint32_t localId = a < check.count ? check.ids[a] : 0xFFFFFFFF;
+            uint32_t remoteId = b < m_remoteTotal ? m_remoteIds[b] : 0xFFFFFFFF;
+
+            if (localId == remoteId) {
+                if (check.hashes[a] != m_remoteHashes[b]) {
+                    m_report.entity = localId;
+                    m_report.presence = DESYNC_BOTH;
+                    m_report.localHash = check.hashes[a];
+                    m_report.remoteHash = m_remoteHashes[b];
+                    return;
+                }
+                a++;
+                b++;
+            }
+            else if (localId < remoteId) {
+                m_report.entity = localId;
+                m_report.presence = DESYNC_LOCAL;
+                m_report.localHash = check.hashes[a];
+                return;
+            }
+            else {
+                m_report.entity = remoteId;
+                m_report.presence = DESYNC_REMOTE;
+                m_report.remoteHash = m_remoteHashes[b];
+                return;
+            }
+        }
+    }
+
+    void LogEntity() {
+        if (!m_report.entity) {
+            Log("[DESYNC] %s: tick %u tem as mesmas entidades e hashes dos dois lados (diferença na sala ou na contagem)",
+                m_localName, m_report.tick);
+            return;
+        }
+
+        RoomRecordKind kind = (RoomRecordKind)(m_report.entity >> 16);
+        const char* kindName = kind == RoomRecordKind::PLAYER ? "player" :
+                               kind == RoomRecordKind::ENEMY ? "inimigo" : "entidade";
+        if (m_report.presence == DESYNC_LOCAL) {
+            Log("[DESYNC] %s: tick %u, primeira entidade divergente: %s %u (só no %s)",
+                m_localName, m_report.tick, kindName, m_report.entity & 0xFFFF, m_localName);
+        }
+        else if (m_report.presence == DESYNC_REMOTE) {
+            Log("[DESYNC] %s: tick %u, primeira entidade divergente: %s %u (só no %s)",
+                m_localName, m_report.tick, kindName, m_report.entity & 0xFFFF, m_remoteName);
+        }
+        else {
+            Log("[DESYNC] %s: tick %u, primeira entidade divergente: %s %u (%s %08X, %s %08X)",
+                m_localName, m_report.tick, kindName, m_report.entity & 0xFFFF,
+                m_localName, m_report.localHash, m_remoteName, m_report.remoteHash);
+        }
+    }
+
+    // Pelo log assíncrono: Compare roda na thread do jogo
+    template<typename... Args>
+    static void Log(const char* format, const Args&... args) {
+        CoopLog(format, args...);
+    }
+
+    const char* m_localName;
+    const char* m_remoteName;
+
+    DesyncCheck m_history[DESYNC_HISTORY];
+    uint32_t m_next;
+
+    uint32_t m_streak;
+    uint32_t m_pendingTick;
+    bool m_diverged;
+    DesyncReport m_report;
+
+    // Detalhe do outro lado sendo montado
+    uint32_t m_remoteTick;
+    uint32_t m_remoteTotal;
+    uint32_t m_remoteReceived;
+    uint32_t m_remoteIds[SNAPSHOT_MAX_ENTITIES];
+    uint32_t m_remoteHashes[SNAPSHOT_MAX_ENTITIES];
+
+    uint32_t m_checks;
+    uint32_t m_mismatches;
+    uint32_t m_episodes;
+};
@@ -0,0 +1,343 @@
+/**
+ * RE4 CO-OP MOD - Descoberta de Salas na LAN
+ *
+ * O código da sala sozinho não diz onde o host está. Na rede local o host
+ * anuncia a sala com beacons UDP pequenos (multicast no grupo
+ * DISCOVERY_GROUP e broadcast, os dois porque roteador doméstico costuma
+ * bloquear um ou outro) e o cliente mantém uma tabela de salas vivas:
+ *
+ * - Beacon (16 bytes): porta TCP do jogo e uma sessão aleatória por Start.
+ *   O código não vai no beacon: ele é o segredo do CPace, e em claro na
+ *   LAN qualquer um entraria na sala. O cliente tenta as salas vivas com o
+ *   código digitado e só a certa completa o handshake (a errada recusa e
+ *   segura o accept por NET_HANDSHAKE_FAIL_DELAY_MS, como a qualquer um)
+ * - Só o host esperando o cliente anuncia (CoopServer aceita um e para os
+ *   beacons ao conectar), então o beacon não leva players nem ping
+ * - Os primeiros DISCOVERY_BURST saem a cada DISCOVERY_BURST_MS (quem já
+ *   está com a tela de join aberta acha a sala na hora); depois um a cada
+ *   DISCOVERY_INTERVAL_MS
+ * - Sala some da tabela DISCOVERY_EXPIRE_MS depois do último beacon, ou
+ *   na hora com o beacon de despedida (host fechou ou lotou)
+ * - Endereço da sala = origem do datagrama (o que o cliente alcança), não
+ *   o que o host acha que é o próprio IP
+ *
+ *   DiscoveryAdvertiser advertiser;             // Host
+ *   advertiser.Start(27015);
+ *   advertiser.Update(GetTickCount());          // Periodicamente
+ *   DiscoveryListener listener;                 // Cliente
+ *   listener.Start();
+ *   listener.Poll(GetTickCount());              // Todo frame do menu
+ *   const DiscoverySession* sessions[DISCOVERY_MAX_SESSIONS];
+ *   uint32_t count = listener.Sessions(sessions, DISCOVERY_MAX_SESSIONS, GetTickCount());
+ */
+
+#pragma once
+#include "coop_core.h"
+#include "coop_crypto.h"
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#include <cstring>
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+constexpr uint16_t DISCOVERY_PORT = 27016;
+constexpr const char* DISCOVERY_GROUP = "239.255.82.52";   // Escopo local da organização
+constexpr uint32_t DISCOVERY_MAGIC = 0x44433452;            // "R4CD"
+constexpr uint8_t DISCOVERY_VERSION = 2;                     // 2: sem código no beacon
+
+constexpr uint32_t DISCOVERY_INTERVAL_MS = 1000;
+constexpr uint32_t DISCOVERY_BURST = 3;
+constexpr uint32_t DISCOVERY_BURST_MS = 100;
+constexpr uint32_t DISCOVERY_EXPIRE_MS = 3500;              // 3 beacons perdidos e meio
+
+constexpr uint32_t DISCOVERY_MAX_SESSIONS = 16;
+constexpr uint32_t DISCOVERY_MAX_TARGETS = 4;
+
+enum DiscoveryFlags : uint8_t {
+    DISCOVERY_CLOSING = 1 << 0,     // Despedida: tira da tabela já
+};
+
+//=============================================================================
+// FORMATO NO FIO
+//=============================================================================
+
+#pragma pack(push, 1)
+struct DiscoveryBeacon {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t flags;
+    uint16_t port;                  // TCP do jogo (CoopServer)
+    uint32_t session;               // Aleatória por Start (host reiniciado = sala nova)
+    uint32_t sequence;
+};
+#pragma pack(pop)
+
+// Sala vista pelo cliente
+struct DiscoverySession {
+    char ip[INET_ADDRSTRLEN];
+    uint16_t port;
+    uint8_t flags;
+    uint32_t session;
+    uint32_t sequence;
+    uint32_t firstSeen;             // GetTickCount() do primeiro beacon
+    uint32_t lastSeen;
+};
+
+//=============================================================================
+// HOST: ANUNCIA A SALA
+//=============================================================================
+
+class DiscoveryAdvertiser {
+public:
+    ~DiscoveryAdvertiser() { Stop(); }
+
+    // Grupo multicast e broadcast no discoveryPort; primeiro beacon já sai
+    bool Start(uint16_t gamePort, uint16_t discoveryPort = DISCOVERY_PORT) {
+        if (m_socket != INVALID_SOCKET) return true;
+
+        m_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (m_socket == INVALID_SOCKET) return false;
+
+        // Só a LAN; o loop deixa achar a sala na mesma máquina
+        int enable = 1;
+        int ttl = 1;
+        setsockopt(m_socket, SOL_SOCKET, SO_BROADCAST, (const char*)&enable, sizeof(enable));
+        setsockopt(m_socket, IPPROTO_IP, IP_MULTICAST_TTL, (const char*)&ttl, sizeof(ttl));
+        setsockopt(m_socket, IPPROTO_IP, IP_MULTICAST_LOOP, (const char*)&enable, sizeof(enable));
+
+        m_discoveryPort = discoveryPort;
+        m_targetCount = 0;
+        AddTarget(DISCOVERY_GROUP);
+        AddTarget("255.255.255.255");
+
+        memset(&m_beacon, 0, sizeof(m_beacon));
+        m_beacon.magic = DISCOVERY_MAGIC;
+        m_beacon.version = DISCOVERY_VERSION;
+        m_beacon.port = gamePort;
+        CryptoRandom((uint8_t*)&m_beacon.session, sizeof(m_beacon.session));
+
+        m_sent = 0;
+        Send(GetTickCount());
+        return true;
+    }
+
+    // Destino extra depois do Start (broadcast de uma sub-rede, VPN, IP conhecido)
+    bool AddTarget(const char* ip) {
+        if (m_targetCount >= DISCOVERY_MAX_TARGETS) return false;
+        sockaddr_in& target = m_targets[m_targetCount];
+        memset(&target, 0, sizeof(target));
+        target.sin_family = AF_INET;
+        target.sin_port = htons(m_discoveryPort);
+        if (inet_pton(AF_INET, ip, &target.sin_addr) != 1) return false;
+        m_targetCount++;
+        return true;
+    }
+
+    // Manda o beacon se já deu a hora
+    void Update(uint32_t now) {
+        if (m_socket == INVALID_SOCKET || (int32_t)(now - m_nextSend) < 0) return;
+        Send(now);
+    }
+
+    // Despedida e fecha
+    void Stop() {
+        if (m_socket == INVALID_SOCKET) return;
+        m_beacon.flags = DISCOVERY_CLOSING;
+        Send(GetTickCount());
+        closesocket(m_socket);
+        m_socket = INVALID_SOCKET;
+    }
+
+    // Fecha sem despedida (como um host que caiu)
+    void Abandon() {
+        if (m_socket == INVALID_SOCKET) return;
+        closesocket(m_socket);
+        m_socket = INVALID_SOCKET;
+    }
+
+    bool IsRunning() const { return m_socket != INVALID_SOCKET; }
+    uint32_t BeaconsSent() const { return m_sent; }
+    uint32_t Session() const { return m_beacon.session; }
+
+private:
+    void Send(uint32_t now) {
+        m_beacon.sequence = m_sent++;
+        for (uint32_t i = 0; i < m_targetCount; i++) {
+            // Rede sem rota para um dos destinos: os outros ainda valem
+            sendto(m_socket, (const char*)&m_beacon, sizeof(m_beacon), 0,
+                   (const sockaddr*)&m_targets[i], sizeof(m_targets[i]));
+        }
+        m_nextSend = now + (m_sent < DISCOVERY_BURST ? DISCOVERY_BURST_MS : DISCOVERY_INTERVAL_MS);
+    }
+
+    SOCKET m_socket = INVALID_SOCKET;
+    sockaddr_in m_targets[DISCOVERY_MAX_TARGETS];
+    uint32_t m_targetCount = 0;
+    uint16_t m_discoveryPort = DISCOVERY_PORT;
+    DiscoveryBeacon m_beacon = {};
+    uint32_t m_nextSend = 0;
+    uint32_t m_sent = 0;
+};
+
+//=============================================================================
+// CLIENTE: TABELA DE SALAS VIVAS
+//=============================================================================
+
+class DiscoveryListener {
+public:
+    ~DiscoveryListener() { Stop(); }
+
+    // Porta compartilhada (vários clientes na mesma máquina) e não bloqueante
+    bool Start(uint16_t port = DISCOVERY_PORT) {
+        if (m_socket != INVALID_SOCKET) return true;
+
+        m_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (m_socket == INVALID_SOCKET) return false;
+
+        int enable = 1;
+        setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, (const char*)&enable, sizeof(enable));
+
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = INADDR_ANY;
+        unsigned long nonBlocking = 1;
+        if (bind(m_socket, (sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR ||
+            ioctlsocket(m_socket, FIONBIO, &nonBlocking) == SOCKET_ERROR) {
+            closesocket(m_socket);
+            m_socket = INVALID_SOCKET;
+            return false;
+        }
+
+        // Sem multicast na rede ainda sobra o broadcast
+        ip_mreq group = {};
+        inet_pton(AF_INET, DISCOVERY_GROUP, &group.imr_multiaddr);
+        group.imr_interface.s_addr = INADDR_ANY;
+        setsockopt(m_socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, (const char*)&group, sizeof(group));
+
+        m_count = 0;
+        return true;
+    }
+
+    void Stop() {
+        if (m_socket == INVALID_SOCKET) return;
+        closesocket(m_socket);
+        m_socket = INVALID_SOCKET;
+    }
+
+    // Lê tudo o que chegou e tira as salas velhas. Retorna os beacons lidos.
+    uint32_t Poll(uint32_t now) {
+        if (m_socket == INVALID_SOCKET) return 0;
+
+        uint32_t received = 0;
+        for (;;) {
+            DiscoveryBeacon beacon;
+            sockaddr_in from = {};
+            int fromLength = sizeof(from);
+            int size = recvfrom(m_socket, (char*)&beacon, sizeof(beacon), 0, (sockaddr*)&from, &fromLength);
+            if (size < 0) break;
+
+            if (size != (int)sizeof(beacon) || beacon.magic != DISCOVERY_MAGIC ||
+                beacon.version != DISCOVERY_VERSION) {
+                m_rejected++;
+                continue;
+            }
+            received++;
+            OnBeacon(beacon, from, now);
+        }
+        m_received += received;
+
+        Expire(now);
+        return received;
+    }
+
+    // Salas vivas, a vista por último primeiro (ordem em que o cliente
+    // tenta o código). Retorna quantas escreveu em out.
+    uint32_t Sessions(const DiscoverySession** out, uint32_t max, uint32_t now) const {
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < m_count; i++) {
+            const DiscoverySession& s = m_sessions[i];
+            if (now - s.lastSeen > DISCOVERY_EXPIRE_MS) continue;
+
+            uint32_t at = count < max ? count++ : max;
+            while (at > 0 && (int32_t)(s.lastSeen - out[at - 1]->lastSeen) > 0) {
+                if (at < max) out[at] = out[at - 1];
+                at--;
+            }
+            if (at < max) out[at] = &s;
+        }
+        return count;
+    }
+
+    // Sala pela sessão do beacon. nullptr se não há.
+    const DiscoverySession* Find(uint32_t session, uint32_t now) const {
+        for (uint32_t i = 0; i < m_count; i++) {
+            const DiscoverySession& s = m_sessions[i];
+            if (s.session == session && now - s.lastSeen <= DISCOVERY_EXPIRE_MS) return &s;
+        }
+        return nullptr;
+    }
+
+    bool IsRunning() const { return m_socket != INVALID_SOCKET; }
+    uint32_t Count() const { return m_count; }
+    const DiscoverySession& At(uint32_t i) const { return m_sessions[i]; }
+    uint32_t Received() const { return m_received; }
+    uint32_t Rejected() const { return m_rejected; }
+
+private:
+    void OnBeacon(const DiscoveryBeacon& beacon, const sockaddr_in& from, uint32_t now) {
+        char ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &from.sin_addr, ip, sizeof(ip));
+
+        // Mesma sessão e origem = mesma sala (chega 2x: multicast e broadcast)
+        uint32_t i = 0;
+        while (i < m_count && (m_sessions[i].session != beacon.session || strcmp(m_sessions[i].ip, ip))) i++;
+
+        if (beacon.flags & DISCOVERY_CLOSING) {
+            if (i < m_count) m_sessions[i] = m_sessions[--m_count];
+            return;
+        }
+
+        if (i == m_count) {
+            if (m_count < DISCOVERY_MAX_SESSIONS) m_count++;
+            else i = Oldest();
+            memset(&m_sessions[i], 0, sizeof(m_sessions[i]));
+            m_sessions[i].session = beacon.session;
+            memcpy(m_sessions[i].ip, ip, sizeof(ip));
+            m_sessions[i].firstSeen = now;
+        }
+        else if ((int32_t)(beacon.sequence - m_sessions[i].sequence) < 0) {
+            m_sessions[i].lastSeen = now;
+            return;     // Cópia atrasada de um beacon anterior
+        }
+
+        DiscoverySession& s = m_sessions[i];
+        s.port = beacon.port;
+        s.flags = beacon.flags;
+        s.sequence = beacon.sequence;
+        s.lastSeen = now;
+    }
+
+    void Expire(uint32_t now) {
+        for (uint32_t i = 0; i < m_count;) {
+            if (now - m_sessions[i].lastSeen > DISCOVERY_EXPIRE_MS) m_sessions[i] = m_sessions[--m_count];
+            else i++;
+        }
+    }
+
+    uint32_t Oldest() const {
+        uint32_t oldest = 0;
+        for (uint32_t i = 1; i < m_count; i++) {
+            if ((int32_t)(m_sessions[i].lastSeen - m_sessions[oldest].lastSeen) < 0) oldest = i;
+        }
+        return oldest;
+    }
+
+    SOCKET m_socket = INVALID_SOCKET;
+    DiscoverySession m_sessions[DISCOVERY_MAX_SESSIONS];
+    uint32_t m_count = 0;
+    uint32_t m_received = 0;
+    uint32_t m_rejected = 0;
+};
@@ -0,0 +1,230 @@
+/**
+ * RE4 CO-OP MOD - Cache de Entidades por Frame
+ *
+ * PlayerPtr()/AshleyPtr() leem os globais do jogo a cada chamada. Em vez
+ * de cada sistema resolver (e validar) os ponteiros de novo, o cache faz
+ * isso uma vez no começo do frame para todos os slots de g_PlayerSlots
+ * e todo o resto usa o resultado:
+ *
+ * - Vtable: o primeiro dword do objeto precisa apontar para dentro do
+ *   executável, e a primeira entrada da vtable também
+ * - Faixa legível: o objeto inteiro (até o maior offset que o mod usa)
+ *   precisa estar em memória committed e gravável. O VirtualQuery só
+ *   roda quando o ponteiro muda ou a sala troca
+ * - Handles: cada slot tem uma geração que muda sempre que um objeto
+ *   novo entra no slot (ponteiro, vtable ou sala mudaram). Um handle
+ *   guardado de um frame anterior nunca resolve para outro objeto
+ *
+ *   EntityCache& entities = EntityCache::Instance();
+ *   entities.Refresh();                     // uma vez por frame
+ *   cPlayer* ashley = entities.Ashley();
+ *
+ * Usado só pela thread do jogo.
+ */
+
+#pragma once
+#include "coop_core.h"
+#include "coop_game_memory.h"
+#include "coop_checkpoint.h"
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+// Slots de player (mesma ordem de g_PlayerSlots e do snapshot)
+constexpr uint16_t ENTITY_SLOT_PLAYER = 0;
+constexpr uint16_t ENTITY_SLOT_ASHLEY = 1;
+constexpr uint16_t ENTITY_CACHE_SLOTS = COOP_MAX_PLAYERS;
+
+// Proteções que permitem leitura e escrita (o mod escreve pose e flags)
+constexpr DWORD ENTITY_WRITABLE_PAGES = PAGE_READWRITE | PAGE_WRITECOPY |
+                                        PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+
+// Referência estável a um slot. Vale enquanto a geração bater.
+struct EntityHandle {
+    uint16_t slot;
+    uint16_t generation;
+};
+
+//=============================================================================
+// VALIDAÇÃO
+//=============================================================================
+
+// Faixa [base, end) do executável do jogo
+struct ImageRange {
+    uintptr_t base = 0;
+    uintptr_t end = 0;
+
+    bool Contains(uintptr_t address) const { return address >= base && address < end; }
+};
+
+inline ImageRange GameImageRange() {
+    ImageRange range;
+    const uint8_t* base = (const uint8_t*)GetModuleHandleA(nullptr);
+    if (!base) return range;
+
+    const IMAGE_DOS_HEADER* dos = (const IMAGE_DOS_HEADER*)base;
+    const IMAGE_NT_HEADERS* nt = (const IMAGE_NT_HEADERS*)(base + dos->e_lfanew);
+    range.base = (uintptr_t)base;
+    range.end = range.base + nt->OptionalHeader.SizeOfImage;
+    return range;
+}
+
+// true se [address, address + size) está committed e gravável.
+// queries recebe quantas chamadas de VirtualQuery foram feitas.
+inline bool IsWritableRange(const void* address, size_t size, uint32_t& queries) {
+    uintptr_t at = (uintptr_t)address;
+    uintptr_t end = at + size;
+    if (end < at) return false;
+
+    while (at < end) {
+        MEMORY_BASIC_INFORMATION info;
+        queries++;
+        if (!VirtualQuery((const void*)at, &info, sizeof(info))) return false;
+        if (info.State != MEM_COMMIT) return false;
+        if (info.Protect & (PAGE_GUARD | PAGE_NOACCESS)) return false;
+        uintptr_t next = (uintptr_t)info.BaseAddress + info.RegionSize;
+        // Páginas sob checkpoint ficam só leitura, mas o handler libera a escrita
+        if (!(info.Protect & ENTITY_WRITABLE_PAGES) &&
+            !MemoryCheckpoints::Instance().Covers((const void*)at, (next < end ? next : end) - at)) {
+            return false;
+        }
+        at = next;
+    }
+    return true;
+}
+
+//=============================================================================
+// CACHE
+//=============================================================================
+
+class EntityCache {
+public:
+    static EntityCache& Instance() {
+        static EntityCache instance;
+        return instance;
+    }
+
+    // Resolve e valida todos os slots. Chamado uma vez no começo do frame.
+    void Refresh() {
+        if (!m_image.end) m_image = GameImageRange();
+
+        uint16_t roomId = CoopMod::CurrentRoomId();
+        bool roomChanged = roomId != m_roomId;
+        m_roomId = roomId;
+
+        uint32_t readSize = 0;
+        WithGameVersion([&](auto table) {
+            readSize = decltype(table)::PLAYER_READ_SIZE;
+        });
+
+        m_validMask = 0;
+        for (uint16_t i = 0; i < ENTITY_CACHE_SLOTS; i++) {
+            RefreshSlot(m_slots[i], g_PlayerSlots[i].source, readSize, roomChanged);
+            if (m_slots[i].entity) m_validMask |= 1u << i;
+        }
+        m_frame++;
+    }
+
+    // Esquece tudo (próximo Refresh valida do zero e troca as gerações)
+    void Invalidate() {
+        for (uint16_t i = 0; i < ENTITY_CACHE_SLOTS; i++) {
+            Drop(m_slots[i]);
+        }
+        m_validMask = 0;
+    }
+
+    cPlayer* Player(uint16_t slot) const {
+        return slot < ENTITY_CACHE_SLOTS ? m_slots[slot].entity : nullptr;
+    }
+
+    cPlayer* Leon() const { return m_slots[ENTITY_SLOT_PLAYER].entity; }
+    cPlayer* Ashley() const { return m_slots[ENTITY_SLOT_ASHLEY].entity; }
+    bool BothValid() const { return Leon() && Ashley(); }
+
+    // Bit i = slot i válido neste frame
+    uint32_t ValidMask() const { return m_validMask; }
+    uint32_t ValidCount() const {
+        uint32_t count = 0;
+        for (uint32_t mask = m_validMask; mask; mask &= mask - 1) count++;
+        return count;
+    }
+
+    EntityHandle Handle(uint16_t slot) const {
+        EntityHandle handle;
+        handle.slot = slot;
+        handle.generation = slot < ENTITY_CACHE_SLOTS ? m_slots[slot].generation : 0;
+        return handle;
+    }
+
+    // nullptr se o slot mudou (ou ficou inválido) desde que o handle foi pego
+    cPlayer* Resolve(EntityHandle handle) const {
+        if (handle.slot >= ENTITY_CACHE_SLOTS) return nullptr;
+        const Slot& slot = m_slots[handle.slot];
+        return slot.generation == handle.generation ? slot.entity : nullptr;
+    }
+
+    uint16_t RoomId() const { return m_roomId; }
+    uint32_t Frame() const { return m_frame; }
+
+    // Chamadas de VirtualQuery desde o início (para medir o custo)
+    uint32_t QueryCount() const { return m_queries; }
+
+private:
+    struct Slot {
+        cPlayer* entity = nullptr;      // nullptr se inválido neste frame
+        cPlayer* raw = nullptr;         // Último valor lido do global
+        GameAddress vtable = 0;
+        uint16_t generation = 0;        // Muda a cada objeto novo no slot
+        bool rangeChecked = false;      // VirtualQuery já aprovou raw
+    };
+
+    void RefreshSlot(Slot& slot, cPlayer** source, uint32_t readSize, bool roomChanged) {
+        cPlayer* raw = source ? *source : nullptr;
+
+        if (raw != slot.raw || roomChanged || !readSize) {
+            Drop(slot);
+            slot.raw = raw;
+        }
+        if (!raw || !readSize) return;
+
+        if (!slot.rangeChecked) {
+            if (!IsWritableRange(raw, readSize, m_queries)) return;
+            slot.rangeChecked = true;
+        }
+
+        // Mesmo endereço com outra vtable: objeto novo (ou ainda construindo)
+        GameAddress vtable = *(const GameAddress*)raw;
+        if (vtable != slot.vtable) {
+            slot.entity = nullptr;
+            slot.vtable = 0;
+            if (!IsVtable(vtable)) return;
+            slot.vtable = vtable;
+        }
+
+        if (!slot.entity) {
+            slot.entity = raw;
+            slot.generation++;
+        }
+    }
+
+    bool IsVtable(GameAddress vtable) const {
+        if (vtable & 3) return false;
+        if (!m_image.Contains(vtable) || !m_image.Contains(vtable + sizeof(GameAddress) - 1)) return false;
+        return m_image.Contains(*FromGameAddress<const GameAddress>(vtable));
+    }
+
+    static void Drop(Slot& slot) {
+        slot.entity = nullptr;
+        slot.raw = nullptr;
+        slot.vtable = 0;
+        slot.rangeChecked = false;
+    }
+
+    Slot m_slots[ENTITY_CACHE_SLOTS];
+    ImageRange m_image;
+    uint32_t m_validMask = 0;
+    uint16_t m_roomId = 0;
+    uint32_t m_frame = 0;
+    uint32_t m_queries = 0;
+};
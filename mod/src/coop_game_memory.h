@@ -0,0 +1,318 @@
+/**
+ * RE4 CO-OP MOD - Acesso Tipado à Memória do Jogo
+ *
+ * Cada executável suportado tem uma OffsetTable<versão> com os campos
+ * (tipo + offset) conhecidos em compile-time. A versão é escolhida uma
+ * vez no Initialize; WithGameVersion() faz um único switch por ponto de
+ * entrada e tudo dentro do lambda usa offsets constantes:
+ *
+ *   WithGameVersion([&](auto table) {
+ *       EmView ashley(table, EntityCache::Instance().Ashley());
+ *       ashley.SetPos(leon.Pos());
+ *   });
+ *
+ * Para suportar outro executável: uma nova GameVersion, uma nova
+ * especialização de OffsetTable e um case em WithGameVersion.
+ */
+
+#pragma once
+#include "coop_core.h"
+#include <type_traits>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define COOP_PREFETCH(p) _mm_prefetch((const char*)(p), _MM_HINT_T0)
+#else
+#define COOP_PREFETCH(p) ((void)0)
+#endif
+
+//=============================================================================
+// VERSÕES E TABELAS DE OFFSETS
+//=============================================================================
+
+enum class GameVersion : uint8_t {
+    UNKNOWN = 0,
+    V1_1_0,             // Steam 1.1.0 (offsets do SDK re4_tweaks)
+};
+
+// Ponteiro guardado na memória do jogo. O jogo é x86, então são sempre
+// 32 bits, mesmo quando o mod roda num processo de 64 bits (harness).
+typedef uint32_t GameAddress;
+
+template<typename T>
+inline T* FromGameAddress(GameAddress address) { return (T*)(uintptr_t)address; }
+
+// Um campo do jogo: tipo + offset a partir da base do objeto
+template<typename T, uint32_t Offset>
+struct GameField {
+    using Type = T;
+    static constexpr uint32_t OFFSET = Offset;
+};
+
+template<GameVersion V> struct OffsetTable;
+
+template<>
+struct OffsetTable<GameVersion::V1_1_0> {
+    static constexpr GameVersion VERSION = GameVersion::V1_1_0;
+
+    // Dentro de cEm (base entity)
+    using HP = GameField<int16_t, 0x324>;
+    using HPMax = GameField<int16_t, 0x326>;
+    using Flags = GameField<uint32_t, 0x3E8>;
+
+    // Dentro de cModel/cCoord (posição)
+    using Pos = GameField<Vec, 0x94>;
+    using PosOld = GameField<Vec, 0x110>;
+
+    // Atributos de colisão (atari.m_flag)
+    using AtariFlag = GameField<uint16_t, 0x2B4 + 0x1A>;
+
+    // Dentro de cPlayer
+    using PlayerFlag = GameField<uint32_t, 0x464>;
+    using PlayerState = GameField<uint32_t, 0x468>;
+    using Weapon = GameField<GameAddress, 0x7D8>;      // cPlWep*
+    using LaserType = GameField<uint32_t, 0x804>;
+
+    // Bytes de cPlayer que o mod lê/escreve (validação de ponteiro)
+    static constexpr uint32_t PLAYER_READ_SIZE = LaserType::OFFSET + sizeof(LaserType::Type);
+
+    // cUnit (base de cEm)
+    using UnitFlag = GameField<uint32_t, 0x4>;          // be_flag
+    static constexpr uint32_t UNIT_ALIVE = 0x1;
+
+    // cManager<cEm> (EmMgr)
+    using ManagerArray = GameField<GameAddress, 0x4>;
+    using ManagerCount = GameField<uint32_t, 0x8>;
+    using ManagerStride = GameField<uint32_t, 0xC>;     // sizeof de cada slot
+
+    // Endereços absolutos
+    static constexpr uint32_t GLOBALS_BASE = 0x85A760;
+    static constexpr uint32_t JOY_ARRAY = 0xC63008;     // Joy[4]
+    static constexpr uint32_t KEY_INPUT = 0xC62EF0;
+
+    // Dentro de GLOBAL_WK
+    using RoomId = GameField<uint16_t, 0x4FAC>;         // ex: 0x100
+    using PlayerType = GameField<uint8_t, 0x4FC8>;
+    using PlayerCostume = GameField<uint8_t, 0x4FC9>;
+    using SubCostume = GameField<uint8_t, 0x4FCB>;      // Roupa da Ashley
+};
+
+//=============================================================================
+// SELEÇÃO DA VERSÃO
+//=============================================================================
+
+inline GameVersion& ActiveGameVersionStorage() {
+    static GameVersion version = GameVersion::UNKNOWN;
+    return version;
+}
+
+inline GameVersion ActiveGameVersion() { return ActiveGameVersionStorage(); }
+
+// Chamado uma vez no Initialize. false se não há tabela para a versão.
+inline bool SelectGameVersion(GameVersion version) {
+    switch (version) {
+        case GameVersion::V1_1_0:
+            ActiveGameVersionStorage() = version;
+            return true;
+        default:
+            ActiveGameVersionStorage() = GameVersion::UNKNOWN;
+            return false;
+    }
+}
+
+// Chama fn(OffsetTable<ativa>()). Versão desconhecida não toca na memória
+// do jogo e retorna false.
+template<typename Fn>
+inline bool WithGameVersion(Fn&& fn) {
+    switch (ActiveGameVersion()) {
+        case GameVersion::V1_1_0:
+            fn(OffsetTable<GameVersion::V1_1_0>());
+            return true;
+        default:
+            return false;
+    }
+}
+
+//=============================================================================
+// VIEWS
+//=============================================================================
+
+// Campos lidos juntos (pose + vida) para replicação
+struct EntityState {
+    Vec pos;
+    int16_t hp;
+    int16_t hpMax;
+    uint32_t flags;
+};
+
+// cEm e tudo que herda dele no jogo (cPlayer inclusive)
+template<typename Table>
+class EmView {
+public:
+    EmView(Table, cEm* em) : m_base((uint8_t*)em) {}
+    EmView(Table, cPlayer* player) : m_base((uint8_t*)player) {}
+
+    explicit operator bool() const { return m_base != nullptr; }
+
+    // Referência tipada para qualquer campo da tabela
+    template<typename F>
+    typename F::Type& Ref() const { return *(typename F::Type*)(m_base + F::OFFSET); }
+
+    int16_t HP() const { return Ref<typename Table::HP>(); }
+    void SetHP(int16_t hp) const { Ref<typename Table::HP>() = hp; }
+    int16_t HPMax() const { return Ref<typename Table::HPMax>(); }
+
+    uint32_t Flags() const { return Ref<typename Table::Flags>(); }
+    void SetFlags(uint32_t flags) const { Ref<typename Table::Flags>() = flags; }
+
+    Vec Pos() const { return Ref<typename Table::Pos>(); }
+    void SetPos(const Vec& pos) const { Ref<typename Table::Pos>() = pos; }
+    Vec PosOld() const { return Ref<typename Table::PosOld>(); }
+    void SetPosOld(const Vec& pos) const { Ref<typename Table::PosOld>() = pos; }
+
+    uint16_t AtariFlag() const { return Ref<typename Table::AtariFlag>(); }
+    void SetAtariFlag(uint16_t flags) const { Ref<typename Table::AtariFlag>() = flags; }
+
+    // Pose + vida numa leitura só
+    EntityState Gather() const {
+        EntityState state;
+        state.pos = Pos();
+        state.hp = HP();
+        state.hpMax = HPMax();
+        state.flags = Flags();
+        return state;
+    }
+
+protected:
+    uint8_t* m_base;
+};
+
+// Campos que só existem em cPlayer
+template<typename Table>
+class PlayerView : public EmView<Table> {
+public:
+    PlayerView(Table table, cPlayer* player) : EmView<Table>(table, player) {}
+
+    uint32_t PlayerFlag() const { return this->template Ref<typename Table::PlayerFlag>(); }
+    void SetPlayerFlag(uint32_t flags) const { this->template Ref<typename Table::PlayerFlag>() = flags; }
+
+    uint32_t PlayerState() const { return this->template Ref<typename Table::PlayerState>(); }
+
+    cPlWep* Weapon() const { return FromGameAddress<cPlWep>(this->template Ref<typename Table::Weapon>()); }
+    uint32_t LaserType() const { return this->template Ref<typename Table::LaserType>(); }
+};
+
+// GLOBAL_WK
+template<typename Table>
+class GlobalsView {
+public:
+    GlobalsView(Table, uint8_t* globals) : m_base(globals) {}
+
+    explicit operator bool() const { return m_base != nullptr; }
+
+    template<typename F>
+    typename F::Type& Ref() const { return *(typename F::Type*)(m_base + F::OFFSET); }
+
+    uint16_t RoomId() const { return Ref<typename Table::RoomId>(); }
+    uint8_t PlayerType() const { return Ref<typename Table::PlayerType>(); }
+    uint8_t PlayerCostume() const { return Ref<typename Table::PlayerCostume>(); }
+    uint8_t SubCostume() const { return Ref<typename Table::SubCostume>(); }
+
+private:
+    uint8_t* m_base;
+};
+
+// Slots do EmMgr (array contíguo com stride fixo; slot livre não tem UNIT_ALIVE)
+template<typename Table>
+class EmListView {
+public:
+    EmListView(Table, cEmMgr* manager) {
+        if (!manager) return;
+        uint8_t* base = (uint8_t*)manager;
+        m_array = FromGameAddress<uint8_t>(*(GameAddress*)(base + Table::ManagerArray::OFFSET));
+        m_count = *(uint32_t*)(base + Table::ManagerCount::OFFSET);
+        m_stride = *(uint32_t*)(base + Table::ManagerStride::OFFSET);
+        if (!m_array || !m_stride) m_count = 0;
+    }
+
+    uint32_t Count() const { return m_count; }
+    uint32_t Stride() const { return m_stride; }
+
+    cEm* At(uint32_t index) const { return (cEm*)(m_array + index * m_stride); }
+
+    bool IsAlive(uint32_t index) const {
+        return (*(uint32_t*)(m_array + index * m_stride + Table::UnitFlag::OFFSET) & Table::UNIT_ALIVE) != 0;
+    }
+
+private:
+    uint8_t* m_array = nullptr;
+    uint32_t m_count = 0;
+    uint32_t m_stride = 0;
+};
+
+//=============================================================================
+// GATHER EM LOTE
+//=============================================================================
+
+// Pose + vida de várias entidades numa passada, buscando a próxima na cache
+// enquanto lê a atual. Entradas nulas são puladas. Retorna quantas leu.
+template<typename Table, typename Entity>
+inline uint32_t GatherEntities(Table table, Entity* const* entities, uint32_t count, EntityState* out) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (i + 1 < count && entities[i + 1]) {
+            const uint8_t* next = (const uint8_t*)entities[i + 1];
+            COOP_PREFETCH(next + Table::Pos::OFFSET);
+            COOP_PREFETCH(next + Table::HP::OFFSET);
+        }
+        if (!entities[i]) continue;
+        out[n++] = EmView<Table>(table, entities[i]).Gather();
+    }
+    return n;
+}
+
+//=============================================================================
+// HELPERS DO CO-OP
+//=============================================================================
+
+namespace CoopMod {
+
+    // Sala atual (0 se os globais ainda não foram encontrados)
+    inline uint16_t CurrentRoomId() {
+        uint16_t roomId = 0;
+        if (pGlobals) {
+            WithGameVersion([&](auto table) {
+                roomId = GlobalsView(table, pGlobals).RoomId();
+            });
+        }
+        return roomId;
+    }
+
+    inline void CopyPosition(cPlayer* from, cPlayer* to) {
+        if (!from || !to) return;
+
+        WithGameVersion([&](auto table) {
+            EmView src(table, from), dst(table, to);
+            dst.SetPos(src.Pos());
+            dst.SetPosOld(src.PosOld());
+        });
+    }
+
+    inline void DisableCollision(cPlayer* entity) {
+        if (!entity) return;
+
+        WithGameVersion([&](auto table) {
+            EmView em(table, entity);
+            em.SetAtariFlag(em.AtariFlag() & ~(SAT_SCA_ENABLE | SAT_OBA_ENABLE));
+        });
+    }
+
+    inline void EnableCollision(cPlayer* entity) {
+        if (!entity) return;
+
+        WithGameVersion([&](auto table) {
+            EmView em(table, entity);
+            em.SetAtariFlag(em.AtariFlag() | SAT_SCA_ENABLE | SAT_OBA_ENABLE);
+        });
+    }
+}
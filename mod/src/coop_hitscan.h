@@ -0,0 +1,416 @@
+/**
+ * RE4 CO-OP MOD - Hitscan (tiro da Ashley)
+ *
+ * Cada inimigo vivo vira uma cápsula vertical (pés até a cabeça). Uma vez
+ * por tick em que alguém atira, as cápsulas são espalhadas num hash
+ * espacial de células no plano XZ. O raio anda pelas células em ordem
+ * (DDA 2D) e testa as cápsulas de cada célula de 4 em 4 com SSE.
+ * Para na primeira célula cuja saída já passou do acerto mais próximo.
+ *
+ * As cápsulas de cada bucket ficam copiadas em sequência (SoA), então o
+ * lote de 4 é um load direto. Um lote pode passar do fim do bucket e
+ * pegar cápsulas do próximo: são cápsulas de verdade, o resultado
+ * continua certo.
+ *
+ *   HitscanWorld& world = ...;
+ *   world.Rebuild(table, EmListView(table, pEmMgr));
+ *   HitscanHit hit;
+ *   if (world.Raycast(origin, direction, HITSCAN_MAX_DISTANCE, hit)) ...
+ */
+
+#pragma once
+#include "coop_core.h"
+#include "coop_game_memory.h"
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define COOP_HITSCAN_SSE 1
+#include <emmintrin.h>
+#endif
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+constexpr uint32_t HITSCAN_MAX_ENTITIES = 1024;
+constexpr uint32_t HITSCAN_BUCKETS = 1024;              // Potência de 2
+constexpr float HITSCAN_CELL_SIZE = 400.0f;             // 4 m
+
+// Hitbox aproximada até mapear o atari do cEm (unidades do jogo: cm)
+constexpr float HITSCAN_ENEMY_HEIGHT = 175.0f;
+constexpr float HITSCAN_ENEMY_RADIUS = 35.0f;
+
+constexpr float HITSCAN_MAX_DISTANCE = 5000.0f;
+
+// Cada cápsula cobre no máximo 2x2 células (raio <= metade da célula)
+constexpr uint32_t HITSCAN_MAX_ENTRIES = HITSCAN_MAX_ENTITIES * 4;
+static_assert(HITSCAN_ENEMY_RADIUS * 2.0f <= HITSCAN_CELL_SIZE, "hitscan: cápsula maior que a célula");
+
+struct HitscanHit {
+    uint32_t index;         // Índice no EmMgr
+    cEm* entity;
+    float distance;
+    Vec point;
+};
+
+//=============================================================================
+// INTERSEÇÃO
+//=============================================================================
+
+// Cápsula vertical: segmento (x, y0, z)-(x, y1, z) com raio r.
+// Retorna a distância de entrada (direction normalizada) ou FLT_MAX.
+// Raio que começa dentro da cápsula não acerta.
+inline float RayCapsule(const Vec& origin, const Vec& direction,
+                        float x, float z, float y0, float y1, float r) {
+    float ox = origin.x - x;
+    float oz = origin.z - z;
+    float best = FLT_MAX;
+
+    // Lateral (cilindro infinito, cortado em y0..y1)
+    float a = direction.x * direction.x + direction.z * direction.z;
+    float bXZ = ox * direction.x + oz * direction.z;
+    float cXZ = ox * ox + oz * oz - r * r;
+    if (a > 1e-8f) {
+        float disc = bXZ * bXZ - a * cXZ;
+        if (disc >= 0.0f) {
+            float t = (-bXZ - sqrtf(disc)) / a;
+            float y = origin.y + t * direction.y;
+            if (t >= 0.0f && y >= y0 && y <= y1) best = t;
+        }
+    }
+
+    // Tampas (esferas nas pontas do segmento)
+    const float caps[2] = { y0, y1 };
+    for (float capY : caps) {
+        float oy = origin.y - capY;
+        float b = bXZ + oy * direction.y;
+        float c = cXZ + oy * oy;
+        float disc = b * b - c;
+        if (disc < 0.0f) continue;
+        float t = -b - sqrtf(disc);
+        if (t >= 0.0f && t < best) best = t;
+    }
+    return best;
+}
+
+#ifdef COOP_HITSCAN_SSE
+
+// Mesma conta de RayCapsule para 4 cápsulas (arrays podem estar desalinhados)
+inline __m128 RayCapsule4(const Vec& origin, const Vec& direction,
+                          const float* x, const float* z, const float* y0, const float* y1, const float* r) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 none = _mm_set1_ps(FLT_MAX);
+    const __m128 dx = _mm_set1_ps(direction.x);
+    const __m128 dy = _mm_set1_ps(direction.y);
+    const __m128 dz = _mm_set1_ps(direction.z);
+    const __m128 oy = _mm_set1_ps(origin.y);
+
+    __m128 radius = _mm_loadu_ps(r);
+    __m128 ox = _mm_sub_ps(_mm_set1_ps(origin.x), _mm_loadu_ps(x));
+    __m128 oz = _mm_sub_ps(_mm_set1_ps(origin.z), _mm_loadu_ps(z));
+    __m128 bottom = _mm_loadu_ps(y0);
+    __m128 top = _mm_loadu_ps(y1);
+
+    __m128 bXZ = _mm_add_ps(_mm_mul_ps(ox, dx), _mm_mul_ps(oz, dz));
+    __m128 cXZ = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(ox, ox), _mm_mul_ps(oz, oz)), _mm_mul_ps(radius, radius));
+    __m128 best = none;
+
+    // Lateral
+    float aScalar = direction.x * direction.x + direction.z * direction.z;
+    if (aScalar > 1e-8f) {
+        __m128 a = _mm_set1_ps(aScalar);
+        __m128 disc = _mm_sub_ps(_mm_mul_ps(bXZ, bXZ), _mm_mul_ps(a, cXZ));
+        __m128 root = _mm_sqrt_ps(_mm_max_ps(disc, zero));
+        __m128 t = _mm_div_ps(_mm_sub_ps(_mm_sub_ps(zero, bXZ), root), a);
+        __m128 y = _mm_add_ps(oy, _mm_mul_ps(t, dy));
+        __m128 ok = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(disc, zero), _mm_cmpge_ps(t, zero)),
+                               _mm_and_ps(_mm_cmpge_ps(y, bottom), _mm_cmple_ps(y, top)));
+        best = _mm_or_ps(_mm_and_ps(ok, t), _mm_andnot_ps(ok, best));
+    }
+
+    // Tampas
+    __m128 capY[2] = { bottom, top };
+    for (int k = 0; k < 2; k++) {
+        __m128 oyc = _mm_sub_ps(oy, capY[k]);
+        __m128 b = _mm_add_ps(bXZ, _mm_mul_ps(oyc, dy));
+        __m128 c = _mm_add_ps(cXZ, _mm_mul_ps(oyc, oyc));
+        __m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), c);
+        __m128 t = _mm_sub_ps(_mm_sub_ps(zero, b), _mm_sqrt_ps(_mm_max_ps(disc, zero)));
+        __m128 ok = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(disc, zero), _mm_cmpge_ps(t, zero)),
+                               _mm_cmplt_ps(t, best));
+        best = _mm_or_ps(_mm_and_ps(ok, t), _mm_andnot_ps(ok, best));
+    }
+    return best;
+}
+
+#endif
+
+//=============================================================================
+// HASH ESPACIAL
+//=============================================================================
+
+class HitscanWorld {
+public:
+    void Clear() { m_count = 0; m_built = false; }
+
+    // Pés do inimigo em feet; a cápsula sobe HITSCAN_ENEMY_HEIGHT
+    bool Add(uint32_t index, cEm* entity, const Vec& feet, float radius = HITSCAN_ENEMY_RADIUS) {
+        if (m_count >= HITSCAN_MAX_ENTITIES) return false;
+        if (radius > HITSCAN_CELL_SIZE * 0.5f) radius = HITSCAN_CELL_SIZE * 0.5f;
+
+        uint32_t i = m_count++;
+        m_index[i] = index;
+        m_entity[i] = entity;
+        m_x[i] = feet.x;
+        m_z[i] = feet.z;
+        m_y0[i] = feet.y + radius;
+        m_y1[i] = feet.y + (HITSCAN_ENEMY_HEIGHT > 2.0f * radius ? HITSCAN_ENEMY_HEIGHT - radius : radius);
+        m_r[i] = radius;
+        m_built = false;
+        return true;
+    }
+
+    // Todos os inimigos vivos do EmMgr, já com o hash montado
+    template<typename Table>
+    void Rebuild(Table table, const EmListView<Table>& enemies) {
+        Clear();
+        uint32_t count = enemies.Count();
+        for (uint32_t i = 0; i < count; i++) {
+            if (i + 1 < count) COOP_PREFETCH((const uint8_t*)enemies.At(i + 1) + Table::Pos::OFFSET);
+            if (!enemies.IsAlive(i)) continue;
+
+            cEm* em = enemies.At(i);
+            EmView<Table> view(table, em);
+            if (view.HP() <= 0) continue;
+            if (!Add(i, em, view.Pos())) break;
+        }
+        Build();
+    }
+
+    // Distribui as cápsulas nos buckets (counting sort, sem alocação)
+    void Build() {
+        memset(m_bucketStart, 0, sizeof(m_bucketStart));
+
+        m_minX = m_minZ = FLT_MAX;
+        m_maxX = m_maxZ = -FLT_MAX;
+        for (uint32_t i = 0; i < m_count; i++) {
+            m_minX = fminf(m_minX, m_x[i] - m_r[i]);
+            m_maxX = fmaxf(m_maxX, m_x[i] + m_r[i]);
+            m_minZ = fminf(m_minZ, m_z[i] - m_r[i]);
+            m_maxZ = fmaxf(m_maxZ, m_z[i] + m_r[i]);
+        }
+
+        uint32_t buckets[4];
+        for (uint32_t i = 0; i < m_count; i++) {
+            uint32_t n = CapsuleBuckets(i, buckets);
+            for (uint32_t k = 0; k < n; k++) m_bucketStart[buckets[k] + 1]++;
+        }
+        for (uint32_t b = 0; b < HITSCAN_BUCKETS; b++) {
+            m_bucketStart[b + 1] += m_bucketStart[b];
+        }
+
+        uint32_t cursor[HITSCAN_BUCKETS];
+        memcpy(cursor, m_bucketStart, sizeof(cursor));
+        for (uint32_t i = 0; i < m_count; i++) {
+            uint32_t n = CapsuleBuckets(i, buckets);
+            for (uint32_t k = 0; k < n; k++) {
+                uint32_t e = cursor[buckets[k]]++;
+                m_entryX[e] = m_x[i];
+                m_entryZ[e] = m_z[i];
+                m_entryY0[e] = m_y0[i];
+                m_entryY1[e] = m_y1[i];
+                m_entryR[e] = m_r[i];
+                m_entryOwner[e] = i;
+            }
+        }
+
+        // Sobra do último lote: cápsulas que nunca acertam
+        uint32_t total = m_bucketStart[HITSCAN_BUCKETS];
+        for (uint32_t e = total; e < total + 3; e++) {
+            m_entryX[e] = m_entryZ[e] = 1e15f;
+            m_entryY0[e] = m_entryY1[e] = m_entryR[e] = 0.0f;
+            m_entryOwner[e] = 0;
+        }
+        m_built = true;
+    }
+
+    // Acerto mais próximo até maxDistance. direction não precisa estar normalizada.
+    bool Raycast(const Vec& origin, const Vec& direction, float maxDistance, HitscanHit& out) const {
+        if (!m_built || !m_count) return false;
+
+        float length = sqrtf(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+        if (length < 1e-6f) return false;
+        Vec d = { direction.x / length, direction.y / length, direction.z / length };
+
+        // Só anda pelo trecho do raio dentro do retângulo XZ das cápsulas
+        float enter = 0.0f, leave = maxDistance;
+        if (!ClipSlab(origin.x, d.x, m_minX, m_maxX, enter, leave) ||
+            !ClipSlab(origin.z, d.z, m_minZ, m_maxZ, enter, leave)) {
+            return false;
+        }
+
+        // DDA no plano XZ, em unidades de t (distância ao longo do raio)
+        int32_t cx = CellCoord(origin.x + d.x * enter);
+        int32_t cz = CellCoord(origin.z + d.z * enter);
+        int32_t stepX = d.x > 0.0f ? 1 : -1;
+        int32_t stepZ = d.z > 0.0f ? 1 : -1;
+        float deltaX = fabsf(d.x) > 1e-8f ? HITSCAN_CELL_SIZE / fabsf(d.x) : FLT_MAX;
+        float deltaZ = fabsf(d.z) > 1e-8f ? HITSCAN_CELL_SIZE / fabsf(d.z) : FLT_MAX;
+        float nextX = deltaX == FLT_MAX ? FLT_MAX
+            : ((float)(cx + (stepX > 0)) * HITSCAN_CELL_SIZE - origin.x) / d.x;
+        float nextZ = deltaZ == FLT_MAX ? FLT_MAX
+            : ((float)(cz + (stepZ > 0)) * HITSCAN_CELL_SIZE - origin.z) / d.z;
+
+        float best = maxDistance;
+        uint32_t bestOwner = 0;
+        bool found = false;
+
+        // Buckets já testados neste raio (células diferentes podem cair no mesmo)
+        uint32_t visited[64];
+        uint32_t visitedCount = 0;
+
+        for (;;) {
+            uint32_t bucket = CellBucket(cx, cz);
+            bool seen = false;
+            for (uint32_t v = 0; v < visitedCount; v++) seen |= visited[v] == bucket;
+            if (!seen) {
+                if (visitedCount < 64) visited[visitedCount++] = bucket;
+                TestBucket(bucket, origin, d, best, bestOwner, found);
+            }
+
+            float cellExit = nextX < nextZ ? nextX : nextZ;
+            if (cellExit >= best || cellExit >= leave) break;   // Nada depois daqui é mais perto
+
+            if (nextX < nextZ) {
+                cx += stepX;
+                nextX += deltaX;
+            }
+            else {
+                cz += stepZ;
+                nextZ += deltaZ;
+            }
+        }
+
+        if (!found) return false;
+        out.index = m_index[bestOwner];
+        out.entity = m_entity[bestOwner];
+        out.distance = best;
+        out.point = { origin.x + d.x * best, origin.y + d.y * best, origin.z + d.z * best };
+        return true;
+    }
+
+    // Referência: testa todas as cápsulas, sem hash (para comparar)
+    bool RaycastBruteForce(const Vec& origin, const Vec& direction, float maxDistance, HitscanHit& out) const {
+        float length = sqrtf(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+        if (length < 1e-6f) return false;
+        Vec d = { direction.x / length, direction.y / length, direction.z / length };
+
+        float best = maxDistance;
+        bool found = false;
+        for (uint32_t i = 0; i < m_count; i++) {
+            float t = RayCapsule(origin, d, m_x[i], m_z[i], m_y0[i], m_y1[i], m_r[i]);
+            if (t < best) {
+                best = t;
+                found = true;
+                out.index = m_index[i];
+                out.entity = m_entity[i];
+            }
+        }
+        if (!found) return false;
+        out.distance = best;
+        out.point = { origin.x + d.x * best, origin.y + d.y * best, origin.z + d.z * best };
+        return true;
+    }
+
+    uint32_t Count() const { return m_count; }
+
+private:
+    static int32_t CellCoord(float v) { return (int32_t)floorf(v / HITSCAN_CELL_SIZE); }
+
+    // Recorta [enter, leave] pela faixa min..max de um eixo
+    static bool ClipSlab(float origin, float d, float min, float max, float& enter, float& leave) {
+        if (fabsf(d) < 1e-8f) return origin >= min && origin <= max;
+        float t0 = (min - origin) / d;
+        float t1 = (max - origin) / d;
+        if (t0 > t1) { float swap = t0; t0 = t1; t1 = swap; }
+        if (t0 > enter) enter = t0;
+        if (t1 < leave) leave = t1;
+        return enter <= leave;
+    }
+
+    static uint32_t CellBucket(int32_t cx, int32_t cz) {
+        uint32_t h = (uint32_t)cx * 73856093u ^ (uint32_t)cz * 19349663u;
+        return h & (HITSCAN_BUCKETS - 1);
+    }
+
+    // Buckets das células que a cápsula toca (1 a 4, sem repetir)
+    uint32_t CapsuleBuckets(uint32_t i, uint32_t* out) const {
+        int32_t x0 = CellCoord(m_x[i] - m_r[i]), x1 = CellCoord(m_x[i] + m_r[i]);
+        int32_t z0 = CellCoord(m_z[i] - m_r[i]), z1 = CellCoord(m_z[i] + m_r[i]);
+        uint32_t n = 0;
+        for (int32_t cx = x0; cx <= x1; cx++) {
+            for (int32_t cz = z0; cz <= z1; cz++) {
+                uint32_t bucket = CellBucket(cx, cz);
+                bool repeated = false;
+                for (uint32_t k = 0; k < n; k++) repeated |= out[k] == bucket;
+                if (!repeated) out[n++] = bucket;
+            }
+        }
+        return n;
+    }
+
+    void TestBucket(uint32_t bucket, const Vec& origin, const Vec& d,
+                    float& best, uint32_t& bestOwner, bool& found) const {
+        uint32_t begin = m_bucketStart[bucket];
+        uint32_t end = m_bucketStart[bucket + 1];
+
+#ifdef COOP_HITSCAN_SSE
+        for (uint32_t e = begin; e < end; e += 4) {
+            __m128 t = RayCapsule4(origin, d, &m_entryX[e], &m_entryZ[e], &m_entryY0[e], &m_entryY1[e], &m_entryR[e]);
+            if (_mm_movemask_ps(_mm_cmplt_ps(t, _mm_set1_ps(best))) == 0) continue;
+
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, t);
+            for (uint32_t k = 0; k < 4; k++) {
+                if (lanes[k] < best) {
+                    best = lanes[k];
+                    bestOwner = m_entryOwner[e + k];
+                    found = true;
+                }
+            }
+        }
+#else
+        for (uint32_t e = begin; e < end; e++) {
+            float t = RayCapsule(origin, d, m_entryX[e], m_entryZ[e], m_entryY0[e], m_entryY1[e], m_entryR[e]);
+            if (t < best) {
+                best = t;
+                bestOwner = m_entryOwner[e];
+                found = true;
+            }
+        }
+#endif
+    }
+
+    // Cápsulas (uma por inimigo)
+    uint32_t m_count = 0;
+    bool m_built = false;
+    uint32_t m_index[HITSCAN_MAX_ENTITIES];
+    cEm* m_entity[HITSCAN_MAX_ENTITIES];
+    float m_x[HITSCAN_MAX_ENTITIES];
+    float m_z[HITSCAN_MAX_ENTITIES];
+    float m_y0[HITSCAN_MAX_ENTITIES];
+    float m_y1[HITSCAN_MAX_ENTITIES];
+    float m_r[HITSCAN_MAX_ENTITIES];
+    float m_minX = 0.0f, m_maxX = 0.0f, m_minZ = 0.0f, m_maxZ = 0.0f;
+
+    // Entradas por bucket (CSR): bucket b ocupa [start[b], start[b + 1])
+    uint32_t m_bucketStart[HITSCAN_BUCKETS + 1];
+    float m_entryX[HITSCAN_MAX_ENTRIES + 3];
+    float m_entryZ[HITSCAN_MAX_ENTRIES + 3];
+    float m_entryY0[HITSCAN_MAX_ENTRIES + 3];
+    float m_entryY1[HITSCAN_MAX_ENTRIES + 3];
+    float m_entryR[HITSCAN_MAX_ENTRIES + 3];
+    uint32_t m_entryOwner[HITSCAN_MAX_ENTRIES + 3];
+};
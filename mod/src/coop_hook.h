@@ -0,0 +1,495 @@
+/**
+ * RE4 CO-OP MOD - Motor de Hooks
+ *
+ * Hook por trampolim em código x86 (32 bits):
+ *
+ * - Um decodificador de tamanho de instrução acha quantas instruções
+ *   inteiras cobrem os 5 bytes do JMP (nunca corta uma instrução ao meio)
+ * - As instruções roubadas são copiadas para um trampolim; saltos
+ *   relativos são reajustados (rel8 vira rel32) e o trampolim termina
+ *   num JMP de volta para o resto da função original
+ * - Os trampolins ficam num pool alocado perto do módulo, então todo
+ *   salto cabe em rel32
+ * - Create() só prepara; Apply() escreve todos os hooks pendentes de uma
+ *   vez, com uma troca de proteção por página (e uma restauração)
+ *
+ *   HookEngine& hooks = HookEngine::Instance();
+ *   hooks.Create(target, MyDetour, (void**)&Original_Fn);
+ *   hooks.SetAllEnabled(true);
+ *   hooks.Apply();
+ *
+ * Apply() não congela as outras threads: chamar antes do código alvo
+ * estar rodando (ou aceitar o risco de uma thread pegar o JMP pela metade).
+ */
+
+#pragma once
+#include <Windows.h>
+#include <cstdint>
+#include <cstring>
+
+//=============================================================================
+// DECODIFICADOR DE TAMANHO (x86 32 bits)
+//=============================================================================
+
+enum X86OpFlags : uint8_t {
+    X86_MODRM = 1 << 0,
+    X86_IMM8 = 1 << 1,
+    X86_IMMZ = 1 << 2,         // imm32 (imm16 com prefixo 66)
+    X86_IMM16 = 1 << 3,
+    X86_REL8 = 1 << 4,
+    X86_REL32 = 1 << 5,
+    X86_PREFIX = 1 << 6,
+    X86_BAD = 1 << 7,          // Não suportado (far ptr, moffs é tratado à parte)
+};
+
+struct X86Instruction {
+    uint8_t length;
+    uint8_t prefixCount;
+    uint8_t opcode;             // Primeiro byte depois dos prefixos
+    uint8_t opcode2;            // Segundo byte se opcode == 0x0F
+    uint8_t relSize;            // 0, 1 ou 4
+    uint8_t relOffset;          // Posição do deslocamento relativo
+    bool endsFlow;              // RET / JMP incondicional: nada depois executa
+};
+
+namespace X86Tables {
+    constexpr uint8_t M = X86_MODRM, I8 = X86_IMM8, IZ = X86_IMMZ, I16 = X86_IMM16;
+    constexpr uint8_t R8 = X86_REL8, R32 = X86_REL32, P = X86_PREFIX, X = X86_BAD;
+
+    constexpr uint8_t ONE_BYTE[256] = {
+        // x0    x1    x2    x3    x4    x5    x6    x7    x8    x9    xA    xB    xC    xD    xE    xF
+        M,    M,    M,    M,    I8,   IZ,   0,    0,    M,    M,    M,    M,    I8,   IZ,   0,    0,      // 0x
+        M,    M,    M,    M,    I8,   IZ,   0,    0,    M,    M,    M,    M,    I8,   IZ,   0,    0,      // 1x
+        M,    M,    M,    M,    I8,   IZ,   P,    0,    M,    M,    M,    M,    I8,   IZ,   P,    0,      // 2x
+        M,    M,    M,    M,    I8,   IZ,   P,    0,    M,    M,    M,    M,    I8,   IZ,   P,    0,      // 3x
+        0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,      // 4x
+        0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,      // 5x
+        0,    0,    M,    M,    P,    P,    P,    P,    IZ,   M|IZ, I8,   M|I8, 0,    0,    0,    0,      // 6x
+        R8,   R8,   R8,   R8,   R8,   R8,   R8,   R8,   R8,   R8,   R8,   R8,   R8,   R8,   R8,   R8,     // 7x
+        M|I8, M|IZ, M|I8, M|I8, M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,      // 8x
+        0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    X,    0,    0,    0,    0,    0,      // 9x
+        0,    0,    0,    0,    0,    0,    0,    0,    I8,   IZ,   0,    0,    0,    0,    0,    0,      // Ax
+        I8,   I8,   I8,   I8,   I8,   I8,   I8,   I8,   IZ,   IZ,   IZ,   IZ,   IZ,   IZ,   IZ,   IZ,     // Bx
+        M|I8, M|I8, I16,  0,    M,    M,    M|I8, M|IZ, I16|I8, 0,  I16,  0,    0,    I8,   0,    0,      // Cx
+        M,    M,    M,    M,    I8,   I8,   0,    0,    M,    M,    M,    M,    M,    M,    M,    M,      // Dx
+        R8,   R8,   R8,   R8,   I8,   I8,   I8,   I8,   R32,  R32,  X,    R8,   0,    0,    0,    0,      // Ex
+        P,    0,    P,    P,    0,    0,    M,    M,    0,    0,    0,    0,    0,    0,    M,    M,      // Fx
+    };
+
+    constexpr uint8_t TWO_BYTE[256] = {
+        // x0    x1    x2    x3    x4    x5    x6    x7    x8    x9    xA    xB    xC    xD    xE    xF
+        M,    M,    M,    M,    X,    0,    0,    0,    0,    0,    X,    0,    X,    M,    0,    M|I8,   // 0x
+        M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,      // 1x
+        M,    M,    M,    M,    X,    X,    X,    X,    M,    M,    M,    M,    M,    M,    M,    M,      // 2x
+        0,    0,    0,    0,    0,    0,    0,    0,    M,    X,    M|I8, X,    X,    X,    X,    X,      // 3x
+        M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,      // 4x
+        M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,      // 5x
+        M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,      // 6x
+        M|I8, M|I8, M|I8, M|I8, M,    M,    M,    0,    M,    M,    X,    X,    M,    M,    M,    M,      // 7x
+        R32,  R32,  R32,  R32,  R32,  R32,  R32,  R32,  R32,  R32,  R32,  R32,  R32,  R32,  R32,  R32,    // 8x
+        M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,      // 9x
+        0,    0,    0,    M,    M|I8, M,    X,    X,    0,    0,    0,    M,    M|I8, M,    M,    M,      // Ax
+        M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M|I8, M,    M,    M,    M,    M,      // Bx
+        M,    M,    M|I8, M,    M|I8, M|I8, M|I8, M,    0,    0,    0,    0,    0,    0,    0,    0,      // Cx
+        M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,      // Dx
+        M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,      // Ex
+        M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,    M,      // Fx
+    };
+}
+
+// Bytes de ModRM + SIB + deslocamento a partir de p (que aponta para o ModRM)
+inline uint32_t X86ModRmSize(const uint8_t* p, bool addr16) {
+    uint8_t modrm = p[0];
+    uint8_t mod = modrm >> 6, rm = modrm & 7;
+    if (mod == 3) return 1;
+
+    if (addr16) {
+        if (mod == 0) return rm == 6 ? 3 : 1;
+        return mod == 1 ? 2 : 3;
+    }
+
+    uint32_t size = 1;
+    if (rm == 4) {
+        size++;                                         // SIB
+        if (mod == 0 && (p[1] & 7) == 5) return size + 4;
+    }
+    if (mod == 0 && rm == 5) return size + 4;           // [disp32]
+    if (mod == 1) return size + 1;
+    if (mod == 2) return size + 4;
+    return size;
+}
+
+// Decodifica uma instrução. false se o opcode não é suportado.
+inline bool X86Decode(const uint8_t* code, X86Instruction& out) {
+    memset(&out, 0, sizeof(out));
+
+    const uint8_t* p = code;
+    bool operand16 = false, addr16 = false;
+    while (X86Tables::ONE_BYTE[*p] & X86_PREFIX) {
+        if (*p == 0x66) operand16 = true;
+        if (*p == 0x67) addr16 = true;
+        if (++out.prefixCount > 4) return false;
+        p++;
+    }
+
+    out.opcode = *p++;
+    uint8_t flags;
+
+    if (out.opcode == 0x0F) {
+        out.opcode2 = *p++;
+        flags = X86Tables::TWO_BYTE[out.opcode2];
+        if (out.opcode2 == 0x38 || out.opcode2 == 0x3A) p++;   // Mapas de 3 bytes
+    }
+    else {
+        flags = X86Tables::ONE_BYTE[out.opcode];
+
+        // mov eax, [moffs] e afins: só o endereço
+        if (out.opcode >= 0xA0 && out.opcode <= 0xA3) p += addr16 ? 2 : 4;
+
+        // VEX (C4/C5 com mod == 11): não aparece no código do jogo
+        if ((out.opcode == 0xC4 || out.opcode == 0xC5) && (*p >> 6) == 3) return false;
+    }
+    if (flags & X86_BAD) return false;
+
+    if (flags & X86_MODRM) {
+        uint8_t reg = (*p >> 3) & 7;
+
+        // F6/F7 /0 e /1 (test) têm imediato
+        if (out.opcode == 0xF6 && reg <= 1) flags |= X86_IMM8;
+        if (out.opcode == 0xF7 && reg <= 1) flags |= X86_IMMZ;
+
+        // RET/JMP indireto também termina o fluxo
+        if (out.opcode == 0xFF && reg == 4) out.endsFlow = true;
+
+        p += X86ModRmSize(p, addr16);
+    }
+
+    if (flags & X86_IMM16) p += 2;
+    if (flags & X86_IMM8) p += 1;
+    if (flags & X86_IMMZ) p += operand16 ? 2 : 4;
+
+    if (flags & (X86_REL8 | X86_REL32)) {
+        if (operand16) return false;                    // jmp rel16: não existe no jogo
+        out.relOffset = (uint8_t)(p - code);
+        out.relSize = (flags & X86_REL8) ? 1 : 4;
+        p += out.relSize;
+    }
+
+    if (out.opcode == 0xC3 || out.opcode == 0xC2 || out.opcode == 0xE9 || out.opcode == 0xEB) {
+        out.endsFlow = true;
+    }
+
+    out.length = (uint8_t)(p - code);
+    return out.length <= 15;
+}
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+constexpr uint32_t HOOK_MAX_HOOKS = 64;
+constexpr uint32_t HOOK_JMP_SIZE = 5;
+constexpr uint32_t HOOK_MAX_STOLEN = HOOK_JMP_SIZE + 14;      // Última instrução começa no byte 4
+constexpr uint32_t HOOK_TRAMPOLINE_SIZE = 64;
+constexpr uint32_t HOOK_POOL_SIZE = 64 * 1024;
+
+enum class HookStatus : uint8_t {
+    OK,
+    BAD_ARGUMENT,
+    UNSUPPORTED_INSTRUCTION,    // Decodificador não conhece (ou não sabe realocar)
+    FUNCTION_TOO_SHORT,         // RET/JMP antes de 5 bytes
+    INTERNAL_JUMP,              // Salto de dentro para dentro dos bytes roubados
+    OUT_OF_RANGE,               // Destino não cabe em rel32
+    POOL_FULL,
+    TOO_MANY_HOOKS,
+    PROTECT_FAILED,
+};
+
+inline bool HookRel32Reachable(const void* from, const void* to) {
+    intptr_t delta = (intptr_t)to - (intptr_t)from;
+    return (int64_t)delta == (int64_t)(int32_t)delta;
+}
+
+// Escreve em out um E9 rel32 que, executado em at, salta para to
+inline void HookEncodeJump(uint8_t* out, const uint8_t* at, const void* to) {
+    int32_t rel = (int32_t)((intptr_t)to - (intptr_t)(at + HOOK_JMP_SIZE));
+    out[0] = 0xE9;
+    memcpy(out + 1, &rel, 4);
+}
+
+//=============================================================================
+// POOL DE TRAMPOLINS (perto do módulo)
+//=============================================================================
+
+class TrampolinePool {
+public:
+    // Reserva o pool a menos de 2 GB de near (no x86 qualquer endereço serve)
+    bool Init(const void* nearAddress) {
+        if (m_base) return true;
+
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        uintptr_t granularity = info.dwAllocationGranularity ? info.dwAllocationGranularity : 0x10000;
+
+        uintptr_t origin = (uintptr_t)nearAddress & ~(granularity - 1);
+        const uintptr_t maxDistance = 0x7FF00000;
+        uintptr_t lowest = origin > maxDistance ? origin - maxDistance : granularity;
+
+        // Desce a partir do módulo pulando regiões ocupadas
+        uintptr_t addr = origin;
+        while (addr >= lowest + granularity) {
+            addr -= granularity;
+
+            MEMORY_BASIC_INFORMATION mbi;
+            if (!VirtualQuery((void*)addr, &mbi, sizeof(mbi))) break;
+
+            if (mbi.State == MEM_FREE) {
+                void* block = VirtualAlloc((void*)addr, HOOK_POOL_SIZE, MEM_RESERVE | MEM_COMMIT, PAGE_EXECUTE_READWRITE);
+                if (block) {
+                    m_base = (uint8_t*)block;
+                    return true;
+                }
+            }
+            else if ((uintptr_t)mbi.AllocationBase < addr) {
+                addr = (uintptr_t)mbi.AllocationBase & ~(granularity - 1);
+            }
+        }
+
+        // Último recurso: onde o sistema quiser (serve se ficar ao alcance)
+        void* block = VirtualAlloc(nullptr, HOOK_POOL_SIZE, MEM_RESERVE | MEM_COMMIT, PAGE_EXECUTE_READWRITE);
+        if (!block) return false;
+        if (!HookRel32Reachable(block, nearAddress)) {
+            VirtualFree(block, 0, MEM_RELEASE);
+            return false;
+        }
+        m_base = (uint8_t*)block;
+        return true;
+    }
+
+    uint8_t* Allocate() {
+        if (!m_base || m_used + HOOK_TRAMPOLINE_SIZE > HOOK_POOL_SIZE) return nullptr;
+        uint8_t* slot = m_base + m_used;
+        m_used += HOOK_TRAMPOLINE_SIZE;
+        return slot;
+    }
+
+    // Devolve o último slot (Create que falhou depois de alocar)
+    void Unallocate(uint8_t* slot) {
+        if (slot && slot + HOOK_TRAMPOLINE_SIZE == m_base + m_used) m_used -= HOOK_TRAMPOLINE_SIZE;
+    }
+
+private:
+    uint8_t* m_base = nullptr;
+    uint32_t m_used = 0;
+};
+
+//=============================================================================
+// MOTOR
+//=============================================================================
+
+class HookEngine {
+public:
+    static HookEngine& Instance() {
+        static HookEngine instance;
+        return instance;
+    }
+
+    // Prepara o hook: monta o trampolim e o JMP, mas não toca no alvo até
+    // o próximo Apply(). *original recebe o trampolim (chamar a função
+    // original por ele).
+    HookStatus Create(void* target, void* detour, void** original, int* id = nullptr) {
+        if (!target || !detour) return HookStatus::BAD_ARGUMENT;
+        if (m_count >= HOOK_MAX_HOOKS) return HookStatus::TOO_MANY_HOOKS;
+        if (!m_pool.Init(target)) return HookStatus::POOL_FULL;
+
+        uint8_t* trampoline = m_pool.Allocate();
+        if (!trampoline) return HookStatus::POOL_FULL;
+
+        Hook& hook = m_hooks[m_count];
+        memset(&hook, 0, sizeof(hook));
+        hook.target = (uint8_t*)target;
+        hook.trampoline = trampoline;
+
+        HookStatus status = BuildTrampoline(hook);
+        if (status == HookStatus::OK && !HookRel32Reachable(hook.target + HOOK_JMP_SIZE, detour)) {
+            status = HookStatus::OUT_OF_RANGE;
+        }
+        if (status != HookStatus::OK) {
+            m_pool.Unallocate(trampoline);
+            return status;
+        }
+
+        // JMP para o detour + int3 no resto dos bytes roubados
+        HookEncodeJump(hook.patch, hook.target, detour);
+        memset(hook.patch + HOOK_JMP_SIZE, 0xCC, hook.stolen - HOOK_JMP_SIZE);
+
+        if (original) *original = trampoline;
+        if (id) *id = (int)m_count;
+        m_count++;
+        return HookStatus::OK;
+    }
+
+    // Marca o estado desejado; só vale no próximo Apply()
+    void SetEnabled(int id, bool enabled) {
+        if (id >= 0 && (uint32_t)id < m_count) m_hooks[id].wanted = enabled;
+    }
+
+    void SetAllEnabled(bool enabled) {
+        for (uint32_t i = 0; i < m_count; i++) m_hooks[i].wanted = enabled;
+    }
+
+    bool IsEnabled(int id) const {
+        return id >= 0 && (uint32_t)id < m_count && m_hooks[id].enabled;
+    }
+
+    uint32_t HookCount() const { return m_count; }
+
+    // Escreve todas as mudanças pendentes. Cada página tocada muda de
+    // proteção uma vez, recebe todos os patches e volta ao original.
+    HookStatus Apply() {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        uintptr_t pageSize = info.dwPageSize ? info.dwPageSize : 0x1000;
+
+        // Páginas distintas tocadas (um patch pode cruzar a borda)
+        uintptr_t pages[HOOK_MAX_HOOKS * 2];
+        DWORD oldProtect[HOOK_MAX_HOOKS * 2];
+        uint32_t pageCount = 0;
+
+        for (uint32_t i = 0; i < m_count; i++) {
+            const Hook& hook = m_hooks[i];
+            if (hook.wanted == hook.enabled) continue;
+
+            uintptr_t first = (uintptr_t)hook.target & ~(pageSize - 1);
+            uintptr_t last = ((uintptr_t)hook.target + hook.stolen - 1) & ~(pageSize - 1);
+            for (uintptr_t page = first; page <= last; page += pageSize) {
+                AddPage(pages, pageCount, page);
+            }
+        }
+        if (pageCount == 0) return HookStatus::OK;
+
+        for (uint32_t i = 0; i < pageCount; i++) {
+            if (!VirtualProtect((void*)pages[i], pageSize, PAGE_EXECUTE_READWRITE, &oldProtect[i])) {
+                RestorePages(pages, oldProtect, i, pageSize);
+                return HookStatus::PROTECT_FAILED;
+            }
+        }
+
+        for (uint32_t i = 0; i < m_count; i++) {
+            Hook& hook = m_hooks[i];
+            if (hook.wanted == hook.enabled) continue;
+
+            memcpy(hook.target, hook.wanted ? hook.patch : hook.original, hook.stolen);
+            hook.enabled = hook.wanted;
+        }
+
+        RestorePages(pages, oldProtect, pageCount, pageSize);
+        FlushInstructionCache(GetCurrentProcess(), nullptr, 0);
+        return HookStatus::OK;
+    }
+
+private:
+    HookEngine() = default;
+
+    struct Hook {
+        uint8_t* target;
+        uint8_t* trampoline;
+        uint8_t stolen;                         // Bytes de instruções inteiras (>= 5)
+        uint8_t original[HOOK_MAX_STOLEN];
+        uint8_t patch[HOOK_MAX_STOLEN];
+        bool enabled;
+        bool wanted;
+    };
+
+    // Copia as instruções que cobrem o JMP para o trampolim, realocando
+    // saltos relativos, e fecha com um JMP de volta
+    static HookStatus BuildTrampoline(Hook& hook) {
+        const uint8_t* src = hook.target;
+        uint8_t* dst = hook.trampoline;
+        uint8_t* end = hook.trampoline + HOOK_TRAMPOLINE_SIZE - HOOK_JMP_SIZE;
+
+        const uint8_t* branchTargets[HOOK_JMP_SIZE];
+        uint32_t branchCount = 0;
+        uint32_t stolen = 0;
+
+        while (stolen < HOOK_JMP_SIZE) {
+            X86Instruction insn;
+            if (!X86Decode(src + stolen, insn)) return HookStatus::UNSUPPORTED_INSTRUCTION;
+
+            const uint8_t* at = src + stolen;
+            const uint8_t* next = at + insn.length;
+
+            if (insn.relSize) {
+                int32_t rel = insn.relSize == 1 ? (int8_t)at[insn.relOffset] : 0;
+                if (insn.relSize == 4) memcpy(&rel, at + insn.relOffset, 4);
+                const uint8_t* dest = next + rel;
+                branchTargets[branchCount++] = dest;
+
+                // Prefixo em salto relativo ou LOOP/JECXZ: não dá para reescrever
+                bool isJcc8 = insn.opcode >= 0x70 && insn.opcode <= 0x7F;
+                if (insn.prefixCount || (insn.relSize == 1 && !isJcc8 && insn.opcode != 0xEB)) {
+                    return HookStatus::UNSUPPORTED_INSTRUCTION;
+                }
+                if (dst + 6 > end) return HookStatus::UNSUPPORTED_INSTRUCTION;
+
+                uint8_t* rel32At;
+                if (insn.relSize == 4) {
+                    memcpy(dst, at, insn.relOffset);
+                    rel32At = dst + insn.relOffset;
+                }
+                else if (isJcc8) {
+                    dst[0] = 0x0F;
+                    dst[1] = (uint8_t)(0x80 | (insn.opcode & 0x0F));
+                    rel32At = dst + 2;
+                }
+                else {
+                    dst[0] = 0xE9;
+                    rel32At = dst + 1;
+                }
+
+                if (!HookRel32Reachable(rel32At + 4, dest)) return HookStatus::OUT_OF_RANGE;
+                int32_t newRel = (int32_t)((intptr_t)dest - (intptr_t)(rel32At + 4));
+                memcpy(rel32At, &newRel, 4);
+                dst = rel32At + 4;
+            }
+            else {
+                if (dst + insn.length > end) return HookStatus::UNSUPPORTED_INSTRUCTION;
+                memcpy(dst, at, insn.length);
+                dst += insn.length;
+            }
+
+            stolen += insn.length;
+            if (insn.endsFlow && stolen < HOOK_JMP_SIZE) return HookStatus::FUNCTION_TOO_SHORT;
+        }
+
+        // Saltos para dentro dos bytes que vão virar JMP quebrariam
+        for (uint32_t i = 0; i < branchCount; i++) {
+            if (branchTargets[i] >= src && branchTargets[i] < src + stolen) return HookStatus::INTERNAL_JUMP;
+        }
+
+        if (!HookRel32Reachable(dst + HOOK_JMP_SIZE, src + stolen)) return HookStatus::OUT_OF_RANGE;
+        HookEncodeJump(dst, dst, src + stolen);
+
+        hook.stolen = (uint8_t)stolen;
+        memcpy(hook.original, src, stolen);
+        return HookStatus::OK;
+    }
+
+    static void AddPage(uintptr_t* pages, uint32_t& count, uintptr_t page) {
+        for (uint32_t i = 0; i < count; i++) {
+            if (pages[i] == page) return;
+        }
+        pages[count++] = page;
+    }
+
+    static void RestorePages(const uintptr_t* pages, const DWORD* oldProtect, uint32_t count, uintptr_t pageSize) {
+        for (uint32_t i = 0; i < count; i++) {
+            DWORD ignored;
+            VirtualProtect((void*)pages[i], pageSize, oldProtect[i], &ignored);
+        }
+    }
+
+    TrampolinePool m_pool;
+    Hook m_hooks[HOOK_MAX_HOOKS];
+    uint32_t m_count = 0;
+};
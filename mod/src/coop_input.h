@@ -0,0 +1,385 @@
+/**
+ * RE4 CO-OP MOD - Input dos Controles (thread de poll + eventos)
+ *
+ * Ler o controle uma vez por frame do jogo faz um aperto esperar até um
+ * frame inteiro para ser visto, e um toque mais curto que o frame some.
+ * Aqui uma thread própria lê os controles a INPUT_POLL_HZ:
+ *
+ * - Cada mudança de estado vira um InputEvent com o instante em que foi
+ *   vista, no anel do controle (produtor único, sem lock)
+ * - A thread do jogo consome tudo que chegou desde o último frame; botões
+ *   e gatilhos apertados em qualquer momento do frame contam, mesmo se
+ *   já foram soltos
+ * - RecordLatency() mede de "mudou" até o input chegar na Ashley
+ *
+ * A fonte é um callback (InputPollFn): XInput no jogo, sintética no
+ * harness.
+ *
+ *   InputPoller::Instance().Start(XInputPadSource, nullptr);
+ *   InputFrame frame;
+ *   frame.Consume(InputPoller::Instance(), P2_INPUT_PAD);
+ *   frame.Build(g_P2_Input);
+ */
+
+#pragma once
+#include "coop_core.h"
+#include "coop_tick.h"
+#include "coop_telemetry.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <Xinput.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+constexpr uint32_t INPUT_MAX_PADS = 4;                  // Limite do XInput
+constexpr uint32_t INPUT_POLL_HZ = 1000;
+constexpr uint32_t INPUT_RECONNECT_MS = 500;            // Controle desconectado é lido só a cada X ms
+constexpr uint32_t INPUT_RING_EVENTS = 256;             // Por controle (potência de 2)
+constexpr uint32_t INPUT_PENDING_MAX = 64;              // Eventos por frame com latência medida
+constexpr int32_t INPUT_STICK_EPSILON = 256;            // Ruído do analógico que não vira evento
+
+// Controller 1 é índice 0, Controller 2 é índice 1
+constexpr uint32_t P2_INPUT_PAD = 1;
+
+// Mesmos bits de XINPUT_GAMEPAD::wButtons
+enum PadButtons : uint16_t {
+    PAD_BUTTON_START = 0x0010,
+    PAD_BUTTON_BACK  = 0x0020,
+    PAD_BUTTON_A     = 0x1000,
+    PAD_BUTTON_B     = 0x2000,
+    PAD_BUTTON_X     = 0x4000,
+    PAD_BUTTON_Y     = 0x8000,
+};
+
+//=============================================================================
+// ESTADO E EVENTO
+//=============================================================================
+
+// Estado cru de um controle (layout do XINPUT_GAMEPAD + conectado)
+struct PadState {
+    uint16_t buttons;
+    uint8_t leftTrigger;
+    uint8_t rightTrigger;
+    int16_t thumbLX;
+    int16_t thumbLY;
+    int16_t thumbRX;
+    int16_t thumbRY;
+    uint8_t connected;
+    uint8_t reserved;
+};
+
+struct InputEvent {
+    uint64_t micros;        // CoopNowMicros() do poll que viu a mudança
+    PadState state;         // Estado completo depois da mudança
+};
+
+// Lê o controle pad. false = desconectado.
+typedef bool (*InputPollFn)(uint32_t pad, PadState& out, void* user);
+
+// Mudou o bastante para virar evento? (analógicos com tolerância de ruído)
+inline bool PadStateChanged(const PadState& a, const PadState& b) {
+    if (a.buttons != b.buttons || a.connected != b.connected) return true;
+    if (a.leftTrigger != b.leftTrigger || a.rightTrigger != b.rightTrigger) return true;
+
+    auto moved = [](int16_t x, int16_t y) {
+        int32_t d = (int32_t)x - (int32_t)y;
+        return d > INPUT_STICK_EPSILON || d < -INPUT_STICK_EPSILON;
+    };
+    return moved(a.thumbLX, b.thumbLX) || moved(a.thumbLY, b.thumbLY) ||
+           moved(a.thumbRX, b.thumbRX) || moved(a.thumbRY, b.thumbRY);
+}
+
+//=============================================================================
+// ANEL POR CONTROLE
+//=============================================================================
+
+// Um produtor (a thread de poll) e um consumidor (a thread do jogo)
+class InputEventRing {
+public:
+    bool Push(const InputEvent& event) {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= INPUT_RING_EVENTS) {
+            m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        m_events[head & (INPUT_RING_EVENTS - 1)] = event;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Só a thread do jogo chama
+    template<typename Fn>
+    uint32_t Drain(Fn&& fn) {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        uint32_t head = m_head.load(std::memory_order_acquire);
+        for (uint32_t i = tail; i != head; i++) {
+            fn(m_events[i & (INPUT_RING_EVENTS - 1)]);
+        }
+        m_tail.store(head, std::memory_order_release);
+        return head - tail;
+    }
+
+    uint32_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<uint32_t> m_head{0};
+    std::atomic<uint32_t> m_dropped{0};
+    alignas(64) std::atomic<uint32_t> m_tail{0};
+    InputEvent m_events[INPUT_RING_EVENTS];
+};
+
+//=============================================================================
+// THREAD DE POLL
+//=============================================================================
+
+class InputPoller {
+public:
+    static InputPoller& Instance() {
+        static InputPoller instance;
+        return instance;
+    }
+
+    // Começa a ler todos os controles. false se já está rodando.
+    bool Start(InputPollFn source, void* user, uint32_t pollHz = INPUT_POLL_HZ) {
+        if (m_running.load(std::memory_order_relaxed) || !source) return false;
+
+        m_source = source;
+        m_user = user;
+        m_periodMicros = 1000000 / (pollHz ? pollHz : 1);
+        m_polls.store(0, std::memory_order_relaxed);
+        m_events.store(0, std::memory_order_relaxed);
+        memset(&m_latency, 0, sizeof(m_latency));
+
+        // Eventos de uma sessão anterior não valem mais
+        for (uint32_t pad = 0; pad < INPUT_MAX_PADS; pad++) {
+            m_rings[pad].Drain([](const InputEvent&) {});
+        }
+
+        m_running.store(true, std::memory_order_relaxed);
+        m_thread = std::thread(&InputPoller::PollThread, this);
+        return true;
+    }
+
+    void Stop() {
+        if (!m_running.load(std::memory_order_relaxed)) return;
+        m_running.store(false, std::memory_order_relaxed);
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    // Para sem esperar a thread (DllMain: o join trava no loader lock).
+    // Ela vê m_running falso e sai sozinha, ou já morreu com o processo.
+    void Abandon() {
+        m_running.store(false, std::memory_order_relaxed);
+        if (m_thread.joinable()) m_thread.detach();
+    }
+
+    bool IsRunning() const { return m_running.load(std::memory_order_relaxed); }
+
+    InputEventRing& Ring(uint32_t pad) { return m_rings[pad]; }
+
+    // Latência mudança -> aplicação (us). Só a thread do jogo escreve e lê.
+    void RecordLatency(uint64_t micros) {
+        uint32_t value = micros > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)micros;
+        m_latency.buckets[TelemetryBucketIndex(value)]++;
+        m_latency.count++;
+        m_latency.sum += value;
+        if (value > m_latency.max) m_latency.max = value;
+    }
+
+    const TelemetryHistogram& Latency() const { return m_latency; }
+
+    uint64_t Polls() const { return m_polls.load(std::memory_order_relaxed); }
+    uint64_t Events() const { return m_events.load(std::memory_order_relaxed); }
+
+    uint32_t Dropped() const {
+        uint32_t dropped = 0;
+        for (uint32_t pad = 0; pad < INPUT_MAX_PADS; pad++) dropped += m_rings[pad].Dropped();
+        return dropped;
+    }
+
+private:
+    InputPoller() = default;
+    ~InputPoller() { Stop(); }
+
+    void PollThread() {
+        using namespace std::chrono;
+
+#ifdef _WIN32
+        // Sleep de 1 ms de verdade (o padrão do Windows é ~15.6 ms)
+        timeBeginPeriod(1);
+#endif
+
+        PadState last[INPUT_MAX_PADS];
+        uint64_t nextTry[INPUT_MAX_PADS];
+        memset(last, 0, sizeof(last));
+        memset(nextTry, 0, sizeof(nextTry));
+
+        steady_clock::time_point next = steady_clock::now();
+        while (m_running.load(std::memory_order_relaxed)) {
+            uint64_t now = CoopNowMicros();
+
+            for (uint32_t pad = 0; pad < INPUT_MAX_PADS; pad++) {
+                // Ler controle ausente é caro no XInput: só de vez em quando
+                if (!last[pad].connected && now < nextTry[pad]) continue;
+
+                PadState state;
+                memset(&state, 0, sizeof(state));
+                state.connected = m_source(pad, state, m_user) ? 1 : 0;
+                if (!state.connected) {
+                    memset(&state, 0, sizeof(state));
+                    nextTry[pad] = now + INPUT_RECONNECT_MS * 1000ull;
+                }
+
+                if (!PadStateChanged(state, last[pad])) continue;
+                last[pad] = state;
+
+                InputEvent event;
+                event.micros = now;
+                event.state = state;
+                m_rings[pad].Push(event);
+                m_events.store(m_events.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+            m_polls.store(m_polls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+            // Período fixo; atrasou (thread preemptada), recomeça de agora
+            next += microseconds(m_periodMicros);
+            steady_clock::time_point current = steady_clock::now();
+            if (next < current) next = current;
+            std::this_thread::sleep_until(next);
+        }
+
+#ifdef _WIN32
+        timeEndPeriod(1);
+#endif
+    }
+
+    InputEventRing m_rings[INPUT_MAX_PADS];
+    std::atomic<bool> m_running{false};
+    std::atomic<uint64_t> m_polls{0};
+    std::atomic<uint64_t> m_events{0};
+    std::thread m_thread;
+
+    InputPollFn m_source = nullptr;
+    void* m_user = nullptr;
+    uint32_t m_periodMicros = 1000;
+
+    // Thread do jogo
+    TelemetryHistogram m_latency;
+};
+
+//=============================================================================
+// CONSUMO POR FRAME
+//=============================================================================
+
+// Junta os eventos de um frame num CoopInput: analógicos pelo último
+// estado, botões e gatilhos pelo que esteve apertado em algum momento
+class InputFrame {
+public:
+    // Drena o anel do controle. Retorna quantos eventos chegaram. O que
+    // foi apertado continua contando até Applied/Discard (frame sem tick
+    // não perde o toque).
+    uint32_t Consume(InputPoller& poller, uint32_t pad) {
+        return poller.Ring(pad).Drain([&](const InputEvent& event) {
+            m_last = event.state;
+            m_held |= event.state.buttons;
+            if (event.state.leftTrigger > m_heldLeft) m_heldLeft = event.state.leftTrigger;
+            if (event.state.rightTrigger > m_heldRight) m_heldRight = event.state.rightTrigger;
+            if (m_pendingCount < INPUT_PENDING_MAX) m_pending[m_pendingCount++] = event.micros;
+        });
+    }
+
+    void Build(CoopInput& out) const {
+        out.connected = m_last.connected != 0;
+        if (!out.connected) {
+            out.Reset();
+            return;
+        }
+
+        out.moveX = m_last.thumbLX / 32768.0f;
+        out.moveY = m_last.thumbLY / 32768.0f;
+        out.lookX = m_last.thumbRX / 32768.0f;
+        out.lookY = m_last.thumbRY / 32768.0f;
+
+        out.leftTrigger = m_heldLeft / 255.0f;
+        out.rightTrigger = m_heldRight / 255.0f;
+
+        out.aim = out.leftTrigger > 0.5f;
+        out.shoot = out.rightTrigger > 0.5f;
+        out.action = (m_held & PAD_BUTTON_A) != 0;
+        out.run = (m_held & PAD_BUTTON_B) != 0;
+        out.reload = (m_held & PAD_BUTTON_X) != 0;
+        out.knife = (m_held & PAD_BUTTON_Y) != 0;
+        out.inventory = (m_held & PAD_BUTTON_START) != 0;
+        out.map = (m_held & PAD_BUTTON_BACK) != 0;
+    }
+
+    // O input chegou na Ashley: fecha a latência dos eventos pendentes
+    void Applied(InputPoller& poller, uint64_t nowMicros) {
+        for (uint32_t i = 0; i < m_pendingCount; i++) {
+            poller.RecordLatency(nowMicros - m_pending[i]);
+        }
+        Discard();
+    }
+
+    // Não chegou em ninguém (sem Ashley, P2 desconectado): não conta
+    void Discard() {
+        m_held = m_last.buttons;
+        m_heldLeft = m_last.leftTrigger;
+        m_heldRight = m_last.rightTrigger;
+        m_pendingCount = 0;
+    }
+
+    void Reset() {
+        memset(&m_last, 0, sizeof(m_last));
+        m_held = 0;
+        m_heldLeft = m_heldRight = 0;
+        m_pendingCount = 0;
+    }
+
+private:
+    PadState m_last = {};
+    uint16_t m_held = 0;
+    uint8_t m_heldLeft = 0;
+    uint8_t m_heldRight = 0;
+    uint64_t m_pending[INPUT_PENDING_MAX];
+    uint32_t m_pendingCount = 0;
+};
+
+//=============================================================================
+// FONTE XINPUT
+//=============================================================================
+
+#ifdef _WIN32
+
+// Carregada em tempo de execução: sem depender de xinput.lib
+inline bool XInputPadSource(uint32_t pad, PadState& out, void*) {
+    typedef DWORD (WINAPI *GetStateFn)(DWORD, XINPUT_STATE*);
+    static GetStateFn getState = []() -> GetStateFn {
+        HMODULE module = LoadLibraryA("xinput1_4.dll");
+        if (!module) module = LoadLibraryA("xinput9_1_0.dll");
+        return module ? (GetStateFn)GetProcAddress(module, "XInputGetState") : nullptr;
+    }();
+
+    XINPUT_STATE state;
+    if (!getState || getState(pad, &state) != ERROR_SUCCESS) return false;
+
+    out.buttons = state.Gamepad.wButtons;
+    out.leftTrigger = state.Gamepad.bLeftTrigger;
+    out.rightTrigger = state.Gamepad.bRightTrigger;
+    out.thumbLX = state.Gamepad.sThumbLX;
+    out.thumbLY = state.Gamepad.sThumbLY;
+    out.thumbRX = state.Gamepad.sThumbRX;
+    out.thumbRY = state.Gamepad.sThumbRY;
+    return true;
+}
+
+#endif
@@ -0,0 +1,488 @@
+/**
+ * RE4 CO-OP MOD - Log assíncrono (formatação adiada)
+ *
+ * printf direto no console de dentro de um hook trava a thread do jogo
+ * no console (lento, e serializa quem mais estiver escrevendo). Aqui quem
+ * loga só copia o ponteiro do formato e os argumentos crus:
+ *
+ *   CoopLog("[HOOK] %u hooks instalados!", hooks.HookCount());
+ *
+ * - O registro vai para o anel da própria thread (produtor único, sem
+ *   lock), com o TSC do momento. Thread que termina devolve o anel, e a
+ *   próxima thread nova fica com ele depois que o dreno o esvaziar
+ * - Uma thread de fundo esvazia os anéis a cada LOG_DRAIN_MS, intercala
+ *   as threads pelo TSC, formata e escreve no arquivo e/ou no console
+ * - Anel cheio descarta e conta; a thread de fundo escreve quantos
+ *   foram perdidos. Quem loga nunca espera.
+ *
+ * O formato precisa viver até o dreno (literal). %s copia a string para
+ * o registro (até LOG_TEXT_BYTES somando todas); o resto é guardado pelo
+ * tipo C++ do argumento, então o modificador de tamanho do formato (l,
+ * ll, z, h) é ignorado e %u com um uint64_t não corrompe nada.
+ */
+
+#pragma once
+#include "coop_profiler.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+constexpr uint32_t LOG_MAX_THREADS = 16;
+constexpr uint32_t LOG_RING_ENTRIES = 1 << 8;           // Por thread (potência de 2)
+constexpr uint32_t LOG_MAX_ARGS = 8;
+constexpr uint32_t LOG_TEXT_BYTES = 40;                 // Cópias dos %s, por registro
+constexpr uint32_t LOG_DRAIN_MS = 10;
+constexpr uint32_t LOG_LINE_BYTES = 1024;
+
+// Arquivo padrão (ao lado do executável do jogo)
+constexpr const char* LOG_FILE = "re4coop.log";
+
+// Tipo guardado de cada argumento (4 bits cada em LogEntry::types)
+enum LogArgType : uint8_t {
+    LOG_ARG_I32,
+    LOG_ARG_U32,
+    LOG_ARG_I64,
+    LOG_ARG_U64,
+    LOG_ARG_F64,
+    LOG_ARG_PTR,
+    LOG_ARG_STR,                // Valor = deslocamento em LogEntry::text
+};
+
+//=============================================================================
+// REGISTRO
+//=============================================================================
+
+struct LogEntry {
+    const char* format;         // Literal: o ponteiro precisa viver até o dreno
+    uint64_t timestamp;         // TSC
+    uint32_t types;
+    uint8_t count;
+    uint8_t textUsed;
+    uint64_t args[LOG_MAX_ARGS];
+    char text[LOG_TEXT_BYTES];
+};
+
+namespace LogDetail {
+    inline void Put(LogEntry& entry, LogArgType type, uint64_t value) {
+        entry.types |= (uint32_t)type << (4 * entry.count);
+        entry.args[entry.count++] = value;
+    }
+
+    // Copia o que couber; sem espaço nenhum vira "" (último byte é sempre 0).
+    // capacity limita a leitura de um char[N] sem terminador.
+    inline void PutString(LogEntry& entry, const char* s, uint32_t capacity = 0xFFFFFFFFu) {
+        if (!s) s = "(null)";
+        uint32_t offset = entry.textUsed;
+        if (offset >= LOG_TEXT_BYTES - 1) {
+            Put(entry, LOG_ARG_STR, LOG_TEXT_BYTES - 1);
+            return;
+        }
+
+        uint32_t room = LOG_TEXT_BYTES - 1 - offset;
+        uint32_t length = 0;
+        while (length < room && length < capacity && s[length]) length++;
+        memcpy(entry.text + offset, s, length);
+        entry.text[offset + length] = 0;
+        entry.textUsed = (uint8_t)(offset + length + 1);
+        Put(entry, LOG_ARG_STR, offset);
+    }
+
+    template<typename T>
+    inline void Encode(LogEntry& entry, const T& value) {
+        if constexpr (std::is_same<T, const char*>::value || std::is_same<T, char*>::value) {
+            PutString(entry, value);
+        }
+        else if constexpr (std::is_array<T>::value) {
+            PutString(entry, value, (uint32_t)std::extent<T>::value);   // char[N]
+        }
+        else if constexpr (std::is_enum<T>::value) {
+            Encode(entry, (typename std::underlying_type<T>::type)value);
+        }
+        else if constexpr (std::is_floating_point<T>::value) {
+            double d = (double)value;
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            Put(entry, LOG_ARG_F64, bits);
+        }
+        else if constexpr (std::is_pointer<T>::value || std::is_null_pointer<T>::value) {
+            Put(entry, LOG_ARG_PTR, (uint64_t)(uintptr_t)value);
+        }
+        else {
+            static_assert(std::is_integral<T>::value, "log: tipo de argumento não suportado");
+            if constexpr (sizeof(T) <= 4) {
+                Put(entry, std::is_signed<T>::value ? LOG_ARG_I32 : LOG_ARG_U32,
+                    std::is_signed<T>::value ? (uint64_t)(int64_t)value : (uint64_t)value);
+            }
+            else {
+                Put(entry, std::is_signed<T>::value ? LOG_ARG_I64 : LOG_ARG_U64, (uint64_t)value);
+            }
+        }
+    }
+
+    // Um especificador com o modificador de tamanho trocado pelo do tipo
+    // guardado. Retorna o que escreveu (-1 se tipo e conversão não batem).
+    inline int FormatArg(char* out, size_t size, const char* flags, size_t flagsLength, char conversion,
+                         LogArgType type, uint64_t value, const char* text) {
+        char spec[32];
+        if (flagsLength > sizeof(spec) - 4) flagsLength = sizeof(spec) - 4;
+        memcpy(spec, flags, flagsLength);
+        size_t n = flagsLength;
+
+        bool integer = strchr("diouxXc", conversion) != nullptr;
+        bool real = strchr("fFeEgGaA", conversion) != nullptr;
+        bool wide = type == LOG_ARG_I64 || type == LOG_ARG_U64;
+        if (integer && wide && conversion != 'c') {
+            spec[n++] = 'l';
+            spec[n++] = 'l';
+        }
+        spec[n++] = conversion;
+        spec[n] = 0;
+
+        switch (type) {
+            case LOG_ARG_I32:
+            case LOG_ARG_U32:
+                if (!integer) return -1;
+                return snprintf(out, size, spec, (int)(uint32_t)value);
+            case LOG_ARG_I64:
+            case LOG_ARG_U64:
+                if (!integer) return -1;
+                if (conversion == 'c') return snprintf(out, size, spec, (int)value);
+                return snprintf(out, size, spec, (long long)value);
+            case LOG_ARG_F64: {
+                if (!real) return -1;
+                double d;
+                memcpy(&d, &value, sizeof(d));
+                return snprintf(out, size, spec, d);
+            }
+            case LOG_ARG_PTR:
+                if (conversion != 'p') return -1;
+                return snprintf(out, size, spec, (void*)(uintptr_t)value);
+            case LOG_ARG_STR:
+                if (conversion != 's') return -1;
+                return snprintf(out, size, spec, text + value);
+        }
+        return -1;
+    }
+}
+
+// Preenche o registro (o mesmo que o CoopLog faz dentro do anel)
+template<typename... Args>
+inline void LogCapture(LogEntry& entry, const char* format, const Args&... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "log: argumentos demais");
+    entry.format = format;
+    entry.types = 0;
+    entry.count = 0;
+    entry.textUsed = 0;
+    entry.text[LOG_TEXT_BYTES - 1] = 0;
+    (LogDetail::Encode(entry, args), ...);
+}
+
+// Formata como o printf faria com os argumentos originais. Argumento que
+// falta ou não combina com a conversão sai como "<?>". Retorna o tamanho.
+inline size_t LogFormat(const LogEntry& entry, char* out, size_t size) {
+    const char* f = entry.format;
+    size_t length = 0;
+    uint32_t arg = 0;
+
+    while (*f && length + 1 < size) {
+        if (*f != '%') {
+            out[length++] = *f++;
+            continue;
+        }
+        if (f[1] == '%') {
+            out[length++] = '%';
+            f += 2;
+            continue;
+        }
+
+        // %[flags][largura][.precisão][tamanho]conversão
+        const char* spec = f++;
+        while (*f && strchr("-+ #0123456789.", *f)) f++;
+        size_t flagsLength = (size_t)(f - spec);
+        while (*f && strchr("hljztL", *f)) f++;
+        if (!*f) break;
+        char conversion = *f++;
+
+        int written = -1;
+        if (arg < entry.count) {
+            LogArgType type = (LogArgType)((entry.types >> (4 * arg)) & 0xF);
+            written = LogDetail::FormatArg(out + length, size - length, spec, flagsLength, conversion,
+                                           type, entry.args[arg], entry.text);
+            arg++;
+        }
+        if (written < 0) written = snprintf(out + length, size - length, "<?>");
+        length += (size_t)written < size - length ? (size_t)written : size - length - 1;
+    }
+
+    out[length] = 0;
+    return length;
+}
+
+//=============================================================================
+// ANEL POR THREAD
+//=============================================================================
+
+// Um produtor (a thread dona) e um consumidor (a thread de dreno). O
+// produtor escreve direto no slot e só depois publica.
+class LogRing {
+public:
+    // Dono novo só depois que o dreno levou tudo do anterior
+    bool TryAcquire() {
+        if (m_tail.load(std::memory_order_acquire) != m_head.load(std::memory_order_acquire)) return false;
+        bool free = false;
+        return m_owned.compare_exchange_strong(free, true, std::memory_order_acquire);
+    }
+
+    // Thread dona terminou (o que ela publicou ainda sai no dreno)
+    void Retire() { m_owned.store(false, std::memory_order_release); }
+
+    LogEntry* Claim() {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= LOG_RING_ENTRIES) {
+            m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &m_entries[head & (LOG_RING_ENTRIES - 1)];
+    }
+
+    void Publish() {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Só a thread de dreno chama
+    uint32_t Head() const { return m_head.load(std::memory_order_acquire); }
+    uint32_t Tail() const { return m_tail.load(std::memory_order_relaxed); }
+    const LogEntry& At(uint32_t index) const { return m_entries[index & (LOG_RING_ENTRIES - 1)]; }
+    void Release(uint32_t tail) { m_tail.store(tail, std::memory_order_release); }
+
+    uint32_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<uint32_t> m_head{0};
+    std::atomic<uint32_t> m_dropped{0};
+    std::atomic<bool> m_owned{false};
+    alignas(64) std::atomic<uint32_t> m_tail{0};
+    LogEntry m_entries[LOG_RING_ENTRIES];
+};
+
+//=============================================================================
+// LOGGER
+//=============================================================================
+
+class Logger {
+public:
+    static Logger& Instance() {
+        static Logger instance;
+        return instance;
+    }
+
+    // Começa a escrever (o que foi logado antes também sai). path nullptr
+    // = só console. false se já está rodando ou o arquivo não abre.
+    bool Start(const char* path = LOG_FILE, bool console = true) {
+        if (m_running.load(std::memory_order_relaxed)) return false;
+
+        m_file = nullptr;
+        if (path) {
+            m_file = fopen(path, "a");
+            if (!m_file) return false;
+        }
+        m_console = console;
+
+        Calibrate();
+        m_running.store(true, std::memory_order_relaxed);
+        m_drainThread = std::thread(&Logger::DrainThread, this);
+        return true;
+    }
+
+    // Para a thread de fundo, escreve o que faltou e fecha o arquivo
+    void Stop() {
+        if (!m_running.load(std::memory_order_relaxed)) return;
+
+        m_running.store(false, std::memory_order_relaxed);
+        if (m_drainThread.joinable()) m_drainThread.join();
+
+        DrainAll();
+        if (m_file) fclose(m_file);
+        m_file = nullptr;
+    }
+
+    bool IsRunning() const { return m_running.load(std::memory_order_relaxed); }
+
+    template<typename... Args>
+    void Write(const char* format, const Args&... args) {
+        LogRing* ring = LocalRing();
+        if (!ring) {
+            m_unregistered.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        LogEntry* entry = ring->Claim();
+        if (!entry) return;
+        entry->timestamp = ProfilerTimestamp();
+        LogCapture(*entry, format, args...);
+        ring->Publish();
+    }
+
+    // Registros descartados por anel cheio ou por falta de anel (todas as threads)
+    uint32_t Dropped() const {
+        uint32_t dropped = m_unregistered.load(std::memory_order_relaxed);
+        uint32_t threads = ThreadCount();
+        for (uint32_t i = 0; i < threads; i++) dropped += m_rings[i].Dropped();
+        return dropped;
+    }
+
+    // Só é exato com o logger parado
+    uint64_t LinesWritten() const { return m_written; }
+
+    // Anéis já criados (no máximo LOG_MAX_THREADS; reaproveitados entre threads)
+    uint32_t RingCount() const { return ThreadCount(); }
+
+private:
+    Logger() : m_baseTsc(ProfilerTimestamp()) {}
+
+    // Saída do processo (na DLL, com o loader lock): não dá para esperar
+    // a thread de fundo, e o que já foi drenado já está no arquivo
+    ~Logger() {
+        if (m_drainThread.joinable()) m_drainThread.detach();
+    }
+
+    uint32_t ThreadCount() const {
+        uint32_t count = m_threadCount.load(std::memory_order_acquire);
+        return count < LOG_MAX_THREADS ? count : LOG_MAX_THREADS;
+    }
+
+    // Devolve o anel quando a thread termina
+    struct RingLease {
+        LogRing* ring = nullptr;
+        ~RingLease() {
+            if (ring) ring->Retire();
+        }
+    };
+
+    // Anel da thread que chama. Fora do template de Write: um anel por
+    // thread, não um por thread e por lista de argumentos.
+    LogRing* LocalRing() {
+        static thread_local RingLease lease;
+        if (!lease.ring) lease.ring = Register();
+        return lease.ring;
+    }
+
+    // Primeiro log de cada thread: um anel devolvido e já drenado, ou um
+    // novo. nullptr se todos estão com threads vivas (ou sem drenar).
+    LogRing* Register() {
+        for (;;) {
+            uint32_t count = m_threadCount.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < count && i < LOG_MAX_THREADS; i++) {
+                if (m_rings[i].TryAcquire()) return &m_rings[i];
+            }
+            if (count >= LOG_MAX_THREADS) return nullptr;
+
+            // Outra thread pode pegar o anel novo entre o incremento e o
+            // TryAcquire (ela já o vê na contagem): tenta de novo
+            if (m_threadCount.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel) &&
+                m_rings[count].TryAcquire()) {
+                return &m_rings[count];
+            }
+        }
+    }
+
+    // Ticks de TSC por microssegundo, medidos contra o steady_clock
+    void Calibrate() {
+        using namespace std::chrono;
+        steady_clock::time_point t0 = steady_clock::now();
+        uint64_t tsc0 = ProfilerTimestamp();
+        std::this_thread::sleep_for(milliseconds(PROFILER_CALIBRATE_MS));
+        uint64_t tsc1 = ProfilerTimestamp();
+        double micros = (double)duration_cast<nanoseconds>(steady_clock::now() - t0).count() / 1000.0;
+        m_ticksPerMicro = micros > 0.0 ? (double)(tsc1 - tsc0) / micros : 1.0;
+    }
+
+    void DrainThread() {
+        while (m_running.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(LOG_DRAIN_MS));
+            DrainAll();
+        }
+    }
+
+    // Intercala os anéis pelo TSC (só o que já estava publicado no início)
+    void DrainAll() {
+        uint32_t threads = ThreadCount();
+        uint32_t tails[LOG_MAX_THREADS];
+        uint32_t heads[LOG_MAX_THREADS];
+        for (uint32_t i = 0; i < threads; i++) {
+            tails[i] = m_rings[i].Tail();
+            heads[i] = m_rings[i].Head();
+        }
+
+        for (;;) {
+            uint32_t best = LOG_MAX_THREADS;
+            for (uint32_t i = 0; i < threads; i++) {
+                if (tails[i] == heads[i]) continue;
+                if (best == LOG_MAX_THREADS ||
+                    m_rings[i].At(tails[i]).timestamp < m_rings[best].At(tails[best]).timestamp) {
+                    best = i;
+                }
+            }
+            if (best == LOG_MAX_THREADS) break;
+
+            WriteLine(m_rings[best].At(tails[best]));
+            m_rings[best].Release(++tails[best]);
+        }
+
+        // Descartes desde o último dreno viram uma linha
+        uint32_t dropped = Dropped();
+        if (dropped != m_reportedDrops) {
+            char line[96];
+            int length = snprintf(line, sizeof(line), "[LOG] %u mensagens descartadas (anel cheio)\n",
+                                  dropped - m_reportedDrops);
+            Output(line, (size_t)length);
+            m_reportedDrops = dropped;
+        }
+
+        if (m_file) fflush(m_file);
+        if (m_console) fflush(stdout);
+    }
+
+    // "[segundos] mensagem" (segundos desde que o logger existe)
+    void WriteLine(const LogEntry& entry) {
+        char line[LOG_LINE_BYTES];
+        uint64_t ticks = entry.timestamp > m_baseTsc ? entry.timestamp - m_baseTsc : 0;
+        int prefix = snprintf(line, sizeof(line), "[%9.3f] ", (double)ticks / m_ticksPerMicro / 1e6);
+        size_t length = (size_t)prefix + LogFormat(entry, line + prefix, sizeof(line) - prefix - 1);
+        line[length++] = '\n';
+        Output(line, length);
+        m_written++;
+    }
+
+    void Output(const char* line, size_t length) {
+        if (m_file) fwrite(line, 1, length, m_file);
+        if (m_console) fwrite(line, 1, length, stdout);
+    }
+
+    LogRing m_rings[LOG_MAX_THREADS];
+    std::atomic<uint32_t> m_threadCount{0};
+    std::atomic<uint32_t> m_unregistered{0};
+    std::atomic<bool> m_running{false};
+    std::thread m_drainThread;
+
+    // Só a thread de dreno (ou Start/Stop com ela parada)
+    FILE* m_file = nullptr;
+    bool m_console = false;
+    double m_ticksPerMicro = 1.0;
+    uint64_t m_baseTsc;
+    uint64_t m_written = 0;
+    uint32_t m_reportedDrops = 0;
+};
+
+template<typename... Args>
+inline void CoopLog(const char* format, const Args&... args) {
+    Logger::Instance().Write(format, args...);
+}
@@ -5,6 +5,20 @@
  */
 
 #include "coop_core.h"
+#include "coop_game_memory.h"
+#include "coop_snapshot.h"
+#include "coop_entity_cache.h"
+#include "coop_scanner.h"
+#include "coop_hook.h"
+#include "coop_tick.h"
+#include "coop_profiler.h"
+#include "coop_hitscan.h"
+#include "coop_players.h"
+#include "coop_camera.h"
+#include "coop_spawn.h"
+#include "coop_input.h"
+#include "coop_seqlock.h"
+#include "coop_checkpoint.h"
 #include <cmath>
 
 //=============================================================================
@@ -17,93 +31,333 @@ CoopConfig g_CoopConfig;
 // Ponteiros que serão encontrados via pattern
 cPlayer** pPL_ptr = nullptr;
 cPlayer** pAS_ptr = nullptr;
+uint8_t* pGlobals = nullptr;
+cEmMgr* pEmMgr = nullptr;
+
+// Slots de player (EntityCache resolve todos a cada frame)
+CoopPlayerSlot g_PlayerSlots[COOP_MAX_PLAYERS] = {};
+
+// Pontos seguros da sala atual (teleporte) e rastro dos players
+static SafeSpawnIndex s_Spawns;
+constexpr uint64_t SPAWN_TRAIL_INTERVAL = 6;      // 10 Hz a 60 ticks/s
+
+// Onde cada slot quer reaparecer em volta do Leon (o índice acha o ponto seguro mais perto)
+static const Vec PLAYER_TELEPORT_OFFSETS[COOP_MAX_PLAYERS] = {
+    { 0.0f, 0.0f, 0.0f },
+    { 100.0f, 0.0f, 0.0f },
+    { -100.0f, 0.0f, 0.0f },
+    { 0.0f, 0.0f, -100.0f },
+};
+
+// Eventos do controle do P2 juntados por frame (thread de poll em coop_input.h)
+static InputFrame s_P2Frame;
+
+// Cópia de g_P2_Input para as outras threads (menu, rede)
+static SeqLock<CoopInput> s_P2InputShared;
 
 // Backup de estado da Ashley
 static uint16_t s_AshleyCollisionBackup = 0;
 static bool s_AshleyControlTaken = false;
 
+// Combate da Ashley
+static HitscanWorld s_Hitscan;
+static uint64_t s_HitscanTick = UINT64_MAX;     // Tick em que s_Hitscan foi montado
+static uint64_t s_LastShotTick = 0;
+static bool s_HasShot = false;
+static Vec s_AshleyFacing = { 0.0f, 0.0f, 1.0f };
+
+// Scheduler de tick fixo
+static FixedTickScheduler s_Scheduler;
+static uint64_t s_LastFrameMicros = 0;
+
+// Câmera co-op
+static CoopCameraSolver s_Camera;
+static float s_CameraYaw = 0.0f;      // TODO: Ler do CameraControl quando o offset for mapeado
+
+// Entidades lidas uma vez por tick de rede
+static SnapshotExtractor s_Snapshot;
+static void (*s_NetworkTick)() = nullptr;
+
+// Regiões dos checkpoints de memória valem para esta sala e estes slots
+static uint16_t s_CheckpointRoom = 0xFFFF;
+static uint32_t s_CheckpointSlots = 0;
+
+// CoopUnload e DllMain podem chegar os dois; só o primeiro desliga
+static bool s_ShutdownDone = false;
+
 namespace CoopMod {
 namespace Hooks {
     void* Original_AshleyAI = nullptr;
     void* Original_CameraUpdate = nullptr;
 }
 
+static bool ReadPlayerPositions(PlayerPositions& players);
+static void UpdateMemoryCheckpoints();
+
 //=============================================================================
 // INICIALIZAÇÃO
 //=============================================================================
 
+// Registra todas as assinaturas antes de escanear: o scanner procura
+// todas juntas e o cache só vale para o mesmo conjunto
+static void FindGamePointers() {
+    PatternScanner& scanner = PatternScanner::Instance();
+    
+    // Padrão do re4_tweaks para pAS_ptr
+    static const int asPattern = scanner.Add("pAS_ptr", "A8 02 74 16 8B 15");
+    
+    // TODO: Padrões de pPL_ptr e EmMgr
+    
+    scanner.ScanModule();
+    
+    // re4_tweaks exige match único; mais de um é outro executável
+    if (!pAS_ptr && scanner.MatchCount(asPattern) == 1) {
+        pAS_ptr = *(cPlayer***)scanner.Find(asPattern, 6);
+    }
+}
+
 bool Initialize() {
+    s_ShutdownDone = false;
+    
     // Inicializa input do P2
     g_P2_Input.Reset();
     g_P2_Input.connected = false;
+    s_P2Frame.Reset();
     
     // Carrega configurações
     g_CoopConfig = CoopConfig();
     
-    // Instala hooks
+    // Scheduler de simulação
+    s_Scheduler.SetTickRate(g_CoopConfig.tickRate);
+    s_Scheduler.SetMaxCatchUp(g_CoopConfig.maxCatchUpTicks);
+    s_Scheduler.Reset();
+    s_LastFrameMicros = 0;
+    s_Camera.Reset();
+    
+    // Só a tabela da v1.1.0 existe por enquanto
+    // TODO: Detectar a versão pelo executável
+    SelectGameVersion(GameVersion::V1_1_0);
+    
+    // Globais ficam em endereço fixo em cada versão
+    if (!pGlobals) {
+        WithGameVersion([](auto table) {
+            pGlobals = (uint8_t*)table.GLOBALS_BASE;
+        });
+    }
+    
+    // Encontra os ponteiros (numa passada só, ou direto do cache)
+    FindGamePointers();
+    BindPlayerSlot(ENTITY_SLOT_PLAYER, pPL_ptr, PlayerCharacter::Leon);
+    BindPlayerSlot(ENTITY_SLOT_ASHLEY, pAS_ptr, PlayerCharacter::Ashley);
+    
+    // Prepara os hooks e escreve todos de uma vez
     Hooks::InstallInputHook();
     Hooks::InstallAshleyAIHook();
     Hooks::InstallCameraHook();
+    HookEngine::Instance().SetAllEnabled(true);
+    HookEngine::Instance().Apply();
+    
+#ifdef _WIN32
+    // Controles lidos fora do frame do jogo
+    InputPoller::Instance().Start(XInputPadSource, nullptr);
+#endif
     
     // Verifica se encontrou ponteiros
     if (!pPL_ptr || !pAS_ptr) {
-        // Tenta encontrar via pattern matching
-        // Pattern do re4_tweaks para pAS_ptr:
-        // pattern = hook::pattern("A8 02 74 16 8B 15");
-        // pAS_ptr = *pattern.count(1).get(0).get<cPlayer**>(6);
-        
         return false;
     }
     
     return true;
 }
 
-void Shutdown() {
+// Devolve o jogo ao original. Só escreve memória e VirtualProtect,
+// então também vale de dentro do DllMain.
+static void RestoreGame() {
     // Libera controle da Ashley se estiver tomado
     if (s_AshleyControlTaken) {
         ReleaseAshleyControl();
     }
     
+    // Restaura os bytes originais do jogo
+    HookEngine::Instance().SetAllEnabled(false);
+    HookEngine::Instance().Apply();
+    
+    // Páginas do jogo voltam à proteção original
+    MemoryCheckpoints::Instance().ClearRegions();
+    
     g_CoopConfig.enabled = false;
 }
 
+void Shutdown() {
+    if (s_ShutdownDone) return;
+    s_ShutdownDone = true;
+    
+    // Antes dos hooks: a thread de poll não pode ver o jogo pela metade
+    InputPoller::Instance().Stop();
+    RestoreGame();
+    
+    // Rastro da sala atual para a próxima sessão
+    if (s_Spawns.IsDirty()) s_Spawns.Save();
+}
+
+void ShutdownFromDllMain(bool processExit) {
+    if (s_ShutdownDone) return;
+    s_ShutdownDone = true;
+    
+    // Sem join: sair da thread precisa do loader lock, que estamos segurando.
+    // Sem CoopUnload antes do FreeLibrary a thread pode acordar em código
+    // já descarregado; por isso o unload de verdade é o export.
+    InputPoller::Instance().Abandon();
+    
+    // Na saída do processo o jogo morre junto: nada a restaurar. O rastro
+    // de spawn não é salvo aqui (arquivo com loader lock); perde-se a sala atual.
+    if (!processExit) RestoreGame();
+}
+
 //=============================================================================
 // LOOP PRINCIPAL
 //=============================================================================
 
 void Update() {
+    COOP_PROFILE_ZONE("CoopMod::Update");
+    
+    uint64_t now = CoopNowMicros();
+    uint64_t frameMicros = s_LastFrameMicros ? now - s_LastFrameMicros : 0;
+    s_LastFrameMicros = now;
+    
+    Advance(frameMicros);
+}
+
+void Advance(uint64_t frameMicros) {
     if (!g_CoopConfig.enabled) return;
     
-    // Atualiza input do Player 2
+    // Resolve os slots de player uma vez; ticks e câmera deste frame usam o cache
+    EntityCache& entities = EntityCache::Instance();
+    entities.Refresh();
+    
+    // Input do Player 2: tudo que a thread de poll viu desde o último frame
     UpdatePlayer2Input();
     
-    // Se Controller 2 não conectado, não faz nada
-    if (!g_P2_Input.connected) return;
+    // Roda quantos ticks fixos couberem no tempo deste frame
+    s_Scheduler.Advance(frameMicros, SimulationTick);
     
-    // Obtém ponteiros
-    cPlayer* leon = PlayerPtr();
-    cPlayer* ashley = AshleyPtr();
+    // Apresentação: uma vez por frame
+    if (g_P2_Input.connected && entities.ValidCount() >= 2) {
+        UpdateCoopCamera(frameMicros * 1e-6f);
+    }
+}
+
+void SimulationTick(uint64_t tick, float dt) {
+    COOP_PROFILE_ZONE("CoopMod::SimulationTick");
     
-    if (!leon || !ashley) return;
+    // Se Controller 2 conectado, P2 controla a Ashley
+    if (g_P2_Input.connected) {
+        cPlayer* leon = EntityCache::Instance().Leon();
+        cPlayer* ashley = EntityCache::Instance().Ashley();
+        
+        if (leon && ashley) {
+            // Toma controle da Ashley se ainda não tomou
+            if (!s_AshleyControlTaken) {
+                TakeOverAshleyControl();
+            }
+            
+            // Aplica input do P2 na Ashley
+            ApplyInputToAshley(ashley, g_P2_Input, dt);
+            s_P2Frame.Applied(InputPoller::Instance(), CoopNowMicros());
+        }
+        else {
+            s_P2Frame.Discard();
+        }
+    }
+    else {
+        s_P2Frame.Discard();
+    }
     
-    // Toma controle da Ashley se ainda não tomou
-    if (!s_AshleyControlTaken) {
-        TakeOverAshleyControl();
+    // Índice de pontos seguros: sala nova carrega do disco; onde os players
+    // pisam vira ponto seguro
+    // TODO: SetFloorProbe + BuildFromProbe com os limites da sala quando a
+    // colisão do jogo estiver mapeada
+    PlayerPositions players;
+    bool havePlayers = ReadPlayerPositions(players);
+    s_Spawns.EnterRoom(EntityCache::Instance().RoomId());
+    if (havePlayers && tick % SPAWN_TRAIL_INTERVAL == 0) {
+        for (uint16_t slot = 0; slot < COOP_MAX_PLAYERS; slot++) {
+            if (players.Has(slot)) s_Spawns.AddPoint(players.Pos(slot));
+        }
     }
     
-    // Aplica input do P2 na Ashley
-    ApplyInputToAshley(ashley, g_P2_Input);
+    // Players longe demais do Leon voltam para perto dele (todos os slots
+    // numa conta só; Ashley com IA segue o Leon sozinha)
+    if (g_CoopConfig.teleportIfTooFar && havePlayers && players.Has(ENTITY_SLOT_PLAYER)) {
+        uint32_t far = PlayersBeyond(players, players.Pos(ENTITY_SLOT_PLAYER), g_CoopConfig.maxDistance);
+        if (!g_P2_Input.connected) far &= ~(1u << ENTITY_SLOT_ASHLEY);
+        
+        for (uint16_t slot = 1; slot < COOP_MAX_PLAYERS; slot++) {
+            if (far & (1u << slot)) TeleportPlayerToLeon(slot);
+        }
+    }
     
-    // Verifica distância e teleporta se necessário
-    if (g_CoopConfig.teleportIfTooFar) {
-        float dist = GetPlayerDistance();
-        if (dist > g_CoopConfig.maxDistance) {
-            TeleportAshleyToLeon();
+    // Replicação em cadência fixa
+    if (s_NetworkTick && g_CoopConfig.netSendInterval &&
+        tick % g_CoopConfig.netSendInterval == 0) {
+        {
+            COOP_PROFILE_ZONE("Snapshot::Capture");
+            s_Snapshot.Capture();
+        }
+        {
+            COOP_PROFILE_ZONE("MemoryCheckpoints::Checkpoint");
+            UpdateMemoryCheckpoints();
         }
+        s_NetworkTick();
+    }
+}
+
+float GetTickAlpha() {
+    return s_Scheduler.Alpha();
+}
+
+uint64_t GetSimTick() {
+    return s_Scheduler.TickIndex();
+}
+
+void SetNetworkTickHandler(void (*handler)()) {
+    s_NetworkTick = handler;
+}
+
+const SnapshotExtractor& GetSnapshot() {
+    return s_Snapshot;
+}
+
+// Um checkpoint por tick de rede. Sala nova ou slot trocado: as structs
+// podem ter mudado de lugar, então registra tudo de novo.
+static void UpdateMemoryCheckpoints() {
+    MemoryCheckpoints& checkpoints = MemoryCheckpoints::Instance();
+    if (!g_CoopConfig.memoryCheckpoints) {
+        if (checkpoints.IsArmed()) checkpoints.ClearRegions();
+        return;
     }
     
-    // Atualiza câmera para mostrar os dois
-    UpdateCoopCamera();
+    const EntityCache& entities = EntityCache::Instance();
+    if (checkpoints.IsArmed() && entities.RoomId() == s_CheckpointRoom &&
+        entities.ValidMask() == s_CheckpointSlots) {
+        checkpoints.Checkpoint();
+        return;
+    }
+    
+    checkpoints.ClearRegions();
+    s_CheckpointRoom = entities.RoomId();
+    s_CheckpointSlots = entities.ValidMask();
+    WithGameVersion([&](auto table) {
+        for (uint16_t i = 0; i < ENTITY_CACHE_SLOTS; i++) {
+            cPlayer* player = entities.Player(i);
+            if (player) checkpoints.AddRegion(player, decltype(table)::PLAYER_READ_SIZE);
+        }
+        
+        EmListView enemies(table, pEmMgr);
+        if (enemies.Count()) checkpoints.AddRegion(enemies.At(0), (size_t)enemies.Count() * enemies.Stride());
+    });
+    // TODO: Inventário quando o offset estiver mapeado
+    checkpoints.Arm();
 }
 
 //=============================================================================
@@ -111,49 +365,24 @@ void Update() {
 //=============================================================================
 
 void UpdatePlayer2Input() {
-    // Aqui você implementa a leitura do Controller 2
-    // Pode usar DirectInput ou XInput
-    
-    // Exemplo com XInput (precisa linkar xinput.lib):
-    /*
-    XINPUT_STATE state;
-    ZeroMemory(&state, sizeof(XINPUT_STATE));
-    
-    // Controller 1 é índice 0, Controller 2 é índice 1
-    DWORD result = XInputGetState(1, &state);
-    
-    if (result == ERROR_SUCCESS) {
-        g_P2_Input.connected = true;
-        
-        // Analógico esquerdo (movimento)
-        g_P2_Input.moveX = state.Gamepad.sThumbLX / 32768.0f;
-        g_P2_Input.moveY = state.Gamepad.sThumbLY / 32768.0f;
-        
-        // Analógico direito (câmera)
-        g_P2_Input.lookX = state.Gamepad.sThumbRX / 32768.0f;
-        g_P2_Input.lookY = state.Gamepad.sThumbRY / 32768.0f;
-        
-        // Triggers
-        g_P2_Input.leftTrigger = state.Gamepad.bLeftTrigger / 255.0f;
-        g_P2_Input.rightTrigger = state.Gamepad.bRightTrigger / 255.0f;
-        
-        // Botões
-        g_P2_Input.aim = g_P2_Input.leftTrigger > 0.5f;
-        g_P2_Input.shoot = g_P2_Input.rightTrigger > 0.5f;
-        g_P2_Input.action = (state.Gamepad.wButtons & XINPUT_GAMEPAD_A) != 0;
-        g_P2_Input.run = (state.Gamepad.wButtons & XINPUT_GAMEPAD_B) != 0;
-        g_P2_Input.reload = (state.Gamepad.wButtons & XINPUT_GAMEPAD_X) != 0;
-        g_P2_Input.knife = (state.Gamepad.wButtons & XINPUT_GAMEPAD_Y) != 0;
-        g_P2_Input.inventory = (state.Gamepad.wButtons & XINPUT_GAMEPAD_START) != 0;
-        g_P2_Input.map = (state.Gamepad.wButtons & XINPUT_GAMEPAD_BACK) != 0;
-    } else {
-        g_P2_Input.connected = false;
+    // Sem thread de poll (fonte não configurada) g_P2_Input fica como está
+    InputPoller& poller = InputPoller::Instance();
+    if (poller.IsRunning()) {
+        // Botões e gatilhos apertados em qualquer momento do frame contam,
+        // mesmo se já foram soltos; analógicos pelo último estado
+        s_P2Frame.Consume(poller, P2_INPUT_PAD);
+        s_P2Frame.Build(g_P2_Input);
     }
-    */
+    
+    s_P2InputShared.Store(g_P2_Input);
 }
 
 bool IsController2Connected() {
-    return g_P2_Input.connected;
+    return s_P2InputShared.Load().connected;
+}
+
+CoopInput GetPlayer2Input() {
+    return s_P2InputShared.Load();
 }
 
 //=============================================================================
@@ -161,12 +390,13 @@ bool IsController2Connected() {
 //=============================================================================
 
 void TakeOverAshleyControl() {
-    cPlayer* ashley = AshleyPtr();
+    cPlayer* ashley = EntityCache::Instance().Ashley();
     if (!ashley) return;
     
     // Backup das flags de colisão
-    uint16_t* collisionFlags = (uint16_t*)((uint8_t*)ashley + Offsets::ATARI_FLAG);
-    s_AshleyCollisionBackup = *collisionFlags;
+    WithGameVersion([&](auto table) {
+        s_AshleyCollisionBackup = EmView(table, ashley).AtariFlag();
+    });
     
     // Habilita combate para Ashley
     if (g_CoopConfig.ashleyHasWeapons) {
@@ -177,30 +407,34 @@ void TakeOverAshleyControl() {
 }
 
 void ReleaseAshleyControl() {
-    cPlayer* ashley = AshleyPtr();
+    cPlayer* ashley = EntityCache::Instance().Ashley();
     if (ashley) {
         // Restaura flags de colisão
-        uint16_t* collisionFlags = (uint16_t*)((uint8_t*)ashley + Offsets::ATARI_FLAG);
-        *collisionFlags = s_AshleyCollisionBackup;
+        WithGameVersion([&](auto table) {
+            EmView(table, ashley).SetAtariFlag(s_AshleyCollisionBackup);
+        });
     }
     
     s_AshleyControlTaken = false;
 }
 
-void ApplyInputToAshley(cPlayer* ashley, const CoopInput& input) {
+void ApplyInputToAshley(cPlayer* ashley, const CoopInput& input, float dt) {
     if (!ashley) return;
     
-    // Obtém posição atual
-    Vec* pos = (Vec*)((uint8_t*)ashley + Offsets::POS);
-    
     // Aplica movimento
     if (fabsf(input.moveX) > 0.1f || fabsf(input.moveY) > 0.1f) {
-        // Velocidade de movimento
-        const float MOVE_SPEED = 5.0f;
+        // Velocidade de movimento (unidades por segundo; era 5.0 por frame a 60 FPS)
+        const float MOVE_SPEED = 300.0f;
         
         // Move baseado no input
-        pos->x += input.moveX * MOVE_SPEED;
-        pos->z += input.moveY * MOVE_SPEED;
+        WithGameVersion([&](auto table) {
+            EmView em(table, ashley);
+            Vec pos = em.Pos();
+            pos.x += input.moveX * MOVE_SPEED * dt;
+            pos.z += input.moveY * MOVE_SPEED * dt;
+            em.SetPos(pos);
+        });
+        s_AshleyFacing = { input.moveX, 0.0f, input.moveY };
         
         // TODO: Rotacionar na direção do movimento
         // TODO: Triggar animação de andar
@@ -226,23 +460,24 @@ void ApplyInputToAshley(cPlayer* ashley, const CoopInput& input) {
 void EnableAshleyCombat(cPlayer* ashley) {
     if (!ashley) return;
     
-    // Verifica se já tem arma
-    cPlWep** weaponPtr = (cPlWep**)((uint8_t*)ashley + Offsets::WEAPON_PTR);
-    
-    if (*weaponPtr == nullptr) {
-        // Dar arma inicial (pistola)
-        // Aqui precisamos chamar a função do jogo para equipar arma
-        // GiveWeaponToAshley(ITEM_ID_HANDGUN);
-    }
-    
-    // Modifica flags para permitir ataque
-    uint32_t* flags = (uint32_t*)((uint8_t*)ashley + Offsets::PLAYER_FLAG);
-    // TODO: Descobrir flag exata para habilitar ataque
-    // *flags |= PLAYER_CAN_ATTACK_FLAG;
+    WithGameVersion([&](auto table) {
+        PlayerView player(table, ashley);
+        
+        // Verifica se já tem arma
+        if (player.Weapon() == nullptr) {
+            // Dar arma inicial (pistola)
+            // Aqui precisamos chamar a função do jogo para equipar arma
+            // GiveWeaponToAshley(ITEM_ID_HANDGUN);
+        }
+        
+        // Modifica flags para permitir ataque
+        // TODO: Descobrir flag exata para habilitar ataque
+        // player.SetPlayerFlag(player.PlayerFlag() | PLAYER_CAN_ATTACK_FLAG);
+    });
 }
 
 void GiveWeaponToAshley(int weaponId) {
-    cPlayer* ashley = AshleyPtr();
+    cPlayer* ashley = EntityCache::Instance().Ashley();
     if (!ashley) return;
     
     // TODO: Chamar função do jogo para dar item
@@ -261,30 +496,63 @@ void ProcessAshleyAim(cPlayer* ashley) {
 void ProcessAshleyShoot(cPlayer* ashley) {
     if (!ashley) return;
     
-    // TODO: Processar tiro
-    // 1. Verificar se tem arma
-    // 2. Verificar se tem munição
-    // 3. Fazer raycast para acertar
-    // 4. Aplicar dano
-    // 5. Reduzir munição
-    // 6. Tocar som
-    // 7. Efeito visual
+    // Gatilho segurado atira a cada ASHLEY_SHOT_INTERVAL ticks
+    const uint64_t ASHLEY_SHOT_INTERVAL = 20;       // ~3 tiros/s a 60 Hz
+    const float ASHLEY_MUZZLE_HEIGHT = 120.0f;
+    const int16_t ASHLEY_SHOT_DAMAGE = 100;
+    
+    uint64_t tick = GetSimTick();
+    if (s_HasShot && tick - s_LastShotTick < ASHLEY_SHOT_INTERVAL) return;
+    
+    // TODO: Verificar arma e munição (inventário da Ashley ainda não mapeado)
+    
+    // Direção: analógico direito; parado, a última direção de movimento
+    Vec direction = { g_P2_Input.lookX, 0.0f, g_P2_Input.lookY };
+    if (fabsf(direction.x) < 0.2f && fabsf(direction.z) < 0.2f) {
+        direction = s_AshleyFacing;
+    }
+    
+    WithGameVersion([&](auto table) {
+        // Hash montado no máximo uma vez por tick, e só quando alguém atira
+        if (s_HitscanTick != tick) {
+            s_Hitscan.Rebuild(table, EmListView(table, pEmMgr));
+            s_HitscanTick = tick;
+        }
+        
+        Vec origin = EmView(table, ashley).Pos();
+        origin.y += ASHLEY_MUZZLE_HEIGHT;
+        
+        HitscanHit hit;
+        if (s_Hitscan.Raycast(origin, direction, HITSCAN_MAX_DISTANCE, hit)) {
+            // TODO: Trocar pela função de dano do jogo (reação, morte, drop)
+            EmView enemy(table, hit.entity);
+            int16_t hp = enemy.HP() - ASHLEY_SHOT_DAMAGE;
+            enemy.SetHP(hp > 0 ? hp : 0);
+        }
+    });
+    
+    s_LastShotTick = tick;
+    s_HasShot = true;
+    
+    // TODO: Reduzir munição
+    // TODO: Tocar som
+    // TODO: Efeito visual (flash + impacto em hit.point)
 }
 
 //=============================================================================
 // SISTEMA DE CÂMERA
 //=============================================================================
 
-void UpdateCoopCamera() {
-    cPlayer* leon = PlayerPtr();
-    cPlayer* ashley = AshleyPtr();
-    
-    if (!leon || !ashley) return;
-    
-    Vec leonPos = GET_POS(leon);
-    Vec ashleyPos = GET_POS(ashley);
-    
-    float distance = CalculateDistance(leonPos, ashleyPos);
+// Posição de todos os slots numa leitura só. false se a versão é desconhecida.
+static bool ReadPlayerPositions(PlayerPositions& players) {
+    return WithGameVersion([&](auto table) {
+        GatherPlayerPositions(table, EntityCache::Instance(), players);
+    });
+}
+
+void UpdateCoopCamera(float dt) {
+    PlayerPositions players;
+    if (!ReadPlayerPositions(players) || players.count < 2) return;
     
     // Se usando split-screen, não precisa ajustar câmera
     if (g_CoopConfig.splitScreen) {
@@ -293,74 +561,84 @@ void UpdateCoopCamera() {
         return;
     }
     
-    // Câmera dinâmica - foca no ponto médio
-    Vec midpoint = CalculateMidpoint(leonPos, ashleyPos);
+    // Câmera dinâmica - enquadra o grupo todo (alvo, distância e FOV suavizados)
+    // TODO: SetLineOfSight com o raycast de colisão do jogo
+    s_Camera.Solve(players, EntityCache::Instance().RoomId(), s_CameraYaw, dt);
     
-    // TODO: Acessar CameraControl e ajustar
+    // TODO: Aplicar no CameraControl (hook de InstallCameraHook)
     // CameraControl* cam = CamCtrl;
     // if (cam) {
-    //     // Ajusta target da câmera
-    //     cam->target = midpoint;
-    //     
-    //     // Zoom out se os players estão longe
-    //     if (distance > 500.0f) {
-    //         cam->Fovy *= 1.1f; // Aumenta FOV para ver mais
-    //     }
+    //     const CoopCameraFrame& frame = s_Camera.Frame();
+    //     cam->target = frame.target;
+    //     cam->eye = frame.eye;
+    //     cam->Fovy = frame.fovy;     // Valor absoluto, nunca multiplicado por frame
     // }
 }
 
+const CoopCameraFrame& GetCameraFrame() {
+    return s_Camera.Frame();
+}
+
 float GetPlayerDistance() {
-    cPlayer* leon = PlayerPtr();
-    cPlayer* ashley = AshleyPtr();
+    PlayerPositions players;
+    if (!ReadPlayerPositions(players) || !players.Has(ENTITY_SLOT_PLAYER) || players.count < 2) return 0.0f;
     
-    if (!leon || !ashley) return 0.0f;
-    
-    Vec leonPos = GET_POS(leon);
-    Vec ashleyPos = GET_POS(ashley);
-    
-    return CalculateDistance(leonPos, ashleyPos);
+    return PlayerMaxDistance(players, players.Pos(ENTITY_SLOT_PLAYER));
 }
 
 Vec GetMidpointBetweenPlayers() {
-    cPlayer* leon = PlayerPtr();
-    cPlayer* ashley = AshleyPtr();
-    
-    if (!leon || !ashley) return {0, 0, 0};
-    
-    Vec leonPos = GET_POS(leon);
-    Vec ashleyPos = GET_POS(ashley);
+    PlayerPositions players;
+    if (!ReadPlayerPositions(players) || players.count < 2) return {0, 0, 0};
     
-    return CalculateMidpoint(leonPos, ashleyPos);
+    return PlayerCentroid(players);
 }
 
 //=============================================================================
 // UTILITÁRIOS
 //=============================================================================
 
-void TeleportAshleyToLeon() {
-    cPlayer* leon = PlayerPtr();
-    cPlayer* ashley = AshleyPtr();
-    
-    if (!leon || !ashley) return;
-    
-    Vec leonPos = GET_POS(leon);
-    
-    // Teleporta Ashley para perto do Leon (com offset)
-    Vec newPos = leonPos;
-    newPos.x += 100.0f;  // 1 metro ao lado
-    
-    // Desabilita colisão temporariamente para evitar bugs
-    DisableCollision(ashley);
+void BindPlayerSlot(uint16_t slot, cPlayer** source, PlayerCharacter character) {
+    if (slot >= COOP_MAX_PLAYERS) return;
+    g_PlayerSlots[slot].source = source;
+    g_PlayerSlots[slot].character = character;
+}
+
+void TeleportPlayerToLeon(uint16_t slot) {
+    const EntityCache& entities = EntityCache::Instance();
+    cPlayer* leon = entities.Leon();
+    cPlayer* player = entities.Player(slot);
     
-    SET_POS(ashley, newPos);
+    if (!leon || !player || slot == ENTITY_SLOT_PLAYER) return;
     
-    // Reabilita colisão
-    EnableCollision(ashley);
+    WithGameVersion([&](auto table) {
+        EmView em(table, player);
+        
+        // Ponto seguro mais perto do lugar desejado ao lado do Leon; sem
+        // nenhum por perto, o próprio lugar do Leon (chão garantido)
+        const Vec& offset = PLAYER_TELEPORT_OFFSETS[slot];
+        Vec leonPos = EmView(table, leon).Pos();
+        Vec desired = { leonPos.x + offset.x, leonPos.y, leonPos.z + offset.z };
+        Vec newPos;
+        if (!s_Spawns.Nearest(desired, SPAWN_SEARCH_RADIUS, newPos)) newPos = leonPos;
+        
+        // Desabilita colisão temporariamente para evitar bugs
+        uint16_t collision = em.AtariFlag();
+        em.SetAtariFlag(collision & ~(SAT_SCA_ENABLE | SAT_OBA_ENABLE));
+        
+        em.SetPos(newPos);
+        
+        // Reabilita colisão
+        em.SetAtariFlag(collision | SAT_SCA_ENABLE | SAT_OBA_ENABLE);
+    });
+}
+
+void TeleportAshleyToLeon() {
+    TeleportPlayerToLeon(ENTITY_SLOT_ASHLEY);
 }
 
 void SyncPositions() {
     // Usado principalmente para debug
-    CopyPosition(PlayerPtr(), AshleyPtr());
+    CopyPosition(EntityCache::Instance().Leon(), EntityCache::Instance().Ashley());
 }
 
 //=============================================================================
@@ -390,9 +668,9 @@ void InstallAshleyAIHook() {
     // Provavelmente algo como cSubChar::update ou similar
     
     // Pattern aproximado (precisa verificar):
-    // auto pattern = hook::pattern("Ashley AI pattern here");
-    // ReadCall(pattern.get_first(), Original_AshleyAI);
-    // InjectHook(pattern.get_first(), AshleyAI_Hook, PATCH_JUMP);
+    // int id = PatternScanner::Instance().Add("AshleyAI", "Ashley AI pattern here");
+    // HookEngine::Instance().Create((void*)PatternScanner::Instance().Find(id),
+    //                               (void*)AshleyAI_Hook, &Original_AshleyAI);
 }
 
 void InstallCameraHook() {
@@ -416,6 +694,12 @@ void InstallWeaponHook() {
 // ENTRY POINT DA DLL
 //=============================================================================
 
+// Chamado pelo loader do mod antes do FreeLibrary (ou ao fechar o jogo),
+// fora do loader lock: aqui dá para esperar threads e gravar arquivo
+extern "C" __declspec(dllexport) void CoopUnload() {
+    CoopMod::Shutdown();
+}
+
 BOOL APIENTRY DllMain(HMODULE hModule, DWORD reason, LPVOID reserved) {
     switch (reason) {
         case DLL_PROCESS_ATTACH:
@@ -426,7 +710,8 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD reason, LPVOID reserved) {
             break;
             
         case DLL_PROCESS_DETACH:
-            CoopMod::Shutdown();
+            // reserved != nullptr: o processo está saindo
+            CoopMod::ShutdownFromDllMain(reserved != nullptr);
             break;
     }
     return TRUE;
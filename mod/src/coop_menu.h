@@ -10,6 +10,7 @@
 
 #pragma once
 #include "coop_core.h"
+#include "coop_network.h"
 #include <string>
 
 //=============================================================================
@@ -80,6 +81,9 @@ public:
     char inputCode[8] = {0};
     int inputPos = 0;
     
+    // Salas da LAN (escuta enquanto a tela de join está aberta)
+    DiscoveryListener discovery;
+    
     // Mensagem de erro
     char errorMessage[128] = {0};
     
@@ -132,6 +136,9 @@ inline void CoopMenu::Hide() {
 inline void CoopMenu::Update() {
     if (state == MenuState::HIDDEN) return;
     
+    // Beacons que chegaram (não bloqueia); o código já resolve ao confirmar
+    if (discovery.IsRunning()) discovery.Poll(GetTickCount());
+    
     // Lê input do menu (Controller 1 ou Teclado)
     // TODO: Integrar com sistema de input do jogo
 }
@@ -171,6 +178,7 @@ inline void CoopMenu::OnConfirm() {
                     state = MenuState::JOIN_ENTER_CODE;
                     memset(inputCode, 0, sizeof(inputCode));
                     inputPos = 0;
+                    discovery.Start();
                     break;
             }
             break;
@@ -206,6 +214,7 @@ inline void CoopMenu::OnCancel() {
         case MenuState::LOCAL_OPTIONS:
         case MenuState::JOIN_ENTER_CODE:
         case MenuState::ERROR_SCREEN:
+            discovery.Stop();
             state = MenuState::MODE_SELECT;
             selectedOption = 0;
             maxOptions = 4;
@@ -262,19 +271,20 @@ inline void CoopMenu::StartHost() {
     settings.mode = GameMode::COOP_HOST;
     state = MenuState::HOST_WAITING;
     
-    // Inicia servidor
-    // if (!g_Server.Start(settings.port)) {
-    //     strcpy(errorMessage, "Falha ao criar servidor!");
-    //     state = MenuState::ERROR_SCREEN;
-    //     return;
-    // }
+    // Replicação roda no tick de rede da simulação
+    CoopMod::SetNetworkTickHandler([] { CoopServer::Instance().Update(); });
     
-    // Gera código da sala
-    GenerateRoomCode(settings.roomCode, 6);
+    // Inicia servidor (que já anuncia a sala na LAN)
+    CoopServer& server = CoopServer::Instance();
+    if (!server.Start(settings.port)) {
+        strcpy(errorMessage, "Falha ao criar servidor!");
+        state = MenuState::ERROR_SCREEN;
+        return;
+    }
     
-    // Obtém IP local
-    // GetLocalIP(settings.hostIP, sizeof(settings.hostIP));
-    strcpy(settings.hostIP, "192.168.1.100"); // Placeholder
+    // Código e IP são os do servidor (o código não vai nos beacons)
+    strcpy(settings.roomCode, server.GetRoomCode());
+    strncpy(settings.hostIP, server.GetLocalIP(), sizeof(settings.hostIP) - 1);
 }
 
 inline void CoopMenu::StartJoin() {
@@ -283,15 +293,35 @@ inline void CoopMenu::StartJoin() {
     
     strcpy(settings.roomCode, inputCode);
     
-    // Converte código para IP (ou usa servidor master)
-    // CodeToIP(inputCode, settings.hostIP);
+    // Envio de input roda no tick de rede da simulação
+    CoopMod::SetNetworkTickHandler([] { CoopClient::Instance().Update(); });
+    
+    // Os beacons não dizem o código: tenta as salas da LAN, a vista por
+    // último primeiro, e fica a que completar o handshake com ele (host
+    // errado recusa no CPace)
+    uint32_t now = GetTickCount();
+    discovery.Poll(now);
+    const DiscoverySession* sessions[DISCOVERY_MAX_SESSIONS];
+    uint32_t count = discovery.Sessions(sessions, DISCOVERY_MAX_SESSIONS, now);
+    if (count == 0) {
+        strcpy(errorMessage, "Sala nao encontrada na rede local!");
+        state = MenuState::ERROR_SCREEN;
+        return;
+    }
     
-    // Conecta
-    // if (!g_Client.Connect(settings.hostIP, settings.port)) {
-    //     strcpy(errorMessage, "Falha ao conectar!");
-    //     state = MenuState::ERROR_SCREEN;
-    //     return;
-    // }
+    bool connected = false;
+    for (uint32_t i = 0; i < count && !connected; i++) {
+        strcpy(settings.hostIP, sessions[i]->ip);
+        settings.port = sessions[i]->port;
+        connected = CoopClient::Instance().Connect(settings.hostIP, settings.port, settings.roomCode);
+    }
+    discovery.Stop();
+    
+    if (!connected) {
+        strcpy(errorMessage, "Falha ao conectar!");
+        state = MenuState::ERROR_SCREEN;
+        return;
+    }
     
     // Sucesso!
     state = MenuState::CONNECTED;
@@ -414,11 +444,28 @@ inline void CoopMenu::RenderConnected() {
     // DrawBox(LEFT, 150, "PLAYER 1\nLEON\n(Host)");
     // DrawBox(RIGHT, 150, "PLAYER 2\nASHLEY\n(Client)");
     
+    // Telemetria do endpoint ativo (snapshot não bloqueia as threads de rede)
+    const NetTelemetry& telemetry = (settings.mode == GameMode::COOP_HOST)
+        ? CoopServer::Instance().GetTelemetry()
+        : CoopClient::Instance().GetTelemetry();
+    
+    static TelemetrySnapshot snap;  // ~16 KB, fora da pilha
+    telemetry.Snapshot(snap);
+    settings.ping = (int)(snap.lastRttUs / 1000);
+    
     // Ping
     char pingStr[32];
     sprintf(pingStr, "Ping: %dms", settings.ping);
     // DrawText(CENTER_X, 350, pingStr, COLOR_GRAY);
     
+    // Jitter e perda. RTT só sai do PING/PONG (1 por segundo): o n diz
+    // quanto o p99 vale
+    char netStr[96];
+    sprintf(netStr, "RTT p50/p99 (1 ping/s, n=%llu): %u/%ums  Perda: %.1f%%  Fila: %u",
+            (unsigned long long)snap.rtt.count, snap.rtt.Percentile(0.50) / 1000,
+            snap.rtt.Percentile(0.99) / 1000, snap.LossPercent(), snap.queueDepth);
+    // DrawText(CENTER_X, 380, netStr, COLOR_GRAY);
+    
     // DrawText(CENTER_X, 450, "[A] Iniciar    [B] Desconectar", COLOR_GRAY);
 }
 
@@ -428,22 +475,6 @@ inline void CoopMenu::RenderError() {
     // DrawText(CENTER_X, 400, "[A/B] Voltar", COLOR_GRAY);
 }
 
-//=============================================================================
-// UTILITÁRIOS
-//=============================================================================
-
-inline void GenerateRoomCode(char* code, int length) {
-    const char chars[] = "ABCDEFGHJKLMNPQRSTUVWXYZ23456789";
-    const int numChars = sizeof(chars) - 1;
-    
-    srand((unsigned)time(nullptr));
-    
-    for (int i = 0; i < length; i++) {
-        code[i] = chars[rand() % numChars];
-    }
-    code[length] = '\0';
-}
-
 //=============================================================================
 // HOOK NO MENU PRINCIPAL
 //=============================================================================
@@ -0,0 +1,551 @@
+/**
+ * RE4 CO-OP MOD - Resync por Árvore de Merkle
+ *
+ * Depois de um desync (ver coop_desync.h) ou de uma parada longa do
+ * GAME_STATE, mandar a sala inteira de novo custa o estado todo mesmo
+ * quando só meia dúzia de entidades está errada. Aqui o estado replicado
+ * vira uma árvore de Merkle e só as folhas diferentes viajam:
+ *
+ * - Folhas: blocos de campo de cada entidade (POSE = posição, STATUS =
+ *   vida, flags e estado), em slots fixos (players, depois inimigos pelo
+ *   índice do EmMgr). Slot vazio tem hash 0, e subárvore toda vazia
+ *   também, então sala pequena não paga pelos slots que não usa.
+ * - Nível 1: uma entidade (hash dos seus blocos); acima dele, nós de
+ *   MERKLE_FANOUT filhos até a raiz
+ * - O cliente congela a árvore dele e pede ao host os filhos da raiz;
+ *   a cada rodada pede os filhos só dos nós que não bateram, até chegar
+ *   nas folhas e pedir os blocos. Rodadas = altura da árvore + 1.
+ *
+ * O host congela a árvore dele no primeiro pedido da sessão, então as
+ * rodadas comparam sempre a mesma versão do estado; o que mudar durante
+ * o resync chega pelo GAME_STATE normal.
+ *
+ * Com quase tudo diferente, descer a árvore custa mais que a sala
+ * inteira (hashes das folhas + blocos de ~15 bytes contra um registro de
+ * sala por entidade). Quando a rodada das entidades volta com pelo menos
+ * MERKLE_FULL_ROOM_PERCENT delas diferentes, o cliente para e pede a sala
+ * inteira (MerkleRequestKind::ROOM). Os níveis de cima não servem para
+ * isso: com fanout 16, um nó erra com uma entidade em 16, e quase todos
+ * já erram com 20% de deriva.
+ *
+ *   MerkleResyncClient client;                  // Cliente
+ *   client.Begin(session, snapshot, GetTickCount());
+ *   n = client.NextRequest(kind, nodes, MERKLE_NODES_PER_PACKET);
+ *   MerkleResyncHost host;                      // Host
+ *   host.OnRequest(session, kind, nodes, n, snapshot);
+ *   n = host.NextHashes(entries, MERKLE_HASHES_PER_PACKET);
+ */
+
+#pragma once
+#include "coop_core.h"
+#include "coop_bulk.h"
+#include "coop_snapshot.h"
+#include "coop_desync.h"
+#include <cstring>
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+constexpr uint32_t MERKLE_SLOTS = BULK_MAX_RECORDS;         // Players e depois inimigos
+constexpr uint32_t MERKLE_BLOCKS = 2;                       // Blocos de campo por entidade
+constexpr uint32_t MERKLE_LEAVES = MERKLE_SLOTS * MERKLE_BLOCKS;
+constexpr uint32_t MERKLE_FANOUT = 16;                      // Filhos por nó acima das entidades
+constexpr uint32_t MERKLE_MAX_LEVELS = 8;
+
+// Por pacote (cada um cabe num buffer do PacketPool)
+constexpr uint32_t MERKLE_NODES_PER_PACKET = 200;
+constexpr uint32_t MERKLE_HASHES_PER_PACKET = 80;
+constexpr uint32_t MERKLE_BLOCKS_PER_PACKET = 30;
+
+constexpr uint32_t MERKLE_TIMEOUT_MS = 3000;                // Host mudo: desiste do resync
+constexpr uint32_t MERKLE_STALL_MS = 2000;                  // GAME_STATE parado: resync quando voltar
+
+// Entidades diferentes (em % das presentes em algum lado) a partir das
+// quais a sala inteira sai mais barata que as folhas e os blocos. As
+// rodadas até as entidades já foram pagas (~20% da sala), então o ponto
+// de troca fica depois dos ~60% em que a descida inteira passa da sala
+// (ver --merkle no harness).
+constexpr uint32_t MERKLE_FULL_ROOM_PERCENT = 75;
+
+constexpr uint32_t MERKLE_NO_SLOT = 0xFFFFFFFF;
+
+// Blocos de campo de uma entidade (folha = slot * MERKLE_BLOCKS + bloco)
+enum MerkleBlock : uint8_t {
+    MERKLE_BLOCK_POSE = 0,      // pos.x, pos.y, pos.z
+    MERKLE_BLOCK_STATUS = 1,    // hp | hpMax << 16, flags, estado do player
+};
+
+enum class MerkleRequestKind : uint8_t {
+    CHILDREN = 0,               // Hashes dos filhos destes nós
+    BLOCKS = 1,                 // Conteúdo destas folhas
+    ROOM = 2,                   // Sala inteira de novo pelo canal em massa (sem nós)
+};
+
+//=============================================================================
+// FORMATO NO FIO
+//=============================================================================
+
+#pragma pack(push, 1)
+struct MerkleNodeHash {
+    uint16_t node;              // MerkleNode(nível, índice)
+    uint32_t hash;
+};
+
+struct MerkleBlockData {
+    uint16_t leaf;
+    uint8_t present;            // 0 = entidade não existe no host (apaga as duas folhas)
+    uint32_t words[3];
+};
+#pragma pack(pop)
+
+// Nó no fio: nível nos 4 bits de cima, índice nos 12 de baixo
+constexpr uint32_t MERKLE_INDEX_BITS = 12;
+static_assert(MERKLE_LEAVES <= (1u << MERKLE_INDEX_BITS), "merkle: folhas não cabem no índice do nó");
+
+inline uint16_t MerkleNode(uint32_t level, uint32_t index) {
+    return (uint16_t)((level << MERKLE_INDEX_BITS) | index);
+}
+inline uint32_t MerkleNodeLevel(uint16_t node) { return node >> MERKLE_INDEX_BITS; }
+inline uint32_t MerkleNodeIndex(uint16_t node) { return node & ((1u << MERKLE_INDEX_BITS) - 1); }
+
+// Slot fixo de uma entidade: os dois lados chegam no mesmo sem combinar
+inline uint32_t MerkleSlot(uint32_t id) {
+    RoomRecordKind kind = (RoomRecordKind)(id >> 16);
+    uint32_t index = id & 0xFFFF;
+    if (kind == RoomRecordKind::PLAYER) return index < COOP_MAX_PLAYERS ? index : MERKLE_NO_SLOT;
+    if (kind == RoomRecordKind::ENEMY && COOP_MAX_PLAYERS + index < MERKLE_SLOTS) return COOP_MAX_PLAYERS + index;
+    return MERKLE_NO_SLOT;
+}
+
+inline uint32_t MerkleSlotId(uint32_t slot) {
+    return slot < COOP_MAX_PLAYERS ? SnapshotId(RoomRecordKind::PLAYER, (uint16_t)slot)
+                                   : SnapshotId(RoomRecordKind::ENEMY, (uint16_t)(slot - COOP_MAX_PLAYERS));
+}
+
+//=============================================================================
+// ÁRVORE
+//=============================================================================
+
+class MerkleTree {
+public:
+    MerkleTree() {
+        // Geometria fixa: nível 0 = folhas, 1 = entidades, depois MERKLE_FANOUT
+        uint32_t count = MERKLE_LEAVES;
+        uint32_t offset = 0;
+        m_levels = 0;
+        for (;;) {
+            m_count[m_levels] = count;
+            m_offset[m_levels] = offset;
+            offset += count;
+            m_levels++;
+            if (count == 1) break;
+            uint32_t fanout = Fanout(m_levels);
+            count = (count + fanout - 1) / fanout;
+        }
+        Clear();
+    }
+
+    void Clear() {
+        memset(m_words, 0, sizeof(m_words));
+        memset(m_present, 0, sizeof(m_present));
+        memset(m_hash, 0, sizeof(m_hash));
+        m_roomId = 0;
+    }
+
+    // Congela o estado do snapshot na árvore
+    void Build(const EntitySnapshot& s) {
+        memset(m_words, 0, sizeof(m_words));
+        memset(m_present, 0, sizeof(m_present));
+        m_roomId = s.roomId;
+
+        for (uint32_t i = 0; i < s.count; i++) {
+            uint32_t slot = MerkleSlot(s.id[i]);
+            if (slot == MERKLE_NO_SLOT) continue;
+
+            uint32_t* pose = m_words[slot * MERKLE_BLOCKS + MERKLE_BLOCK_POSE];
+            memcpy(&pose[0], &s.posX[i], 4);
+            memcpy(&pose[1], &s.posY[i], 4);
+            memcpy(&pose[2], &s.posZ[i], 4);
+
+            uint32_t* status = m_words[slot * MERKLE_BLOCKS + MERKLE_BLOCK_STATUS];
+            status[0] = (uint32_t)(uint16_t)s.hp[i] | ((uint32_t)(uint16_t)s.hpMax[i] << 16);
+            status[1] = s.flags[i];
+            status[2] = s.state[i];
+            m_present[slot] = 1;
+        }
+
+        for (uint32_t leaf = 0; leaf < MERKLE_LEAVES; leaf++) m_hash[leaf] = LeafHash(leaf);
+        for (uint32_t level = 1; level < m_levels; level++) {
+            for (uint32_t i = 0; i < m_count[level]; i++) m_hash[m_offset[level] + i] = NodeHash(level, i);
+        }
+    }
+
+    uint32_t Levels() const { return m_levels; }
+    uint32_t RootLevel() const { return m_levels - 1; }
+    uint32_t Count(uint32_t level) const { return m_count[level]; }
+    uint32_t Hash(uint32_t level, uint32_t index) const { return m_hash[m_offset[level] + index]; }
+    uint32_t Root() const { return Hash(RootLevel(), 0); }
+    uint16_t RoomId() const { return m_roomId; }
+
+    bool IsValidNode(uint16_t node) const {
+        uint32_t level = MerkleNodeLevel(node);
+        return level < m_levels && MerkleNodeIndex(node) < m_count[level];
+    }
+
+    // Filhos de (level >= 1, index) no nível de baixo: [ChildBegin, ChildEnd)
+    uint32_t ChildBegin(uint32_t level, uint32_t index) const { return index * Fanout(level); }
+    uint32_t ChildEnd(uint32_t level, uint32_t index) const {
+        uint32_t end = (index + 1) * Fanout(level);
+        return end < m_count[level - 1] ? end : m_count[level - 1];
+    }
+
+    void GetBlock(uint32_t leaf, MerkleBlockData& out) const {
+        out.leaf = (uint16_t)leaf;
+        out.present = m_present[leaf / MERKLE_BLOCKS];
+        memcpy(out.words, m_words[leaf], sizeof(out.words));
+    }
+
+    // Bloco do outro lado. Retorna o slot tocado (MERKLE_NO_SLOT se inválido).
+    uint32_t SetBlock(const MerkleBlockData& block) {
+        if (block.leaf >= MERKLE_LEAVES) return MERKLE_NO_SLOT;
+        uint32_t slot = block.leaf / MERKLE_BLOCKS;
+
+        if (block.present) {
+            memcpy(m_words[block.leaf], block.words, sizeof(block.words));
+            m_present[slot] = 1;
+        }
+        else {
+            memset(m_words[slot * MERKLE_BLOCKS], 0, MERKLE_BLOCKS * sizeof(m_words[0]));
+            m_present[slot] = 0;
+        }
+
+        for (uint32_t b = 0; b < MERKLE_BLOCKS; b++) RehashPath(slot * MERKLE_BLOCKS + b);
+        return slot;
+    }
+
+    bool Present(uint32_t slot) const { return m_present[slot] != 0; }
+
+    // Entidade do slot no formato do estado da sala
+    RoomEntityRecord Record(uint32_t slot) const {
+        RoomEntityRecord record;
+        memset(&record, 0, sizeof(record));
+        uint32_t id = MerkleSlotId(slot);
+        record.kind = (RoomRecordKind)(id >> 16);
+        record.index = (uint16_t)id;
+
+        const uint32_t* pose = m_words[slot * MERKLE_BLOCKS + MERKLE_BLOCK_POSE];
+        memcpy(&record.pos.x, &pose[0], 4);
+        memcpy(&record.pos.y, &pose[1], 4);
+        memcpy(&record.pos.z, &pose[2], 4);
+
+        const uint32_t* status = m_words[slot * MERKLE_BLOCKS + MERKLE_BLOCK_STATUS];
+        record.hp = (int16_t)(status[0] & 0xFFFF);
+        record.hpMax = (int16_t)(status[0] >> 16);
+        record.flags = status[1];
+        return record;
+    }
+
+private:
+    static uint32_t Fanout(uint32_t level) { return level == 1 ? MERKLE_BLOCKS : MERKLE_FANOUT; }
+
+    // Mesma canonização do hash de desync (posição na quantização do fio,
+    // só os bits de flags que são gameplay). Folha presente nunca é 0.
+    uint32_t LeafHash(uint32_t leaf) const {
+        using namespace DesyncHashDetail;
+        if (!m_present[leaf / MERKLE_BLOCKS]) return 0;
+
+        const uint32_t* w = m_words[leaf];
+        uint32_t words[3];
+        if (leaf % MERKLE_BLOCKS == MERKLE_BLOCK_POSE) {
+            float pos[3];
+            memcpy(pos, w, sizeof(pos));
+            for (uint32_t k = 0; k < 3; k++) words[k] = QuantizePos(pos[k]);
+        }
+        else {
+            words[0] = w[0];
+            words[1] = w[1] & DESYNC_FLAGS_MASK;
+            words[2] = w[2];
+        }
+
+        uint32_t h = SEED + PRIME5 + leaf;
+        for (uint32_t k = 0; k < 3; k++) h = Rotl(h + words[k] * PRIME3, 17) * PRIME4;
+        h = Avalanche(h);
+        return h ? h : 1;
+    }
+
+    // Filhos todos vazios = 0 (subárvore vazia igual dos dois lados de graça)
+    uint32_t NodeHash(uint32_t level, uint32_t index) const {
+        using namespace DesyncHashDetail;
+        uint32_t h = SEED + PRIME5 + level;
+        uint32_t any = 0;
+        for (uint32_t c = ChildBegin(level, index); c < ChildEnd(level, index); c++) {
+            uint32_t child = m_hash[m_offset[level - 1] + c];
+            any |= child;
+            h = Rotl(h + child * PRIME3, 17) * PRIME4;
+        }
+        if (!any) return 0;
+        h = Avalanche(h);
+        return h ? h : 1;
+    }
+
+    void RehashPath(uint32_t leaf) {
+        m_hash[leaf] = LeafHash(leaf);
+        uint32_t index = leaf;
+        for (uint32_t level = 1; level < m_levels; level++) {
+            index /= Fanout(level);
+            m_hash[m_offset[level] + index] = NodeHash(level, index);
+        }
+    }
+
+    uint32_t m_levels;
+    uint32_t m_count[MERKLE_MAX_LEVELS];
+    uint32_t m_offset[MERKLE_MAX_LEVELS];
+    uint32_t m_hash[MERKLE_LEAVES * 2];         // Todos os níveis em sequência
+
+    uint32_t m_words[MERKLE_LEAVES][3];
+    uint8_t m_present[MERKLE_SLOTS];
+    uint16_t m_roomId;
+};
+
+//=============================================================================
+// CLIENTE: DESCE A ÁRVORE (thread do jogo)
+//=============================================================================
+
+class MerkleResyncClient {
+public:
+    // Congela o estado local e começa pedindo os filhos da raiz.
+    // fullRoomPercent acima de 100 nunca pede a sala inteira.
+    void Begin(uint16_t session, const EntitySnapshot& local, uint32_t now,
+               uint32_t fullRoomPercent = MERKLE_FULL_ROOM_PERCENT) {
+        m_tree.Build(local);
+        m_session = session;
+        m_active = true;
+        m_fullRoomPercent = fullRoomPercent;
+        m_wantsRoom = false;
+        m_live = 0;
+        m_kind = MerkleRequestKind::CHILDREN;
+        m_pending[0] = MerkleNode(m_tree.RootLevel(), 0);
+        m_pendingCount = 1;
+        m_sent = 0;
+        m_expected = 0;
+        m_received = 0;
+        m_nextCount = 0;
+        m_rounds = 0;
+        m_blocks = 0;
+        m_lastActivity = now;
+    }
+
+    void Abort() { m_active = false; }
+
+    bool IsActive() const { return m_active; }
+    uint16_t Session() const { return m_session; }
+
+    // true uma vez quando o resync parou para pedir a sala inteira
+    bool TakeRoomRequest() {
+        bool wants = m_wantsRoom;
+        m_wantsRoom = false;
+        return wants;
+    }
+
+    // Próximo pedaço do pedido desta rodada (0 = tudo pedido, esperando)
+    uint32_t NextRequest(MerkleRequestKind& kind, uint16_t* nodes, uint32_t max) {
+        if (!m_active) return 0;
+        if (m_sent == 0 && m_pendingCount) m_rounds++;
+
+        uint32_t n = 0;
+        while (n < max && m_sent < m_pendingCount) {
+            uint16_t node = m_pending[m_sent++];
+            nodes[n++] = node;
+            m_expected += m_kind == MerkleRequestKind::BLOCKS ? 1 :
+                          m_tree.ChildEnd(MerkleNodeLevel(node), MerkleNodeIndex(node)) -
+                          m_tree.ChildBegin(MerkleNodeLevel(node), MerkleNodeIndex(node));
+        }
+        kind = m_kind;
+        return n;
+    }
+
+    // Hashes do host: o que não bate desce mais um nível na próxima rodada
+    void OnHashes(uint16_t session, const MerkleNodeHash* entries, uint32_t n, uint32_t now) {
+        if (!m_active || session != m_session || m_kind != MerkleRequestKind::CHILDREN) return;
+        m_lastActivity = now;
+
+        for (uint32_t k = 0; k < n; k++) {
+            uint16_t node = entries[k].node;
+            if (!m_tree.IsValidNode(node)) continue;
+            m_received++;
+
+            uint32_t level = MerkleNodeLevel(node);
+            uint32_t local = m_tree.Hash(level, MerkleNodeIndex(node));
+            if (local || entries[k].hash) m_live++;
+            if (local == entries[k].hash) continue;
+            if (m_nextCount < MERKLE_LEAVES) m_next[m_nextCount++] = node;
+        }
+        FinishRound();
+    }
+
+    // Blocos do host: aplica na árvore e devolve os slots tocados em slots
+    // (n no máximo). Retorna quantos.
+    uint32_t OnBlocks(uint16_t session, const MerkleBlockData* blocks, uint32_t n, uint32_t* slots, uint32_t now) {
+        if (!m_active || session != m_session || m_kind != MerkleRequestKind::BLOCKS) return 0;
+        m_lastActivity = now;
+
+        uint32_t touched = 0;
+        for (uint32_t k = 0; k < n; k++) {
+            uint32_t slot = m_tree.SetBlock(blocks[k]);
+            if (slot == MERKLE_NO_SLOT) continue;
+            m_received++;
+            m_blocks++;
+            if (!touched || slots[touched - 1] != slot) slots[touched++] = slot;
+        }
+        FinishRound();
+        return touched;
+    }
+
+    bool TimedOut(uint32_t now) const { return m_active && now - m_lastActivity > MERKLE_TIMEOUT_MS; }
+
+    const MerkleTree& Tree() const { return m_tree; }
+    uint32_t Rounds() const { return m_rounds; }
+    uint32_t BlocksApplied() const { return m_blocks; }
+
+private:
+    void FinishRound() {
+        if (m_sent < m_pendingCount || m_received < m_expected) return;
+
+        if (m_kind == MerkleRequestKind::BLOCKS || !m_nextCount) {
+            m_active = false;
+            return;
+        }
+
+        // Rodada das entidades: diferentes demais, a sala inteira sai mais barata
+        if (MerkleNodeLevel(m_next[0]) == 1 && m_nextCount * 100 >= m_live * m_fullRoomPercent) {
+            m_active = false;
+            m_wantsRoom = true;
+            return;
+        }
+
+        // Filhos que não bateram: nós internos pedem os filhos, folhas o conteúdo
+        m_kind = MerkleNodeLevel(m_next[0]) == 0 ? MerkleRequestKind::BLOCKS : MerkleRequestKind::CHILDREN;
+        memcpy(m_pending, m_next, m_nextCount * sizeof(m_next[0]));
+        m_pendingCount = m_nextCount;
+        m_nextCount = 0;
+        m_sent = 0;
+        m_expected = 0;
+        m_received = 0;
+        m_live = 0;
+    }
+
+    MerkleTree m_tree;
+    uint16_t m_session = 0;
+    bool m_active = false;
+
+    // Rodada atual
+    MerkleRequestKind m_kind = MerkleRequestKind::CHILDREN;
+    uint16_t m_pending[MERKLE_LEAVES];
+    uint32_t m_pendingCount = 0;
+    uint32_t m_sent = 0;
+    uint32_t m_expected = 0;
+    uint32_t m_received = 0;
+    uint32_t m_live = 0;                        // Nós recebidos com algo em algum lado
+
+    // Sala inteira no lugar do resto da descida
+    uint32_t m_fullRoomPercent = MERKLE_FULL_ROOM_PERCENT;
+    bool m_wantsRoom = false;
+
+    // Nós que não bateram (pedido da próxima rodada)
+    uint16_t m_next[MERKLE_LEAVES];
+    uint32_t m_nextCount = 0;
+
+    uint32_t m_rounds = 0;
+    uint32_t m_blocks = 0;
+    uint32_t m_lastActivity = 0;
+};
+
+//=============================================================================
+// HOST: RESPONDE OS PEDIDOS (thread do jogo)
+//=============================================================================
+
+class MerkleResyncHost {
+public:
+    void Reset() {
+        m_hasSession = false;
+        m_head = m_tail = 0;
+        m_childCursor = 0;
+    }
+
+    // Pedido do cliente. Sessão nova congela o snapshot atual.
+    void OnRequest(uint16_t session, MerkleRequestKind kind, const uint16_t* nodes, uint32_t n,
+                   const EntitySnapshot& current) {
+        if (kind != MerkleRequestKind::CHILDREN && kind != MerkleRequestKind::BLOCKS) return;
+        if (!m_hasSession || session != m_session) {
+            m_tree.Build(current);
+            m_session = session;
+            m_hasSession = true;
+            m_head = m_tail = 0;
+            m_childCursor = 0;
+        }
+        if (m_head == m_tail) m_head = m_tail = 0;
+
+        for (uint32_t k = 0; k < n && m_tail < MERKLE_LEAVES; k++) {
+            uint16_t node = nodes[k];
+            if (!m_tree.IsValidNode(node)) continue;
+            if (kind == MerkleRequestKind::CHILDREN ? MerkleNodeLevel(node) == 0 : MerkleNodeLevel(node) != 0) continue;
+            m_nodes[m_tail] = node;
+            m_kinds[m_tail] = kind;
+            m_tail++;
+        }
+    }
+
+    bool HasPending() const { return m_head < m_tail; }
+    MerkleRequestKind PendingKind() const { return m_kinds[m_head]; }
+    uint16_t Session() const { return m_session; }
+
+    // Próximo pacote de hashes (para no primeiro pedido de blocos)
+    uint32_t NextHashes(MerkleNodeHash* out, uint32_t max) {
+        uint32_t n = 0;
+        while (n < max && m_head < m_tail && m_kinds[m_head] == MerkleRequestKind::CHILDREN) {
+            uint16_t node = m_nodes[m_head];
+            uint32_t level = MerkleNodeLevel(node);
+            uint32_t index = MerkleNodeIndex(node);
+            uint32_t begin = m_tree.ChildBegin(level, index);
+            uint32_t end = m_tree.ChildEnd(level, index);
+
+            uint32_t child = begin + m_childCursor;
+            for (; child < end && n < max; child++) {
+                out[n].node = MerkleNode(level - 1, child);
+                out[n].hash = m_tree.Hash(level - 1, child);
+                n++;
+            }
+            if (child < end) {
+                m_childCursor = child - begin;
+                break;
+            }
+            m_childCursor = 0;
+            m_head++;
+        }
+        return n;
+    }
+
+    // Próximo pacote de blocos (para no primeiro pedido de hashes)
+    uint32_t NextBlocks(MerkleBlockData* out, uint32_t max) {
+        uint32_t n = 0;
+        while (n < max && m_head < m_tail && m_kinds[m_head] == MerkleRequestKind::BLOCKS) {
+            m_tree.GetBlock(MerkleNodeIndex(m_nodes[m_head++]), out[n++]);
+        }
+        return n;
+    }
+
+    const MerkleTree& Tree() const { return m_tree; }
+
+private:
+    MerkleTree m_tree;
+    uint16_t m_session = 0;
+    bool m_hasSession = false;
+
+    // Pedidos em espera (uma rodada por vez, no máximo uma folha por entrada)
+    uint16_t m_nodes[MERKLE_LEAVES];
+    MerkleRequestKind m_kinds[MERKLE_LEAVES];
+    uint32_t m_head = 0;
+    uint32_t m_tail = 0;
+    uint32_t m_childCursor = 0;
+};
@@ -5,16 +5,35 @@
  * - Servidor (Host)
  * - Cliente (Join)
  * - Protocolo de sincronização
+ * - Handshake CPace (autenticado pelo código da sala) e registros AEAD (ver coop_crypto.h)
+ * - Sincronia de relógio pelo PING/PONG (ver ClockSync em coop_tick.h)
+ * - Detecção de desync por hash de estado (ver coop_desync.h)
+ * - Resync só do que diverge por árvore de Merkle (ver coop_merkle.h)
+ * - Anúncio da sala na LAN enquanto espera o cliente (ver coop_discovery.h)
  */
 
 #pragma once
 #include "coop_core.h"
+#include "coop_game_memory.h"
+#include "coop_telemetry.h"
+#include "coop_packet_pool.h"
+#include "coop_bulk.h"
+#include "coop_snapshot.h"
+#include "coop_crypto.h"
+#include "coop_schema.h"
+#include "coop_profiler.h"
+#include "coop_seqlock.h"
+#include "coop_anim.h"
+#include "coop_tick.h"
+#include "coop_desync.h"
+#include "coop_merkle.h"
+#include "coop_discovery.h"
 #include <WinSock2.h>
 #include <WS2tcpip.h>
+#include <cstddef>
 #include <thread>
 #include <atomic>
-#include <mutex>
-#include <queue>
+#include <utility>
 
 #pragma comment(lib, "ws2_32.lib")
 
@@ -33,11 +52,25 @@ enum class PacketType : uint8_t {
     DISCONNECT = 0x04,
     PING = 0x05,
     PONG = 0x06,
+    CONNECT_CONFIRM = 0x07, // Client -> Host (tag de confirmação do CPace)
     
     // Gameplay
     GAME_STATE = 0x10,      // Host -> Client (estado do jogo)
     PLAYER_INPUT = 0x11,    // Client -> Host (input do P2)
     EVENT = 0x12,           // Eventos especiais
+    
+    // Estado da sala (baixa prioridade)
+    ROOM_STATE_CHUNK = 0x13, // Host -> Client (chunk do estado da sala nova)
+    ROOM_STATE_NACK = 0x14,  // Client -> Host (pede um chunk de novo)
+    
+    // Desync (ver coop_desync.h)
+    DESYNC_REQUEST = 0x15,   // Client -> Host (pede os hashes por entidade de um check)
+    DESYNC_DETAIL = 0x16,    // Host -> Client (hashes por entidade, em pedaços)
+
+    // Resync (ver coop_merkle.h)
+    MERKLE_REQUEST = 0x17,   // Client -> Host (filhos ou blocos destes nós)
+    MERKLE_HASHES = 0x18,    // Host -> Client (hashes dos filhos pedidos)
+    MERKLE_BLOCKS = 0x19,    // Host -> Client (conteúdo das folhas pedidas)
 };
 
 // Header comum
@@ -47,31 +80,61 @@ struct PacketHeader {
     uint32_t timestamp;
 };
 
+// Handshake (únicos pacotes em claro; tudo depois dele é cifrado)
+//   CONNECT_REQUEST: share CPace do cliente + suítes que ele roda
+//   CONNECT_ACCEPT:  share CPace do host + suíte escolhida + tag do host
+//   CONNECT_CONFIRM: tag do cliente (ConfirmPacket)
+struct HandshakePacket {
+    PacketHeader header;
+    uint8_t publicKey[X25519_KEY_SIZE];
+    uint8_t suites;
+    uint8_t confirm[CPACE_CONFIRM_SIZE];    // Zerado no CONNECT_REQUEST
+};
+
+struct ConfirmPacket {
+    PacketHeader header;
+    uint8_t confirm[CPACE_CONFIRM_SIZE];
+};
+
+// PING (Client -> Host) e PONG (Host -> Client). Os relógios em us dão o
+// RTT da telemetria e alimentam o ClockSync do cliente. O host não manda
+// PING: fica sabendo do RTT pelo que o cliente mediu no PONG anterior.
+// Como no NTP, o host manda a chegada do PING e a saída do PONG: o tempo
+// que o PONG espera na fila de controle não entra no RTT nem no offset.
+struct ClockPacket {
+    PacketHeader header;
+    uint32_t clientMicros;      // CoopClockMicros32() do cliente ao mandar o PING
+    uint32_t hostReceiveMicros; // CoopClockMicros32() do host ao receber o PING (0 no PING)
+    uint32_t hostMicros;        // CoopClockMicros32() do host ao selar o PONG (0 no PING)
+    uint32_t rttMicros;         // Último RTT do cliente (só no PING; 0 antes do primeiro PONG)
+};
+
+// Estado de um slot de player dentro do GAME_STATE
+struct PlayerSlotState {
+    Vec pos;
+    float rotation;
+    int16_t hp;
+    uint8_t state;
+    AnimKey anim;               // Só muda nas descontinuidades (ver coop_anim.h)
+    uint8_t weapon;
+};
+
 // Pacote de estado do jogo (Host -> Client)
 struct GameStatePacket {
     PacketHeader header;
     
-    // Estado do Leon (P1)
-    Vec leonPos;
-    float leonRotation;
-    int16_t leonHP;
-    uint8_t leonState;
-    uint8_t leonAnimation;
-    uint8_t leonWeapon;
-    
-    // Estado da Ashley (P2)
-    Vec ashleyPos;
-    float ashleyRotation;
-    int16_t ashleyHP;
-    uint8_t ashleyState;
-    uint8_t ashleyAnimation;
+    // Slots de player (0 = Leon, 1 = Ashley, 2+ = extras; ver g_PlayerSlots)
+    uint8_t playerMask;              // Bit i = players[i] presente
+    PlayerSlotState players[COOP_MAX_PLAYERS];
     
     // Estado do mundo
-    uint8_t roomId;
+    uint16_t roomId;
     uint8_t enemyCount;
     // ... mais dados conforme necessário
     
-    uint32_t checksum;
+    // Último check de desync do host (tick 0 = nenhum ainda)
+    uint32_t checkTick;
+    uint64_t checkHash;
 };
 
 // Pacote de input do Player 2 (Client -> Host)
@@ -91,7 +154,9 @@ struct PlayerInputPacket {
     float leftTrigger;
     float rightTrigger;
     
-    uint32_t checksum;
+    // Hash do cliente para o último check do host que ele aplicou
+    uint32_t checkTick;
+    uint64_t checkHash;
 };
 
 // Pacote de evento
@@ -104,8 +169,106 @@ struct EventPacket {
     uint32_t checksum;
 };
 
+// Chunk do estado da sala (Host -> Client). Só os primeiros
+// chunk.recordCount registros são enviados.
+struct RoomChunkPacket {
+    PacketHeader header;
+    BulkChunkHeader chunk;
+    RoomEntityRecord records[BULK_RECORDS_PER_CHUNK];
+};
+
+// Pedido de reenvio de um chunk (Client -> Host)
+struct RoomNackPacket {
+    PacketHeader header;
+    uint16_t transferId;
+    uint16_t chunkIndex;
+};
+
+// Pedido dos hashes por entidade de um check que não bateu (Client -> Host)
+struct DesyncRequestPacket {
+    PacketHeader header;
+    uint32_t tick;
+};
+
+// Hashes por entidade de um check (Host -> Client). Só os primeiros
+// count pares são enviados.
+struct DesyncDetailPacket {
+    PacketHeader header;
+    uint32_t tick;
+    uint16_t total;             // Entidades no check
+    uint16_t first;             // Índice do primeiro par deste pacote
+    uint8_t count;
+    DesyncEntityHash entities[DESYNC_DETAIL_PER_PACKET];
+};
+
+// Pedido de uma rodada do resync (Client -> Host). Só os primeiros count
+// nós são enviados; todos do mesmo tipo de pedido.
+struct MerkleRequestPacket {
+    PacketHeader header;
+    uint16_t session;
+    MerkleRequestKind kind;
+    uint8_t count;
+    uint16_t nodes[MERKLE_NODES_PER_PACKET];
+};
+
+// Hashes dos filhos pedidos (Host -> Client)
+struct MerkleHashesPacket {
+    PacketHeader header;
+    uint16_t session;
+    uint8_t count;
+    MerkleNodeHash entries[MERKLE_HASHES_PER_PACKET];
+};
+
+// Conteúdo das folhas pedidas (Host -> Client)
+struct MerkleBlocksPacket {
+    PacketHeader header;
+    uint16_t session;
+    uint8_t count;
+    MerkleBlockData blocks[MERKLE_BLOCKS_PER_PACKET];
+};
+
 #pragma pack(pop)
 
+// Depois do handshake todo pacote vai selado: o corpo do registro (pacote
+// + tag) tem que caber num buffer do pool, ou o RecordReader do outro lado
+// recusa e derruba a conexão. Os de tamanho variável contam cheios.
+constexpr uint32_t NET_MAX_SEALED_PACKET = PACKET_BUFFER_SIZE - AEAD_TAG_SIZE;
+
+static_assert(sizeof(PacketHeader) <= NET_MAX_SEALED_PACKET, "DISCONNECT não cabe selado");
+static_assert(sizeof(ClockPacket) <= NET_MAX_SEALED_PACKET, "PING/PONG não cabe selado");
+static_assert(sizeof(EventPacket) <= NET_MAX_SEALED_PACKET, "EVENT não cabe selado");
+static_assert(sizeof(RoomChunkPacket) <= NET_MAX_SEALED_PACKET, "ROOM_STATE_CHUNK não cabe selado");
+static_assert(sizeof(RoomNackPacket) <= NET_MAX_SEALED_PACKET, "ROOM_STATE_NACK não cabe selado");
+static_assert(sizeof(DesyncRequestPacket) <= NET_MAX_SEALED_PACKET, "DESYNC_REQUEST não cabe selado");
+static_assert(sizeof(DesyncDetailPacket) <= NET_MAX_SEALED_PACKET, "DESYNC_DETAIL não cabe selado");
+static_assert(sizeof(MerkleRequestPacket) <= NET_MAX_SEALED_PACKET, "MERKLE_REQUEST não cabe selado");
+static_assert(sizeof(MerkleHashesPacket) <= NET_MAX_SEALED_PACKET, "MERKLE_HASHES não cabe selado");
+static_assert(sizeof(MerkleBlocksPacket) <= NET_MAX_SEALED_PACKET, "MERKLE_BLOCKS não cabe selado");
+
+// Nome legível do canal (usado pelo dump de telemetria)
+inline const char* PacketTypeName(uint8_t type) {
+    switch ((PacketType)type) {
+        case PacketType::CONNECT_REQUEST: return "CONNECT_REQ";
+        case PacketType::CONNECT_ACCEPT: return "CONNECT_ACCEPT";
+        case PacketType::CONNECT_REJECT: return "CONNECT_REJECT";
+        case PacketType::DISCONNECT: return "DISCONNECT";
+        case PacketType::PING: return "PING";
+        case PacketType::PONG: return "PONG";
+        case PacketType::CONNECT_CONFIRM: return "CONNECT_CONFIRM";
+        case PacketType::GAME_STATE: return "GAME_STATE";
+        case PacketType::PLAYER_INPUT: return "PLAYER_INPUT";
+        case PacketType::EVENT: return "EVENT";
+        case PacketType::ROOM_STATE_CHUNK: return "ROOM_CHUNK";
+        case PacketType::ROOM_STATE_NACK: return "ROOM_NACK";
+        case PacketType::DESYNC_REQUEST: return "DESYNC_REQ";
+        case PacketType::DESYNC_DETAIL: return "DESYNC_DETAIL";
+        case PacketType::MERKLE_REQUEST: return "MERKLE_REQ";
+        case PacketType::MERKLE_HASHES: return "MERKLE_HASHES";
+        case PacketType::MERKLE_BLOCKS: return "MERKLE_BLOCKS";
+    }
+    return nullptr;
+}
+
 // Bits dos botões
 enum ButtonMask : uint16_t {
     BTN_ACTION = 0x0001,    // A
@@ -122,6 +285,224 @@ enum ButtonMask : uint16_t {
     BTN_DPAD_RIGHT = 0x0800,
 };
 
+//=============================================================================
+// SCHEMAS (formato no fio dos pacotes de gameplay)
+//=============================================================================
+
+// Faixas de quantização
+using WorldPos = QuantVec<-131072, 131072, 24>;    // 1/64 de unidade
+using Heading = QuantFloat<-4, 4, 16>;             // Radianos
+using StickAxis = QuantFloat<-1, 1, 16>;
+using TriggerAxis = QuantFloat<0, 1, 8>;
+
+static_assert(std::is_same<WorldPos::Axis, DesyncPosAxis>::value,
+              "desync: hash quantiza a posição igual ao GAME_STATE");
+
+// Campos de um slot; no delta cada slot só custa os bits da máscara
+// enquanto ninguém nele se mexe
+#define COOP_PLAYER_SLOT_FIELDS(i) \
+    SlotField<&GameStatePacket::players, i, &PlayerSlotState::pos, WorldPos>, \
+    SlotField<&GameStatePacket::players, i, &PlayerSlotState::rotation, Heading>, \
+    SlotField<&GameStatePacket::players, i, &PlayerSlotState::hp, RawInt<int16_t>>, \
+    SlotField<&GameStatePacket::players, i, &PlayerSlotState::state, RawInt<uint8_t>>, \
+    SlotField<&GameStatePacket::players, i, &PlayerSlotState::anim, AnimKeyCodec>, \
+    SlotField<&GameStatePacket::players, i, &PlayerSlotState::weapon, RawInt<uint8_t>>
+
+static_assert(COOP_MAX_PLAYERS == 4, "GameStateSchema: um COOP_PLAYER_SLOT_FIELDS por slot");
+
+using GameStateSchema = PacketSchema<GameStatePacket,
+    Field<&GameStatePacket::playerMask, UIntBits<uint8_t, COOP_MAX_PLAYERS>>,
+    COOP_PLAYER_SLOT_FIELDS(0),
+    COOP_PLAYER_SLOT_FIELDS(1),
+    COOP_PLAYER_SLOT_FIELDS(2),
+    COOP_PLAYER_SLOT_FIELDS(3),
+    Field<&GameStatePacket::roomId, RawInt<uint16_t>>,
+    Field<&GameStatePacket::enemyCount, RawInt<uint8_t>>,
+    Field<&GameStatePacket::checkTick, RawInt<uint32_t>>,
+    Field<&GameStatePacket::checkHash, DesyncHashCodec>>;
+
+#undef COOP_PLAYER_SLOT_FIELDS
+
+using InputSchema = PacketSchema<PlayerInputPacket,
+    Field<&PlayerInputPacket::moveX, StickAxis>,
+    Field<&PlayerInputPacket::moveY, StickAxis>,
+    Field<&PlayerInputPacket::lookX, StickAxis>,
+    Field<&PlayerInputPacket::lookY, StickAxis>,
+    Field<&PlayerInputPacket::buttons, UIntBits<uint16_t, 12>, REPL_ALWAYS>,
+    Field<&PlayerInputPacket::leftTrigger, TriggerAxis>,
+    Field<&PlayerInputPacket::rightTrigger, TriggerAxis>,
+    Field<&PlayerInputPacket::checkTick, RawInt<uint32_t>>,
+    Field<&PlayerInputPacket::checkHash, DesyncHashCodec>>;
+
+using InputButtonMap = ButtonMap<
+    ButtonBit<&CoopInput::action, BTN_ACTION>,
+    ButtonBit<&CoopInput::run, BTN_RUN>,
+    ButtonBit<&CoopInput::reload, BTN_RELOAD>,
+    ButtonBit<&CoopInput::knife, BTN_KNIFE>,
+    ButtonBit<&CoopInput::aim, BTN_AIM>,
+    ButtonBit<&CoopInput::shoot, BTN_SHOOT>,
+    ButtonBit<&CoopInput::inventory, BTN_INVENTORY>,
+    ButtonBit<&CoopInput::map, BTN_MAP>>;
+
+// GAME_STATE completo a cada N pacotes (o resto é delta do anterior)
+constexpr uint32_t STATE_KEYFRAME_INTERVAL = 60;
+
+// Pacote com schema no fio: [PacketHeader][SchemaEncoding][campos em bits]
+enum class SchemaEncoding : uint8_t {
+    FULL = 0,
+    DELTA = 1,      // Relativo ao último pacote do mesmo tipo
+};
+
+constexpr uint32_t SCHEMA_PAYLOAD_OFFSET = sizeof(PacketHeader) + 1;
+
+// Codifica direto no buffer do pool (baseline nulo = FULL)
+template<typename Schema>
+inline void EncodeSchemaPacket(PacketHandle& handle, const typename Schema::Struct& packet,
+                               const typename Schema::Struct* baseline) {
+    static_assert(SCHEMA_PAYLOAD_OFFSET + Schema::MAX_BYTES <= NET_MAX_SEALED_PACKET, "schema não cabe selado");
+    
+    uint8_t* data = handle.Data();
+    memcpy(data, &packet.header, sizeof(PacketHeader));
+    data[sizeof(PacketHeader)] = (uint8_t)(baseline ? SchemaEncoding::DELTA : SchemaEncoding::FULL);
+    
+    BitWriter writer(data + SCHEMA_PAYLOAD_OFFSET, PacketHandle::Capacity() - SCHEMA_PAYLOAD_OFFSET);
+    if (baseline) Schema::EncodeDelta(writer, *baseline, packet);
+    else Schema::Encode(writer, packet);
+    
+    handle.SetSize(SCHEMA_PAYLOAD_OFFSET + writer.Flush());
+}
+
+// false se truncado, delta sem baseline ou fora das faixas do schema
+template<typename Schema>
+inline bool DecodeSchemaPacket(const uint8_t* data, uint32_t size,
+                               const typename Schema::Struct* baseline, typename Schema::Struct& out) {
+    if (size < SCHEMA_PAYLOAD_OFFSET) return false;
+    
+    BitReader reader(data + SCHEMA_PAYLOAD_OFFSET, size - SCHEMA_PAYLOAD_OFFSET);
+    switch ((SchemaEncoding)data[sizeof(PacketHeader)]) {
+        case SchemaEncoding::FULL:
+            out = typename Schema::Struct();
+            Schema::Decode(reader, out);
+            break;
+            
+        case SchemaEncoding::DELTA:
+            if (!baseline) return false;
+            Schema::DecodeDelta(reader, *baseline, out);
+            break;
+            
+        default:
+            return false;
+    }
+    
+    memcpy(&out.header, data, sizeof(PacketHeader));
+    return !reader.Overflow() && Schema::Validate(out);
+}
+
+//=============================================================================
+// TRANSPORTE (registros [tamanho][corpo] sobre o TCP)
+//=============================================================================
+
+// Maior lote que a thread de envio sela e manda num único send()
+constexpr uint32_t NET_SEND_BATCH_SIZE = 8192;
+
+// Tempo máximo esperando o outro lado durante o handshake
+constexpr DWORD NET_HANDSHAKE_TIMEOUT_MS = 5000;
+
+// Espera do host depois de um handshake que não confirmou. Cada conexão
+// testa um palpite do código (~30 bits): a 1 por segundo, a média para
+// acertar passa de uma década.
+constexpr DWORD NET_HANDSHAKE_FAIL_DELAY_MS = 1000;
+
+inline bool SendAll(SOCKET s, const uint8_t* data, uint32_t size) {
+    while (size > 0) {
+        int sent = send(s, (const char*)data, (int)size, 0);
+        if (sent <= 0) return false;
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+enum class RecordStatus {
+    READY,
+    NEED_MORE,
+    INVALID,        // Registro maior que um buffer do pool
+};
+
+// Remonta registros do stream (um recv pode trazer vários ou meio registro)
+class RecordReader {
+public:
+    void Reset() { m_start = m_end = 0; }
+    
+    // record aponta para o prefixo de tamanho; o corpo vem logo depois
+    RecordStatus Next(uint8_t*& record, uint32_t& bodySize) {
+        uint32_t available = m_end - m_start;
+        if (available < SECURE_LENGTH_SIZE) return RecordStatus::NEED_MORE;
+        
+        uint8_t* p = m_buffer + m_start;
+        bodySize = (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+        if (bodySize > PACKET_BUFFER_SIZE) return RecordStatus::INVALID;
+        if (available < SECURE_LENGTH_SIZE + bodySize) return RecordStatus::NEED_MORE;
+        
+        record = p;
+        m_start += SECURE_LENGTH_SIZE + bodySize;
+        return RecordStatus::READY;
+    }
+    
+    // Lê o que tiver no socket. false se a conexão caiu.
+    bool Fill(SOCKET s) {
+        // Move o registro incompleto para o início (sempre cabe mais um inteiro)
+        if (m_start > 0) {
+            memmove(m_buffer, m_buffer + m_start, m_end - m_start);
+            m_end -= m_start;
+            m_start = 0;
+        }
+        
+        int received = recv(s, (char*)m_buffer + m_end, sizeof(m_buffer) - m_end, 0);
+        if (received <= 0) return false;
+        m_end += received;
+        return true;
+    }
+    
+private:
+    uint8_t m_buffer[4096];
+    uint32_t m_start = 0;
+    uint32_t m_end = 0;
+};
+
+// Registro em claro (só no handshake)
+inline bool SendPlainRecord(SOCKET s, const void* data, uint32_t size) {
+    uint8_t record[SECURE_LENGTH_SIZE + sizeof(HandshakePacket)];
+    if (size > sizeof(HandshakePacket)) return false;
+    
+    record[0] = (uint8_t)size;
+    record[1] = (uint8_t)(size >> 8);
+    memcpy(record + SECURE_LENGTH_SIZE, data, size);
+    return SendAll(s, record, size + SECURE_LENGTH_SIZE);
+}
+
+// Espera um registro em claro, com timeout (o outro lado pode nunca responder)
+inline bool RecvPlainRecord(SOCKET s, RecordReader& reader, void* out, uint32_t capacity, uint32_t& size) {
+    DWORD timeout = NET_HANDSHAKE_TIMEOUT_MS;
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+    
+    uint8_t* record = nullptr;
+    uint32_t bodySize = 0;
+    RecordStatus status;
+    while ((status = reader.Next(record, bodySize)) == RecordStatus::NEED_MORE) {
+        if (!reader.Fill(s)) break;
+    }
+    
+    // Depois do handshake o recv volta a bloquear sem limite
+    timeout = 0;
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+    
+    if (status != RecordStatus::READY || bodySize > capacity) return false;
+    memcpy(out, record + SECURE_LENGTH_SIZE, bodySize);
+    size = bodySize;
+    return true;
+}
+
 //=============================================================================
 // SERVIDOR (HOST)
 //=============================================================================
@@ -135,7 +516,7 @@ public:
     
     bool Start(uint16_t port = 27015);
     void Stop();
-    void Update();
+    void Update();      // Chamado a cada tick de rede
     
     bool IsRunning() const { return m_running; }
     bool IsClientConnected() const { return m_clientConnected; }
@@ -144,13 +525,19 @@ public:
     const char* GetRoomCode() const { return m_roomCode; }
     const char* GetLocalIP() const { return m_localIP; }
     uint16_t GetPort() const { return m_port; }
-    int GetPing() const { return m_ping; }
+    int GetPing() const { return (int)(m_telemetry.LastRttUs() / 1000); }
+    
+    // Telemetria (snapshot pode ser lido de qualquer thread sem bloquear)
+    const NetTelemetry& GetTelemetry() const { return m_telemetry; }
     
     // Envia estado do jogo para o cliente
     void SendGameState();
     
-    // Obtém último input recebido do cliente
-    const PlayerInputPacket& GetClientInput() const { return m_lastClientInput; }
+    // Cópia do último input recebido do cliente (sem lock, qualquer thread)
+    PlayerInputPacket GetClientInput() const { return m_clientInput.Load(); }
+    
+    // Checks de desync contra o hash que o cliente devolve (thread do jogo)
+    const DesyncMonitor& GetDesync() const { return m_desync; }
     
 private:
     CoopServer() = default;
@@ -160,9 +547,25 @@ private:
     void ReceiveThread();
     void SendThread();
     
+    bool Handshake(TelemetryBlock& telemetry);
+    void HandlePacket(PacketHandle& rx, uint32_t size, TelemetryBlock& telemetry);
+    
     void GenerateRoomCode();
     void GetLocalIPAddress();
-    uint32_t CalculateChecksum(const void* data, size_t size);
+    
+    // Estado da sala (thread do jogo)
+    void BeginRoomTransfer(uint16_t roomId);
+    void ProcessRoomNacks();
+    void PumpRoomTransfer();
+    
+    // Desync (thread do jogo)
+    void RecordDesyncCheck(const EntitySnapshot& snapshot);
+    void CompareClientCheck();
+    void PumpDesyncDetail();
+    
+    // Resync por Merkle (thread do jogo)
+    void ProcessMerkleRequests();
+    void PumpMerkleResync();
     
     // Sockets
     SOCKET m_listenSocket = INVALID_SOCKET;
@@ -182,18 +585,58 @@ private:
     char m_roomCode[8] = {0};
     char m_localIP[64] = {0};
     uint16_t m_port = 27015;
-    int m_ping = 0;
-    
-    // Input do cliente
-    PlayerInputPacket m_lastClientInput = {};
-    std::mutex m_inputMutex;
     
-    // Fila de envio
-    std::queue<GameStatePacket> m_sendQueue;
-    std::mutex m_sendMutex;
+    // Telemetria
+    NetTelemetry m_telemetry;
+    
+    // Input do cliente (a thread de recepção publica)
+    SeqLock<PlayerInputPacket> m_clientInput;
+    std::atomic<uint32_t> m_lastInputTick{0};   // CoopClockMicros32() da chegada
+    
+    // Fila de envio (handles do PacketPool, sem alocação)
+    PacketQueue<64> m_sendQueue;
+    
+    // Respostas da thread de recepção (PONG), seladas pela thread de envio
+    PacketQueue<8> m_controlQueue;
+    
+    // Sessão cifrada da conexão atual
+    SecureSession m_session;
+    RecordReader m_reader;
+    
+    // Estado da sala: fila de baixa prioridade e NACKs vindos do cliente
+    BulkTransferSender m_roomSender;
+    PacketQueue<16> m_roomQueue;
+    PacketQueue<16> m_nackInbox;
+    uint16_t m_lastRoomId = 0;
+    std::atomic<bool> m_roomSyncRequested{false};
+    
+    // Último GAME_STATE enfileirado (baseline do próximo delta)
+    GameStatePacket m_stateBaseline = {};
+    AnimKeyEncoder m_animEncoders[COOP_MAX_PLAYERS];
+    std::atomic<bool> m_stateKeyframeRequested{true};
+    
+    // Desync: check atual (vai em todo GAME_STATE) e o detalhe pedido pelo
+    // cliente, que a thread de recepção deixa em m_desyncRequest
+    DesyncMonitor m_desync{"host", "cliente"};
+    uint32_t m_checkCountdown = 0;
+    uint32_t m_checkTick = 0;
+    uint64_t m_checkHash = 0;
+    uint32_t m_clientCheckTick = 0;
+    std::atomic<uint32_t> m_desyncRequest{0};
+    uint32_t m_detailTick = 0;
+    uint32_t m_detailNext = 0;
+    
+    // Resync: pedidos do cliente (repassados pela thread de recepção) e a
+    // árvore congelada da sessão
+    MerkleResyncHost m_merkle;
+    PacketQueue<32> m_merkleInbox;
+    
+    // Beacons da sala na LAN (só a thread de accept, ou Start/Stop com ela parada)
+    DiscoveryAdvertiser m_discovery;
     
     // Sequência
     uint32_t m_sendSequence = 0;
+    uint32_t m_roomSequence = 0;
 };
 
 //=============================================================================
@@ -245,6 +688,18 @@ inline bool CoopServer::Start(uint16_t port) {
     GenerateRoomCode();
     GetLocalIPAddress();
     
+    // Sem UDP na rede ainda dá para entrar pelo IP
+    m_discovery.Start(m_port);
+    
+    m_telemetry.Reset();
+    m_lastInputTick = 0;
+    m_desync.Reset();
+    m_checkCountdown = 0;
+    m_checkTick = 0;
+    m_clientCheckTick = 0;
+    m_desyncRequest = 0;
+    m_detailTick = 0;
+    m_merkle.Reset();
     m_running = true;
     
     // Inicia threads
@@ -270,6 +725,15 @@ inline void CoopServer::Stop() {
     if (m_acceptThread.joinable()) m_acceptThread.join();
     if (m_receiveThread.joinable()) m_receiveThread.join();
     if (m_sendThread.joinable()) m_sendThread.join();
+    m_discovery.Stop();
+    
+    // Devolve ao pool o que não chegou a ser enviado
+    m_sendQueue.Clear();
+    m_controlQueue.Clear();
+    m_roomQueue.Clear();
+    m_nackInbox.Clear();
+    m_merkleInbox.Clear();
+    m_session.Reset();
     
     WSACleanup();
 }
@@ -277,21 +741,218 @@ inline void CoopServer::Stop() {
 inline void CoopServer::Update() {
     if (!m_running || !m_clientConnected) return;
     
-    // Envia estado do jogo periodicamente
-    // (chamado do game loop)
+    // Idade do input do cliente no momento em que o jogo o consome
+    uint32_t inputTick = m_lastInputTick.load(std::memory_order_relaxed);
+    if (inputTick) {
+        m_telemetry.GameThread().RecordSnapshotAge(CoopClockMicros32() - inputTick);
+    }
+    
+    // Troca de sala (ou cliente novo): começa a transferir o estado da sala
+    uint16_t roomId = CoopMod::CurrentRoomId();
+    if (roomId != m_lastRoomId || m_roomSyncRequested.exchange(false)) {
+        m_lastRoomId = roomId;
+        BeginRoomTransfer(roomId);
+        m_merkle.Reset();           // Árvore congelada é da sala (ou conexão) anterior
+    }
+    
+    // Envia estado do jogo
+    // (chamado a cada tick de rede pelo scheduler do CoopMod)
     SendGameState();
+    
+    // Hash que o cliente devolveu para um check nosso
+    CompareClientCheck();
+    
+    // Estado da sala usa só a banda que sobra (o resync e o detalhe de
+    // desync só a que sobra depois dela)
+    ProcessRoomNacks();
+    PumpRoomTransfer();
+    ProcessMerkleRequests();
+    PumpMerkleResync();
+    PumpDesyncDetail();
+}
+
+inline void CoopServer::BeginRoomTransfer(uint16_t roomId) {
+    static RoomEntityRecord records[BULK_MAX_RECORDS];
+    uint32_t count = CollectRoomState(CoopMod::GetSnapshot().Current(), records, BULK_MAX_RECORDS);
+    m_roomSender.Begin(roomId, records, count);
+}
+
+inline void CoopServer::ProcessRoomNacks() {
+    PacketHandle nack;
+    while (m_nackInbox.Pop(nack)) {
+        const RoomNackPacket* request = nack.As<RoomNackPacket>();
+        if (m_roomSender.Resend(request->transferId, request->chunkIndex)) {
+            m_telemetry.GameThread().RecordRetransmit((uint8_t)PacketType::ROOM_STATE_CHUNK);
+        }
+    }
+}
+
+inline void CoopServer::PumpRoomTransfer() {
+    // Tempo real acumulando na fila: cede a banda e tenta no próximo tick
+    if (!m_roomSender.HasPending() || m_sendQueue.Size() > 1) return;
+    
+    for (uint32_t i = 0; i < g_CoopConfig.bulkChunksPerTick && m_roomSender.HasPending(); i++) {
+        if (m_roomQueue.Size() >= 16) break;
+        
+        PacketHandle handle = PacketPool::Instance().Acquire();
+        if (!handle) break;
+        
+        RoomChunkPacket& packet = *handle.Emplace<RoomChunkPacket>();
+        packet.header.type = PacketType::ROOM_STATE_CHUNK;
+        packet.header.sequence = m_roomSequence++;
+        packet.header.timestamp = GetTickCount();
+        m_roomSender.NextChunk(packet.chunk, packet.records);
+        
+        // Só manda os registros usados
+        handle.SetSize((uint32_t)(offsetof(RoomChunkPacket, records) +
+                                  packet.chunk.recordCount * sizeof(RoomEntityRecord)));
+        m_roomQueue.Push(handle);
+    }
+}
+
+inline void CoopServer::RecordDesyncCheck(const EntitySnapshot& snapshot) {
+    // Cliente não compara (ver DESYNC_CHECKS): check fica zerado
+    if (!DESYNC_CHECKS) return;
+    
+    if (m_checkCountdown) {
+        m_checkCountdown--;
+        return;
+    }
+    m_checkCountdown = DESYNC_CHECK_INTERVAL - 1;
+    
+    // Tick do scheduler do host; 0 fica reservado para "sem check"
+    uint32_t tick = (uint32_t)CoopMod::GetSimTick();
+    if (!tick) tick = 1;
+    
+    COOP_PROFILE_ZONE("DesyncMonitor::Record");
+    m_checkHash = m_desync.Record(tick, snapshot);
+    m_checkTick = tick;
+}
+
+inline void CoopServer::CompareClientCheck() {
+    if (!DESYNC_CHECKS) return;
+    
+    PlayerInputPacket input = GetClientInput();
+    if (!input.checkTick || input.checkTick == m_clientCheckTick) return;
+    
+    m_clientCheckTick = input.checkTick;
+    m_desync.Compare(input.checkTick, input.checkHash);
+}
+
+inline void CoopServer::PumpDesyncDetail() {
+    uint32_t requested = m_desyncRequest.exchange(0, std::memory_order_relaxed);
+    if (requested) {
+        m_detailTick = requested;
+        m_detailNext = 0;
+    }
+    if (!m_detailTick) return;
+    
+    // Check que já saiu do histórico: o cliente fica sem detalhe
+    const DesyncCheck* check = m_desync.Find(m_detailTick);
+    if (!check) {
+        m_detailTick = 0;
+        return;
+    }
+    
+    // Fila cheia ou pool esgotado: continua no próximo tick. Check vazio
+    // ainda manda um pacote (total = 0 fecha o relatório do cliente).
+    do {
+        if (m_roomQueue.Size() >= 16) return;
+        PacketHandle handle = PacketPool::Instance().Acquire();
+        if (!handle) return;
+        
+        uint32_t count = check->count - m_detailNext;
+        if (count > DESYNC_DETAIL_PER_PACKET) count = DESYNC_DETAIL_PER_PACKET;
+        
+        DesyncDetailPacket& packet = *handle.Emplace<DesyncDetailPacket>();
+        packet.header.type = PacketType::DESYNC_DETAIL;
+        packet.header.sequence = m_roomSequence++;
+        packet.header.timestamp = GetTickCount();
+        packet.tick = m_detailTick;
+        packet.total = (uint16_t)check->count;
+        packet.first = (uint16_t)m_detailNext;
+        packet.count = (uint8_t)count;
+        for (uint32_t k = 0; k < count; k++) {
+            packet.entities[k].id = check->ids[m_detailNext + k];
+            packet.entities[k].hash = check->hashes[m_detailNext + k];
+        }
+        handle.SetSize((uint32_t)(offsetof(DesyncDetailPacket, entities) + count * sizeof(DesyncEntityHash)));
+        m_roomQueue.Push(handle);
+        
+        m_detailNext += count;
+    } while (m_detailNext < check->count);
+    
+    m_detailTick = 0;
+}
+
+inline void CoopServer::ProcessMerkleRequests() {
+    PacketHandle request;
+    while (m_merkleInbox.Pop(request)) {
+        const MerkleRequestPacket* packet = request.As<MerkleRequestPacket>();
+        if (packet->count > MERKLE_NODES_PER_PACKET ||
+            request.Size() < offsetof(MerkleRequestPacket, nodes) + packet->count * sizeof(uint16_t)) {
+            continue;
+        }
+        
+        // Cliente viu diferença demais: a sala inteira sai mais barata
+        if (packet->kind == MerkleRequestKind::ROOM) {
+            BeginRoomTransfer(m_lastRoomId);
+            m_merkle.Reset();
+            continue;
+        }
+        
+        // Primeiro pedido de uma sessão congela o estado atual
+        COOP_PROFILE_ZONE("MerkleResyncHost::OnRequest");
+        m_merkle.OnRequest(packet->session, packet->kind, packet->nodes, packet->count,
+                           CoopMod::GetSnapshot().Current());
+    }
+}
+
+inline void CoopServer::PumpMerkleResync() {
+    // Mesmo orçamento do estado da sala, que tem prioridade
+    if (!m_merkle.HasPending() || m_roomSender.HasPending() || m_sendQueue.Size() > 1) return;
+    
+    for (uint32_t i = 0; i < g_CoopConfig.bulkChunksPerTick && m_merkle.HasPending(); i++) {
+        if (m_roomQueue.Size() >= 16) break;
+        
+        PacketHandle handle = PacketPool::Instance().Acquire();
+        if (!handle) break;
+        
+        if (m_merkle.PendingKind() == MerkleRequestKind::CHILDREN) {
+            MerkleHashesPacket& packet = *handle.Emplace<MerkleHashesPacket>();
+            packet.header.type = PacketType::MERKLE_HASHES;
+            packet.header.sequence = m_roomSequence++;
+            packet.header.timestamp = GetTickCount();
+            packet.session = m_merkle.Session();
+            packet.count = (uint8_t)m_merkle.NextHashes(packet.entries, MERKLE_HASHES_PER_PACKET);
+            handle.SetSize((uint32_t)(offsetof(MerkleHashesPacket, entries) + packet.count * sizeof(MerkleNodeHash)));
+        }
+        else {
+            MerkleBlocksPacket& packet = *handle.Emplace<MerkleBlocksPacket>();
+            packet.header.type = PacketType::MERKLE_BLOCKS;
+            packet.header.sequence = m_roomSequence++;
+            packet.header.timestamp = GetTickCount();
+            packet.session = m_merkle.Session();
+            packet.count = (uint8_t)m_merkle.NextBlocks(packet.blocks, MERKLE_BLOCKS_PER_PACKET);
+            handle.SetSize((uint32_t)(offsetof(MerkleBlocksPacket, blocks) + packet.count * sizeof(MerkleBlockData)));
+        }
+        m_roomQueue.Push(handle);
+    }
 }
 
 inline void CoopServer::AcceptThread() {
     while (m_running) {
-        // Configura timeout para accept
+        // Beacon da sala na LAN quando der a hora
+        m_discovery.Update(GetTickCount());
+        
+        // Configura timeout para accept (curto o bastante para o ritmo dos beacons)
         fd_set readSet;
         FD_ZERO(&readSet);
         FD_SET(m_listenSocket, &readSet);
         
         timeval timeout;
-        timeout.tv_sec = 1;
-        timeout.tv_usec = 0;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = DISCOVERY_BURST_MS * 1000;
         
         int result = select(0, &readSet, nullptr, nullptr, &timeout);
         
@@ -300,7 +961,20 @@ inline void CoopServer::AcceptThread() {
             m_clientSocket = accept(m_listenSocket, (sockaddr*)&m_clientAddr, &addrLen);
             
             if (m_clientSocket != INVALID_SOCKET) {
+                // Troca de chaves; cliente que não completa é descartado
+                NetTelemetry::Writer telemetry = m_telemetry.Acquire();
+                if (!Handshake(*telemetry)) {
+                    closesocket(m_clientSocket);
+                    m_clientSocket = INVALID_SOCKET;
+                    m_session.Reset();
+                    Sleep(NET_HANDSHAKE_FAIL_DELAY_MS);
+                    continue;
+                }
+                
                 m_clientConnected = true;
+                m_roomSyncRequested = true;   // Cliente novo precisa da sala inteira
+                m_stateKeyframeRequested = true;
+                m_discovery.Stop();           // Sala lotada: some da lista da LAN
                 
                 // Inicia threads de comunicação
                 m_receiveThread = std::thread(&CoopServer::ReceiveThread, this);
@@ -312,104 +986,272 @@ inline void CoopServer::AcceptThread() {
     }
 }
 
+inline bool CoopServer::Handshake(TelemetryBlock& telemetry) {
+    m_reader.Reset();
+    
+    HandshakePacket request;
+    uint32_t size = 0;
+    if (!RecvPlainRecord(m_clientSocket, m_reader, &request, sizeof(request), size) ||
+        size != sizeof(request) || request.header.type != PacketType::CONNECT_REQUEST) {
+        return false;
+    }
+    telemetry.RecordReceive((uint8_t)PacketType::CONNECT_REQUEST, size, 0, false);
+    
+    CipherSuite suite = SecureSession::ChooseSuite(request.suites);
+    if (suite == CipherSuite::NONE) {
+        PacketHeader reject;
+        reject.type = PacketType::CONNECT_REJECT;
+        reject.sequence = 0;
+        reject.timestamp = GetTickCount();
+        SendPlainRecord(m_clientSocket, &reject, sizeof(reject));
+        return false;
+    }
+    
+    m_session.Begin(SecureRole::HOST, m_roomCode);
+    if (!m_session.Establish(request.publicKey, request.suites, suite)) return false;
+    
+    HandshakePacket accept = {};
+    accept.header.type = PacketType::CONNECT_ACCEPT;
+    accept.header.timestamp = GetTickCount();
+    memcpy(accept.publicKey, m_session.PublicKey(), X25519_KEY_SIZE);
+    accept.suites = (uint8_t)suite;
+    memcpy(accept.confirm, m_session.LocalConfirm(), CPACE_CONFIRM_SIZE);
+    if (!SendPlainRecord(m_clientSocket, &accept, sizeof(accept))) return false;
+    telemetry.RecordSend((uint8_t)PacketType::CONNECT_ACCEPT, sizeof(accept) + SECURE_LENGTH_SIZE);
+    
+    // Cliente com o código da sala errado tem outro K: a tag dele não bate
+    // e o AcceptThread segura a próxima tentativa
+    ConfirmPacket confirm;
+    if (!RecvPlainRecord(m_clientSocket, m_reader, &confirm, sizeof(confirm), size) ||
+        size != sizeof(confirm) || confirm.header.type != PacketType::CONNECT_CONFIRM) {
+        return false;
+    }
+    telemetry.RecordReceive((uint8_t)PacketType::CONNECT_CONFIRM, size, 0, false);
+    return m_session.VerifyConfirm(confirm.confirm);
+}
+
 inline void CoopServer::ReceiveThread() {
+    NetTelemetry::Writer telemetry = m_telemetry.Acquire();
+    
+    // Buffer de recepção do pool, reaproveitado durante toda a conexão
+    PacketHandle rx = PacketPool::Instance().Acquire();
+    if (!rx) {
+        m_clientConnected = false;
+        return;
+    }
+    
     while (m_running && m_clientConnected) {
-        char buffer[1024];
-        int received = recv(m_clientSocket, buffer, sizeof(buffer), 0);
-        
-        if (received > 0) {
-            PacketHeader* header = (PacketHeader*)buffer;
+        // Abre todos os registros completos que já chegaram
+        uint8_t* record;
+        uint32_t bodySize;
+        RecordStatus status;
+        while ((status = m_reader.Next(record, bodySize)) == RecordStatus::READY) {
+            memcpy(rx.Data(), record + SECURE_LENGTH_SIZE, bodySize);
             
-            switch (header->type) {
-                case PacketType::PLAYER_INPUT:
-                    if (received >= sizeof(PlayerInputPacket)) {
-                        std::lock_guard<std::mutex> lock(m_inputMutex);
-                        memcpy(&m_lastClientInput, buffer, sizeof(PlayerInputPacket));
-                    }
-                    break;
-                    
-                case PacketType::PING: {
-                    // Responde com PONG
-                    PacketHeader pong;
-                    pong.type = PacketType::PONG;
-                    pong.sequence = header->sequence;
-                    pong.timestamp = GetTickCount();
-                    send(m_clientSocket, (char*)&pong, sizeof(pong), 0);
-                    break;
-                }
-                
-                case PacketType::DISCONNECT:
-                    m_clientConnected = false;
-                    break;
+            uint32_t size;
+            if (!m_session.Open(record, rx.Data(), bodySize, size) || size < sizeof(PacketHeader)) {
+                status = RecordStatus::INVALID;
+                break;
             }
+            rx.SetSize(size);
+            HandlePacket(rx, size, *telemetry);
         }
-        else if (received == 0 || received == SOCKET_ERROR) {
-            // Conexão perdida
+        
+        // Registro forjado, repetido ou corrompido derruba a conexão
+        if (status == RecordStatus::INVALID || !m_reader.Fill(m_clientSocket)) {
             m_clientConnected = false;
             break;
         }
     }
 }
 
+inline void CoopServer::HandlePacket(PacketHandle& rx, uint32_t size, TelemetryBlock& telemetry) {
+    PacketHeader* header = rx.As<PacketHeader>();
+    telemetry.RecordReceive((uint8_t)header->type, size + SECURE_RECORD_OVERHEAD, header->sequence,
+                            header->type == PacketType::PLAYER_INPUT);
+    
+    switch (header->type) {
+        case PacketType::PLAYER_INPUT: {
+            PlayerInputPacket input;
+            if (DecodeSchemaPacket<InputSchema>(rx.Data(), size, nullptr, input)) {
+                m_clientInput.Store(input);
+                m_lastInputTick.store(CoopClockMicros32(), std::memory_order_relaxed);
+            }
+            break;
+        }
+            
+        case PacketType::ROOM_STATE_NACK:
+            // Repassa o buffer inteiro para a thread do jogo e pega outro
+            if (size >= sizeof(RoomNackPacket)) {
+                PacketHandle next = PacketPool::Instance().Acquire();
+                if (next && m_nackInbox.Push(rx)) rx = std::move(next);
+            }
+            break;
+            
+        case PacketType::DESYNC_REQUEST:
+            // Só o pedido mais recente vale; a thread do jogo monta o detalhe
+            if (size >= sizeof(DesyncRequestPacket)) {
+                m_desyncRequest.store(rx.As<DesyncRequestPacket>()->tick, std::memory_order_relaxed);
+            }
+            break;
+            
+        case PacketType::MERKLE_REQUEST:
+            if (size >= offsetof(MerkleRequestPacket, nodes)) {
+                PacketHandle next = PacketPool::Instance().Acquire();
+                if (next && m_merkleInbox.Push(rx)) rx = std::move(next);
+            }
+            break;
+            
+        case PacketType::PING: {
+            // Responde com PONG (ecoa os relógios do cliente para ele medir o RTT
+            // e o offset). Só a thread de envio sela, então o PONG passa pela
+            // fila de controle; hostMicros é lido lá, na hora de selar.
+            uint32_t receivedMicros = CoopClockMicros32();
+            if (size >= sizeof(ClockPacket) && rx.As<ClockPacket>()->rttMicros) {
+                telemetry.RecordRtt(rx.As<ClockPacket>()->rttMicros);
+            }
+            
+            PacketHandle handle = PacketPool::Instance().Acquire();
+            if (!handle) break;
+            
+            ClockPacket& pong = *handle.Emplace<ClockPacket>();
+            pong.header.type = PacketType::PONG;
+            pong.header.sequence = header->sequence;
+            pong.header.timestamp = header->timestamp;
+            if (size >= sizeof(ClockPacket)) {
+                pong.clientMicros = rx.As<ClockPacket>()->clientMicros;
+                pong.hostReceiveMicros = receivedMicros;
+            }
+            m_controlQueue.Push(handle);
+            break;
+        }
+        
+        case PacketType::DISCONNECT:
+            m_clientConnected = false;
+            break;
+            
+        default:
+            break;      // Tipos só do host -> cliente (ou do handshake): ignora
+    }
+}
+
 inline void CoopServer::SendThread() {
+    NetTelemetry::Writer telemetry = m_telemetry.Acquire();
+    
+    // Tudo que estiver nas filas é selado num lote contíguo e vai num send()
+    uint8_t batch[NET_SEND_BATCH_SIZE];
+    PacketHandle packet;
+    
     while (m_running && m_clientConnected) {
-        GameStatePacket packet;
-        bool hasPacket = false;
-        
-        {
-            std::lock_guard<std::mutex> lock(m_sendMutex);
-            if (!m_sendQueue.empty()) {
-                packet = m_sendQueue.front();
-                m_sendQueue.pop();
-                hasPacket = true;
+        uint32_t used = 0;
+        
+        // Controle e tempo real primeiro; estado da sala só com a fila vazia
+        while (used + PACKET_BUFFER_SIZE + SECURE_RECORD_OVERHEAD <= sizeof(batch) &&
+               (m_controlQueue.Pop(packet) || m_sendQueue.Pop(packet) || m_roomQueue.Pop(packet))) {
+            if (packet.As<PacketHeader>()->type == PacketType::PONG) {
+                packet.As<ClockPacket>()->hostMicros = CoopClockMicros32();
             }
+            uint32_t sealed = m_session.Seal(packet.Data(), packet.Size(), batch + used);
+            telemetry->RecordSend((uint8_t)packet.As<PacketHeader>()->type, sealed);
+            used += sealed;
+            packet.Reset();
         }
         
-        if (hasPacket) {
-            send(m_clientSocket, (char*)&packet, sizeof(packet), 0);
-        }
-        else {
+        if (used == 0) {
             Sleep(1); // Evita busy loop
         }
+        else if (!SendAll(m_clientSocket, batch, used)) {
+            m_clientConnected = false;
+        }
     }
 }
 
 inline void CoopServer::SendGameState() {
+    COOP_PROFILE_ZONE("CoopServer::SendGameState");
+    
     GameStatePacket packet = {};
-    packet.header.type = PacketType::GAME_STATE;
-    packet.header.sequence = m_sendSequence++;
-    packet.header.timestamp = GetTickCount();
     
-    // Preenche com estado atual do jogo
-    cPlayer* leon = PlayerPtr();
-    cPlayer* ashley = AshleyPtr();
+    // Preenche com o snapshot deste tick
+    const SnapshotExtractor& extractor = CoopMod::GetSnapshot();
+    const EntitySnapshot& snapshot = extractor.Current();
     
-    if (leon) {
-        packet.leonPos = GET_POS(leon);
-        // packet.leonRotation = ...
-        packet.leonHP = GET_HP(leon);
+    // Um bloco por slot presente; slots vazios ficam zerados
+    bool playersDirty = false;
+    uint32_t hostMicros = CoopClockMicros32();
+    for (uint16_t slot = 0; slot < COOP_MAX_PLAYERS; slot++) {
+        int32_t i = snapshot.PlayerSlot(slot);
+        if (i < 0) continue;
+        
+        PlayerSlotState& player = packet.players[slot];
+        player.pos = snapshot.Pos(i);
+        // player.rotation = ...
+        player.hp = snapshot.hp[i];
         // ... mais dados
+        
+        // Chave nova só quando a previsão do cliente deixaria de servir
+        // TODO: Ler id/fase/velocidade/blend do cMot quando o offset for mapeado
+        if (ANIM_REPLICATION) {
+            AnimSample anim = {};
+            m_animEncoders[slot].Update(anim, hostMicros, player.anim);
+        }
+        
+        packet.playerMask |= (uint8_t)(1u << slot);
+        playersDirty |= extractor.PlayerDirty(slot) != 0;
     }
     
-    if (ashley) {
-        packet.ashleyPos = GET_POS(ashley);
-        packet.ashleyHP = GET_HP(ashley);
-        // ...
+    packet.roomId = snapshot.roomId;
+    
+    // Check de desync: vai em todo pacote, mas no delta só custa bits
+    // quando troca
+    RecordDesyncCheck(snapshot);
+    packet.checkTick = m_checkTick;
+    packet.checkHash = m_checkHash;
+    
+    // Players parados e nada diferente do último pacote: não manda
+    // (keyframe pendente sempre vai)
+    bool keyframeDue = m_stateKeyframeRequested.load() ||
+                       m_sendSequence % STATE_KEYFRAME_INTERVAL == 0;
+    if (!keyframeDue && !playersDirty &&
+        GameStateSchema::ChangedMask(m_stateBaseline, packet) == 0) {
+        return;
     }
     
-    packet.checksum = CalculateChecksum(&packet, sizeof(packet) - 4);
+    // Memória do jogo fora das faixas (ex.: no meio de uma troca de sala): pula
+    if (!GameStateSchema::Validate(packet)) return;
     
-    // Adiciona à fila de envio
-    std::lock_guard<std::mutex> lock(m_sendMutex);
-    m_sendQueue.push(packet);
+    // Codifica direto no buffer que vai para o socket
+    PacketHandle handle = PacketPool::Instance().Acquire();
+    if (!handle) return; // Pool esgotado: pula este frame
+    
+    packet.header.type = PacketType::GAME_STATE;
+    packet.header.sequence = m_sendSequence++;
+    packet.header.timestamp = GetTickCount();
+    
+    // Delta do último pacote enfileirado; o TCP entrega todos em ordem
+    bool keyframe = m_stateKeyframeRequested.exchange(false) ||
+                    packet.header.sequence % STATE_KEYFRAME_INTERVAL == 0;
+    EncodeSchemaPacket<GameStateSchema>(handle, packet, keyframe ? nullptr : &m_stateBaseline);
+    
+    // Adiciona à fila de envio (cheia = descarta, o handle volta ao pool)
+    if (m_sendQueue.Push(handle)) {
+        m_stateBaseline = packet;
+    }
+    else if (keyframe) {
+        m_stateKeyframeRequested = true;
+    }
+    m_telemetry.GameThread().RecordQueueDepth(m_sendQueue.Size());
 }
 
 inline void CoopServer::GenerateRoomCode() {
+    // 32 caracteres: cada byte aleatório escolhe um sem viés. srand(time)
+    // dava o mesmo código a dois hosts abertos no mesmo segundo.
     const char chars[] = "ABCDEFGHJKLMNPQRSTUVWXYZ23456789";
-    srand((unsigned)time(nullptr));
+    static_assert(sizeof(chars) - 1 == 32, "código da sala: alfabeto de 32");
     
+    uint8_t random[6];
+    CryptoRandom(random, sizeof(random));
     for (int i = 0; i < 6; i++) {
-        m_roomCode[i] = chars[rand() % (sizeof(chars) - 1)];
+        m_roomCode[i] = chars[random[i] % 32];
     }
     m_roomCode[6] = '\0';
 }
@@ -434,16 +1276,6 @@ inline void CoopServer::GetLocalIPAddress() {
     }
 }
 
-inline uint32_t CoopServer::CalculateChecksum(const void* data, size_t size) {
-    uint32_t checksum = 0;
-    const uint8_t* bytes = (const uint8_t*)data;
-    for (size_t i = 0; i < size; i++) {
-        checksum += bytes[i];
-        checksum = (checksum << 1) | (checksum >> 31);
-    }
-    return checksum;
-}
-
 //=============================================================================
 // CLIENTE (JOIN)
 //=============================================================================
@@ -455,18 +1287,35 @@ public:
         return instance;
     }
     
-    bool Connect(const char* ip, uint16_t port = 27015);
+    bool Connect(const char* ip, uint16_t port = 27015, const char* roomCode = nullptr);
     void Disconnect();
-    void Update();
+    void Update();      // Chamado a cada tick de rede
     
     bool IsConnected() const { return m_connected; }
-    int GetPing() const { return m_ping; }
+    int GetPing() const { return (int)(m_telemetry.LastRttUs() / 1000); }
+    
+    // Telemetria (snapshot pode ser lido de qualquer thread sem bloquear)
+    const NetTelemetry& GetTelemetry() const { return m_telemetry; }
     
     // Envia input do jogador local
     void SendInput(const CoopInput& input);
     
-    // Obtém último estado do jogo recebido
-    const GameStatePacket& GetGameState() const { return m_lastGameState; }
+    // Cópia do último estado do jogo recebido (sem lock, qualquer thread)
+    GameStatePacket GetGameState() const { return m_gameState.Load(); }
+    
+    // Relógio do host estimado pelos PONGs
+    const ClockSync& GetClock() const { return m_clock; }
+    
+    // Estado da sala: pronto quando todos os chunks da sala atual chegaram
+    bool IsRoomReady() const { return m_roomReceiver.IsReady(); }
+    const BulkTransferReceiver& GetRoomTransfer() const { return m_roomReceiver; }
+    const RoomEntityRecord* GetRoomState(uint32_t& count) const {
+        count = m_roomRecordCount;
+        return m_roomState;
+    }
+    
+    // Checks de desync contra o host (thread do jogo)
+    const DesyncMonitor& GetDesync() const { return m_desync; }
     
 private:
     CoopClient() = default;
@@ -475,27 +1324,79 @@ private:
     void ReceiveThread();
     void SendThread();
     
+    bool Handshake(const char* roomCode);
+    void HandlePacket(PacketHandle& rx, uint32_t size, TelemetryBlock& telemetry);
+    
+    // Estado da sala (thread do jogo)
+    void ProcessRoomChunks();
+    void SendRoomNack(uint16_t transferId, uint16_t chunkIndex);
+    static void ApplyRoomRecords(uint16_t roomId, const RoomEntityRecord* records,
+                                 uint32_t count, void* user);
+    
+    // Desync (thread do jogo)
+    void ProcessDesyncCheck();
+    void ProcessDesyncDetail();
+    
+    // Resync por Merkle (thread do jogo)
+    void BeginResync();
+    void ProcessMerkleReplies();
+    void SendMerkleRequests();
+    void PatchRoomState(uint32_t slot);
+    
     SOCKET m_socket = INVALID_SOCKET;
     std::atomic<bool> m_connected{false};
     
     std::thread m_receiveThread;
     std::thread m_sendThread;
     
-    int m_ping = 0;
     uint32_t m_sendSequence = 0;
     
-    GameStatePacket m_lastGameState = {};
-    std::mutex m_stateMutex;
-    
-    std::queue<PlayerInputPacket> m_sendQueue;
-    std::mutex m_sendMutex;
+    // Telemetria
+    NetTelemetry m_telemetry;
+    
+    // Estado do host: a thread de recepção decodifica contra a própria
+    // baseline e publica a cópia
+    GameStatePacket m_baseline = {};
+    bool m_hasGameState = false;                // Baseline para os deltas do host
+    SeqLock<GameStatePacket> m_gameState;
+    std::atomic<uint32_t> m_lastStateTick{0};   // CoopClockMicros32() da chegada
+    ClockSync m_clock;                          // A thread de recepção alimenta
+    
+    PacketQueue<64> m_sendQueue;
+    
+    // Sessão cifrada
+    SecureSession m_session;
+    RecordReader m_reader;
+    
+    // Estado da sala: chunks recebidos esperando a thread do jogo
+    PacketQueue<64> m_roomInbox;
+    BulkTransferReceiver m_roomReceiver;
+    RoomEntityRecord m_roomState[BULK_MAX_RECORDS];
+    uint32_t m_roomRecordCount = 0;
+    uint16_t m_roomStateTransfer = 0;
+    
+    // Desync: check do host aplicado por último, o nosso hash dele (vai no
+    // input) e os pedaços do detalhe esperando a thread do jogo
+    DesyncMonitor m_desync{"cliente", "host"};
+    std::atomic<uint32_t> m_checkSequence{0};   // GAME_STATE que trouxe o check atual
+    uint32_t m_lastCheckTick = 0;
+    uint32_t m_reportTick = 0;
+    uint64_t m_reportHash = 0;
+    PacketQueue<32> m_desyncInbox;
+    
+    // Resync: respostas do host esperando a thread do jogo. A sessão não
+    // volta a zero na reconexão (o host só esquece a dele na troca de sala).
+    MerkleResyncClient m_merkle;
+    PacketQueue<64> m_merkleInbox;
+    uint16_t m_merkleSession = 0;
+    uint32_t m_prevStateTick = 0;               // Para ver a parada do GAME_STATE
 };
 
 //=============================================================================
 // IMPLEMENTAÇÃO DO CLIENTE
 //=============================================================================
 
-inline bool CoopClient::Connect(const char* ip, uint16_t port) {
+inline bool CoopClient::Connect(const char* ip, uint16_t port, const char* roomCode) {
     if (m_connected) return true;
     
     // Inicializa Winsock
@@ -524,6 +1425,26 @@ inline bool CoopClient::Connect(const char* ip, uint16_t port) {
         return false;
     }
     
+    m_telemetry.Reset();
+    m_lastStateTick = 0;
+    m_hasGameState = false;
+    m_clock.Reset();
+    m_desync.Reset();
+    m_checkSequence = 0;
+    m_lastCheckTick = 0;
+    m_reportTick = 0;
+    m_reportHash = 0;
+    m_merkle.Abort();
+    m_prevStateTick = 0;
+    
+    // Troca de chaves antes de qualquer pacote de jogo
+    if (!Handshake(roomCode)) {
+        closesocket(m_socket);
+        m_socket = INVALID_SOCKET;
+        WSACleanup();
+        return false;
+    }
+    
     m_connected = true;
     
     // Inicia threads
@@ -536,14 +1457,21 @@ inline bool CoopClient::Connect(const char* ip, uint16_t port) {
 inline void CoopClient::Disconnect() {
     if (!m_connected) return;
     
+    m_connected = false;
+    
+    // Para a thread de envio antes: daqui em diante só esta thread sela
+    if (m_sendThread.joinable()) m_sendThread.join();
+    
     // Envia pacote de desconexão
     PacketHeader disconnect;
     disconnect.type = PacketType::DISCONNECT;
     disconnect.sequence = 0;
     disconnect.timestamp = GetTickCount();
-    send(m_socket, (char*)&disconnect, sizeof(disconnect), 0);
     
-    m_connected = false;
+    uint8_t record[sizeof(disconnect) + SECURE_RECORD_OVERHEAD];
+    uint32_t sealed = m_session.Seal((const uint8_t*)&disconnect, sizeof(disconnect), record);
+    SendAll(m_socket, record, sealed);
+    m_telemetry.GameThread().RecordSend((uint8_t)PacketType::DISCONNECT, sealed);
     
     if (m_socket != INVALID_SOCKET) {
         closesocket(m_socket);
@@ -551,7 +1479,12 @@ inline void CoopClient::Disconnect() {
     }
     
     if (m_receiveThread.joinable()) m_receiveThread.join();
-    if (m_sendThread.joinable()) m_sendThread.join();
+    m_session.Reset();
+    
+    m_sendQueue.Clear();
+    m_roomInbox.Clear();
+    m_desyncInbox.Clear();
+    m_merkleInbox.Clear();
     
     WSACleanup();
 }
@@ -559,11 +1492,257 @@ inline void CoopClient::Disconnect() {
 inline void CoopClient::Update() {
     if (!m_connected) return;
     
+    // Idade do estado do host no momento em que o jogo o consome
+    uint32_t stateTick = m_lastStateTick.load(std::memory_order_relaxed);
+    if (stateTick) {
+        m_telemetry.GameThread().RecordSnapshotAge(CoopClockMicros32() - stateTick);
+    }
+    
+    // GAME_STATE voltou depois de uma parada longa: o que mudou no meio
+    // (inimigos mortos, spawns) não vem em delta nenhum
+    if (stateTick != m_prevStateTick) {
+        if (m_prevStateTick && stateTick - m_prevStateTick > MERKLE_STALL_MS * 1000) BeginResync();
+        m_prevStateTick = stateTick;
+    }
+    
+    // Hash do nosso estado para o check que veio com o GAME_STATE
+    // (antes do input, que leva o resultado de volta ao host)
+    ProcessDesyncCheck();
+    
     // Lê input local e envia
     SendInput(g_P2_Input);
+    
+    // Aplica o que chegou do estado da sala
+    ProcessRoomChunks();
+    ProcessMerkleReplies();
+    ProcessDesyncDetail();
+}
+
+inline void CoopClient::ProcessDesyncCheck() {
+    // Sem o estado do host aplicado, nosso hash não diz nada (ver DESYNC_CHECKS)
+    if (!DESYNC_CHECKS) return;
+    
+    GameStatePacket state = GetGameState();
+    if (!state.checkTick || state.checkTick == m_lastCheckTick) return;
+    m_lastCheckTick = state.checkTick;
+    
+    // Só vale no tick em que o GAME_STATE do check é o último aplicado:
+    // se outro já chegou por cima, nosso estado é de depois do check
+    if (state.header.sequence != m_checkSequence.load(std::memory_order_relaxed)) return;
+    
+    // Troca de sala no meio: os dois lados ainda não têm a mesma sala
+    const EntitySnapshot& snapshot = CoopMod::GetSnapshot().Current();
+    if (snapshot.roomId != state.roomId || !m_roomReceiver.IsReady()) return;
+    
+    {
+        COOP_PROFILE_ZONE("DesyncMonitor::Record");
+        m_reportHash = m_desync.Record(state.checkTick, snapshot);
+        m_reportTick = state.checkTick;
+    }
+    
+    if (m_desync.Compare(state.checkTick, state.checkHash) != DesyncResult::DIVERGED) return;
+    
+    // Desync novo: pede ao host os hashes por entidade do primeiro check errado
+    PacketHandle handle = PacketPool::Instance().Acquire();
+    if (!handle) return;
+    
+    DesyncRequestPacket& request = *handle.Emplace<DesyncRequestPacket>();
+    request.header.type = PacketType::DESYNC_REQUEST;
+    request.header.sequence = 0;
+    request.header.timestamp = GetTickCount();
+    request.tick = m_desync.Report().tick;
+    m_sendQueue.Push(handle);
+    
+    // E já corrige: o resync só traz o que está diferente
+    BeginResync();
+}
+
+inline void CoopClient::BeginResync() {
+    // Sala chegando ainda vai trazer tudo; resync em andamento já cobre
+    if (m_merkle.IsActive() || !m_roomReceiver.IsReady()) return;
+    
+    {
+        COOP_PROFILE_ZONE("MerkleTree::Build");
+        m_merkle.Begin(++m_merkleSession, CoopMod::GetSnapshot().Current(), GetTickCount());
+    }
+    SendMerkleRequests();
+}
+
+inline void CoopClient::ProcessMerkleReplies() {
+    PacketHandle reply;
+    uint32_t slots[MERKLE_BLOCKS_PER_PACKET];
+    uint32_t now = GetTickCount();
+    
+    while (m_merkleInbox.Pop(reply)) {
+        const PacketHeader* header = reply.As<PacketHeader>();
+        
+        if (header->type == PacketType::MERKLE_HASHES) {
+            const MerkleHashesPacket* packet = reply.As<MerkleHashesPacket>();
+            if (packet->count > MERKLE_HASHES_PER_PACKET ||
+                reply.Size() < offsetof(MerkleHashesPacket, entries) + packet->count * sizeof(MerkleNodeHash)) {
+                continue;
+            }
+            m_merkle.OnHashes(packet->session, packet->entries, packet->count, now);
+        }
+        else {
+            const MerkleBlocksPacket* packet = reply.As<MerkleBlocksPacket>();
+            if (packet->count > MERKLE_BLOCKS_PER_PACKET ||
+                reply.Size() < offsetof(MerkleBlocksPacket, blocks) + packet->count * sizeof(MerkleBlockData)) {
+                continue;
+            }
+            uint32_t touched = m_merkle.OnBlocks(packet->session, packet->blocks, packet->count, slots, now);
+            for (uint32_t i = 0; i < touched; i++) PatchRoomState(slots[i]);
+        }
+    }
+    
+    // Sala nova no meio (ela traz tudo) ou host mudo: desiste
+    if (m_merkle.IsActive() && (!m_roomReceiver.IsReady() || m_merkle.TimedOut(now))) {
+        m_merkle.Abort();
+        return;
+    }
+    
+    // Diferença demais na rodada das entidades: pede a sala inteira
+    if (m_merkle.TakeRoomRequest()) {
+        PacketHandle handle = PacketPool::Instance().Acquire();
+        if (!handle) return;
+        
+        MerkleRequestPacket& packet = *handle.Emplace<MerkleRequestPacket>();
+        packet.header.type = PacketType::MERKLE_REQUEST;
+        packet.header.sequence = 0;
+        packet.header.timestamp = GetTickCount();
+        packet.session = m_merkle.Session();
+        packet.kind = MerkleRequestKind::ROOM;
+        packet.count = 0;
+        handle.SetSize((uint32_t)offsetof(MerkleRequestPacket, nodes));
+        m_sendQueue.Push(handle);
+        return;
+    }
+    
+    // Rodada fechou: pede o próximo nível
+    SendMerkleRequests();
+}
+
+inline void CoopClient::SendMerkleRequests() {
+    while (m_merkle.IsActive()) {
+        PacketHandle handle = PacketPool::Instance().Acquire();
+        if (!handle) return;
+        
+        MerkleRequestPacket& packet = *handle.Emplace<MerkleRequestPacket>();
+        MerkleRequestKind kind;
+        uint32_t count = m_merkle.NextRequest(kind, packet.nodes, MERKLE_NODES_PER_PACKET);
+        if (!count) return;
+        
+        packet.header.type = PacketType::MERKLE_REQUEST;
+        packet.header.sequence = 0;
+        packet.header.timestamp = GetTickCount();
+        packet.session = m_merkle.Session();
+        packet.kind = kind;
+        packet.count = (uint8_t)count;
+        handle.SetSize((uint32_t)(offsetof(MerkleRequestPacket, nodes) + count * sizeof(uint16_t)));
+        m_sendQueue.Push(handle);
+    }
+}
+
+inline void CoopClient::PatchRoomState(uint32_t slot) {
+    const MerkleTree& tree = m_merkle.Tree();
+    RoomEntityRecord record = tree.Record(slot);
+    
+    uint32_t i = 0;
+    while (i < m_roomRecordCount &&
+           (m_roomState[i].kind != record.kind || m_roomState[i].index != record.index)) {
+        i++;
+    }
+    
+    if (!tree.Present(slot)) {
+        // Não existe mais no host
+        if (i < m_roomRecordCount) m_roomState[i] = m_roomState[--m_roomRecordCount];
+    }
+    else if (i < m_roomRecordCount) {
+        m_roomState[i] = record;
+    }
+    else if (m_roomRecordCount < BULK_MAX_RECORDS) {
+        m_roomState[m_roomRecordCount++] = record;
+    }
+    
+    // TODO: Escrever na entidade local, como em ApplyRoomRecords
+}
+
+inline void CoopClient::ProcessDesyncDetail() {
+    PacketHandle detail;
+    while (m_desyncInbox.Pop(detail)) {
+        const DesyncDetailPacket* packet = detail.As<DesyncDetailPacket>();
+        if (packet->count > DESYNC_DETAIL_PER_PACKET ||
+            detail.Size() < offsetof(DesyncDetailPacket, entities) + packet->count * sizeof(DesyncEntityHash)) {
+            continue;
+        }
+        m_desync.AddRemoteDetail(packet->tick, packet->first, packet->total, packet->entities, packet->count);
+    }
+}
+
+inline void CoopClient::ProcessRoomChunks() {
+    PacketHandle chunk;
+    while (m_roomInbox.Pop(chunk)) {
+        const RoomChunkPacket* packet = chunk.As<RoomChunkPacket>();
+        
+        uint32_t expected = (uint32_t)(offsetof(RoomChunkPacket, records) +
+                                       packet->chunk.recordCount * sizeof(RoomEntityRecord));
+        BulkChunkResult result = (chunk.Size() < expected)
+            ? BulkChunkResult::CORRUPT
+            : m_roomReceiver.OnChunk(packet->chunk, packet->records, ApplyRoomRecords, this);
+        
+        if (result == BulkChunkResult::CORRUPT) {
+            SendRoomNack(packet->chunk.transferId, packet->chunk.chunkIndex);
+        }
+    }
+    
+    // Transferência parada há meio segundo: pede o que falta
+    uint16_t missing[8];
+    uint32_t count = m_roomReceiver.CollectMissing(15, missing, 8);
+    for (uint32_t i = 0; i < count; i++) {
+        SendRoomNack(m_roomReceiver.TransferId(), missing[i]);
+    }
+}
+
+inline void CoopClient::SendRoomNack(uint16_t transferId, uint16_t chunkIndex) {
+    PacketHandle handle = PacketPool::Instance().Acquire();
+    if (!handle) return;
+    
+    RoomNackPacket& packet = *handle.Emplace<RoomNackPacket>();
+    packet.header.type = PacketType::ROOM_STATE_NACK;
+    packet.header.sequence = 0;
+    packet.header.timestamp = GetTickCount();
+    packet.transferId = transferId;
+    packet.chunkIndex = chunkIndex;
+    
+    m_sendQueue.Push(handle);
+}
+
+inline void CoopClient::ApplyRoomRecords(uint16_t roomId, const RoomEntityRecord* records,
+                                         uint32_t count, void* user) {
+    CoopClient* self = (CoopClient*)user;
+    
+    // Chunk atrasado de uma sala que o host já deixou: o GAME_STATE da sala
+    // nova sai antes dos chunks dela, então já foi publicado
+    if (self->m_lastStateTick.load(std::memory_order_relaxed) && self->GetGameState().roomId != roomId) return;
+    
+    // Primeiro chunk de uma sala nova descarta a tabela anterior
+    if (self->m_roomStateTransfer != self->m_roomReceiver.TransferId()) {
+        self->m_roomStateTransfer = self->m_roomReceiver.TransferId();
+        self->m_roomRecordCount = 0;
+    }
+    
+    for (uint32_t i = 0; i < count && self->m_roomRecordCount < BULK_MAX_RECORDS; i++) {
+        self->m_roomState[self->m_roomRecordCount++] = records[i];
+        
+        // TODO: Escrever inimigos/itens/portas nas entidades locais
+        // (precisa do índice no EmMgr)
+    }
 }
 
 inline void CoopClient::SendInput(const CoopInput& input) {
+    PacketHandle handle = PacketPool::Instance().Acquire();
+    if (!handle) return;
+    
     PlayerInputPacket packet = {};
     packet.header.type = PacketType::PLAYER_INPUT;
     packet.header.sequence = m_sendSequence++;
@@ -575,87 +1754,194 @@ inline void CoopClient::SendInput(const CoopInput& input) {
     packet.lookY = input.lookY;
     packet.leftTrigger = input.leftTrigger;
     packet.rightTrigger = input.rightTrigger;
+    packet.buttons = InputButtonMap::Pack(input);
+    packet.checkTick = m_reportTick;
+    packet.checkHash = m_reportHash;
+    
+    // Input muda quase todo tick: vai sempre completo (~24 bytes de campos)
+    EncodeSchemaPacket<InputSchema>(handle, packet, nullptr);
+    
+    m_sendQueue.Push(handle);
+    m_telemetry.GameThread().RecordQueueDepth(m_sendQueue.Size());
+}
+
+inline bool CoopClient::Handshake(const char* roomCode) {
+    TelemetryBlock& telemetry = m_telemetry.GameThread();
+    m_reader.Reset();
+    m_session.Begin(SecureRole::CLIENT, roomCode);
+    
+    HandshakePacket request = {};
+    request.header.type = PacketType::CONNECT_REQUEST;
+    request.header.timestamp = GetTickCount();
+    memcpy(request.publicKey, m_session.PublicKey(), X25519_KEY_SIZE);
+    request.suites = SecureSession::LocalSuites();
+    if (!SendPlainRecord(m_socket, &request, sizeof(request))) return false;
+    telemetry.RecordSend((uint8_t)PacketType::CONNECT_REQUEST, sizeof(request) + SECURE_LENGTH_SIZE);
+    
+    // CONNECT_REJECT é menor que o HandshakePacket: falha no teste de tamanho
+    HandshakePacket accept;
+    uint32_t size = 0;
+    if (!RecvPlainRecord(m_socket, m_reader, &accept, sizeof(accept), size) ||
+        size != sizeof(accept) || accept.header.type != PacketType::CONNECT_ACCEPT) {
+        return false;
+    }
+    telemetry.RecordReceive((uint8_t)PacketType::CONNECT_ACCEPT, size, 0, false);
     
-    // Converte botões para bitmask
-    packet.buttons = 0;
-    if (input.action) packet.buttons |= BTN_ACTION;
-    if (input.run) packet.buttons |= BTN_RUN;
-    if (input.reload) packet.buttons |= BTN_RELOAD;
-    if (input.knife) packet.buttons |= BTN_KNIFE;
-    if (input.aim) packet.buttons |= BTN_AIM;
-    if (input.shoot) packet.buttons |= BTN_SHOOT;
-    if (input.inventory) packet.buttons |= BTN_INVENTORY;
-    if (input.map) packet.buttons |= BTN_MAP;
+    // A tag do host prova que ele conhece o código; sem ela nada sai cifrado
+    if (!m_session.Establish(accept.publicKey, request.suites, (CipherSuite)accept.suites) ||
+        !m_session.VerifyConfirm(accept.confirm)) {
+        return false;
+    }
     
-    std::lock_guard<std::mutex> lock(m_sendMutex);
-    m_sendQueue.push(packet);
+    ConfirmPacket confirm = {};
+    confirm.header.type = PacketType::CONNECT_CONFIRM;
+    confirm.header.timestamp = GetTickCount();
+    memcpy(confirm.confirm, m_session.LocalConfirm(), CPACE_CONFIRM_SIZE);
+    if (!SendPlainRecord(m_socket, &confirm, sizeof(confirm))) return false;
+    telemetry.RecordSend((uint8_t)PacketType::CONNECT_CONFIRM, sizeof(confirm) + SECURE_LENGTH_SIZE);
+    return true;
 }
 
 inline void CoopClient::ReceiveThread() {
+    NetTelemetry::Writer telemetry = m_telemetry.Acquire();
+    
+    PacketHandle rx = PacketPool::Instance().Acquire();
+    if (!rx) {
+        m_connected = false;
+        return;
+    }
+    
     while (m_connected) {
-        char buffer[1024];
-        int received = recv(m_socket, buffer, sizeof(buffer), 0);
-        
-        if (received > 0) {
-            PacketHeader* header = (PacketHeader*)buffer;
+        // Abre todos os registros completos que já chegaram
+        // (o host pode mandar GAME_STATE junto com o CONNECT_ACCEPT)
+        uint8_t* record;
+        uint32_t bodySize;
+        RecordStatus status;
+        while ((status = m_reader.Next(record, bodySize)) == RecordStatus::READY) {
+            memcpy(rx.Data(), record + SECURE_LENGTH_SIZE, bodySize);
             
-            switch (header->type) {
-                case PacketType::GAME_STATE:
-                    if (received >= sizeof(GameStatePacket)) {
-                        std::lock_guard<std::mutex> lock(m_stateMutex);
-                        memcpy(&m_lastGameState, buffer, sizeof(GameStatePacket));
-                    }
-                    break;
-                    
-                case PacketType::PONG:
-                    // Calcula ping
-                    m_ping = GetTickCount() - header->timestamp;
-                    break;
-                    
-                case PacketType::DISCONNECT:
-                    m_connected = false;
-                    break;
+            uint32_t size;
+            if (!m_session.Open(record, rx.Data(), bodySize, size) || size < sizeof(PacketHeader)) {
+                status = RecordStatus::INVALID;
+                break;
             }
+            rx.SetSize(size);
+            HandlePacket(rx, size, *telemetry);
         }
-        else if (received == 0 || received == SOCKET_ERROR) {
+        
+        if (status == RecordStatus::INVALID || !m_reader.Fill(m_socket)) {
             m_connected = false;
             break;
         }
     }
 }
 
+inline void CoopClient::HandlePacket(PacketHandle& rx, uint32_t size, TelemetryBlock& telemetry) {
+    PacketHeader* header = rx.As<PacketHeader>();
+    telemetry.RecordReceive((uint8_t)header->type, size + SECURE_RECORD_OVERHEAD, header->sequence,
+                            header->type == PacketType::GAME_STATE);
+    
+    switch (header->type) {
+        case PacketType::GAME_STATE: {
+            // A baseline é só desta thread; o jogo lê a cópia publicada
+            GameStatePacket state;
+            if (DecodeSchemaPacket<GameStateSchema>(rx.Data(), size,
+                                                    m_hasGameState ? &m_baseline : nullptr, state)) {
+                // Pacote que trouxe um check novo (antes de publicar o estado)
+                if (!m_hasGameState || state.checkTick != m_baseline.checkTick) {
+                    m_checkSequence.store(state.header.sequence, std::memory_order_relaxed);
+                }
+                m_baseline = state;
+                m_hasGameState = true;
+                m_gameState.Store(state);
+                m_lastStateTick.store(CoopClockMicros32(), std::memory_order_relaxed);
+            }
+            break;
+        }
+            
+        case PacketType::ROOM_STATE_CHUNK:
+            // Repassa o buffer inteiro para a thread do jogo e pega outro
+            if (size >= offsetof(RoomChunkPacket, records)) {
+                PacketHandle next = PacketPool::Instance().Acquire();
+                if (next && m_roomInbox.Push(rx)) rx = std::move(next);
+            }
+            break;
+            
+        case PacketType::DESYNC_DETAIL:
+            if (size >= offsetof(DesyncDetailPacket, entities)) {
+                PacketHandle next = PacketPool::Instance().Acquire();
+                if (next && m_desyncInbox.Push(rx)) rx = std::move(next);
+            }
+            break;
+            
+        case PacketType::MERKLE_HASHES:
+        case PacketType::MERKLE_BLOCKS:
+            if (size >= offsetof(MerkleHashesPacket, entries)) {
+                PacketHandle next = PacketPool::Instance().Acquire();
+                if (next && m_merkleInbox.Push(rx)) rx = std::move(next);
+            }
+            break;
+            
+        case PacketType::PONG:
+            // RTT = agora - relógio que nós mesmos mandamos no PING, menos o
+            // tempo que o PONG ficou no host
+            if (size >= sizeof(ClockPacket)) {
+                const ClockPacket* pong = rx.As<ClockPacket>();
+                uint32_t now = CoopClockMicros32();
+                if (m_clock.AddSample(pong->clientMicros, pong->hostReceiveMicros, pong->hostMicros, now)) {
+                    telemetry.RecordRtt(m_clock.LastRtt());
+                }
+            }
+            break;
+            
+        case PacketType::DISCONNECT:
+            m_connected = false;
+            break;
+            
+        default:
+            break;      // Tipos só do cliente -> host (ou do handshake): ignora
+    }
+}
+
 inline void CoopClient::SendThread() {
+    NetTelemetry::Writer telemetry = m_telemetry.Acquire();
     uint32_t lastPing = 0;
     
+    // Tudo que estiver na fila é selado num lote contíguo e vai num send()
+    uint8_t batch[NET_SEND_BATCH_SIZE];
+    PacketHandle packet;
+    
     while (m_connected) {
+        uint32_t used = 0;
+        
         // Envia ping periodicamente
         if (GetTickCount() - lastPing > 1000) {
-            PacketHeader ping;
-            ping.type = PacketType::PING;
-            ping.sequence = 0;
-            ping.timestamp = GetTickCount();
-            send(m_socket, (char*)&ping, sizeof(ping), 0);
+            ClockPacket ping = {};
+            ping.header.type = PacketType::PING;
+            ping.header.sequence = 0;
+            ping.header.timestamp = GetTickCount();
+            ping.clientMicros = CoopClockMicros32();
+            ping.rttMicros = m_telemetry.LastRttUs();
+            uint32_t sealed = m_session.Seal((const uint8_t*)&ping, sizeof(ping), batch);
+            telemetry->RecordSend((uint8_t)PacketType::PING, sealed);
+            used += sealed;
             lastPing = GetTickCount();
         }
         
         // Envia pacotes da fila
-        PlayerInputPacket packet;
-        bool hasPacket = false;
-        
-        {
-            std::lock_guard<std::mutex> lock(m_sendMutex);
-            if (!m_sendQueue.empty()) {
-                packet = m_sendQueue.front();
-                m_sendQueue.pop();
-                hasPacket = true;
-            }
+        while (used + PACKET_BUFFER_SIZE + SECURE_RECORD_OVERHEAD <= sizeof(batch) &&
+               m_sendQueue.Pop(packet)) {
+            uint32_t sealed = m_session.Seal(packet.Data(), packet.Size(), batch + used);
+            telemetry->RecordSend((uint8_t)packet.As<PacketHeader>()->type, sealed);
+            used += sealed;
+            packet.Reset();
         }
         
-        if (hasPacket) {
-            send(m_socket, (char*)&packet, sizeof(packet), 0);
-        }
-        else {
+        if (used == 0) {
             Sleep(1);
         }
+        else if (!SendAll(m_socket, batch, used)) {
+            m_connected = false;
+        }
     }
 }
@@ -0,0 +1,271 @@
+/**
+ * RE4 CO-OP MOD - Pool de Buffers de Pacote
+ *
+ * Implementa:
+ * - Pool fixo de buffers (sem heap depois da inicialização)
+ * - PacketHandle com contagem de referência (cópia = AddRef)
+ * - Fila SPSC lock-free de handles (game thread -> thread de envio)
+ *
+ * O pacote é montado uma única vez dentro do buffer final, passa pela
+ * fila e pelo send() como handle e volta para o pool quando a última
+ * referência some.
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+// Maior pacote que cabe num buffer (GameStatePacket + folga para crescer)
+constexpr uint32_t PACKET_BUFFER_SIZE = 512;
+
+// Quantidade de buffers. Índice 0xFFFF é reservado como "nulo".
+constexpr uint32_t PACKET_POOL_CAPACITY = 256;
+
+//=============================================================================
+// BUFFER
+//=============================================================================
+
+struct PacketBuffer {
+    std::atomic<uint32_t> refs;
+    uint32_t size;              // Bytes válidos em data
+    uint16_t index;             // Posição no pool
+    alignas(8) uint8_t data[PACKET_BUFFER_SIZE];
+};
+
+struct PacketPoolStats {
+    uint64_t acquired;
+    uint64_t exhausted;         // Acquire() sem buffer livre
+    uint32_t inUse;
+    uint32_t highWater;         // Maior inUse já visto
+};
+
+class PacketHandle;
+
+//=============================================================================
+// POOL
+//=============================================================================
+
+class PacketPool {
+public:
+    static PacketPool& Instance() {
+        static PacketPool instance;
+        return instance;
+    }
+
+    // Retorna handle vazio se o pool estiver esgotado (nunca aloca)
+    PacketHandle Acquire();
+
+    PacketPoolStats GetStats() const {
+        PacketPoolStats stats;
+        stats.acquired = m_acquired.load(std::memory_order_relaxed);
+        stats.exhausted = m_exhausted.load(std::memory_order_relaxed);
+        stats.inUse = m_inUse.load(std::memory_order_relaxed);
+        stats.highWater = m_highWater.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    friend class PacketHandle;
+
+    static constexpr uint16_t NIL = 0xFFFF;
+
+    PacketPool() {
+        for (uint32_t i = 0; i < PACKET_POOL_CAPACITY; i++) {
+            m_buffers[i].refs.store(0, std::memory_order_relaxed);
+            m_buffers[i].size = 0;
+            m_buffers[i].index = (uint16_t)i;
+            m_next[i].store((uint16_t)(i + 1 < PACKET_POOL_CAPACITY ? i + 1 : NIL),
+                            std::memory_order_relaxed);
+        }
+        m_head.store(0, std::memory_order_release);
+    }
+
+    PacketPool(const PacketPool&) = delete;
+    PacketPool& operator=(const PacketPool&) = delete;
+
+    // Pilha de Treiber: head = (tag << 16) | índice. O tag evita ABA.
+    PacketBuffer* Pop() {
+        uint32_t head = m_head.load(std::memory_order_acquire);
+        for (;;) {
+            uint16_t index = (uint16_t)(head & 0xFFFF);
+            if (index == NIL) return nullptr;
+
+            uint16_t next = m_next[index].load(std::memory_order_relaxed);
+            uint32_t newHead = ((head + 0x10000) & 0xFFFF0000) | next;
+            if (m_head.compare_exchange_weak(head, newHead, std::memory_order_acquire)) {
+                return &m_buffers[index];
+            }
+        }
+    }
+
+    void Push(PacketBuffer* buffer) {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        for (;;) {
+            m_next[buffer->index].store((uint16_t)(head & 0xFFFF), std::memory_order_relaxed);
+            uint32_t newHead = ((head + 0x10000) & 0xFFFF0000) | buffer->index;
+            if (m_head.compare_exchange_weak(head, newHead, std::memory_order_release)) {
+                return;
+            }
+        }
+    }
+
+    void Release(PacketBuffer* buffer) {
+        if (buffer->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            m_inUse.fetch_sub(1, std::memory_order_relaxed);
+            Push(buffer);
+        }
+    }
+
+    PacketBuffer m_buffers[PACKET_POOL_CAPACITY];
+    std::atomic<uint16_t> m_next[PACKET_POOL_CAPACITY];
+    std::atomic<uint32_t> m_head{0};
+
+    std::atomic<uint64_t> m_acquired{0};
+    std::atomic<uint64_t> m_exhausted{0};
+    std::atomic<uint32_t> m_inUse{0};
+    std::atomic<uint32_t> m_highWater{0};
+};
+
+//=============================================================================
+// HANDLE
+//=============================================================================
+
+class PacketHandle {
+public:
+    PacketHandle() = default;
+
+    PacketHandle(const PacketHandle& other) : m_buffer(other.m_buffer) {
+        if (m_buffer) m_buffer->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    PacketHandle(PacketHandle&& other) noexcept : m_buffer(other.m_buffer) {
+        other.m_buffer = nullptr;
+    }
+
+    PacketHandle& operator=(PacketHandle other) noexcept {
+        PacketBuffer* tmp = m_buffer;
+        m_buffer = other.m_buffer;
+        other.m_buffer = tmp;
+        return *this;
+    }
+
+    ~PacketHandle() { Reset(); }
+
+    void Reset() {
+        if (m_buffer) {
+            PacketPool::Instance().Release(m_buffer);
+            m_buffer = nullptr;
+        }
+    }
+
+    explicit operator bool() const { return m_buffer != nullptr; }
+
+    uint8_t* Data() { return m_buffer->data; }
+    const uint8_t* Data() const { return m_buffer->data; }
+    uint32_t Size() const { return m_buffer->size; }
+    void SetSize(uint32_t size) { m_buffer->size = size; }
+    static constexpr uint32_t Capacity() { return PACKET_BUFFER_SIZE; }
+
+    // Constrói o pacote zerado direto no buffer final
+    template<typename T>
+    T* Emplace() {
+        static_assert(sizeof(T) <= PACKET_BUFFER_SIZE, "pacote maior que o buffer do pool");
+        memset(m_buffer->data, 0, sizeof(T));
+        m_buffer->size = sizeof(T);
+        return reinterpret_cast<T*>(m_buffer->data);
+    }
+
+    template<typename T>
+    T* As() { return reinterpret_cast<T*>(m_buffer->data); }
+
+    template<typename T>
+    const T* As() const { return reinterpret_cast<const T*>(m_buffer->data); }
+
+    // Transferência de posse crua (usada pela fila)
+    PacketBuffer* Detach() {
+        PacketBuffer* buffer = m_buffer;
+        m_buffer = nullptr;
+        return buffer;
+    }
+
+    static PacketHandle Adopt(PacketBuffer* buffer) {
+        PacketHandle handle;
+        handle.m_buffer = buffer;
+        return handle;
+    }
+
+private:
+    PacketBuffer* m_buffer = nullptr;
+};
+
+inline PacketHandle PacketPool::Acquire() {
+    PacketBuffer* buffer = Pop();
+    if (!buffer) {
+        m_exhausted.fetch_add(1, std::memory_order_relaxed);
+        return PacketHandle();
+    }
+
+    buffer->refs.store(1, std::memory_order_relaxed);
+    buffer->size = 0;
+
+    m_acquired.fetch_add(1, std::memory_order_relaxed);
+    uint32_t inUse = m_inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+    uint32_t high = m_highWater.load(std::memory_order_relaxed);
+    while (inUse > high && !m_highWater.compare_exchange_weak(high, inUse, std::memory_order_relaxed)) {}
+
+    return PacketHandle::Adopt(buffer);
+}
+
+//=============================================================================
+// FILA SPSC DE HANDLES
+//=============================================================================
+
+// Um produtor (game thread) e um consumidor (thread de envio).
+// Capacity precisa ser potência de 2.
+template<uint32_t Capacity>
+class PacketQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity deve ser potência de 2");
+
+public:
+    ~PacketQueue() { Clear(); }
+
+    // false se a fila estiver cheia (o handle continua com o chamador)
+    bool Push(PacketHandle& handle) {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) >= Capacity) return false;
+
+        m_slots[tail & (Capacity - 1)] = handle.Detach();
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(PacketHandle& out) {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;
+
+        out = PacketHandle::Adopt(m_slots[head & (Capacity - 1)]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t Size() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    // Só com produtor e consumidor parados
+    void Clear() {
+        PacketHandle handle;
+        while (Pop(handle)) handle.Reset();
+    }
+
+private:
+    PacketBuffer* m_slots[Capacity] = {};
+    alignas(64) std::atomic<uint32_t> m_head{0};
+    alignas(64) std::atomic<uint32_t> m_tail{0};
+};
@@ -0,0 +1,200 @@
+/**
+ * RE4 CO-OP MOD - Slots de Player
+ *
+ * Posição de todos os slots (até COOP_MAX_PLAYERS) num layout SoA, um
+ * float por slot em cada eixo. Com 4 slots cada eixo cabe num registro
+ * SSE, então distância, centro, enquadramento e "quem está longe demais"
+ * custam o mesmo para 2 ou 4 players.
+ *
+ *   PlayerPositions players;
+ *   GatherPlayerPositions(table, EntityCache::Instance(), players);
+ *   uint32_t far = PlayersBeyond(players, players.Pos(0), maxDistance);
+ *
+ * Slots vazios ficam fora de mask e não entram em nenhuma conta.
+ */
+
+#pragma once
+#include "coop_core.h"
+#include "coop_game_memory.h"
+#include "coop_entity_cache.h"
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define COOP_PLAYERS_SSE 1
+#include <emmintrin.h>
+#endif
+
+static_assert(COOP_MAX_PLAYERS == 4, "players: as contas SSE assumem um registro por eixo");
+
+//=============================================================================
+// POSIÇÕES
+//=============================================================================
+
+struct PlayerPositions {
+    alignas(16) float x[COOP_MAX_PLAYERS];
+    alignas(16) float y[COOP_MAX_PLAYERS];
+    alignas(16) float z[COOP_MAX_PLAYERS];
+    uint32_t mask;          // Bit i = slot i válido
+    uint32_t count;
+
+    Vec Pos(uint32_t slot) const { return { x[slot], y[slot], z[slot] }; }
+    bool Has(uint32_t slot) const { return (mask & (1u << slot)) != 0; }
+};
+
+// Enquadramento do grupo: centro, raio em volta dele e caixa
+struct PlayerFraming {
+    Vec center;
+    float radius;           // Maior distância de um player até center
+    Vec min;
+    Vec max;
+};
+
+template<typename Table>
+inline void GatherPlayerPositions(Table table, const EntityCache& entities, PlayerPositions& out) {
+    out.mask = 0;
+    out.count = 0;
+    for (uint16_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+        cPlayer* player = entities.Player(i);
+        Vec pos = player ? EmView(table, player).Pos() : Vec{ 0.0f, 0.0f, 0.0f };
+        out.x[i] = pos.x;
+        out.y[i] = pos.y;
+        out.z[i] = pos.z;
+        if (player) {
+            out.mask |= 1u << i;
+            out.count++;
+        }
+    }
+}
+
+//=============================================================================
+// CONTAS EM LOTE
+//=============================================================================
+
+#ifdef COOP_PLAYERS_SSE
+
+// Lanes dos slots válidos em 1s
+inline __m128 PlayerLaneMask(uint32_t mask) {
+    const __m128i bits = _mm_set_epi32(8, 4, 2, 1);
+    __m128i m = _mm_and_si128(_mm_set1_epi32((int)mask), bits);
+    return _mm_castsi128_ps(_mm_cmpeq_epi32(m, bits));
+}
+
+inline __m128 PlayerDistanceSq4(const PlayerPositions& p, const Vec& from) {
+    __m128 dx = _mm_sub_ps(_mm_load_ps(p.x), _mm_set1_ps(from.x));
+    __m128 dy = _mm_sub_ps(_mm_load_ps(p.y), _mm_set1_ps(from.y));
+    __m128 dz = _mm_sub_ps(_mm_load_ps(p.z), _mm_set1_ps(from.z));
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+}
+
+inline float HorizontalSum(__m128 v) {
+    __m128 pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+}
+
+inline float HorizontalMax(__m128 v) {
+    __m128 pairs = _mm_max_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_max_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+}
+
+inline float HorizontalMin(__m128 v) {
+    __m128 pairs = _mm_min_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_min_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+}
+
+#endif
+
+// Distância de cada slot até from (slots vazios recebem 0)
+inline void PlayerDistances(const PlayerPositions& p, const Vec& from, float* out) {
+#ifdef COOP_PLAYERS_SSE
+    __m128 distance = _mm_sqrt_ps(PlayerDistanceSq4(p, from));
+    _mm_storeu_ps(out, _mm_and_ps(distance, PlayerLaneMask(p.mask)));
+#else
+    for (uint32_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+        out[i] = p.Has(i) ? CoopMod::CalculateDistance(p.Pos(i), from) : 0.0f;
+    }
+#endif
+}
+
+// Máscara dos slots válidos a mais de maxDistance de from
+inline uint32_t PlayersBeyond(const PlayerPositions& p, const Vec& from, float maxDistance) {
+#ifdef COOP_PLAYERS_SSE
+    __m128 far = _mm_cmpgt_ps(PlayerDistanceSq4(p, from), _mm_set1_ps(maxDistance * maxDistance));
+    return (uint32_t)_mm_movemask_ps(far) & p.mask;
+#else
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+        if (p.Has(i) && CoopMod::CalculateDistance(p.Pos(i), from) > maxDistance) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+// Média das posições válidas (com 2 players, o ponto médio)
+inline Vec PlayerCentroid(const PlayerPositions& p) {
+    if (!p.count) return { 0.0f, 0.0f, 0.0f };
+    float scale = 1.0f / (float)p.count;
+
+#ifdef COOP_PLAYERS_SSE
+    __m128 valid = PlayerLaneMask(p.mask);
+    return {
+        HorizontalSum(_mm_and_ps(_mm_load_ps(p.x), valid)) * scale,
+        HorizontalSum(_mm_and_ps(_mm_load_ps(p.y), valid)) * scale,
+        HorizontalSum(_mm_and_ps(_mm_load_ps(p.z), valid)) * scale
+    };
+#else
+    Vec sum = { 0.0f, 0.0f, 0.0f };
+    for (uint32_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+        if (!p.Has(i)) continue;
+        sum.x += p.x[i];
+        sum.y += p.y[i];
+        sum.z += p.z[i];
+    }
+    return { sum.x * scale, sum.y * scale, sum.z * scale };
+#endif
+}
+
+// Maior distância de um slot válido até from
+inline float PlayerMaxDistance(const PlayerPositions& p, const Vec& from) {
+#ifdef COOP_PLAYERS_SSE
+    __m128 distanceSq = _mm_and_ps(PlayerDistanceSq4(p, from), PlayerLaneMask(p.mask));
+    return sqrtf(HorizontalMax(distanceSq));
+#else
+    float distances[COOP_MAX_PLAYERS];
+    PlayerDistances(p, from, distances);
+    float best = 0.0f;
+    for (uint32_t i = 0; i < COOP_MAX_PLAYERS; i++) best = distances[i] > best ? distances[i] : best;
+    return best;
+#endif
+}
+
+inline PlayerFraming ComputePlayerFraming(const PlayerPositions& p) {
+    PlayerFraming framing;
+    framing.center = PlayerCentroid(p);
+    framing.radius = PlayerMaxDistance(p, framing.center);
+
+    if (!p.count) {
+        framing.min = framing.max = framing.center;
+        return framing;
+    }
+
+#ifdef COOP_PLAYERS_SSE
+    // Slots vazios viram +inf no min e -inf no max
+    __m128 valid = PlayerLaneMask(p.mask);
+    __m128 high = _mm_set1_ps(FLT_MAX), low = _mm_set1_ps(-FLT_MAX);
+    __m128 x = _mm_load_ps(p.x), y = _mm_load_ps(p.y), z = _mm_load_ps(p.z);
+    #define PLAYER_PICK(v, fill) _mm_or_ps(_mm_and_ps(valid, v), _mm_andnot_ps(valid, fill))
+    framing.min = { HorizontalMin(PLAYER_PICK(x, high)), HorizontalMin(PLAYER_PICK(y, high)), HorizontalMin(PLAYER_PICK(z, high)) };
+    framing.max = { HorizontalMax(PLAYER_PICK(x, low)), HorizontalMax(PLAYER_PICK(y, low)), HorizontalMax(PLAYER_PICK(z, low)) };
+    #undef PLAYER_PICK
+#else
+    framing.min = { FLT_MAX, FLT_MAX, FLT_MAX };
+    framing.max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (uint32_t i = 0; i < COOP_MAX_PLAYERS; i++) {
+        if (!p.Has(i)) continue;
+        framing.min = { fminf(framing.min.x, p.x[i]), fminf(framing.min.y, p.y[i]), fminf(framing.min.z, p.z[i]) };
+        framing.max = { fmaxf(framing.max.x, p.x[i]), fmaxf(framing.max.y, p.y[i]), fmaxf(framing.max.z, p.z[i]) };
+    }
+#endif
+    return framing;
+}
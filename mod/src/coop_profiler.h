@@ -0,0 +1,316 @@
+/**
+ * RE4 CO-OP MOD - Profiler (zonas com RDTSC + trace do Chrome)
+ *
+ * Mede quanto tempo o mod adiciona a cada frame do jogo:
+ *
+ *   void Update() {
+ *       COOP_PROFILE_ZONE("CoopMod::Update");
+ *       ...
+ *   }
+ *
+ * - A zona lê o TSC na entrada e na saída e grava um evento no anel da
+ *   própria thread (produtor único, sem lock e sem LOCK)
+ * - Uma thread de fundo esvazia os anéis a cada PROFILER_DRAIN_MS e
+ *   escreve no formato JSON do Chrome (abrir em chrome://tracing ou
+ *   ui.perfetto.dev)
+ * - Anel cheio descarta o evento e conta em Dropped(); a thread do jogo
+ *   nunca espera o disco
+ *
+ * Sem COOP_PROFILING definido as macros não geram código. Com ele
+ * definido e o profiler parado, cada zona custa um load relaxed.
+ */
+
+#pragma once
+#include <Windows.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+constexpr uint32_t PROFILER_MAX_THREADS = 16;
+constexpr uint32_t PROFILER_RING_EVENTS = 1 << 12;     // Por thread (potência de 2)
+constexpr uint32_t PROFILER_DRAIN_MS = 20;
+constexpr uint32_t PROFILER_CALIBRATE_MS = 20;
+
+// Arquivo padrão (ao lado do executável do jogo)
+constexpr const char* PROFILER_TRACE_FILE = "re4coop_trace.json";
+
+inline uint64_t ProfilerTimestamp() {
+    return __rdtsc();
+}
+
+//=============================================================================
+// ANEL POR THREAD
+//=============================================================================
+
+struct ProfileEvent {
+    const char* name;       // Literal: o ponteiro precisa viver até o dreno
+    uint64_t start;
+    uint64_t end;
+};
+
+// Um produtor (a thread dona) e um consumidor (a thread de dreno)
+class ProfileRing {
+public:
+    // Dono novo só depois que o dreno levou tudo do anterior
+    bool TryAcquire() {
+        if (m_tail.load(std::memory_order_acquire) != m_head.load(std::memory_order_acquire)) return false;
+        bool free = false;
+        return m_owned.compare_exchange_strong(free, true, std::memory_order_acquire);
+    }
+
+    // Thread dona terminou (o que ela gravou ainda sai no dreno)
+    void Retire() { m_owned.store(false, std::memory_order_release); }
+
+    void Push(const char* name, uint64_t start, uint64_t end) {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= PROFILER_RING_EVENTS) {
+            m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+
+        ProfileEvent& event = m_events[head & (PROFILER_RING_EVENTS - 1)];
+        event.name = name;
+        event.start = start;
+        event.end = end;
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    // Só a thread de dreno chama
+    template<typename Fn>
+    uint32_t Drain(Fn&& fn) {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        uint32_t head = m_head.load(std::memory_order_acquire);
+        for (uint32_t i = tail; i != head; i++) {
+            fn(m_events[i & (PROFILER_RING_EVENTS - 1)]);
+        }
+        m_tail.store(head, std::memory_order_release);
+        return head - tail;
+    }
+
+    uint32_t ThreadId() const { return m_threadId.load(std::memory_order_relaxed); }
+    uint32_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    friend class Profiler;
+
+    alignas(64) std::atomic<uint32_t> m_head{0};
+    std::atomic<uint32_t> m_dropped{0};
+    std::atomic<uint32_t> m_threadId{0};
+    std::atomic<bool> m_owned{false};
+    alignas(64) std::atomic<uint32_t> m_tail{0};
+    ProfileEvent m_events[PROFILER_RING_EVENTS];
+};
+
+//=============================================================================
+// PROFILER
+//=============================================================================
+
+class Profiler {
+public:
+    static Profiler& Instance() {
+        static Profiler instance;
+        return instance;
+    }
+
+    // Abre o arquivo e começa a gravar. false se já está gravando ou o
+    // arquivo não abre.
+    bool Start(const char* path = PROFILER_TRACE_FILE) {
+        if (m_running.load(std::memory_order_relaxed)) return false;
+
+        m_file = fopen(path, "w");
+        if (!m_file) return false;
+        fputs("{\"traceEvents\":[\n", m_file);
+        m_firstEvent = true;
+
+        Calibrate();
+
+        // Descarta o que ficou de uma gravação anterior
+        uint32_t threads = ThreadCount();
+        for (uint32_t i = 0; i < threads; i++) {
+            m_rings[i].Drain([](const ProfileEvent&) {});
+        }
+
+        m_running.store(true, std::memory_order_relaxed);
+        m_enabled.store(true, std::memory_order_release);
+        m_drainThread = std::thread(&Profiler::DrainThread, this);
+        return true;
+    }
+
+    // Para de gravar, esvazia os anéis e fecha o arquivo
+    void Stop() {
+        if (!m_running.load(std::memory_order_relaxed)) return;
+
+        m_enabled.store(false, std::memory_order_relaxed);
+        m_running.store(false, std::memory_order_relaxed);
+        if (m_drainThread.joinable()) m_drainThread.join();
+
+        DrainAll();
+        fputs("\n]}\n", m_file);
+        fclose(m_file);
+        m_file = nullptr;
+    }
+
+    bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    void Record(const char* name, uint64_t start, uint64_t end) {
+        ProfileRing* ring = LocalRing();
+        if (ring) ring->Push(name, start, end);
+    }
+
+    // Eventos descartados por anel cheio (todas as threads)
+    uint32_t Dropped() const {
+        uint32_t dropped = 0;
+        uint32_t threads = ThreadCount();
+        for (uint32_t i = 0; i < threads; i++) dropped += m_rings[i].Dropped();
+        return dropped;
+    }
+
+    // Só é exato com o profiler parado
+    uint64_t EventsWritten() const { return m_written; }
+
+    // Anéis já criados (no máximo PROFILER_MAX_THREADS; reaproveitados entre threads)
+    uint32_t RingCount() const { return ThreadCount(); }
+
+private:
+    Profiler() = default;
+
+    uint32_t ThreadCount() const {
+        uint32_t count = m_threadCount.load(std::memory_order_acquire);
+        return count < PROFILER_MAX_THREADS ? count : PROFILER_MAX_THREADS;
+    }
+
+    // Devolve o anel quando a thread termina
+    struct RingLease {
+        ProfileRing* ring = nullptr;
+        ~RingLease() {
+            if (ring) ring->Retire();
+        }
+    };
+
+    ProfileRing* LocalRing() {
+        static thread_local RingLease lease;
+        if (!lease.ring) lease.ring = Register();
+        return lease.ring;
+    }
+
+    // Primeira zona de cada thread: um anel devolvido e já drenado, ou um
+    // novo. nullptr se todos estão com threads vivas (ou sem drenar).
+    ProfileRing* Register() {
+        ProfileRing* ring = Acquire();
+        if (ring) ring->m_threadId.store((uint32_t)GetCurrentThreadId(), std::memory_order_relaxed);
+        return ring;
+    }
+
+    ProfileRing* Acquire() {
+        for (;;) {
+            uint32_t count = m_threadCount.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < count && i < PROFILER_MAX_THREADS; i++) {
+                if (m_rings[i].TryAcquire()) return &m_rings[i];
+            }
+            if (count >= PROFILER_MAX_THREADS) return nullptr;
+
+            // Outra thread pode pegar o anel novo entre o incremento e o
+            // TryAcquire (ela já o vê na contagem): tenta de novo
+            if (m_threadCount.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel) &&
+                m_rings[count].TryAcquire()) {
+                return &m_rings[count];
+            }
+        }
+    }
+
+    // Ticks de TSC por microssegundo, medidos contra o steady_clock
+    void Calibrate() {
+        using namespace std::chrono;
+        steady_clock::time_point t0 = steady_clock::now();
+        uint64_t tsc0 = ProfilerTimestamp();
+        std::this_thread::sleep_for(milliseconds(PROFILER_CALIBRATE_MS));
+        uint64_t tsc1 = ProfilerTimestamp();
+        double micros = (double)duration_cast<nanoseconds>(steady_clock::now() - t0).count() / 1000.0;
+
+        m_ticksPerMicro = micros > 0.0 ? (double)(tsc1 - tsc0) / micros : 1.0;
+        m_baseTsc = tsc0;
+    }
+
+    void DrainThread() {
+        while (m_running.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(PROFILER_DRAIN_MS));
+            DrainAll();
+        }
+    }
+
+    void DrainAll() {
+        uint32_t threads = ThreadCount();
+        for (uint32_t i = 0; i < threads; i++) {
+            ProfileRing& ring = m_rings[i];
+            ring.Drain([&](const ProfileEvent& event) { Write(ring.ThreadId(), event); });
+        }
+        fflush(m_file);
+    }
+
+    // Evento "X" (completo): início + duração, em microssegundos
+    void Write(uint32_t tid, const ProfileEvent& event) {
+        if (event.start < m_baseTsc) return;    // Gravado antes do Start
+
+        double ts = (double)(event.start - m_baseTsc) / m_ticksPerMicro;
+        double dur = (double)(event.end - event.start) / m_ticksPerMicro;
+        fprintf(m_file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                m_firstEvent ? "" : ",\n", event.name, tid, ts, dur);
+        m_firstEvent = false;
+        m_written++;
+    }
+
+    ProfileRing m_rings[PROFILER_MAX_THREADS];
+    std::atomic<uint32_t> m_threadCount{0};
+    std::atomic<bool> m_enabled{false};
+    std::atomic<bool> m_running{false};
+    std::thread m_drainThread;
+
+    // Só a thread de dreno (ou Start/Stop com ela parada)
+    FILE* m_file = nullptr;
+    bool m_firstEvent = true;
+    double m_ticksPerMicro = 1.0;
+    uint64_t m_baseTsc = 0;
+    uint64_t m_written = 0;
+};
+
+//=============================================================================
+// ZONA
+//=============================================================================
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name)
+        : m_name(name), m_start(Profiler::Instance().IsEnabled() ? ProfilerTimestamp() : 0) {}
+
+    ~ProfileScope() {
+        if (m_start) Profiler::Instance().Record(m_name, m_start, ProfilerTimestamp());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_start;
+};
+
+#define COOP_PROFILE_CONCAT2(a, b) a##b
+#define COOP_PROFILE_CONCAT(a, b) COOP_PROFILE_CONCAT2(a, b)
+
+#ifdef COOP_PROFILING
+#define COOP_PROFILE_ZONE(name) ProfileScope COOP_PROFILE_CONCAT(coopProfileZone, __LINE__)(name)
+#else
+#define COOP_PROFILE_ZONE(name) ((void)0)
+#endif
@@ -0,0 +1,452 @@
+/**
+ * RE4 CO-OP MOD - Scanner de Assinaturas
+ *
+ * Todas as assinaturas registradas são procuradas numa passada só pela
+ * imagem do executável (no estilo "Teddy" do Hyperscan):
+ *
+ * - Cada padrão escolhe uma âncora de 2 bytes fixos (a menos comum em
+ *   código x86) e cai num de 8 buckets
+ * - Com SSSE3, 16 posições por vez passam por tabelas de nibble (pshufb)
+ *   e só as que podem começar alguma âncora viram candidatas
+ * - Sem SSSE3, cada posição vai direto para a tabela de âncoras
+ * - Candidatas passam por uma tabela de 64K âncoras e só os padrões com
+ *   aquela âncora exata são comparados
+ *
+ * O resultado vai para um cache em disco, chaveado pelos headers do
+ * executável e pelo conjunto de padrões: depois da primeira vez o jogo
+ * abre sem escanear nada.
+ *
+ *   PatternScanner& scanner = PatternScanner::Instance();
+ *   int as = scanner.Add("pAS_ptr", "A8 02 74 16 8B 15");
+ *   scanner.ScanModule();
+ *   pAS_ptr = *(cPlayer***)scanner.Find(as, 6);
+ */
+
+#pragma once
+#include "coop_core.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <Windows.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define COOP_SCANNER_X86 1
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define COOP_TARGET_SSSE3
+#else
+#include <cpuid.h>
+#define COOP_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#endif
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+constexpr uint32_t SCAN_MAX_PATTERNS = 256;
+constexpr uint32_t SCAN_MAX_PATTERN_BYTES = 64;
+constexpr uint32_t SCAN_BUCKETS = 8;
+constexpr uint32_t SCAN_NOT_FOUND = 0xFFFFFFFFu;
+
+// Arquivo de cache (ao lado do executável do jogo)
+constexpr const char* SCAN_CACHE_FILE = "re4coop_patterns.cache";
+
+//=============================================================================
+// UTILITÁRIOS
+//=============================================================================
+
+inline uint64_t ScanHash(const void* data, size_t size, uint64_t hash = 0xCBF29CE484222325ull) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+inline uint32_t ScanLowestBit(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctz(mask);
+#endif
+}
+
+inline bool CpuHasSsse3() {
+#ifdef COOP_SCANNER_X86
+    static const bool supported = [] {
+        unsigned int ecx;
+#ifdef _MSC_VER
+        int regs[4];
+        __cpuid(regs, 1);
+        ecx = (unsigned int)regs[2];
+#else
+        unsigned int eax, ebx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+#endif
+        return (ecx & (1u << 9)) != 0;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+// Quão comum o byte é em código x86 compilado (maior = pior âncora)
+inline uint32_t ScanByteWeight(uint8_t b) {
+    switch (b) {
+        case 0x00: case 0xFF: case 0xCC: return 8;
+        case 0x8B: case 0x89: case 0x8D: case 0xE8: return 6;
+        case 0x83: case 0x85: case 0x0F: case 0x45: case 0x44: case 0x24: return 4;
+        case 0x50: case 0x51: case 0x52: case 0x53: case 0x55: case 0x56: case 0x57:
+        case 0x5D: case 0x5E: case 0x5F: case 0xC3: case 0x74: case 0x75: case 0x90: return 3;
+        default: return 1;
+    }
+}
+
+//=============================================================================
+// PADRÃO
+//=============================================================================
+
+struct ScanPattern {
+    const char* name;
+    uint8_t bytes[SCAN_MAX_PATTERN_BYTES];
+    uint8_t mask[SCAN_MAX_PATTERN_BYTES];   // 0xFF = byte fixo, 0x00 = '?'
+    uint32_t length;
+
+    uint32_t anchorOffset;                  // Posição da âncora dentro do padrão
+    uint16_t anchor;                        // bytes[anchorOffset] | bytes[anchorOffset + 1] << 8
+    uint8_t bucket;
+
+    uint32_t firstOffset;                   // Offset na imagem (SCAN_NOT_FOUND se não achou)
+    uint32_t matchCount;
+
+    // "8B 15 ? ? ? ? A8 02" (?? também vale como curinga)
+    bool Parse(const char* text) {
+        length = 0;
+        const char* p = text;
+        while (*p) {
+            if (*p == ' ') { p++; continue; }
+            if (length >= SCAN_MAX_PATTERN_BYTES) return false;
+
+            if (*p == '?') {
+                bytes[length] = 0;
+                mask[length] = 0;
+                length++;
+                p++;
+                if (*p == '?') p++;
+                continue;
+            }
+
+            int hi = HexDigit(p[0]);
+            int lo = p[1] ? HexDigit(p[1]) : -1;
+            if (hi < 0 || lo < 0) return false;
+            bytes[length] = (uint8_t)(hi << 4 | lo);
+            mask[length] = 0xFF;
+            length++;
+            p += 2;
+        }
+        return ChooseAnchor();
+    }
+
+    bool MatchesAt(const uint8_t* image, uint32_t size, uint32_t offset) const {
+        if (offset > size || size - offset < length) return false;
+        const uint8_t* at = image + offset;
+        for (uint32_t i = 0; i < length; i++) {
+            if ((at[i] & mask[i]) != bytes[i]) return false;
+        }
+        return true;
+    }
+
+private:
+    static int HexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    }
+
+    // Par de bytes fixos vizinhos com menor peso. Sem par: padrão inválido.
+    bool ChooseAnchor() {
+        uint32_t best = 0xFFFFFFFFu;
+        for (uint32_t i = 0; i + 1 < length; i++) {
+            if (!mask[i] || !mask[i + 1]) continue;
+            uint32_t weight = ScanByteWeight(bytes[i]) + ScanByteWeight(bytes[i + 1]);
+            if (weight < best) {
+                best = weight;
+                anchorOffset = i;
+            }
+        }
+        if (best == 0xFFFFFFFFu) return false;
+        anchor = (uint16_t)(bytes[anchorOffset] | bytes[anchorOffset + 1] << 8);
+        return true;
+    }
+};
+
+//=============================================================================
+// SCANNER
+//=============================================================================
+
+class PatternScanner {
+public:
+    static PatternScanner& Instance() {
+        static PatternScanner instance;
+        return instance;
+    }
+
+    // Registra um padrão. Retorna o id ou -1 (texto inválido / sem espaço).
+    int Add(const char* name, const char* text) {
+        if (m_count >= SCAN_MAX_PATTERNS) return -1;
+
+        ScanPattern& p = m_patterns[m_count];
+        memset(&p, 0, sizeof(p));
+        p.name = name;
+        if (!p.Parse(text)) return -1;
+
+        p.firstOffset = SCAN_NOT_FOUND;
+        m_patternHash = ScanHash(text, strlen(text) + 1, m_patternHash);
+        m_built = false;
+        return (int)m_count++;
+    }
+
+    uint32_t PatternCount() const { return m_count; }
+    const ScanPattern& Pattern(int id) const { return m_patterns[id]; }
+
+    // Imagem onde os offsets são procurados/resolvidos
+    void SetImage(const uint8_t* base, uint32_t size) {
+        m_image = base;
+        m_imageSize = size;
+    }
+
+    // Procura todos os padrões numa passada
+    void Scan() {
+        if (!m_built) Build();
+
+        for (uint32_t i = 0; i < m_count; i++) {
+            m_patterns[i].firstOffset = SCAN_NOT_FOUND;
+            m_patterns[i].matchCount = 0;
+        }
+        if (!m_image || m_count == 0) return;
+
+#ifdef COOP_SCANNER_X86
+        if (CpuHasSsse3()) {
+            ScanSsse3();
+            return;
+        }
+#endif
+        ScanScalar(0);
+    }
+
+    // Endereço do primeiro match + offset (nullptr se não achou)
+    const uint8_t* Find(int id, uint32_t offset = 0) const {
+        if (id < 0 || (uint32_t)id >= m_count || !m_image) return nullptr;
+        const ScanPattern& p = m_patterns[id];
+        return p.firstOffset == SCAN_NOT_FOUND ? nullptr : m_image + p.firstOffset + offset;
+    }
+
+    uint32_t MatchCount(int id) const {
+        return (id < 0 || (uint32_t)id >= m_count) ? 0 : m_patterns[id].matchCount;
+    }
+
+    //-------------------------------------------------------------------------
+    // Cache em disco
+    //-------------------------------------------------------------------------
+
+    // Chave da imagem + conjunto de padrões (muda se qualquer um mudar)
+    uint64_t CacheKey(uint64_t imageKey) const {
+        return ScanHash(&m_patternHash, sizeof(m_patternHash), imageKey);
+    }
+
+    // Carrega resultados válidos para esta imagem. Cada hit do cache é
+    // conferido contra a imagem; qualquer divergência descarta o cache.
+    bool LoadCache(const char* path, uint64_t imageKey) {
+        FILE* file = fopen(path, "rb");
+        if (!file) return false;
+
+        CacheHeader header;
+        bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+                  header.magic == CACHE_MAGIC && header.key == CacheKey(imageKey) &&
+                  header.count == m_count;
+
+        CacheEntry entries[SCAN_MAX_PATTERNS];
+        if (ok) ok = fread(entries, sizeof(CacheEntry), m_count, file) == m_count;
+        fclose(file);
+        if (!ok) return false;
+
+        for (uint32_t i = 0; i < m_count; i++) {
+            if (entries[i].firstOffset != SCAN_NOT_FOUND &&
+                !m_patterns[i].MatchesAt(m_image, m_imageSize, entries[i].firstOffset)) {
+                return false;
+            }
+        }
+
+        for (uint32_t i = 0; i < m_count; i++) {
+            m_patterns[i].firstOffset = entries[i].firstOffset;
+            m_patterns[i].matchCount = entries[i].matchCount;
+        }
+        return true;
+    }
+
+    bool SaveCache(const char* path, uint64_t imageKey) const {
+        FILE* file = fopen(path, "wb");
+        if (!file) return false;
+
+        CacheHeader header;
+        header.magic = CACHE_MAGIC;
+        header.count = m_count;
+        header.key = CacheKey(imageKey);
+
+        CacheEntry entries[SCAN_MAX_PATTERNS];
+        for (uint32_t i = 0; i < m_count; i++) {
+            entries[i].firstOffset = m_patterns[i].firstOffset;
+            entries[i].matchCount = m_patterns[i].matchCount;
+        }
+
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(entries, sizeof(CacheEntry), m_count, file) == m_count;
+        fclose(file);
+        return ok;
+    }
+
+    // Escaneia o executável do jogo (ou lê do cache ao lado dele).
+    // Retorna true se os resultados vieram do cache.
+    bool ScanModule() {
+        const uint8_t* base = (const uint8_t*)GetModuleHandleA(nullptr);
+        const IMAGE_DOS_HEADER* dos = (const IMAGE_DOS_HEADER*)base;
+        const IMAGE_NT_HEADERS* nt = (const IMAGE_NT_HEADERS*)(base + dos->e_lfanew);
+        SetImage(base, nt->OptionalHeader.SizeOfImage);
+
+        // Headers + tabela de seções: mudam com qualquer build/patch do exe
+        uint32_t headerSize = nt->OptionalHeader.SizeOfHeaders;
+        uint64_t imageKey = ScanHash(base, headerSize);
+
+        char path[MAX_PATH];
+        CoopDataPath(SCAN_CACHE_FILE, path);
+
+        if (LoadCache(path, imageKey)) return true;
+
+        Scan();
+        SaveCache(path, imageKey);
+        return false;
+    }
+
+private:
+    PatternScanner() = default;
+
+    static constexpr uint32_t CACHE_MAGIC = 0x53344552;    // "RE4S"
+    static constexpr uint16_t NO_PATTERN = 0xFFFF;
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t count;
+        uint64_t key;
+    };
+
+    struct CacheEntry {
+        uint32_t firstOffset;
+        uint32_t matchCount;
+    };
+
+    // Buckets (tabelas de nibble) e listas por âncora
+    void Build() {
+        memset(m_nibbles, 0, sizeof(m_nibbles));
+        for (uint32_t i = 0; i < 65536; i++) m_anchorHead[i] = NO_PATTERN;
+
+        // Âncoras iguais caem no mesmo bucket; as distintas se espalham
+        uint32_t distinct = 0;
+        for (uint32_t i = m_count; i-- > 0;) {
+            ScanPattern& p = m_patterns[i];
+            uint16_t head = m_anchorHead[p.anchor];
+            p.bucket = head != NO_PATTERN ? m_patterns[head].bucket : (uint8_t)(distinct++ % SCAN_BUCKETS);
+
+            m_anchorNext[i] = head;
+            m_anchorHead[p.anchor] = (uint16_t)i;
+
+            uint8_t bit = (uint8_t)(1u << p.bucket);
+            uint8_t c0 = (uint8_t)p.anchor, c1 = (uint8_t)(p.anchor >> 8);
+            m_nibbles[0][c0 & 0xF] |= bit;
+            m_nibbles[1][c0 >> 4] |= bit;
+            m_nibbles[2][c1 & 0xF] |= bit;
+            m_nibbles[3][c1 >> 4] |= bit;
+        }
+        m_built = true;
+    }
+
+    // Candidata em pos: confirma os padrões com exatamente esta âncora
+    void Verify(uint32_t pos) {
+        uint16_t value = (uint16_t)(m_image[pos] | m_image[pos + 1] << 8);
+
+        for (uint16_t i = m_anchorHead[value]; i != NO_PATTERN; i = m_anchorNext[i]) {
+            ScanPattern& p = m_patterns[i];
+            if (pos < p.anchorOffset) continue;
+
+            uint32_t start = pos - p.anchorOffset;
+            if (!p.MatchesAt(m_image, m_imageSize, start)) continue;
+
+            if (p.matchCount == 0) p.firstOffset = start;
+            p.matchCount++;
+        }
+    }
+
+    void ScanScalar(uint32_t from) {
+        if (m_imageSize < 2) return;
+        for (uint32_t pos = from; pos + 1 < m_imageSize; pos++) {
+            uint16_t value = (uint16_t)(m_image[pos] | m_image[pos + 1] << 8);
+            if (m_anchorHead[value] != NO_PATTERN) Verify(pos);
+        }
+    }
+
+#ifdef COOP_SCANNER_X86
+    COOP_TARGET_SSSE3 void ScanSsse3() {
+        const __m128i lo0 = _mm_loadu_si128((const __m128i*)m_nibbles[0]);
+        const __m128i hi0 = _mm_loadu_si128((const __m128i*)m_nibbles[1]);
+        const __m128i lo1 = _mm_loadu_si128((const __m128i*)m_nibbles[2]);
+        const __m128i hi1 = _mm_loadu_si128((const __m128i*)m_nibbles[3]);
+        const __m128i low4 = _mm_set1_epi8(0x0F);
+        const __m128i zero = _mm_setzero_si128();
+
+        uint32_t pos = 0;
+        for (; pos + 17 <= m_imageSize; pos += 16) {
+            __m128i v0 = _mm_loadu_si128((const __m128i*)(m_image + pos));
+            __m128i v1 = _mm_loadu_si128((const __m128i*)(m_image + pos + 1));
+
+            // Buckets cujo 1º byte da âncora bate em cada posição...
+            __m128i r = _mm_and_si128(_mm_shuffle_epi8(lo0, _mm_and_si128(v0, low4)),
+                                      _mm_shuffle_epi8(hi0, _mm_and_si128(_mm_srli_epi16(v0, 4), low4)));
+            // ...e cujo 2º byte bate na seguinte
+            r = _mm_and_si128(r, _mm_shuffle_epi8(lo1, _mm_and_si128(v1, low4)));
+            r = _mm_and_si128(r, _mm_shuffle_epi8(hi1, _mm_and_si128(_mm_srli_epi16(v1, 4), low4)));
+
+            uint32_t hits = ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(r, zero)) & 0xFFFF;
+            if (!hits) continue;
+
+            while (hits) {
+                uint32_t j = ScanLowestBit(hits);
+                hits &= hits - 1;
+
+                // Bucket é só filtro: a âncora exata decide
+                uint16_t value = (uint16_t)(m_image[pos + j] | m_image[pos + j + 1] << 8);
+                if (m_anchorHead[value] != NO_PATTERN) Verify(pos + j);
+            }
+        }
+        ScanScalar(pos);
+    }
+#endif
+
+    ScanPattern m_patterns[SCAN_MAX_PATTERNS];
+    uint32_t m_count = 0;
+    uint64_t m_patternHash = 0xCBF29CE484222325ull;
+
+    const uint8_t* m_image = nullptr;
+    uint32_t m_imageSize = 0;
+
+    bool m_built = false;
+    uint16_t m_anchorHead[65536];           // Primeiro padrão com a âncora
+    uint16_t m_anchorNext[SCAN_MAX_PATTERNS];
+    uint8_t m_nibbles[4][16];               // lo/hi do 1º byte, lo/hi do 2º byte
+};
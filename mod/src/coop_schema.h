@@ -0,0 +1,371 @@
+/**
+ * RE4 CO-OP MOD - Schema de Pacotes em Compile-Time
+ *
+ * Cada pacote descreve seus campos uma vez (membro, codec, flags de
+ * replicação) e o compilador gera Encode/Decode/EncodeDelta/DecodeDelta/
+ * Validate totalmente especializados. Não há tabela nem reflexão em
+ * runtime: tudo vira uma sequência fixa de shifts e stores.
+ *
+ *   using InputSchema = PacketSchema<PlayerInputPacket,
+ *       Field<&PlayerInputPacket::moveX, QuantFloat<-1, 1, 16>>,
+ *       Field<&PlayerInputPacket::buttons, UIntBits<uint16_t, 12>, REPL_ALWAYS>>;
+ *
+ * Faixas de quantização são inteiras porque o C++17 não aceita float
+ * como parâmetro de template.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <type_traits>
+
+//=============================================================================
+// STREAM DE BITS
+//=============================================================================
+
+class BitWriter {
+public:
+    BitWriter(uint8_t* out, uint32_t capacity) : m_out(out), m_capacity(capacity) {}
+
+    // bits <= 32
+    void Write(uint32_t value, uint32_t bits) {
+        if (bits < 32) value &= (1u << bits) - 1;
+        m_scratch |= (uint64_t)value << m_scratchBits;
+        m_scratchBits += bits;
+
+        // Descarrega 32 bits por vez (little-endian)
+        if (m_scratchBits >= 32) {
+            if (m_size + 4 <= m_capacity) {
+                // Pelo ponteiro o compilador junta os 4 bytes num store só
+                // (m_size + k em uint32_t poderia dar a volta)
+                uint32_t word = (uint32_t)m_scratch;
+                uint8_t* dst = m_out + m_size;
+                dst[0] = (uint8_t)word;
+                dst[1] = (uint8_t)(word >> 8);
+                dst[2] = (uint8_t)(word >> 16);
+                dst[3] = (uint8_t)(word >> 24);
+                m_size += 4;
+            }
+            else {
+                m_overflow = true;
+            }
+            m_scratch >>= 32;
+            m_scratchBits -= 32;
+        }
+    }
+
+    // Descarrega os bits pendentes. Retorna bytes usados.
+    uint32_t Flush() {
+        while (m_scratchBits > 0) {
+            if (m_size < m_capacity) m_out[m_size++] = (uint8_t)m_scratch;
+            else m_overflow = true;
+            m_scratch >>= 8;
+            m_scratchBits = m_scratchBits > 8 ? m_scratchBits - 8 : 0;
+        }
+        return m_size;
+    }
+
+    bool Overflow() const { return m_overflow; }
+
+private:
+
+    uint8_t* m_out;
+    uint32_t m_capacity;
+    uint32_t m_size = 0;
+    uint64_t m_scratch = 0;
+    uint32_t m_scratchBits = 0;
+    bool m_overflow = false;
+};
+
+class BitReader {
+public:
+    BitReader(const uint8_t* data, uint32_t size) : m_data(data), m_size(size) {}
+
+    // Ler além do fim devolve zeros e marca Overflow()
+    uint32_t Read(uint32_t bits) {
+        if (m_scratchBits < bits) {
+            // Recarrega 32 bits por vez (cabe: sobram no máximo 31 no scratch);
+            // byte a byte só no fim do buffer
+            if (m_pos + 4 <= m_size) {
+                const uint8_t* src = m_data + m_pos;
+                uint32_t word = (uint32_t)src[0] | ((uint32_t)src[1] << 8) |
+                                ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+                m_scratch |= (uint64_t)word << m_scratchBits;
+                m_scratchBits += 32;
+                m_pos += 4;
+            }
+            else {
+                while (m_scratchBits < bits) {
+                    uint8_t byte = 0;
+                    if (m_pos < m_size) byte = m_data[m_pos++];
+                    else m_overflow = true;
+                    m_scratch |= (uint64_t)byte << m_scratchBits;
+                    m_scratchBits += 8;
+                }
+            }
+        }
+
+        uint32_t value = (uint32_t)(bits < 32 ? m_scratch & ((1ull << bits) - 1) : m_scratch);
+        m_scratch >>= bits;
+        m_scratchBits -= bits;
+        return value;
+    }
+
+    bool Overflow() const { return m_overflow; }
+
+private:
+    const uint8_t* m_data;
+    uint32_t m_size;
+    uint32_t m_pos = 0;
+    uint64_t m_scratch = 0;
+    uint32_t m_scratchBits = 0;
+    bool m_overflow = false;
+};
+
+//=============================================================================
+// CODECS
+//=============================================================================
+
+// Inteiro cru (8/16/32 bits)
+template<typename T>
+struct RawInt {
+    static_assert(std::is_integral<T>::value && sizeof(T) <= 4, "RawInt: inteiro de até 32 bits");
+    static constexpr uint32_t BITS = sizeof(T) * 8;
+
+    static void Write(BitWriter& w, T v) { w.Write((uint32_t)(typename std::make_unsigned<T>::type)v, BITS); }
+    static void Read(BitReader& r, T& v) { v = (T)r.Read(BITS); }
+    static bool Same(T a, T b) { return a == b; }
+    static bool Valid(T) { return true; }
+};
+
+// Inteiro sem sinal que cabe em Bits (ex.: bitmask de 12 botões)
+template<typename T, uint32_t Bits>
+struct UIntBits {
+    static_assert(std::is_unsigned<T>::value && Bits >= 1 && Bits <= sizeof(T) * 8, "UIntBits: faixa inválida");
+    static constexpr uint32_t BITS = Bits;
+
+    static void Write(BitWriter& w, T v) { w.Write((uint32_t)v, BITS); }
+    static void Read(BitReader& r, T& v) { v = (T)r.Read(BITS); }
+    static bool Same(T a, T b) { return a == b; }
+    static bool Valid(T v) { return Bits >= 32 || ((uint64_t)v >> Bits) == 0; }
+};
+
+// Float em [Min, Max] com Bits de resolução (fora da faixa é saturado)
+template<int32_t Min, int32_t Max, uint32_t Bits>
+struct QuantFloat {
+    static_assert(Min < Max, "QuantFloat: Min >= Max");
+    static_assert(Bits >= 2 && Bits <= 24, "QuantFloat: precisão do float acaba em 24 bits");
+    static constexpr uint32_t BITS = Bits;
+    static constexpr uint32_t STEPS = (1u << Bits) - 1;
+    static constexpr float SCALE = (float)STEPS / (float)(Max - Min);
+
+    static uint32_t Quantize(float v) {
+        if (!(v > (float)Min)) return 0;        // Também pega NaN
+        if (v >= (float)Max) return STEPS;
+        return (uint32_t)((v - (float)Min) * SCALE + 0.5f);
+    }
+
+    static float Dequantize(uint32_t q) { return (float)Min + (float)q / SCALE; }
+
+    static void Write(BitWriter& w, float v) { w.Write(Quantize(v), BITS); }
+    static void Read(BitReader& r, float& v) { v = Dequantize(r.Read(BITS)); }
+    static bool Same(float a, float b) { return Quantize(a) == Quantize(b); }
+    static bool Valid(float v) { return v >= (float)Min && v <= (float)Max; }
+};
+
+// Vetor com os três eixos na mesma faixa
+template<int32_t Min, int32_t Max, uint32_t Bits>
+struct QuantVec {
+    using Axis = QuantFloat<Min, Max, Bits>;
+    static constexpr uint32_t BITS = Axis::BITS * 3;
+
+    template<typename V>
+    static void Write(BitWriter& w, const V& v) {
+        Axis::Write(w, v.x);
+        Axis::Write(w, v.y);
+        Axis::Write(w, v.z);
+    }
+
+    template<typename V>
+    static void Read(BitReader& r, V& v) {
+        Axis::Read(r, v.x);
+        Axis::Read(r, v.y);
+        Axis::Read(r, v.z);
+    }
+
+    template<typename V>
+    static bool Same(const V& a, const V& b) {
+        return Axis::Same(a.x, b.x) && Axis::Same(a.y, b.y) && Axis::Same(a.z, b.z);
+    }
+
+    template<typename V>
+    static bool Valid(const V& v) { return Axis::Valid(v.x) && Axis::Valid(v.y) && Axis::Valid(v.z); }
+};
+
+//=============================================================================
+// CAMPOS E SCHEMA
+//=============================================================================
+
+// Flags de replicação
+enum ReplicationFlags : uint8_t {
+    REPL_ON_CHANGE = 0,         // No delta só quando muda (depois de quantizar)
+    REPL_ALWAYS = 1 << 0,       // Vai em todo delta (ex.: botões, que o host consome por borda)
+};
+
+template<typename M> struct MemberTraits;
+template<typename S, typename T>
+struct MemberTraits<T S::*> {
+    using Struct = S;
+    using Type = T;
+};
+
+template<auto Member, typename Codec, uint8_t Flags = REPL_ON_CHANGE>
+struct Field {
+    using Struct = typename MemberTraits<decltype(Member)>::Struct;
+    using Type = typename MemberTraits<decltype(Member)>::Type;
+
+    static constexpr uint32_t BITS = Codec::BITS;
+    static constexpr bool ALWAYS = (Flags & REPL_ALWAYS) != 0;
+
+    // Campos de structs packed: copia por valor, nunca liga referência ao membro
+    static void Write(BitWriter& w, const Struct& s) {
+        Type value = s.*Member;
+        Codec::Write(w, value);
+    }
+
+    static void Read(BitReader& r, Struct& s) {
+        Type value;
+        Codec::Read(r, value);
+        s.*Member = value;
+    }
+
+    static bool Changed(const Struct& base, const Struct& s) {
+        Type a = base.*Member, b = s.*Member;
+        return ALWAYS || !Codec::Same(a, b);
+    }
+
+    static bool Valid(const Struct& s) {
+        Type value = s.*Member;
+        return Codec::Valid(value);
+    }
+};
+
+// Campo de um elemento de array do pacote: (s.*Array)[Index].*Member
+// (ex.: um campo de cada slot de player)
+template<typename M> struct ArrayMemberTraits;
+template<typename S, typename E, size_t N>
+struct ArrayMemberTraits<E (S::*)[N]> {
+    using Struct = S;
+    using Element = E;
+    static constexpr size_t COUNT = N;
+};
+
+template<auto Array, uint32_t Index, auto Member, typename Codec, uint8_t Flags = REPL_ON_CHANGE>
+struct SlotField {
+    using Struct = typename ArrayMemberTraits<decltype(Array)>::Struct;
+    using Element = typename ArrayMemberTraits<decltype(Array)>::Element;
+    using Type = typename MemberTraits<decltype(Member)>::Type;
+
+    static_assert(Index < ArrayMemberTraits<decltype(Array)>::COUNT, "SlotField: índice fora do array");
+    static_assert(std::is_same<typename MemberTraits<decltype(Member)>::Struct, Element>::value,
+                  "SlotField: membro de outro struct");
+
+    static constexpr uint32_t BITS = Codec::BITS;
+    static constexpr bool ALWAYS = (Flags & REPL_ALWAYS) != 0;
+
+    static void Write(BitWriter& w, const Struct& s) {
+        Type value = (s.*Array)[Index].*Member;
+        Codec::Write(w, value);
+    }
+
+    static void Read(BitReader& r, Struct& s) {
+        Type value;
+        Codec::Read(r, value);
+        (s.*Array)[Index].*Member = value;
+    }
+
+    static bool Changed(const Struct& base, const Struct& s) {
+        Type a = (base.*Array)[Index].*Member, b = (s.*Array)[Index].*Member;
+        return ALWAYS || !Codec::Same(a, b);
+    }
+
+    static bool Valid(const Struct& s) {
+        Type value = (s.*Array)[Index].*Member;
+        return Codec::Valid(value);
+    }
+};
+
+template<typename S, typename... Fields>
+struct PacketSchema {
+    using Struct = S;
+    
+    static constexpr uint32_t FIELD_COUNT = sizeof...(Fields);
+    static_assert(FIELD_COUNT >= 1 && FIELD_COUNT <= 32, "PacketSchema: 1 a 32 campos");
+    static_assert((std::is_same<typename Fields::Struct, S>::value && ...), "campo de outro struct");
+
+    static constexpr uint32_t FULL_BITS = (Fields::BITS + ...);
+    static constexpr uint32_t MAX_DELTA_BITS = FIELD_COUNT + FULL_BITS;
+    static constexpr uint32_t MAX_BYTES = (MAX_DELTA_BITS + 7) / 8;
+
+    static void Encode(BitWriter& w, const S& s) {
+        (Fields::Write(w, s), ...);
+    }
+
+    static void Decode(BitReader& r, S& s) {
+        BitReader local = r;
+        (Fields::Read(local, s), ...);
+        r = local;
+    }
+
+    // Máscara de campos alterados + só os alterados
+    static void EncodeDelta(BitWriter& w, const S& base, const S& s) {
+        uint32_t mask = ChangedMask(base, s);
+        w.Write(mask, FIELD_COUNT);
+
+        uint32_t bit = 0;
+        ((mask & (1u << bit++) ? Fields::Write(w, s) : void()), ...);
+    }
+
+    // out começa como cópia de base e recebe só os campos da máscara
+    static void DecodeDelta(BitReader& r, const S& base, S& out) {
+        out = base;
+        uint32_t mask = r.Read(FIELD_COUNT);
+
+        uint32_t bit = 0;
+        ((mask & (1u << bit++) ? Fields::Read(r, out) : void()), ...);
+    }
+
+    static uint32_t ChangedMask(const S& base, const S& s) {
+        uint32_t mask = 0, bit = 0;
+        ((mask |= Fields::Changed(base, s) ? (1u << bit) : 0u, bit++), ...);
+        return mask;
+    }
+
+    // Faixas e NaN (antes de mandar e depois de receber)
+    static bool Validate(const S& s) {
+        return (Fields::Valid(s) && ...);
+    }
+};
+
+//=============================================================================
+// MAPA DE BOTÕES (bool do struct <-> bit da máscara)
+//=============================================================================
+
+template<auto Member, uint16_t Mask>
+struct ButtonBit {
+    using Struct = typename MemberTraits<decltype(Member)>::Struct;
+
+    static uint16_t Pack(const Struct& s) { return (s.*Member) ? Mask : 0; }
+    static void Unpack(Struct& s, uint16_t bits) { s.*Member = (bits & Mask) != 0; }
+};
+
+template<typename... Bits>
+struct ButtonMap {
+    template<typename S>
+    static uint16_t Pack(const S& s) { return (uint16_t)(Bits::Pack(s) | ... | 0); }
+
+    template<typename S>
+    static void Unpack(S& s, uint16_t bits) { (Bits::Unpack(s, bits), ...); }
+};
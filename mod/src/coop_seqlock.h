@@ -0,0 +1,119 @@
+/**
+ * RE4 CO-OP MOD - Seqlock (publicação entre threads sem mutex)
+ *
+ * Um escritor publica um valor inteiro; qualquer número de leitores pega
+ * uma cópia consistente, sem lock dos dois lados:
+ *
+ * - Store() nunca espera (incrementa a sequência para ímpar, copia,
+ *   volta para par)
+ * - Load() copia e confere a sequência; se o escritor passou no meio,
+ *   copia de novo. O escritor não espera pelos leitores.
+ *
+ * O valor fica em palavras std::atomic<uint32_t> acessadas com relaxed
+ * (nativo em x86 e x64; atomic<uint64_t> no x86 vira cmpxchg8b). Assim a
+ * cópia concorrente não é data race e as fences fazem o resto.
+ *
+ *   SeqLock<GameStatePacket> m_gameState;       // Thread de recepção
+ *   m_gameState.Store(state);
+ *   GameStatePacket state = m_gameState.Load(); // Thread do jogo
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define COOP_SEQLOCK_PAUSE 1
+#include <emmintrin.h>
+#endif
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+// Tentativas com pause antes de ceder a CPU (escritor preemptado no meio)
+constexpr uint32_t SEQLOCK_SPINS_BEFORE_YIELD = 64;
+
+//=============================================================================
+// SEQLOCK
+//=============================================================================
+
+template<typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "seqlock: T é copiado palavra por palavra");
+
+public:
+    // Começa zerado (versão 0)
+    SeqLock() {
+        for (uint32_t i = 0; i < WORDS; i++) m_words[i].store(0, std::memory_order_relaxed);
+    }
+
+    // Só o escritor chama
+    void Store(const T& value) {
+        uint32_t words[WORDS];
+        words[WORDS - 1] = 0;
+        memcpy(words, &value, sizeof(T));
+
+        uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (uint32_t i = 0; i < WORDS; i++) {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Cópia consistente. Retorna a versão (quantos Store já terminaram).
+    uint32_t Load(T& out) const {
+        uint32_t words[WORDS];
+        uint32_t spins = 0;
+
+        for (;;) {
+            uint32_t before = m_sequence.load(std::memory_order_acquire);
+            if (!(before & 1)) {
+                for (uint32_t i = 0; i < WORDS; i++) {
+                    words[i] = m_words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_sequence.load(std::memory_order_relaxed) == before) {
+                    memcpy((void*)&out, words, sizeof(T));
+                    return before / 2;
+                }
+            }
+            Backoff(spins);
+        }
+    }
+
+    T Load() const {
+        T out;
+        Load(out);
+        return out;
+    }
+
+    // Versão publicada, sem copiar (para saber se vale a pena ler)
+    uint32_t Version() const {
+        return m_sequence.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static constexpr uint32_t WORDS = (uint32_t)((sizeof(T) + 3) / 4);
+
+    static void Backoff(uint32_t& spins) {
+        if (++spins < SEQLOCK_SPINS_BEFORE_YIELD) {
+#ifdef COOP_SEQLOCK_PAUSE
+            _mm_pause();
+#endif
+            return;
+        }
+        spins = 0;
+        std::this_thread::yield();
+    }
+
+    alignas(64) std::atomic<uint32_t> m_sequence{0};
+    std::atomic<uint32_t> m_words[WORDS];
+};
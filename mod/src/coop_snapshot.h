@@ -0,0 +1,280 @@
+/**
+ * RE4 CO-OP MOD - Snapshot de Entidades (SoA)
+ *
+ * Uma vez por tick de rede o host percorre os players e a lista do EmMgr
+ * e copia pose/vida/flags para arrays separados por campo. A comparação
+ * com o tick anterior roda em SSE2, 4 entidades por vez, e gera uma
+ * máscara de campos sujos por entidade. A replicação lê daqui em vez de
+ * espalhar leituras pela memória do jogo.
+ *
+ * Layout: players primeiro (na ordem dos slots válidos), depois os
+ * inimigos vivos na ordem do EmMgr. Slots depois de count ficam zerados
+ * até o múltiplo de 4, então o diff nunca precisa de laço de sobra.
+ */
+
+#pragma once
+#include "coop_core.h"
+#include "coop_game_memory.h"
+#include "coop_bulk.h"
+#include "coop_entity_cache.h"
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define COOP_SNAPSHOT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+//=============================================================================
+// FORMATO
+//=============================================================================
+
+constexpr uint32_t SNAPSHOT_MAX_ENTITIES = BULK_MAX_RECORDS;
+static_assert(SNAPSHOT_MAX_ENTITIES % 4 == 0, "snapshot: capacidade múltipla de 4");
+
+// Campos que mudaram desde o tick anterior
+enum SnapshotDirty : uint8_t {
+    DIRTY_POS = 1 << 0,
+    DIRTY_HP = 1 << 1,          // hp ou hpMax
+    DIRTY_FLAGS = 1 << 2,
+    DIRTY_STATE = 1 << 3,
+    DIRTY_SPAWN = 1 << 4,       // Entidade nova no slot (ou primeiro snapshot)
+    DIRTY_ALL = 0x1F,
+};
+
+// Identidade estável de uma entidade entre ticks (nunca 0)
+inline uint32_t SnapshotId(RoomRecordKind kind, uint16_t index) {
+    return ((uint32_t)kind << 16) | index;
+}
+
+struct EntitySnapshot {
+    uint32_t count;
+    uint16_t roomId;
+
+    alignas(16) uint32_t id[SNAPSHOT_MAX_ENTITIES];
+    alignas(16) float posX[SNAPSHOT_MAX_ENTITIES];
+    alignas(16) float posY[SNAPSHOT_MAX_ENTITIES];
+    alignas(16) float posZ[SNAPSHOT_MAX_ENTITIES];
+    alignas(16) int16_t hp[SNAPSHOT_MAX_ENTITIES];
+    alignas(16) int16_t hpMax[SNAPSHOT_MAX_ENTITIES];
+    alignas(16) uint32_t flags[SNAPSHOT_MAX_ENTITIES];
+    alignas(16) uint32_t state[SNAPSHOT_MAX_ENTITIES];     // PlayerState (0 para inimigos)
+
+    cEm* entity[SNAPSHOT_MAX_ENTITIES];
+
+    Vec Pos(uint32_t i) const { return { posX[i], posY[i], posZ[i] }; }
+    RoomRecordKind Kind(uint32_t i) const { return (RoomRecordKind)(id[i] >> 16); }
+    uint16_t Index(uint32_t i) const { return (uint16_t)id[i]; }
+
+    // Índice do player (slot de g_PlayerSlots) ou -1 se ele não estava na sala
+    int32_t PlayerSlot(uint16_t player) const {
+        uint32_t wanted = SnapshotId(RoomRecordKind::PLAYER, player);
+        for (uint32_t i = 0; i < count && i < ENTITY_CACHE_SLOTS; i++) {
+            if (id[i] == wanted) return (int32_t)i;
+        }
+        return -1;
+    }
+};
+
+//=============================================================================
+// DIFF
+//=============================================================================
+
+inline uint32_t SnapshotLanes(uint32_t count) { return (count + 3) & ~3u; }
+
+// dirty[i] = campos de cur que mudaram em relação a prev, para i < cur.count.
+// Retorna quantas entidades têm algum campo sujo.
+inline uint32_t DiffSnapshots(const EntitySnapshot& prev, const EntitySnapshot& cur, uint8_t* dirty) {
+    uint32_t lanes = SnapshotLanes(cur.count);
+    uint32_t dirtyCount = 0;
+
+#ifdef COOP_SNAPSHOT_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bitPos = _mm_set1_epi32(DIRTY_POS);
+    const __m128i bitHp = _mm_set1_epi32(DIRTY_HP);
+    const __m128i bitFlags = _mm_set1_epi32(DIRTY_FLAGS);
+    const __m128i bitState = _mm_set1_epi32(DIRTY_STATE);
+    const __m128i bitAll = _mm_set1_epi32(DIRTY_ALL);
+    static const uint8_t CLEAN_COUNT[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+    uint8_t lastGroup[4];
+
+    for (uint32_t i = 0; i < lanes; i += 4) {
+        #define SNAP_EQ32(field) _mm_cmpeq_epi32(_mm_load_si128((const __m128i*)&cur.field[i]), \
+                                                 _mm_load_si128((const __m128i*)&prev.field[i]))
+        #define SNAP_EQ16(field) _mm_cmpeq_epi16(_mm_loadl_epi64((const __m128i*)&cur.field[i]), \
+                                                 _mm_loadl_epi64((const __m128i*)&prev.field[i]))
+
+        // Posição comparada bit a bit (mudança exata, sem tolerância)
+        __m128i samePos = _mm_and_si128(_mm_and_si128(SNAP_EQ32(posX), SNAP_EQ32(posY)), SNAP_EQ32(posZ));
+
+        // hp/hpMax são 16 bits: expande a máscara para 32 bits por entidade
+        __m128i sameHp16 = _mm_and_si128(SNAP_EQ16(hp), SNAP_EQ16(hpMax));
+        __m128i sameHp = _mm_unpacklo_epi16(sameHp16, sameHp16);
+
+        __m128i bits = _mm_andnot_si128(samePos, bitPos);
+        bits = _mm_or_si128(bits, _mm_andnot_si128(sameHp, bitHp));
+        bits = _mm_or_si128(bits, _mm_andnot_si128(SNAP_EQ32(flags), bitFlags));
+        bits = _mm_or_si128(bits, _mm_andnot_si128(SNAP_EQ32(state), bitState));
+        bits = _mm_or_si128(bits, _mm_andnot_si128(SNAP_EQ32(id), bitAll));   // Outra entidade no slot
+
+        #undef SNAP_EQ32
+        #undef SNAP_EQ16
+
+        // Lanes sem nenhum bit (o padding depois de count fica de fora)
+        uint32_t clean = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(bits, zero)));
+
+        // 4 x int32 -> 4 x uint8
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(bits, zero), zero);
+        uint32_t word = (uint32_t)_mm_cvtsi128_si32(packed);
+
+        if (i + 4 <= cur.count) {
+            memcpy(&dirty[i], &word, 4);
+            dirtyCount += 4 - CLEAN_COUNT[clean];
+        }
+        else {
+            memcpy(lastGroup, &word, 4);
+            for (uint32_t k = 0; i + k < cur.count; k++) {
+                dirty[i + k] = lastGroup[k];
+                if (!(clean & (1u << k))) dirtyCount++;
+            }
+        }
+    }
+#else
+    for (uint32_t i = 0; i < cur.count; i++) {
+        uint8_t bits = 0;
+        if (cur.posX[i] != prev.posX[i] || cur.posY[i] != prev.posY[i] || cur.posZ[i] != prev.posZ[i]) bits |= DIRTY_POS;
+        if (cur.hp[i] != prev.hp[i] || cur.hpMax[i] != prev.hpMax[i]) bits |= DIRTY_HP;
+        if (cur.flags[i] != prev.flags[i]) bits |= DIRTY_FLAGS;
+        if (cur.state[i] != prev.state[i]) bits |= DIRTY_STATE;
+        if (cur.id[i] != prev.id[i]) bits = DIRTY_ALL;
+        dirty[i] = bits;
+        if (bits) dirtyCount++;
+    }
+#endif
+
+    return dirtyCount;
+}
+
+//=============================================================================
+// EXTRAÇÃO (host, thread do jogo)
+//=============================================================================
+
+class SnapshotExtractor {
+public:
+    SnapshotExtractor() { Reset(); }
+
+    // Próximo Capture marca tudo como sujo
+    void Reset() {
+        memset(m_buffers, 0, sizeof(m_buffers));
+        memset(m_dirty, 0, sizeof(m_dirty));
+        m_current = 0;
+        m_dirtyCount = 0;
+    }
+
+    // Lê o jogo para o buffer livre e compara com o anterior
+    const EntitySnapshot& Capture() {
+        EntitySnapshot& prev = m_buffers[m_current];
+        EntitySnapshot& cur = m_buffers[m_current ^ 1];
+        uint32_t oldCount = cur.count;
+
+        cur.count = 0;
+        cur.roomId = CoopMod::CurrentRoomId();
+
+        const EntityCache& entities = EntityCache::Instance();
+        WithGameVersion([&](auto table) {
+            for (uint16_t i = 0; i < ENTITY_CACHE_SLOTS; i++) {
+                cPlayer* entity = entities.Player(i);
+                if (!entity) continue;
+                PlayerView player(table, entity);
+                Store(cur, SnapshotId(RoomRecordKind::PLAYER, i), (cEm*)entity,
+                      player.Gather(), player.PlayerState());
+            }
+
+            EmListView enemies(table, pEmMgr);
+            uint32_t enemyCount = enemies.Count();
+            for (uint32_t i = 0; i < enemyCount && cur.count < SNAPSHOT_MAX_ENTITIES; i++) {
+                if (i + 1 < enemyCount) COOP_PREFETCH(enemies.At(i + 1));
+                if (!enemies.IsAlive(i)) continue;
+
+                cEm* em = enemies.At(i);
+                Store(cur, SnapshotId(RoomRecordKind::ENEMY, (uint16_t)i), em,
+                      EmView(table, em).Gather(), 0);
+            }
+        });
+
+        // Todo buffer fica zerado depois de count: o diff lê os dois até o
+        // múltiplo de 4 e slot vazio (id 0) conta como entidade nova
+        if (oldCount > cur.count) ClearSlots(cur, cur.count, oldCount);
+
+        m_dirtyCount = DiffSnapshots(prev, cur, m_dirty);
+        m_current ^= 1;
+        return cur;
+    }
+
+    const EntitySnapshot& Current() const { return m_buffers[m_current]; }
+    const EntitySnapshot& Previous() const { return m_buffers[m_current ^ 1]; }
+
+    // Máscara SnapshotDirty por entidade de Current()
+    const uint8_t* Dirty() const { return m_dirty; }
+    uint32_t DirtyCount() const { return m_dirtyCount; }
+
+    uint8_t PlayerDirty(uint16_t player) const {
+        int32_t slot = Current().PlayerSlot(player);
+        return slot >= 0 ? m_dirty[slot] : 0;
+    }
+
+private:
+    static void Store(EntitySnapshot& s, uint32_t id, cEm* entity, const EntityState& state, uint32_t playerState) {
+        uint32_t i = s.count++;
+        s.id[i] = id;
+        s.posX[i] = state.pos.x;
+        s.posY[i] = state.pos.y;
+        s.posZ[i] = state.pos.z;
+        s.hp[i] = state.hp;
+        s.hpMax[i] = state.hpMax;
+        s.flags[i] = state.flags;
+        s.state[i] = playerState;
+        s.entity[i] = entity;
+    }
+
+    static void ClearSlots(EntitySnapshot& s, uint32_t begin, uint32_t end) {
+        if (end <= begin) return;
+        uint32_t n = end - begin;
+        memset(&s.id[begin], 0, n * sizeof(s.id[0]));
+        memset(&s.posX[begin], 0, n * sizeof(s.posX[0]));
+        memset(&s.posY[begin], 0, n * sizeof(s.posY[0]));
+        memset(&s.posZ[begin], 0, n * sizeof(s.posZ[0]));
+        memset(&s.hp[begin], 0, n * sizeof(s.hp[0]));
+        memset(&s.hpMax[begin], 0, n * sizeof(s.hpMax[0]));
+        memset(&s.flags[begin], 0, n * sizeof(s.flags[0]));
+        memset(&s.state[begin], 0, n * sizeof(s.state[0]));
+        memset(&s.entity[begin], 0, n * sizeof(s.entity[0]));
+    }
+
+    EntitySnapshot m_buffers[2];
+    uint32_t m_current;
+    uint8_t m_dirty[SNAPSHOT_MAX_ENTITIES];
+    uint32_t m_dirtyCount;
+};
+
+//=============================================================================
+// ESTADO DA SALA A PARTIR DO SNAPSHOT
+//=============================================================================
+
+inline uint32_t CollectRoomState(const EntitySnapshot& snapshot, RoomEntityRecord* out, uint32_t max) {
+    uint32_t n = 0;
+
+    for (uint32_t i = 0; i < snapshot.count && n < max; i++) {
+        RoomEntityRecord& record = out[n++];
+        memset(&record, 0, sizeof(record));
+        record.kind = snapshot.Kind(i);
+        record.index = snapshot.Index(i);
+        record.pos = snapshot.Pos(i);
+        record.hp = snapshot.hp[i];
+        record.hpMax = snapshot.hpMax[i];
+        record.flags = snapshot.flags[i];
+    }
+
+    // TODO: Itens e portas
+
+    return n;
+}
@@ -0,0 +1,271 @@
+/**
+ * RE4 CO-OP MOD - Índice de Pontos Seguros por Sala
+ *
+ * Lugares onde um player pode ficar de pé, para o teleporte não largar
+ * ninguém dentro de parede ou fora de um parapeito. Vêm de duas fontes:
+ *
+ * - Sonda de chão (SetFloorProbe): na entrada da sala, uma varredura em
+ *   grade de 50 cm pergunta ao jogo as alturas de chão de cada coluna
+ * - Rastro: posições por onde os players já andaram (se alguém esteve
+ *   ali, dá para ficar de pé ali), somadas enquanto a sala roda
+ *
+ * Os pontos ficam num hash espacial de células de 2 m no plano XZ. A
+ * consulta anda em anéis de células a partir do ponto pedido e para
+ * quando o anel já está mais longe que o melhor achado. O índice de cada
+ * sala vai para disco (re4coop_spawn_XXXX.cache) ao sair dela e é lido de
+ * volta na próxima entrada.
+ *
+ *   SafeSpawnIndex& spawns = ...;
+ *   spawns.EnterRoom(roomId);
+ *   Vec pos;
+ *   if (spawns.Nearest(desired, SPAWN_SEARCH_RADIUS, pos)) ...
+ */
+
+#pragma once
+#include "coop_core.h"
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+//=============================================================================
+// CONFIGURAÇÃO
+//=============================================================================
+
+constexpr uint32_t SPAWN_MAX_POINTS = 32768;
+constexpr uint32_t SPAWN_BUCKETS = 4096;                // Potência de 2
+constexpr float SPAWN_CELL_SIZE = 200.0f;
+constexpr float SPAWN_SPACING = 50.0f;                  // Pontos mais perto que isso não entram
+constexpr float SPAWN_FLOOR_TOLERANCE = 150.0f;         // Diferença de altura aceita (mesmo andar)
+constexpr float SPAWN_SEARCH_RADIUS = 600.0f;
+constexpr uint32_t SPAWN_MAX_FLOORS = 8;                // Chãos por coluna na sonda
+
+constexpr const char* SPAWN_CACHE_FORMAT = "re4coop_spawn_%04X.cache";
+
+// Alturas de chão onde dá para ficar de pé na coluna (x, z).
+// Retorna quantas escreveu em floors (no máximo max).
+typedef uint32_t (*SpawnFloorProbe)(float x, float z, float* floors, uint32_t max, void* user);
+
+//=============================================================================
+// ÍNDICE
+//=============================================================================
+
+class SafeSpawnIndex {
+public:
+    SafeSpawnIndex() { Clear(); }
+
+    void Clear() {
+        for (uint32_t b = 0; b < SPAWN_BUCKETS; b++) m_head[b] = NO_POINT;
+        m_count = 0;
+        m_dirty = false;
+    }
+
+    void SetFloorProbe(SpawnFloorProbe probe, void* user) {
+        m_probe = probe;
+        m_probeUser = user;
+    }
+
+    // Troca de sala: grava a anterior (se mudou) e carrega a nova do disco
+    void EnterRoom(uint16_t roomId) {
+        if (m_hasRoom && roomId == m_roomId) return;
+        if (m_hasRoom && m_dirty) Save();
+
+        Clear();
+        m_roomId = roomId;
+        m_hasRoom = true;
+        Load();
+    }
+
+    // Varre [min, max] no plano XZ com a sonda de chão. Retorna pontos novos.
+    uint32_t BuildFromProbe(const Vec& min, const Vec& max) {
+        if (!m_probe) return 0;
+
+        uint32_t added = 0;
+        float floors[SPAWN_MAX_FLOORS];
+        for (float z = min.z; z <= max.z; z += SPAWN_SPACING) {
+            for (float x = min.x; x <= max.x; x += SPAWN_SPACING) {
+                uint32_t n = m_probe(x, z, floors, SPAWN_MAX_FLOORS, m_probeUser);
+                for (uint32_t i = 0; i < n && i < SPAWN_MAX_FLOORS; i++) {
+                    // A grade já tem o espaçamento certo: sem checar vizinhos
+                    if (!Insert({ x, floors[i], z })) return added;
+                    added++;
+                }
+            }
+        }
+        return added;
+    }
+
+    // Ponto de rastro. Ignorado se já existe outro a menos de SPAWN_SPACING.
+    bool AddPoint(const Vec& pos) {
+        Vec near;
+        if (Nearest(pos, SPAWN_SPACING, near)) return false;
+        return Insert(pos);
+    }
+
+    // Ponto válido mais próximo de pos no mesmo andar (até maxDistance no XZ)
+    bool Nearest(const Vec& pos, float maxDistance, Vec& out) const {
+        if (!m_count) return false;
+
+        int32_t cx = CellCoord(pos.x);
+        int32_t cz = CellCoord(pos.z);
+        int32_t rings = (int32_t)ceilf(maxDistance / SPAWN_CELL_SIZE);
+        float bestSq = maxDistance * maxDistance;
+        uint32_t best = NO_POINT;
+
+        for (int32_t ring = 0; ring <= rings; ring++) {
+            // Todo ponto de um anel está a pelo menos (ring - 1) células de pos
+            float ringDistance = (float)(ring - 1) * SPAWN_CELL_SIZE;
+            if (ring > 1 && ringDistance * ringDistance > bestSq) break;
+
+            for (int32_t dz = -ring; dz <= ring; dz++) {
+                bool edge = dz == -ring || dz == ring;
+                for (int32_t dx = -ring; dx <= ring; dx += edge ? 1 : 2 * ring) {
+                    ScanBucket(CellBucket(cx + dx, cz + dz), pos, bestSq, best);
+                    if (!ring) break;
+                }
+            }
+        }
+
+        if (best == NO_POINT) return false;
+        out = { m_x[best], m_y[best], m_z[best] };
+        return true;
+    }
+
+    uint32_t Count() const { return m_count; }
+    Vec Point(uint32_t i) const { return { m_x[i], m_y[i], m_z[i] }; }
+    uint16_t RoomId() const { return m_roomId; }
+    bool IsDirty() const { return m_dirty; }
+
+    //-------------------------------------------------------------------------
+    // Cache em disco
+    //-------------------------------------------------------------------------
+
+    bool Save() {
+        if (!m_hasRoom) return false;
+        char path[MAX_PATH];
+        CachePath(m_roomId, path);
+        FILE* file = fopen(path, "wb");
+        if (!file) return false;
+
+        CacheHeader header;
+        header.magic = CACHE_MAGIC;
+        header.roomId = m_roomId;
+        header.version = CACHE_VERSION;
+        header.count = m_count;
+
+        // Agrupado por bucket: no Load cada lista sai contígua na memória
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        for (uint32_t b = 0; ok && b < SPAWN_BUCKETS; b++) {
+            for (uint32_t i = m_head[b]; ok && i != NO_POINT; i = m_next[i]) {
+                Vec point = { m_x[i], m_y[i], m_z[i] };
+                ok = fwrite(&point, sizeof(point), 1, file) == 1;
+            }
+        }
+        fclose(file);
+        if (ok) m_dirty = false;
+        return ok;
+    }
+
+    bool Load() {
+        Clear();
+        char path[MAX_PATH];
+        CachePath(m_roomId, path);
+        FILE* file = fopen(path, "rb");
+        if (!file) return false;
+
+        CacheHeader header;
+        bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+                  header.magic == CACHE_MAGIC && header.version == CACHE_VERSION &&
+                  header.roomId == m_roomId && header.count <= SPAWN_MAX_POINTS;
+        Vec block[256];
+        uint32_t count = ok ? header.count : 0;
+        for (uint32_t at = 0; ok && at < count;) {
+            uint32_t n = count - at < 256 ? count - at : 256;
+            ok = fread(block, sizeof(Vec), n, file) == n;
+            for (uint32_t k = 0; ok && k < n; k++, at++) {
+                ok = std::isfinite(block[k].x) && std::isfinite(block[k].y) && std::isfinite(block[k].z);
+                m_x[at] = block[k].x;
+                m_y[at] = block[k].y;
+                m_z[at] = block[k].z;
+            }
+        }
+        fclose(file);
+        if (!ok) return false;
+
+        // De trás para frente: cada lista começa no menor índice e segue em ordem
+        for (uint32_t i = count; i-- > 0;) Link(i);
+        m_count = count;
+        m_dirty = false;
+        return true;
+    }
+
+private:
+    static constexpr uint32_t NO_POINT = 0xFFFFFFFF;
+    static constexpr uint32_t CACHE_MAGIC = 0x4E505352;     // "RSPN"
+    static constexpr uint16_t CACHE_VERSION = 1;
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint16_t roomId;
+        uint16_t version;
+        uint32_t count;
+    };
+
+    static void CachePath(uint16_t roomId, char* path) {
+        char file[64];
+        snprintf(file, sizeof(file), SPAWN_CACHE_FORMAT, roomId);
+        CoopDataPath(file, path);
+    }
+
+    static int32_t CellCoord(float v) { return (int32_t)floorf(v / SPAWN_CELL_SIZE); }
+
+    static uint32_t CellBucket(int32_t cx, int32_t cz) {
+        uint32_t h = (uint32_t)cx * 73856093u ^ (uint32_t)cz * 19349663u;
+        return h & (SPAWN_BUCKETS - 1);
+    }
+
+    bool Insert(const Vec& pos) {
+        if (m_count >= SPAWN_MAX_POINTS) return false;
+        uint32_t i = m_count++;
+        m_x[i] = pos.x;
+        m_y[i] = pos.y;
+        m_z[i] = pos.z;
+        Link(i);
+        m_dirty = true;
+        return true;
+    }
+
+    // Ponto i na frente da lista do seu bucket
+    void Link(uint32_t i) {
+        uint32_t bucket = CellBucket(CellCoord(m_x[i]), CellCoord(m_z[i]));
+        m_next[i] = m_head[bucket];
+        m_head[bucket] = i;
+    }
+
+    void ScanBucket(uint32_t bucket, const Vec& pos, float& bestSq, uint32_t& best) const {
+        for (uint32_t i = m_head[bucket]; i != NO_POINT; i = m_next[i]) {
+            if (fabsf(m_y[i] - pos.y) > SPAWN_FLOOR_TOLERANCE) continue;
+            float dx = m_x[i] - pos.x;
+            float dz = m_z[i] - pos.z;
+            float distanceSq = dx * dx + dz * dz;
+            if (distanceSq < bestSq) {
+                bestSq = distanceSq;
+                best = i;
+            }
+        }
+    }
+
+    uint32_t m_head[SPAWN_BUCKETS];
+    uint32_t m_next[SPAWN_MAX_POINTS];
+    float m_x[SPAWN_MAX_POINTS];
+    float m_y[SPAWN_MAX_POINTS];
+    float m_z[SPAWN_MAX_POINTS];
+    uint32_t m_count = 0;
+
+    uint16_t m_roomId = 0;
+    bool m_hasRoom = false;
+    bool m_dirty = false;
+
+    SpawnFloorProbe m_probe = nullptr;
+    void* m_probeUser = nullptr;
+};
@@ -0,0 +1,385 @@
+/**
+ * RE4 CO-OP MOD - Telemetria de Rede
+ *
+ * Implementa:
+ * - Contadores por canal (PacketType): pacotes e bytes enviados/recebidos
+ * - Perda (buracos na sequência) e retransmissões
+ * - Profundidade da fila de envio
+ * - Histogramas logarítmicos (estilo HDR) de RTT e idade do snapshot
+ *
+ * Cada thread escreve só no seu próprio bloco de contadores, então não
+ * existe lock nem read-modify-write disputado no caminho quente. O snapshot
+ * soma os blocos com leituras relaxed e nunca bloqueia as threads de rede.
+ *
+ * No x64 os contadores de 64 bits são mov simples. No x86 (o alvo do jogo)
+ * load/store atômico de 64 bits vira LOCK CMPXCHG8B: continua sem disputa
+ * (a linha é do escritor), mas custa algumas dezenas de ciclos por evento.
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+//=============================================================================
+// HISTOGRAMA LOGARÍTMICO
+//=============================================================================
+
+// 8 sub-buckets lineares por potência de 2 (erro relativo máximo ~12.5%)
+constexpr uint32_t TELEMETRY_SUB_BITS = 3;
+constexpr uint32_t TELEMETRY_SUB_COUNT = 1u << TELEMETRY_SUB_BITS;
+constexpr uint32_t TELEMETRY_BUCKETS = (32 - TELEMETRY_SUB_BITS + 1) * TELEMETRY_SUB_COUNT;
+
+// Número de canais (um por valor possível de PacketType)
+constexpr uint32_t TELEMETRY_CHANNELS = 256;
+
+inline uint32_t TelemetryBucketIndex(uint32_t value) {
+    if (value < TELEMETRY_SUB_COUNT) return value;
+
+    uint32_t msb = 31;
+    while (!(value & (1u << msb))) msb--;
+
+    uint32_t shift = msb - TELEMETRY_SUB_BITS;
+    return (shift + 1) * TELEMETRY_SUB_COUNT + ((value >> shift) & (TELEMETRY_SUB_COUNT - 1));
+}
+
+// Menor valor que cai no bucket
+inline uint32_t TelemetryBucketValue(uint32_t index) {
+    if (index < TELEMETRY_SUB_COUNT) return index;
+
+    uint32_t shift = index / TELEMETRY_SUB_COUNT - 1;
+    uint32_t sub = index % TELEMETRY_SUB_COUNT;
+    return (TELEMETRY_SUB_COUNT | sub) << shift;
+}
+
+// Histograma agregado (cópia simples, sem atômicos)
+struct TelemetryHistogram {
+    uint64_t buckets[TELEMETRY_BUCKETS];
+    uint64_t count;
+    uint64_t sum;
+    uint32_t max;
+
+    // Valor no percentil p (0.0 a 1.0), em microssegundos
+    uint32_t Percentile(double p) const {
+        if (count == 0) return 0;
+
+        uint64_t target = (uint64_t)(p * (double)(count - 1)) + 1;
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < TELEMETRY_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen >= target) return TelemetryBucketValue(i);
+        }
+        return max;
+    }
+
+    uint32_t Mean() const {
+        return count ? (uint32_t)(sum / count) : 0;
+    }
+};
+
+//=============================================================================
+// SNAPSHOT (lido pelo menu e pelo dump externo)
+//=============================================================================
+
+struct ChannelStats {
+    uint64_t packetsSent;
+    uint64_t bytesSent;
+    uint64_t packetsReceived;
+    uint64_t bytesReceived;
+    uint64_t lost;          // Pacotes que faltaram na sequência
+    uint64_t retransmits;
+};
+
+struct TelemetrySnapshot {
+    ChannelStats channels[TELEMETRY_CHANNELS];
+    ChannelStats total;
+
+    TelemetryHistogram rtt;          // Round-trip (us)
+    TelemetryHistogram snapshotAge;  // Idade do último estado consumido (us)
+
+    uint32_t lastRttUs;
+    uint32_t queueDepth;
+    uint32_t queueDepthMax;
+
+    // Perda em % sobre tudo que deveria ter chegado
+    float LossPercent() const {
+        uint64_t expected = total.packetsReceived + total.lost;
+        return expected ? (float)(100.0 * (double)total.lost / (double)expected) : 0.0f;
+    }
+};
+
+//=============================================================================
+// BLOCO POR THREAD
+//=============================================================================
+
+// Cada bloco tem um único escritor. Por isso os incrementos são load+store
+// relaxed (não fetch_add) e mesmo assim o leitor nunca vê valor rasgado.
+class TelemetryBlock {
+public:
+    void RecordSend(uint8_t channel, uint32_t bytes) {
+        Bump(m_channels[channel].packetsSent, 1);
+        Bump(m_channels[channel].bytesSent, bytes);
+    }
+
+    // sequence é usado para detectar perda (só em canais com sequência crescente)
+    void RecordReceive(uint8_t channel, uint32_t bytes, uint32_t sequence, bool trackLoss) {
+        AtomicChannel& ch = m_channels[channel];
+        Bump(ch.packetsReceived, 1);
+        Bump(ch.bytesReceived, bytes);
+
+        if (!trackLoss) return;
+
+        uint32_t expected = ch.nextSequence.load(std::memory_order_relaxed);
+        if (ch.sequenced.load(std::memory_order_relaxed) && sequence > expected) {
+            Bump(ch.lost, sequence - expected);
+        }
+        if (!ch.sequenced.load(std::memory_order_relaxed) || sequence >= expected) {
+            ch.nextSequence.store(sequence + 1, std::memory_order_relaxed);
+            ch.sequenced.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    void RecordRetransmit(uint8_t channel) {
+        Bump(m_channels[channel].retransmits, 1);
+    }
+
+    void RecordRtt(uint32_t micros) {
+        Record(m_rtt, micros);
+        m_lastRttUs.store(micros, std::memory_order_relaxed);
+    }
+
+    void RecordSnapshotAge(uint32_t micros) {
+        Record(m_snapshotAge, micros);
+    }
+
+    void RecordQueueDepth(uint32_t depth) {
+        m_queueDepth.store(depth, std::memory_order_relaxed);
+        if (depth > m_queueDepthMax.load(std::memory_order_relaxed)) {
+            m_queueDepthMax.store(depth, std::memory_order_relaxed);
+        }
+    }
+
+    void Reset() {
+        for (AtomicChannel& ch : m_channels) {
+            ch.packetsSent.store(0, std::memory_order_relaxed);
+            ch.bytesSent.store(0, std::memory_order_relaxed);
+            ch.packetsReceived.store(0, std::memory_order_relaxed);
+            ch.bytesReceived.store(0, std::memory_order_relaxed);
+            ch.lost.store(0, std::memory_order_relaxed);
+            ch.retransmits.store(0, std::memory_order_relaxed);
+            ch.nextSequence.store(0, std::memory_order_relaxed);
+            ch.sequenced.store(false, std::memory_order_relaxed);
+        }
+        ResetHistogram(m_rtt);
+        ResetHistogram(m_snapshotAge);
+        m_lastRttUs.store(0, std::memory_order_relaxed);
+        m_queueDepth.store(0, std::memory_order_relaxed);
+        m_queueDepthMax.store(0, std::memory_order_relaxed);
+        m_owned.store(false, std::memory_order_relaxed);
+    }
+
+private:
+    friend class NetTelemetry;
+
+    struct AtomicChannel {
+        std::atomic<uint64_t> packetsSent;
+        std::atomic<uint64_t> bytesSent;
+        std::atomic<uint64_t> packetsReceived;
+        std::atomic<uint64_t> bytesReceived;
+        std::atomic<uint64_t> lost;
+        std::atomic<uint64_t> retransmits;
+        std::atomic<uint32_t> nextSequence;
+        std::atomic<bool> sequenced;
+    };
+
+    struct AtomicHistogram {
+        std::atomic<uint64_t> buckets[TELEMETRY_BUCKETS];
+        std::atomic<uint64_t> sum;
+        std::atomic<uint32_t> max;
+    };
+
+    static void Bump(std::atomic<uint64_t>& counter, uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    static void ResetHistogram(AtomicHistogram& h) {
+        for (std::atomic<uint64_t>& bucket : h.buckets) bucket.store(0, std::memory_order_relaxed);
+        h.sum.store(0, std::memory_order_relaxed);
+        h.max.store(0, std::memory_order_relaxed);
+    }
+
+    static void Record(AtomicHistogram& h, uint32_t value) {
+        Bump(h.buckets[TelemetryBucketIndex(value)], 1);
+        Bump(h.sum, value);
+        if (value > h.max.load(std::memory_order_relaxed)) {
+            h.max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    AtomicChannel m_channels[TELEMETRY_CHANNELS];
+    AtomicHistogram m_rtt;
+    AtomicHistogram m_snapshotAge;
+    std::atomic<uint32_t> m_lastRttUs;
+    std::atomic<uint32_t> m_queueDepth;
+    std::atomic<uint32_t> m_queueDepthMax;
+    std::atomic<bool> m_owned;
+};
+
+//=============================================================================
+// TELEMETRIA DE UM ENDPOINT (servidor ou cliente)
+//=============================================================================
+
+class NetTelemetry {
+public:
+    // Bloco 0 é reservado para a thread do jogo; os outros são das threads de rede
+    static constexpr int MAX_WRITERS = 8;
+
+    // Posse de um bloco enquanto a thread de rede estiver viva
+    class Writer {
+    public:
+        explicit Writer(TelemetryBlock* block) : m_block(block) {}
+        Writer(Writer&& other) noexcept : m_block(other.m_block) { other.m_block = nullptr; }
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+        ~Writer() {
+            // Os contadores ficam no bloco: a próxima thread continua somando
+            if (m_block) m_block->m_owned.store(false, std::memory_order_release);
+        }
+
+        TelemetryBlock* operator->() { return m_block; }
+        TelemetryBlock& operator*() { return *m_block; }
+
+    private:
+        TelemetryBlock* m_block;
+    };
+
+    NetTelemetry() {
+        Reset();
+    }
+
+    // Bloco exclusivo da thread do jogo (SendGameState, Update, ...)
+    TelemetryBlock& GameThread() { return m_blocks[0]; }
+
+    // Último RTT medido por qualquer thread (0 se ainda não houve PONG)
+    uint32_t LastRttUs() const {
+        uint32_t rtt = 0;
+        for (int i = 0; i < MAX_WRITERS; i++) {
+            uint32_t v = m_blocks[i].m_lastRttUs.load(std::memory_order_relaxed);
+            if (v) rtt = v;
+        }
+        return rtt;
+    }
+
+    // Chamado uma vez no início de cada thread de rede
+    Writer Acquire() {
+        for (int i = 1; i < MAX_WRITERS; i++) {
+            bool expected = false;
+            if (m_blocks[i].m_owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return Writer(&m_blocks[i]);
+            }
+        }
+        // Sem bloco livre: a thread não registra nada (nunca acontece com 3 threads)
+        return Writer(&m_discard);
+    }
+
+    // Zera tudo (nova sessão). Só deve ser chamado sem threads de rede vivas.
+    void Reset() {
+        for (int i = 0; i < MAX_WRITERS; i++) m_blocks[i].Reset();
+        m_discard.Reset();
+        m_discard.m_owned.store(true, std::memory_order_relaxed);
+    }
+
+    // Soma todos os blocos. Não bloqueia ninguém; valores podem estar
+    // alguns incrementos atrás das threads de rede.
+    void Snapshot(TelemetrySnapshot& out) const {
+        memset(&out, 0, sizeof(out));
+
+        for (int b = 0; b < MAX_WRITERS; b++) {
+            const TelemetryBlock& block = m_blocks[b];
+
+            for (uint32_t c = 0; c < TELEMETRY_CHANNELS; c++) {
+                const TelemetryBlock::AtomicChannel& src = block.m_channels[c];
+                ChannelStats& dst = out.channels[c];
+                dst.packetsSent += src.packetsSent.load(std::memory_order_relaxed);
+                dst.bytesSent += src.bytesSent.load(std::memory_order_relaxed);
+                dst.packetsReceived += src.packetsReceived.load(std::memory_order_relaxed);
+                dst.bytesReceived += src.bytesReceived.load(std::memory_order_relaxed);
+                dst.lost += src.lost.load(std::memory_order_relaxed);
+                dst.retransmits += src.retransmits.load(std::memory_order_relaxed);
+            }
+
+            Merge(out.rtt, block.m_rtt);
+            Merge(out.snapshotAge, block.m_snapshotAge);
+
+            uint32_t rtt = block.m_lastRttUs.load(std::memory_order_relaxed);
+            if (rtt) out.lastRttUs = rtt;
+
+            out.queueDepth += block.m_queueDepth.load(std::memory_order_relaxed);
+            uint32_t depthMax = block.m_queueDepthMax.load(std::memory_order_relaxed);
+            if (depthMax > out.queueDepthMax) out.queueDepthMax = depthMax;
+        }
+
+        for (uint32_t c = 0; c < TELEMETRY_CHANNELS; c++) {
+            const ChannelStats& ch = out.channels[c];
+            out.total.packetsSent += ch.packetsSent;
+            out.total.bytesSent += ch.bytesSent;
+            out.total.packetsReceived += ch.packetsReceived;
+            out.total.bytesReceived += ch.bytesReceived;
+            out.total.lost += ch.lost;
+            out.total.retransmits += ch.retransmits;
+        }
+    }
+
+private:
+    static void Merge(TelemetryHistogram& dst, const TelemetryBlock::AtomicHistogram& src) {
+        for (uint32_t i = 0; i < TELEMETRY_BUCKETS; i++) {
+            uint64_t n = src.buckets[i].load(std::memory_order_relaxed);
+            dst.buckets[i] += n;
+            dst.count += n;
+        }
+        dst.sum += src.sum.load(std::memory_order_relaxed);
+        uint32_t max = src.max.load(std::memory_order_relaxed);
+        if (max > dst.max) dst.max = max;
+    }
+
+    TelemetryBlock m_blocks[MAX_WRITERS];
+    TelemetryBlock m_discard;
+};
+
+//=============================================================================
+// DUMP EXTERNO
+//=============================================================================
+
+// Escreve o snapshot em texto (arquivo de log, console, ...).
+// channelName é opcional e converte o id do canal em nome legível.
+inline void DumpTelemetry(const TelemetrySnapshot& snap, FILE* out,
+                          const char* (*channelName)(uint8_t) = nullptr) {
+    if (!out) return;
+
+    fprintf(out, "[NET] total: tx %llu pkts / %llu B, rx %llu pkts / %llu B, perda %.2f%%, retx %llu\n",
+            (unsigned long long)snap.total.packetsSent, (unsigned long long)snap.total.bytesSent,
+            (unsigned long long)snap.total.packetsReceived, (unsigned long long)snap.total.bytesReceived,
+            snap.LossPercent(), (unsigned long long)snap.total.retransmits);
+
+    for (uint32_t c = 0; c < TELEMETRY_CHANNELS; c++) {
+        const ChannelStats& ch = snap.channels[c];
+        if (!ch.packetsSent && !ch.packetsReceived) continue;
+
+        const char* name = channelName ? channelName((uint8_t)c) : nullptr;
+        fprintf(out, "[NET]   %-14s tx %llu / %llu B  rx %llu / %llu B  perda %llu  retx %llu\n",
+                name ? name : "?",
+                (unsigned long long)ch.packetsSent, (unsigned long long)ch.bytesSent,
+                (unsigned long long)ch.packetsReceived, (unsigned long long)ch.bytesReceived,
+                (unsigned long long)ch.lost, (unsigned long long)ch.retransmits);
+    }
+
+    fprintf(out, "[NET] rtt us: p50 %u  p90 %u  p99 %u  max %u  (n=%llu)\n",
+            snap.rtt.Percentile(0.50), snap.rtt.Percentile(0.90),
+            snap.rtt.Percentile(0.99), snap.rtt.max, (unsigned long long)snap.rtt.count);
+    fprintf(out, "[NET] idade do snapshot us: p50 %u  p90 %u  p99 %u  max %u  (n=%llu)\n",
+            snap.snapshotAge.Percentile(0.50), snap.snapshotAge.Percentile(0.90),
+            snap.snapshotAge.Percentile(0.99), snap.snapshotAge.max,
+            (unsigned long long)snap.snapshotAge.count);
+    fprintf(out, "[NET] fila de envio: %u (max %u)\n", snap.queueDepth, snap.queueDepthMax);
+}
@@ -0,0 +1,185 @@
+/**
+ * RE4 CO-OP MOD - Scheduler de Tick Fixo
+ *
+ * A simulação do co-op (input da Ashley, teleporte, replicação) roda em
+ * ticks de duração fixa, independente do FPS do jogo. Cada frame soma o
+ * tempo real num acumulador e executa quantos ticks couberem nele.
+ *
+ * O acumulador é racional (us x tickRate contra 1e6 por tick): 1/60 s não
+ * é um número inteiro de us, e truncar em 16666 us adiantaria a simulação
+ * em 0.004% (8 ticks por hora) em relação a um peer com outra taxa.
+ *
+ * - Frame lento: roda vários ticks para alcançar (até maxCatchUpTicks)
+ * - Frame rápido: pode rodar zero ticks
+ * - Alpha(): fração do próximo tick já acumulada, para interpolar a
+ *   apresentação entre o estado do tick anterior e o atual
+ *
+ * ClockSync estima o relógio do host no cliente (PING/PONG com os quatro
+ * relógios do NTP), para o cliente avançar sozinho o que o host só manda
+ * quando muda.
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+//=============================================================================
+// RELÓGIO
+//=============================================================================
+
+// Relógio monotônico em microssegundos (QueryPerformanceCounter no MSVC)
+inline uint64_t CoopNowMicros() {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Relógio em microssegundos truncado em 32 bits (como vai no fio). Dá a
+// volta a cada ~71 min; diferenças em uint32_t continuam certas.
+inline uint32_t CoopClockMicros32() {
+    return (uint32_t)CoopNowMicros();
+}
+
+//=============================================================================
+// SINCRONIA DE RELÓGIO
+//=============================================================================
+
+constexpr uint32_t CLOCK_SYNC_WINDOW = 8;     // Amostras (uma por PING)
+
+// Offset host - local. Cada amostra (envio local, chegada e saída no host,
+// chegada local) dá um offset com erro de no máximo RTT/2, onde o RTT já
+// desconta o tempo que a resposta esperou no host; fica o da amostra de
+// menor RTT da janela, que é a que menos sofreu com fila e jitter.
+class ClockSync {
+public:
+    void Reset() {
+        m_count = 0;
+        m_next = 0;
+        m_lastRtt = 0;
+        m_offset.store(0, std::memory_order_relaxed);
+        m_synced.store(false, std::memory_order_relaxed);
+    }
+
+    // Só a thread que recebe os PONGs chama. false se a amostra é inválida.
+    bool AddSample(uint32_t localSend, uint32_t remoteReceive, uint32_t remoteSend, uint32_t localReceive) {
+        uint32_t total = localReceive - localSend;
+        uint32_t hold = remoteSend - remoteReceive;
+        if (total > 0x7FFFFFFFu || hold > total) return false;     // Relógio voltou (aqui ou lá)
+        uint32_t rtt = total - hold;
+
+        // Média da ida (chegada lá - envio aqui) e da volta (saída lá - chegada aqui)
+        int64_t out = (int32_t)(remoteReceive - localSend);
+        int64_t back = (int32_t)(remoteSend - localReceive);
+
+        Sample& sample = m_samples[m_next];
+        sample.rtt = rtt;
+        sample.offset = (int32_t)((out + back) / 2);
+        m_lastRtt = rtt;
+        m_next = (m_next + 1) % CLOCK_SYNC_WINDOW;
+        if (m_count < CLOCK_SYNC_WINDOW) m_count++;
+
+        // Da mais velha para a mais nova; empate fica com a mais nova (drift)
+        uint32_t oldest = m_count < CLOCK_SYNC_WINDOW ? 0 : m_next;
+        const Sample* best = &m_samples[oldest];
+        for (uint32_t k = 1; k < m_count; k++) {
+            const Sample& candidate = m_samples[(oldest + k) % CLOCK_SYNC_WINDOW];
+            if (candidate.rtt <= best->rtt) best = &candidate;
+        }
+        m_offset.store(best->offset, std::memory_order_relaxed);
+        m_bestRtt.store(best->rtt, std::memory_order_relaxed);
+        m_synced.store(true, std::memory_order_release);
+        return true;
+    }
+
+    // RTT da última amostra válida (só a thread que chama AddSample)
+    uint32_t LastRtt() const { return m_lastRtt; }
+
+    // Qualquer thread
+    bool Synced() const { return m_synced.load(std::memory_order_acquire); }
+    int32_t Offset() const { return m_offset.load(std::memory_order_relaxed); }
+    uint32_t BestRtt() const { return m_bestRtt.load(std::memory_order_relaxed); }
+    uint32_t RemoteMicros(uint32_t local) const { return local + (uint32_t)Offset(); }
+
+private:
+    struct Sample {
+        uint32_t rtt;
+        int32_t offset;
+    };
+
+    Sample m_samples[CLOCK_SYNC_WINDOW] = {};
+    uint32_t m_count = 0;
+    uint32_t m_next = 0;
+    uint32_t m_lastRtt = 0;
+    std::atomic<int32_t> m_offset{0};
+    std::atomic<uint32_t> m_bestRtt{0};
+    std::atomic<bool> m_synced{false};
+};
+
+//=============================================================================
+// SCHEDULER
+//=============================================================================
+
+class FixedTickScheduler {
+public:
+    explicit FixedTickScheduler(uint32_t tickRate = 60, uint32_t maxCatchUpTicks = 8) {
+        SetTickRate(tickRate);
+        m_maxCatchUp = maxCatchUpTicks;
+    }
+
+    void SetTickRate(uint32_t tickRate) {
+        if (tickRate == 0) tickRate = 1;
+        m_accumulator = m_accumulator / m_tickRate * tickRate;
+        m_tickRate = tickRate;
+    }
+
+    void SetMaxCatchUp(uint32_t ticks) { m_maxCatchUp = ticks ? ticks : 1; }
+
+    void Reset() {
+        m_accumulator = 0;
+        m_tick = 0;
+        m_droppedMicros = 0;
+    }
+
+    // Soma o tempo do frame e executa tick(tickIndex, dtSeconds) quantas
+    // vezes couber. Retorna o número de ticks executados.
+    template<typename TickFn>
+    uint32_t Advance(uint64_t frameMicros, TickFn&& tick) {
+        m_accumulator += frameMicros * m_tickRate;
+
+        // Espiral da morte: se nem o catch-up alcança, descarta o excesso
+        uint64_t limit = TICK_UNITS * m_maxCatchUp;
+        if (m_accumulator > limit) {
+            m_droppedMicros += (m_accumulator - limit) / m_tickRate;
+            m_accumulator = limit;
+        }
+
+        uint32_t ran = 0;
+        float dt = TickSeconds();
+        while (m_accumulator >= TICK_UNITS) {
+            m_accumulator -= TICK_UNITS;
+            tick(m_tick, dt);
+            m_tick++;
+            ran++;
+        }
+        return ran;
+    }
+
+    float TickSeconds() const { return 1.0f / (float)m_tickRate; }
+    uint32_t TickRate() const { return m_tickRate; }
+    uint64_t TickIndex() const { return m_tick; }
+    uint64_t DroppedMicros() const { return m_droppedMicros; }
+
+    // 0.0 = exatamente no último tick, ~1.0 = quase no próximo
+    float Alpha() const { return (float)m_accumulator / (float)TICK_UNITS; }
+
+private:
+    // Um tick no acumulador (us x tickRate)
+    static constexpr uint64_t TICK_UNITS = 1000000;
+
+    uint32_t m_tickRate = 60;
+    uint32_t m_maxCatchUp = 8;
+
+    uint64_t m_accumulator = 0;     // us x tickRate
+    uint64_t m_tick = 0;
+    uint64_t m_droppedMicros = 0;
+};